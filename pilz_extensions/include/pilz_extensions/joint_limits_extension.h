@@ -19,12 +19,19 @@
 
 #include <joint_limits_interface/joint_limits.h>
 #include <map>
+#include <memory>
+
+#include "pilz_extensions/joint_limits_grid.h"
 
 namespace pilz_extensions {
 namespace joint_limits_interface {
 
 /**
  * @brief Extends joint_limits_interface::JointLimits with a deceleration parameter
+ * and with configuration dependent limits
+ *
+ * A grid of a configuration dependent limit tightens the scalar limit: the limit
+ * at a configuration is the minimum of the scalar limit and the interpolated grid value.
  */
 struct JointLimits : ::joint_limits_interface::JointLimits {
   JointLimits()
@@ -37,6 +44,15 @@ double max_deceleration;
 
 bool has_deceleration_limits;
 
+/// maximum velocity over the joint positions and the payload, nullptr if none
+std::shared_ptr<const JointLimitsGrid> velocity_grid;
+
+/// maximum acceleration over the joint positions and the payload, nullptr if none
+std::shared_ptr<const JointLimitsGrid> acceleration_grid;
+
+/// maximum deceleration (as positive values) over the joint positions and the payload, nullptr if none
+std::shared_ptr<const JointLimitsGrid> deceleration_grid;
+
 };
 }
 
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JOINT_LIMITS_GRID_H
+#define JOINT_LIMITS_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pilz_extensions {
+
+/**
+ * @brief A limit of a joint tabulated over a grid of joint positions and the payload,
+ * interpolated multilinearly between the grid points.
+ *
+ * The grid is spanned by up to MAX_AXES axes, each with strictly increasing points. An axis is
+ * either the position of a joint (given by the name of the joint) or the payload [kg] (PAYLOAD_AXIS).
+ * The values are stored row-major, i.e. the index of the last axis changes fastest.
+ *
+ * Coordinates outside of an axis are clamped to the axis. A coordinate which is not known (NaN)
+ * takes the minimum over the whole axis, so that an unknown payload or joint position
+ * results in the worst case.
+ */
+class JointLimitsGrid
+{
+public:
+  //! Maximal number of axes of a grid.
+  static constexpr std::size_t MAX_AXES {4};
+
+  struct Axis
+  {
+    //! Name of the joint, or PAYLOAD_AXIS
+    std::string name;
+    //! Strictly increasing points of the axis
+    std::vector<double> points;
+  };
+
+  static const std::string& getPayloadAxisName()
+  {
+    static const std::string PAYLOAD_AXIS {"payload"};
+    return PAYLOAD_AXIS;
+  }
+
+public:
+  /**
+   * @throws std::invalid_argument if the grid has no or more than MAX_AXES axes, an axis has no points
+   * or its points are not strictly increasing, or the number of values does not match the grid.
+   */
+  JointLimitsGrid(const std::vector<Axis>& axes, const std::vector<double>& values)
+    : axes_(axes)
+    , values_(values)
+    , strides_(axes.size())
+  {
+    if(axes_.empty() || axes_.size() > MAX_AXES)
+    {
+      throw std::invalid_argument("A joint limits grid needs 1 to " + std::to_string(MAX_AXES) + " axes");
+    }
+    std::size_t value_count {1};
+    for(std::size_t i = axes_.size(); i-- > 0;)
+    {
+      const std::vector<double>& points {axes_[i].points};
+      if(points.empty() || std::adjacent_find(points.begin(), points.end(), std::greater_equal<double>()) != points.end())
+      {
+        throw std::invalid_argument("The points of axis " + axes_[i].name + " are empty or not strictly increasing");
+      }
+      strides_[i] = value_count;
+      value_count *= points.size();
+    }
+    if(values_.size() != value_count)
+    {
+      throw std::invalid_argument("A joint limits grid of this size needs " + std::to_string(value_count)
+                                  + " values, got " + std::to_string(values_.size()));
+    }
+  }
+
+  const std::vector<Axis>& getAxes() const
+  {
+    return axes_;
+  }
+
+  const std::vector<double>& getValues() const
+  {
+    return values_;
+  }
+
+  /**
+   * @return The grid with all values multiplied by the factor.
+   */
+  JointLimitsGrid scaled(double factor) const
+  {
+    JointLimitsGrid grid {*this};
+    for(double& value : grid.values_)
+    {
+      value *= factor;
+    }
+    return grid;
+  }
+
+  /**
+   * @brief Interpolates the limit at the coordinates (one per axis, in the order of the axes).
+   */
+  double interpolate(const double* coordinates) const
+  {
+    return interpolate(0, 0, coordinates);
+  }
+
+  /**
+   * @brief Returns the minimal value of the grid points of all cells intersecting the box [lower, upper],
+   * a lower bound of the interpolated limit within the box.
+   * @param lower Lower bounds of the box (one per axis)
+   * @param upper Upper bounds of the box (one per axis)
+   */
+  double getMinimum(const double* lower, const double* upper) const
+  {
+    return getMinimum(0, 0, lower, upper);
+  }
+
+private:
+  double interpolate(std::size_t axis, std::size_t offset, const double* coordinates) const
+  {
+    if(axis == axes_.size())
+    {
+      return values_[offset];
+    }
+    const std::vector<double>& points {axes_[axis].points};
+    const double coordinate {coordinates[axis]};
+    if(std::isnan(coordinate))
+    {
+      double minimum {std::numeric_limits<double>::infinity()};
+      for(std::size_t i = 0; i < points.size(); ++i)
+      {
+        minimum = std::min(minimum, interpolate(axis + 1, offset + i * strides_[axis], coordinates));
+      }
+      return minimum;
+    }
+    if(coordinate <= points.front())
+    {
+      return interpolate(axis + 1, offset, coordinates);
+    }
+    if(coordinate >= points.back())
+    {
+      return interpolate(axis + 1, offset + (points.size() - 1) * strides_[axis], coordinates);
+    }
+
+    const std::size_t i {static_cast<std::size_t>(std::upper_bound(points.begin(), points.end(), coordinate)
+                                                  - points.begin()) - 1};
+    const double weight {(coordinate - points[i]) / (points[i + 1] - points[i])};
+    return (1. - weight) * interpolate(axis + 1, offset + i * strides_[axis], coordinates)
+           + weight * interpolate(axis + 1, offset + (i + 1) * strides_[axis], coordinates);
+  }
+
+  double getMinimum(std::size_t axis, std::size_t offset, const double* lower, const double* upper) const
+  {
+    if(axis == axes_.size())
+    {
+      return values_[offset];
+    }
+    const std::vector<double>& points {axes_[axis].points};
+    std::size_t first {0}, last {points.size() - 1};
+    if(!std::isnan(lower[axis]) && !std::isnan(upper[axis]))
+    {
+      // the grid points of the cells containing the bounds
+      const auto lower_it = std::upper_bound(points.begin(), points.end(), lower[axis]);
+      first = lower_it == points.begin() ? 0 : static_cast<std::size_t>(lower_it - points.begin()) - 1;
+      const auto upper_it = std::lower_bound(points.begin(), points.end(), upper[axis]);
+      last = upper_it == points.end() ? points.size() - 1 : static_cast<std::size_t>(upper_it - points.begin());
+    }
+
+    double minimum {std::numeric_limits<double>::infinity()};
+    for(std::size_t i = first; i <= last; ++i)
+    {
+      minimum = std::min(minimum, getMinimum(axis + 1, offset + i * strides_[axis], lower, upper));
+    }
+    return minimum;
+  }
+
+private:
+  std::vector<Axis> axes_;
+  std::vector<double> values_;
+  //! Distance of neighboring points of an axis in the values
+  std::vector<std::size_t> strides_;
+};
+
+}
+
+#endif // JOINT_LIMITS_GRID_H
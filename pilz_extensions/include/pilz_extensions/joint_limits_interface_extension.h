@@ -17,14 +17,176 @@
 #ifndef JOINT_LIMITS_INTERFACE_EXTENSION_H
 #define JOINT_LIMITS_INTERFACE_EXTENSION_H
 
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <joint_limits_interface/joint_limits_rosparam.h>
 #include "pilz_extensions/joint_limits_extension.h"
 
 namespace pilz_extensions {
 namespace joint_limits_interface {
 
+namespace detail
+{
+
+/**
+ * @brief Reads a boolean member of an XmlRpc struct.
+ */
+inline bool getMember(XmlRpc::XmlRpcValue& param, const std::string& name, bool& value)
+{
+  if(!param.hasMember(name) || param[name].getType() != XmlRpc::XmlRpcValue::TypeBoolean)
+  {
+    return false;
+  }
+  value = static_cast<bool>(param[name]);
+  return true;
+}
+
+/**
+ * @brief Reads a floating point member of an XmlRpc struct, which may also be given as integer.
+ */
+inline bool getMember(XmlRpc::XmlRpcValue& param, const std::string& name, double& value)
+{
+  if(!param.hasMember(name))
+  {
+    return false;
+  }
+  XmlRpc::XmlRpcValue& member {param[name]};
+  if(member.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+  {
+    value = static_cast<double>(member);
+    return true;
+  }
+  if(member.getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    value = static_cast<int>(member);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Reads the limit "max_<name>" if "has_<name>_limits" is set (as ::joint_limits_interface::getJointLimits).
+ */
+inline void getLimit(XmlRpc::XmlRpcValue& param, const std::string& name, bool& has_limit, double& max_limit)
+{
+  bool has_param_limit {false};
+  if(getMember(param, "has_" + name + "_limits", has_param_limit))
+  {
+    if(!has_param_limit) {has_limit = false;}
+    double max_param_limit;
+    if(has_param_limit && getMember(param, "max_" + name, max_param_limit))
+    {
+      has_limit = true;
+      max_limit = max_param_limit;
+    }
+  }
+}
+
+/**
+ * @brief Reads an array of floating point numbers, which may also be given as integers.
+ * @throws std::invalid_argument if the value is no such array.
+ */
+inline std::vector<double> getNumbers(XmlRpc::XmlRpcValue& param, const std::string& name)
+{
+  if(param.getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    throw std::invalid_argument(name + " must be an array of numbers");
+  }
+  std::vector<double> numbers;
+  numbers.reserve(static_cast<std::size_t>(param.size()));
+  for(int i = 0; i < param.size(); ++i)
+  {
+    if(param[i].getType() == XmlRpc::XmlRpcValue::TypeDouble)
+    {
+      numbers.push_back(static_cast<double>(param[i]));
+    }
+    else if(param[i].getType() == XmlRpc::XmlRpcValue::TypeInt)
+    {
+      numbers.push_back(static_cast<int>(param[i]));
+    }
+    else
+    {
+      throw std::invalid_argument(name + " must be an array of numbers");
+    }
+  }
+  return numbers;
+}
+
+/**
+ * @brief Reads the grid "max_<name>" of the configuration dependent limits, nullptr if there is none.
+ */
+inline std::shared_ptr<const JointLimitsGrid> getGrid(XmlRpc::XmlRpcValue& table,
+                                                      const std::vector<JointLimitsGrid::Axis>& axes,
+                                                      const std::string& name)
+{
+  const std::string member {"max_" + name};
+  if(!table.hasMember(member))
+  {
+    return nullptr;
+  }
+  std::vector<double> values {getNumbers(table[member], member)};
+  for(double& value : values)
+  {
+    value = std::fabs(value);
+  }
+  return std::make_shared<const JointLimitsGrid>(axes, values);
+}
+
+/**
+ * @brief Reads the configuration dependent limits of a joint:
+ *
+ * @code
+ * configuration_dependent_limits:
+ *   axes:
+ *     - {name: joint_2, points: [-1.5, 0.0, 1.5]}
+ *     - {name: payload, points: [0.0, 5.0]}
+ *   max_acceleration: [2.0, 1.2,  3.0, 2.0,  2.0, 1.2]
+ * @endcode
+ *
+ * The grids "max_velocity", "max_acceleration" and "max_deceleration" are optional; the deceleration
+ * is stored as positive values.
+ * @throws std::invalid_argument if the limits are malformed.
+ */
+inline void getConfigurationDependentLimits(XmlRpc::XmlRpcValue& table,
+                                            ::pilz_extensions::joint_limits_interface::JointLimits& limits)
+{
+  if(table.getType() != XmlRpc::XmlRpcValue::TypeStruct || !table.hasMember("axes")
+     || table["axes"].getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    throw std::invalid_argument("configuration_dependent_limits must be a struct with an array of axes");
+  }
+
+  std::vector<JointLimitsGrid::Axis> axes;
+  XmlRpc::XmlRpcValue& axes_param {table["axes"]};
+  for(int i = 0; i < axes_param.size(); ++i)
+  {
+    XmlRpc::XmlRpcValue& axis_param {axes_param[i]};
+    if(axis_param.getType() != XmlRpc::XmlRpcValue::TypeStruct || !axis_param.hasMember("name")
+       || axis_param["name"].getType() != XmlRpc::XmlRpcValue::TypeString || !axis_param.hasMember("points"))
+    {
+      throw std::invalid_argument("An axis of configuration_dependent_limits needs a name and points");
+    }
+    JointLimitsGrid::Axis axis;
+    axis.name = static_cast<std::string>(axis_param["name"]);
+    axis.points = getNumbers(axis_param["points"], "points of axis " + axis.name);
+    axes.push_back(axis);
+  }
+
+  limits.velocity_grid = getGrid(table, axes, "velocity");
+  limits.acceleration_grid = getGrid(table, axes, "acceleration");
+  limits.deceleration_grid = getGrid(table, axes, "deceleration");
+}
+
+}
+
+
 /**
  * @see joint_limits_inteface::getJointLimits(...)
+ * @throws std::invalid_argument if the configuration dependent limits are malformed.
  */
 inline bool getJointLimits(const std::string& joint_name,
                            const ros::NodeHandle& nh,
@@ -68,6 +230,72 @@ inline bool getJointLimits(const std::string& joint_name,
     }
   }
 
+  // Configuration dependent limits
+  XmlRpc::XmlRpcValue configuration_dependent_limits;
+  if(limits_nh.getParam("configuration_dependent_limits", configuration_dependent_limits))
+  {
+    detail::getConfigurationDependentLimits(configuration_dependent_limits, limits);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Same as getJointLimits(joint_name, nh, limits), but reads the limits from the
+ * already fetched parameter "joint_limits" (a struct with one member per joint), which saves
+ * the round-trips to the parameter server per joint and limit.
+ *
+ * @param joint_name Name of the joint
+ * @param joint_limits_param The parameter "joint_limits"
+ * @param limits The limits to be updated with the limits of the parameter
+ * @return True if the parameter contains limits of the joint
+ * @throws std::invalid_argument if the configuration dependent limits are malformed.
+ */
+inline bool getJointLimits(const std::string& joint_name,
+                           XmlRpc::XmlRpcValue& joint_limits_param,
+                           ::pilz_extensions::joint_limits_interface::JointLimits& limits)
+{
+  if(joint_limits_param.getType() != XmlRpc::XmlRpcValue::TypeStruct
+     || !joint_limits_param.hasMember(joint_name)
+     || joint_limits_param[joint_name].getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    ROS_DEBUG_STREAM("No joint limits specification found for joint '" << joint_name << "'.");
+    return false;
+  }
+  XmlRpc::XmlRpcValue& param {joint_limits_param[joint_name]};
+
+  // Position limits
+  bool has_position_limits {false};
+  if(detail::getMember(param, "has_position_limits", has_position_limits))
+  {
+    if(!has_position_limits) {limits.has_position_limits = false;}
+    double min_pos, max_pos;
+    if(has_position_limits && detail::getMember(param, "min_position", min_pos)
+       && detail::getMember(param, "max_position", max_pos))
+    {
+      limits.has_position_limits = true;
+      limits.min_position = min_pos;
+      limits.max_position = max_pos;
+    }
+
+    bool angle_wraparound;
+    if(!has_position_limits && detail::getMember(param, "angle_wraparound", angle_wraparound))
+    {
+      limits.angle_wraparound = angle_wraparound;
+    }
+  }
+
+  detail::getLimit(param, "velocity", limits.has_velocity_limits, limits.max_velocity);
+  detail::getLimit(param, "acceleration", limits.has_acceleration_limits, limits.max_acceleration);
+  detail::getLimit(param, "jerk", limits.has_jerk_limits, limits.max_jerk);
+  detail::getLimit(param, "effort", limits.has_effort_limits, limits.max_effort);
+  detail::getLimit(param, "deceleration", limits.has_deceleration_limits, limits.max_deceleration);
+
+  if(param.hasMember("configuration_dependent_limits"))
+  {
+    detail::getConfigurationDependentLimits(param["configuration_dependent_limits"], limits);
+  }
+
   return true;
 }
 
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <limits>
+#include <stdexcept>
+
 #include "ros/ros.h"
 
 #include <gtest/gtest.h>
@@ -75,6 +78,112 @@ TEST_F(JointLimitTest, readInvalidParameterName)
                                                                        joint_limits_extended));
 }
 
+/**
+ * @brief Checks that reading the limits from the fetched parameter gives the same limits
+ * as reading them from the parameter server.
+ */
+TEST_F(JointLimitTest, readFromFetchedParameter)
+{
+  ros::NodeHandle node_handle("~");
+
+  XmlRpc::XmlRpcValue joint_limits_param;
+  ASSERT_TRUE(node_handle.getParam("joint_limits", joint_limits_param));
+
+  for(const std::string& joint_name : {"joint_1", "joint_6"})
+  {
+    pilz_extensions::joint_limits_interface::JointLimits expected_limits;
+    pilz_extensions::joint_limits_interface::JointLimits limits;
+    ASSERT_TRUE(pilz_extensions::joint_limits_interface::getJointLimits(joint_name, node_handle, expected_limits));
+    ASSERT_TRUE(pilz_extensions::joint_limits_interface::getJointLimits(joint_name, joint_limits_param, limits));
+
+    EXPECT_EQ(expected_limits.has_position_limits, limits.has_position_limits);
+    EXPECT_EQ(expected_limits.has_velocity_limits, limits.has_velocity_limits);
+    EXPECT_EQ(expected_limits.has_acceleration_limits, limits.has_acceleration_limits);
+    EXPECT_EQ(expected_limits.max_acceleration, limits.max_acceleration);
+    EXPECT_EQ(expected_limits.has_deceleration_limits, limits.has_deceleration_limits);
+    EXPECT_EQ(expected_limits.max_deceleration, limits.max_deceleration);
+  }
+
+  pilz_extensions::joint_limits_interface::JointLimits limits;
+  EXPECT_FALSE(pilz_extensions::joint_limits_interface::getJointLimits("anything", joint_limits_param, limits));
+}
+
+/**
+ * @brief Checks that the configuration dependent limits are read from the parameter server
+ * and from the fetched parameter, and interpolated over the joint position and the payload.
+ */
+TEST_F(JointLimitTest, readConfigurationDependentLimits)
+{
+  ros::NodeHandle node_handle("~");
+
+  XmlRpc::XmlRpcValue joint_limits_param;
+  ASSERT_TRUE(node_handle.getParam("joint_limits", joint_limits_param));
+
+  pilz_extensions::joint_limits_interface::JointLimits server_limits;
+  pilz_extensions::joint_limits_interface::JointLimits fetched_limits;
+  ASSERT_TRUE(pilz_extensions::joint_limits_interface::getJointLimits("joint_6", node_handle, server_limits));
+  ASSERT_TRUE(pilz_extensions::joint_limits_interface::getJointLimits("joint_6", joint_limits_param, fetched_limits));
+
+  for(const auto& limits : {server_limits, fetched_limits})
+  {
+    EXPECT_FALSE(limits.velocity_grid);
+    ASSERT_TRUE(limits.acceleration_grid);
+    ASSERT_TRUE(limits.deceleration_grid);
+    ASSERT_EQ(2u, limits.acceleration_grid->getAxes().size());
+    EXPECT_EQ("joint_2", limits.acceleration_grid->getAxes().front().name);
+    EXPECT_EQ(pilz_extensions::JointLimitsGrid::getPayloadAxisName(),
+              limits.acceleration_grid->getAxes().back().name);
+
+    // between the grid points, outside of the grid and with unknown payload
+    const double between[] {-0.75, 2.5};
+    EXPECT_NEAR(3.75, limits.acceleration_grid->interpolate(between), 1e-12);
+    const double outside[] {3., 10.};
+    EXPECT_NEAR(2., limits.acceleration_grid->interpolate(outside), 1e-12);
+    const double unknown_payload[] {0., std::numeric_limits<double>::quiet_NaN()};
+    EXPECT_NEAR(3., limits.acceleration_grid->interpolate(unknown_payload), 1e-12);
+
+    // the deceleration is stored as positive values
+    EXPECT_NEAR(4., limits.deceleration_grid->interpolate(unknown_payload), 1e-12);
+  }
+
+  // joints without configuration dependent limits
+  pilz_extensions::joint_limits_interface::JointLimits limits;
+  ASSERT_TRUE(pilz_extensions::joint_limits_interface::getJointLimits("joint_1", joint_limits_param, limits));
+  EXPECT_FALSE(limits.acceleration_grid);
+}
+
+/**
+ * @brief Checks that malformed configuration dependent limits are rejected.
+ */
+TEST_F(JointLimitTest, readInvalidConfigurationDependentLimits)
+{
+  XmlRpc::XmlRpcValue joint_limits_param;
+  XmlRpc::XmlRpcValue& table {joint_limits_param["joint"]["configuration_dependent_limits"]};
+  table["axes"][0]["name"] = std::string("payload");
+  table["axes"][0]["points"][0] = 0.;
+  table["axes"][0]["points"][1] = 5.;
+
+  // wrong number of values
+  table["max_velocity"][0] = 1.;
+  pilz_extensions::joint_limits_interface::JointLimits limits;
+  EXPECT_THROW(pilz_extensions::joint_limits_interface::getJointLimits("joint", joint_limits_param, limits),
+               std::invalid_argument);
+
+  table["max_velocity"][1] = 2;
+  EXPECT_TRUE(pilz_extensions::joint_limits_interface::getJointLimits("joint", joint_limits_param, limits));
+  EXPECT_TRUE(limits.velocity_grid);
+
+  // points not increasing
+  table["axes"][0]["points"][1] = 0.;
+  EXPECT_THROW(pilz_extensions::joint_limits_interface::getJointLimits("joint", joint_limits_param, limits),
+               std::invalid_argument);
+
+  // no axes
+  table["axes"] = std::string("payload");
+  EXPECT_THROW(pilz_extensions::joint_limits_interface::getJointLimits("joint", joint_limits_param, limits),
+               std::invalid_argument);
+}
+
 TEST_F(JointLimitTest, OldRead)
 {
   ros::NodeHandle node_handle("~");
@@ -236,8 +236,9 @@ class BaseCmd(_AbstractCmd):
         # Set general info
         req.planner_id = self._planner_id
         req.group_name = self._planning_group
-        req.max_velocity_scaling_factor = self._vel_scale * robot._speed_override
-        req.max_acceleration_scaling_factor = self._acc_scale * self._calc_acc_scale(robot._speed_override)
+        speed_override = robot._command_speed_override
+        req.max_velocity_scaling_factor = self._vel_scale * speed_override
+        req.max_acceleration_scaling_factor = self._acc_scale * self._calc_acc_scale(speed_override)
         req.allowed_planning_time = 1.0
 
         # Set an empty diff as start_state => the current state is used by the planner
@@ -104,6 +104,7 @@ class Robot(object):
     _SEQUENCE_TOPIC = "sequence_move_group"
     _BRAKE_TEST_EXECUTE_SRV = "/prbt/execute_braketest"
     _GET_SPEED_OVERRIDE_SRV = "/prbt/get_speed_override"
+    _CAPABILITY_SPEED_OVERRIDE_PARAM = "/move_group/speed_override_service"
     _BRAKE_TEST_REQUIRED_SRV = "/prbt/brake_test_required"
     _INSTANCE_PARAM = "/robot_api_instance"
 
@@ -162,13 +163,27 @@ class Robot(object):
     def _speed_override(self):
         """ Returns the currently active speed override
 
-        Both velocity and acceleration scaling of a command are factorized during :py:meth:`move`.
+        Both velocity and acceleration scaling of a command are factorized during :py:meth:`move`,
+        unless the sequence capability applies the speed override itself.
         The command itself remains untouched.
         """
         res = self._get_speed_override_srv()
 
         return res.speed_override
 
+    @property
+    def _command_speed_override(self):
+        """ Returns the speed override which has to be factorized into the scaling of a command
+
+        If the sequence capability applies the speed override to the planned trajectories itself
+        (parameter ``speed_override_service`` of the move_group node is set), the scaling factors
+        of the commands must not be reduced a second time and 1.0 is returned.
+        """
+        if rospy.get_param(self._CAPABILITY_SPEED_OVERRIDE_PARAM, ""):
+            return 1.0
+
+        return self._speed_override
+
     def get_planning_frame(self):
         """Get the name of the frame in which the robot is planning."""
         return self._robot_commander.get_planning_frame()
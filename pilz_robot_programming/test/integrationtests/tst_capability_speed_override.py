@@ -0,0 +1,93 @@
+#!/usr/bin/env python
+# Copyright (c) 2019 Pilz GmbH & Co. KG
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+import unittest
+import rospy
+from pilz_robot_programming.robot import *
+from pilz_robot_programming.commands import *
+from tst_api_utils import setOverrideParam
+
+API_VERSION = "1"
+
+EXP_VEL_SCALE = 0.7
+EXP_ACC_SCALE = 0.5
+
+
+class TestCapabilitySpeedOverride(unittest.TestCase):
+    """ Checks that the speed override is not applied by the client if the sequence capability applies it
+        (parameter speed_override_service of the move_group node is set in the launch file).
+    """
+    def setUp(self):
+        rospy.loginfo("SetUp called...")
+        self.robot = Robot(API_VERSION)
+
+    def tearDown(self):
+        setOverrideParam(1.0)
+        if hasattr(self, 'robot'):
+            self.robot._release()
+            self.robot = None
+
+    def testCommandNotScaled(self):
+        """ Test that the scaling factors of a command are not reduced by the speed override
+
+            Test sequence:
+                1. Set speed override.
+                2. Convert ptp command to request.
+
+            Test results:
+                1. -
+                2. Scaling factors of the request are the ones of the command.
+        """
+        # 1
+        setOverrideParam(0.2)
+        self.assertEqual(0.2, self.robot._speed_override)
+
+        # 2
+        ptp = Ptp(goal=[0, 0.5, 0.5, 0, 0, 0], vel_scale=EXP_VEL_SCALE, acc_scale=EXP_ACC_SCALE)
+        req = ptp._cmd_to_request(self.robot)
+        self.assertEqual(EXP_VEL_SCALE, req.max_velocity_scaling_factor)
+        self.assertEqual(EXP_ACC_SCALE, req.max_acceleration_scaling_factor)
+
+    def testSequenceNotScaled(self):
+        """ Test that the scaling factors of the sequence items are not reduced by the speed override
+
+            Test sequence:
+                1. Set speed override.
+                2. Create sequence request.
+
+            Test results:
+                1. -
+                2. Scaling factors of all items are the ones of the commands.
+        """
+        # 1
+        setOverrideParam(0.2)
+
+        # 2
+        seq = Sequence()
+        seq.append(Ptp(goal=[0, 0.5, 0.5, 0, 0, 0], vel_scale=EXP_VEL_SCALE, acc_scale=EXP_ACC_SCALE), 0.1)
+        seq.append(Ptp(goal=[0.5, 0.5, 0.5, 0, 0, 0], vel_scale=EXP_VEL_SCALE, acc_scale=EXP_ACC_SCALE))
+        seq_action_goal = seq._get_sequence_request(self.robot)
+
+        self.assertEqual(2, len(seq_action_goal.request.items))
+        for item in seq_action_goal.request.items:
+            self.assertEqual(EXP_VEL_SCALE, item.req.max_velocity_scaling_factor)
+            self.assertEqual(EXP_ACC_SCALE, item.req.max_acceleration_scaling_factor)
+
+
+if __name__ == '__main__':
+    import rostest
+    rospy.init_node('tst_capability_speed_override')
+    rostest.rosrun('pilz_robot_programming', 'tst_capability_speed_override', TestCapabilitySpeedOverride)
@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ros/ros.h>
+
+#include <eigen_conversions/eigen_kdl.h>
+#include <kdl/path_line.hpp>
+#include <kdl/rotational_interpolation_sa.hpp>
+#include <kdl/trajectory_segment.hpp>
+
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/conversions.h>
+
+#include <pilz_industrial_motion_testutils/command_types_typedef.h>
+#include <pilz_industrial_motion_testutils/sequence.h>
+#include <pilz_industrial_motion_testutils/xml_testdata_loader.h>
+
+#include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/compact_trajectory.h"
+#include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/plan_components_builder.h"
+#include "pilz_trajectory_generation/trajectory_blender_transition_window.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
+#include "pilz_trajectory_generation/trajectory_generator_lin.h"
+#include "pilz_trajectory_generation/trajectory_generator_ptp.h"
+#include "pilz_trajectory_generation/velocity_profile_atrap.h"
+
+using namespace pilz_industrial_motion_testutils;
+
+namespace
+{
+
+const std::string ROBOT_DESCRIPTION_STR {"robot_description"};
+const std::string PARAM_NAMESPACE_LIMITS {"robot_description_planning"};
+
+// parameters from parameter server
+const std::string PARAM_TEST_DATA_FILE_NAME {"testdata_file_name"};
+const std::string PARAM_PLANNING_GROUP_NAME {"planning_group"};
+const std::string PARAM_TARGET_LINK_NAME {"target_link"};
+const std::string PARAM_PTP_CMD_NAME {"ptp_cmd"};
+const std::string PARAM_LIN_CMD_NAMES {"lin_cmds"};
+const std::string PARAM_BLEND_RADIUS {"blend_radius"};
+
+// sampling times of the parametrized benchmarks in milliseconds
+const std::vector<int64_t> SAMPLING_TIMES_MS {1, 10, 100};
+const int64_t MIN_SEQUENCE_LENGTH {1};
+const int64_t MAX_SEQUENCE_LENGTH {16};
+
+/**
+ * @brief Robot model, limits and test data shared by all benchmarks.
+ *
+ * The data is taken from the parameter server, which makes it possible to
+ * run the same benchmarks on every robot in test/test_robots.
+ */
+class BenchmarkContext
+{
+public:
+  BenchmarkContext();
+
+public:
+  //! Returns a LIN trajectory generated from the specified command.
+  robot_trajectory::RobotTrajectoryPtr generateLin(const LinJoint& cmd, double sampling_time,
+                                                   const robot_state::RobotState* start_state = nullptr);
+
+  //! Returns the LIN commands of the closed loop in turns.
+  const LinJoint& getLinCmd(std::size_t index) const;
+
+public:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_;
+
+  std::string planning_group_, target_link_;
+  double blend_radius_ {0.05};
+  pilz::LimitsContainer planner_limits_;
+
+  std::unique_ptr<pilz::TrajectoryGeneratorPTP> ptp_generator_;
+  std::unique_ptr<pilz::TrajectoryGeneratorLIN> lin_generator_;
+
+  PtpJoint ptp_cmd_;
+  //! LIN commands of the test data followed by a LIN back to the first start position.
+  std::vector<LinJoint> lin_cmds_;
+
+  std::map<std::string, double> lin_start_joints_;
+  Eigen::Isometry3d lin_start_pose_, lin_goal_pose_;
+};
+
+std::unique_ptr<BenchmarkContext> context;
+
+std::map<std::string, double> toJointMap(const JointConfiguration& config)
+{
+  const sensor_msgs::JointState joint_state {config.toSensorMsg()};
+  std::map<std::string, double> joints;
+  for (std::size_t i = 0; i < joint_state.name.size(); ++i)
+  {
+    joints[joint_state.name.at(i)] = joint_state.position.at(i);
+  }
+  return joints;
+}
+
+BenchmarkContext::BenchmarkContext()
+  : robot_model_(robot_model_loader::RobotModelLoader(ROBOT_DESCRIPTION_STR).getModel())
+{
+  if (!robot_model_)
+  {
+    throw std::runtime_error("Robot model could not be loaded.");
+  }
+
+  std::string test_data_file_name, ptp_cmd_name;
+  std::vector<std::string> lin_cmd_names;
+  if (!ph_.getParam(PARAM_TEST_DATA_FILE_NAME, test_data_file_name)
+      || !ph_.getParam(PARAM_PLANNING_GROUP_NAME, planning_group_)
+      || !ph_.getParam(PARAM_TARGET_LINK_NAME, target_link_))
+  {
+    throw std::runtime_error("Missing benchmark parameters.");
+  }
+  ph_.param(PARAM_PTP_CMD_NAME, ptp_cmd_name, std::string("Ptp1"));
+  ph_.param(PARAM_LIN_CMD_NAMES, lin_cmd_names, std::vector<std::string> {"lin2", "lin3"});
+  ph_.param(PARAM_BLEND_RADIUS, blend_radius_, blend_radius_);
+
+  XmlTestdataLoader data_loader {test_data_file_name, robot_model_};
+  ptp_cmd_ = data_loader.getPtpJoint(ptp_cmd_name);
+  for (const auto& lin_cmd_name : lin_cmd_names)
+  {
+    lin_cmds_.push_back(data_loader.getLinJoint(lin_cmd_name));
+  }
+  if (lin_cmds_.empty())
+  {
+    throw std::runtime_error("No LIN commands specified.");
+  }
+  // close the loop, so that sequences of arbitrary length can be built
+  LinJoint lin_back {lin_cmds_.back()};
+  lin_back.setStartConfiguration(lin_cmds_.back().getGoalConfiguration());
+  lin_back.setGoalConfiguration(lin_cmds_.front().getStartConfiguration());
+  lin_cmds_.push_back(lin_back);
+
+  // create the limits container
+  pilz::JointLimitsContainer joint_limits {pilz::JointLimitsAggregator::getAggregatedLimits(
+                                             ros::NodeHandle(PARAM_NAMESPACE_LIMITS),
+                                             robot_model_->getActiveJointModels())};
+  planner_limits_.setJointLimits(joint_limits);
+  planner_limits_.setCartesianLimits(pilz::CartesianLimitsAggregator::getAggregatedLimits(
+                                       ros::NodeHandle(PARAM_NAMESPACE_LIMITS)));
+
+  ptp_generator_.reset(new pilz::TrajectoryGeneratorPTP(robot_model_, planner_limits_));
+  lin_generator_.reset(new pilz::TrajectoryGeneratorLIN(robot_model_, planner_limits_));
+
+  lin_start_joints_ = toJointMap(lin_cmds_.front().getStartConfiguration());
+  if (!pilz::computeLinkFK(robot_model_, target_link_, lin_start_joints_, lin_start_pose_)
+      || !pilz::computeLinkFK(robot_model_, target_link_, toJointMap(lin_cmds_.front().getGoalConfiguration()),
+                              lin_goal_pose_))
+  {
+    throw std::runtime_error("Failed to compute the poses of the LIN command.");
+  }
+}
+
+robot_trajectory::RobotTrajectoryPtr BenchmarkContext::generateLin(const LinJoint& cmd, double sampling_time,
+                                                                   const robot_state::RobotState* start_state)
+{
+  planning_interface::MotionPlanRequest req {cmd.toRequest()};
+  if (start_state)
+  {
+    moveit::core::robotStateToRobotStateMsg(*start_state, req.start_state);
+  }
+
+  planning_interface::MotionPlanResponse res;
+  if (!lin_generator_->generate(req, res, sampling_time))
+  {
+    throw std::runtime_error("Failed to generate LIN trajectory.");
+  }
+  return res.trajectory_;
+}
+
+const LinJoint& BenchmarkContext::getLinCmd(std::size_t index) const
+{
+  return lin_cmds_.at(index % lin_cmds_.size());
+}
+
+void addSamplingTimes(benchmark::internal::Benchmark* bench)
+{
+  for (int64_t sampling_time : SAMPLING_TIMES_MS)
+  {
+    bench->Arg(sampling_time);
+  }
+}
+
+double toSeconds(int64_t milliseconds)
+{
+  return static_cast<double>(milliseconds) / 1000.;
+}
+
+}
+
+/**
+ * @brief Inverse kinematics of the goal pose of the LIN command.
+ */
+static void BM_ComputePoseIK(benchmark::State& state)
+{
+  std::map<std::string, double> solution;
+  for (auto _ : state)
+  {
+    if (!pilz::computePoseIK(context->robot_model_, context->planning_group_, context->target_link_,
+                             context->lin_goal_pose_, context->robot_model_->getModelFrame(),
+                             context->lin_start_joints_, solution, false))
+    {
+      state.SkipWithError("Failed to compute inverse kinematics.");
+      break;
+    }
+    benchmark::DoNotOptimize(solution);
+  }
+}
+BENCHMARK(BM_ComputePoseIK);
+
+/**
+ * @brief Sampling of a Cartesian straight line into a joint trajectory,
+ * parametrized by the sampling time in milliseconds.
+ */
+static void BM_GenerateJointTrajectory(benchmark::State& state)
+{
+  KDL::Frame kdl_start_pose, kdl_goal_pose;
+  tf::transformEigenToKDL(context->lin_start_pose_, kdl_start_pose);
+  tf::transformEigenToKDL(context->lin_goal_pose_, kdl_goal_pose);
+
+  const pilz::CartesianLimit& cart_limits {context->planner_limits_.getCartesianLimits()};
+  const double eqradius {cart_limits.getMaxTranslationalVelocity() / cart_limits.getMaxRotationalVelocity()};
+  KDL::Path_Line path(kdl_start_pose, kdl_goal_pose, new KDL::RotationalInterpolation_SingleAxis(), eqradius, true);
+  pilz::VelocityProfile_ATrap vp(cart_limits.getMaxTranslationalVelocity(),
+                                 cart_limits.getMaxTranslationalAcceleration(),
+                                 cart_limits.getMaxTranslationalDeceleration());
+  vp.SetProfile(0, path.PathLength());
+  KDL::Trajectory_Segment cart_trajectory(&path, &vp, false);
+
+  const double sampling_time {toSeconds(state.range(0))};
+  pilz::CompactTrajectory joint_trajectory;
+  moveit_msgs::MoveItErrorCodes error_code;
+  for (auto _ : state)
+  {
+    if (!pilz::generateJointTrajectory(context->robot_model_,
+                                       context->planner_limits_.getJointLimitContainer(),
+                                       cart_trajectory, context->planning_group_, context->target_link_,
+                                       context->lin_start_joints_, sampling_time, joint_trajectory, error_code))
+    {
+      state.SkipWithError("Failed to generate joint trajectory.");
+      break;
+    }
+  }
+  state.counters["waypoints"] = joint_trajectory.getWayPointCount();
+}
+BENCHMARK(BM_GenerateJointTrajectory)->ArgName("sampling_time_ms")->Apply(addSamplingTimes);
+
+/**
+ * @brief Planning of a PTP command, parametrized by the sampling time in milliseconds.
+ */
+static void BM_PlanPTP(benchmark::State& state)
+{
+  const planning_interface::MotionPlanRequest req {context->ptp_cmd_.toRequest()};
+  const double sampling_time {toSeconds(state.range(0))};
+  planning_interface::MotionPlanResponse res;
+  for (auto _ : state)
+  {
+    if (!context->ptp_generator_->generate(req, res, sampling_time))
+    {
+      state.SkipWithError("Failed to generate PTP trajectory.");
+      break;
+    }
+  }
+  if (res.trajectory_)
+  {
+    state.counters["waypoints"] = res.trajectory_->getWayPointCount();
+  }
+}
+BENCHMARK(BM_PlanPTP)->ArgName("sampling_time_ms")->Apply(addSamplingTimes);
+
+/**
+ * @brief Setting and sampling of a trapezoid velocity profile, parametrized
+ * by the sampling time in milliseconds.
+ */
+static void BM_VelocityProfileATrap(benchmark::State& state)
+{
+  const pilz::CartesianLimit& cart_limits {context->planner_limits_.getCartesianLimits()};
+  const double distance {(context->lin_goal_pose_.translation() - context->lin_start_pose_.translation()).norm()};
+  const double sampling_time {toSeconds(state.range(0))};
+  pilz::VelocityProfile_ATrap vp(cart_limits.getMaxTranslationalVelocity(),
+                                 cart_limits.getMaxTranslationalAcceleration(),
+                                 cart_limits.getMaxTranslationalDeceleration());
+  for (auto _ : state)
+  {
+    vp.SetProfile(0, distance);
+    for (double t = 0; t < vp.Duration(); t += sampling_time)
+    {
+      benchmark::DoNotOptimize(vp.Pos(t));
+      benchmark::DoNotOptimize(vp.Vel(t));
+      benchmark::DoNotOptimize(vp.Acc(t));
+    }
+  }
+}
+BENCHMARK(BM_VelocityProfileATrap)->ArgName("sampling_time_ms")->Apply(addSamplingTimes);
+
+/**
+ * @brief Blending of two LIN trajectories, parametrized by the sampling time
+ * in milliseconds.
+ */
+static void BM_TrajectoryBlenderTransitionWindow(benchmark::State& state)
+{
+  const double sampling_time {toSeconds(state.range(0))};
+
+  pilz::TrajectoryBlendRequest blend_req;
+  blend_req.group_name = context->planning_group_;
+  blend_req.link_name = context->target_link_;
+  blend_req.blend_radius = context->blend_radius_;
+  try
+  {
+    blend_req.first_trajectory = context->generateLin(context->getLinCmd(0), sampling_time);
+    blend_req.second_trajectory = context->generateLin(context->getLinCmd(1), sampling_time,
+                                                       &blend_req.first_trajectory->getLastWayPoint());
+  }
+  catch (const std::runtime_error& ex)
+  {
+    state.SkipWithError(ex.what());
+    return;
+  }
+
+  pilz::TrajectoryBlenderTransitionWindow blender {context->planner_limits_};
+  for (auto _ : state)
+  {
+    pilz::TrajectoryBlendResponse blend_res;
+    if (!blender.blend(blend_req, blend_res))
+    {
+      state.SkipWithError("Failed to blend trajectories.");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_TrajectoryBlenderTransitionWindow)->ArgName("sampling_time_ms")->Apply(addSamplingTimes);
+
+/**
+ * @brief Blending and concatenation of LIN trajectories by the
+ * PlanComponentsBuilder, parametrized by the number of trajectories.
+ */
+static void BM_PlanComponentsBuilder(benchmark::State& state)
+{
+  std::vector<robot_trajectory::RobotTrajectoryPtr> trajectories;
+  try
+  {
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+      trajectories.push_back(context->generateLin(context->getLinCmd(i), 0.1,
+                                                  i == 0 ? nullptr : &trajectories.back()->getLastWayPoint()));
+    }
+  }
+  catch (const std::runtime_error& ex)
+  {
+    state.SkipWithError(ex.what());
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    pilz_trajectory_generation::PlanComponentsBuilder builder;
+    builder.setModel(context->robot_model_);
+    builder.setBlender(std::unique_ptr<pilz::TrajectoryBlender>(
+                         new pilz::TrajectoryBlenderTransitionWindow(context->planner_limits_)));
+    try
+    {
+      for (std::size_t i = 0; i < trajectories.size(); ++i)
+      {
+        builder.append(trajectories.at(i), i + 1 < trajectories.size() ? context->blend_radius_ : 0.);
+      }
+      benchmark::DoNotOptimize(builder.build());
+    }
+    catch (const std::exception& ex)
+    {
+      state.SkipWithError(ex.what());
+      break;
+    }
+  }
+}
+BENCHMARK(BM_PlanComponentsBuilder)->ArgName("sequence_length")
+->RangeMultiplier(2)->Range(MIN_SEQUENCE_LENGTH, MAX_SEQUENCE_LENGTH);
+
+/**
+ * @brief Solving of a sequence of LIN commands by the CommandListManager,
+ * including the planning pipeline, parametrized by the number of commands.
+ */
+static void BM_CommandListManagerSolve(benchmark::State& state)
+{
+  Sequence seq;
+  for (int64_t i = 0; i < state.range(0); ++i)
+  {
+    seq.add(context->getLinCmd(i));
+  }
+  const pilz_msgs::MotionSequenceRequest req {seq.toRequest()};
+
+  pilz_trajectory_generation::CommandListManager manager {context->ph_, context->robot_model_};
+  planning_scene::PlanningScenePtr scene {std::make_shared<planning_scene::PlanningScene>(context->robot_model_)};
+  planning_pipeline::PlanningPipelinePtr pipeline {
+    std::make_shared<planning_pipeline::PlanningPipeline>(context->robot_model_, context->ph_)};
+
+  for (auto _ : state)
+  {
+    try
+    {
+      benchmark::DoNotOptimize(manager.solve(scene, pipeline, req));
+    }
+    catch (const std::exception& ex)
+    {
+      state.SkipWithError(ex.what());
+      break;
+    }
+  }
+}
+BENCHMARK(BM_CommandListManagerSolve)->ArgName("sequence_length")
+->RangeMultiplier(2)->Range(MIN_SEQUENCE_LENGTH, MAX_SEQUENCE_LENGTH)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "benchmark_trajectory_generation");
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+
+  try
+  {
+    context.reset(new BenchmarkContext());
+  }
+  catch (const std::exception& ex)
+  {
+    ROS_ERROR_STREAM("Failed to set up the benchmarks: " << ex.what());
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  context.reset();
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATION_COUNTERS_H
+#define ALLOCATION_COUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Returns the heap allocations of the calling thread since its start.
+ *
+ * Defined by the allocation counter library (libpilz_allocation_counter.so),
+ * if it is preloaded (LD_PRELOAD). Declared weak, so that the symbol is null
+ * otherwise.
+ */
+extern "C" void pilz_get_heap_allocation_counts(uint64_t* allocations, uint64_t* allocated_bytes)
+  __attribute__((weak));
+
+namespace pilz
+{
+
+/**
+ * @brief Heap allocations and (instrumented) copies of large objects.
+ */
+struct AllocationCounts
+{
+  uint64_t allocations {0};
+  uint64_t allocated_bytes {0};
+  uint64_t copies {0};
+  uint64_t copied_bytes {0};
+
+  AllocationCounts& operator+=(const AllocationCounts& other);
+
+  AllocationCounts operator-(const AllocationCounts& other) const;
+};
+
+/**
+ * @brief Counters of the calling thread, used to attribute heap allocations
+ * and copies to the planning phases (see PhaseTimings).
+ *
+ * Only counts in builds with PILZ_ENABLE_ALLOCATION_COUNTERS (see
+ * CATKIN_ENABLE_ALLOCATION_COUNTERS), otherwise all counts are zero.
+ * The heap allocations are only counted, if the allocation counter library
+ * is preloaded.
+ */
+class AllocationCounters
+{
+public:
+  /**
+   * @return True if the counts contain the heap allocations.
+   */
+  static bool hasHeapAllocations();
+
+  /**
+   * @return The counts of the calling thread since its start.
+   */
+  static AllocationCounts get();
+
+  /**
+   * @return The counts of the calling thread since the specified counts were taken.
+   */
+  static AllocationCounts getSince(const AllocationCounts& start);
+
+  /**
+   * @brief Counts a copy of the specified size (in bytes). Use PILZ_COUNT_COPY
+   * to count copies only in builds with allocation counters.
+   */
+  static void countCopy(std::size_t bytes);
+
+private:
+  static AllocationCounts& copyCounts();
+};
+
+inline AllocationCounts& AllocationCounts::operator+=(const AllocationCounts& other)
+{
+  allocations += other.allocations;
+  allocated_bytes += other.allocated_bytes;
+  copies += other.copies;
+  copied_bytes += other.copied_bytes;
+  return *this;
+}
+
+inline AllocationCounts AllocationCounts::operator-(const AllocationCounts& other) const
+{
+  AllocationCounts diff;
+  diff.allocations = allocations - other.allocations;
+  diff.allocated_bytes = allocated_bytes - other.allocated_bytes;
+  diff.copies = copies - other.copies;
+  diff.copied_bytes = copied_bytes - other.copied_bytes;
+  return diff;
+}
+
+inline bool AllocationCounters::hasHeapAllocations()
+{
+#ifdef PILZ_ENABLE_ALLOCATION_COUNTERS
+  return pilz_get_heap_allocation_counts != nullptr;
+#else
+  return false;
+#endif
+}
+
+inline AllocationCounts AllocationCounters::get()
+{
+#ifdef PILZ_ENABLE_ALLOCATION_COUNTERS
+  AllocationCounts counts {copyCounts()};
+  if(pilz_get_heap_allocation_counts)
+  {
+    pilz_get_heap_allocation_counts(&counts.allocations, &counts.allocated_bytes);
+  }
+  return counts;
+#else
+  return AllocationCounts();
+#endif
+}
+
+inline AllocationCounts AllocationCounters::getSince(const AllocationCounts& start)
+{
+  return get() - start;
+}
+
+inline void AllocationCounters::countCopy(std::size_t bytes)
+{
+  AllocationCounts& counts {copyCounts()};
+  ++counts.copies;
+  counts.copied_bytes += bytes;
+}
+
+inline AllocationCounts& AllocationCounters::copyCounts()
+{
+  static thread_local AllocationCounts counts;
+  return counts;
+}
+
+}
+
+/**
+ * @brief Counts a copy of the specified size (in bytes). The size is not
+ * evaluated in builds without allocation counters.
+ */
+#ifdef PILZ_ENABLE_ALLOCATION_COUNTERS
+#define PILZ_COUNT_COPY(bytes) pilz::AllocationCounters::countCopy(bytes)
+#else
+#define PILZ_COUNT_COPY(bytes) static_cast<void>(0)
+#endif
+
+#endif // ALLOCATION_COUNTERS_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <memory>
+
+namespace pilz
+{
+
+/**
+ * @brief Thread-safe flag which is used to cancel a running planning
+ * request from another thread.
+ *
+ * Copies of a token share the same flag. Long running loops (e.g. the
+ * sampling of a Cartesian trajectory) poll isCancelled() and stop as soon as
+ * possible.
+ */
+class CancellationToken
+{
+public:
+  //! Creates a token which is never cancelled.
+  CancellationToken() = default;
+
+  /**
+   * @return A new token which can be cancelled by calling cancel().
+   */
+  static CancellationToken create();
+
+  /**
+   * @return A new token which is cancelled by calling cancel() or
+   * when the specified parent token is cancelled.
+   */
+  static CancellationToken createChild(const CancellationToken& parent);
+
+  /**
+   * @brief Cancels the token and all of its copies.
+   *
+   * Has no effect on a default constructed token.
+   */
+  void cancel() const;
+
+  bool isCancelled() const;
+
+private:
+  struct State;
+
+  explicit CancellationToken(const std::shared_ptr<State>& state);
+
+private:
+  std::shared_ptr<State> state_;
+};
+
+struct CancellationToken::State
+{
+  std::atomic_bool cancelled {false};
+  CancellationToken parent;
+};
+
+/**
+ * @brief Makes the specified token the current token of the calling thread
+ * for the lifetime of the scope.
+ *
+ * Used to hand the token of a sequence down to the planning contexts which are
+ * created by the planning pipeline: Planning contexts created while a
+ * scope is active are cancelled together with the token of the scope.
+ */
+class CancellationScope
+{
+public:
+  explicit CancellationScope(const CancellationToken& token);
+  ~CancellationScope();
+
+  CancellationScope(const CancellationScope&) = delete;
+  CancellationScope& operator=(const CancellationScope&) = delete;
+
+  /**
+   * @return The token of the innermost active scope of the calling thread,
+   * or a token which is never cancelled if there is no active scope.
+   */
+  static CancellationToken getCurrentToken();
+
+private:
+  static CancellationToken& currentToken();
+
+private:
+  CancellationToken previous_token_;
+};
+
+inline CancellationToken::CancellationToken(const std::shared_ptr<State>& state)
+  : state_(state)
+{
+}
+
+inline CancellationToken CancellationToken::create()
+{
+  return CancellationToken(std::make_shared<State>());
+}
+
+inline CancellationToken CancellationToken::createChild(const CancellationToken& parent)
+{
+  std::shared_ptr<State> state {std::make_shared<State>()};
+  state->parent = parent;
+  return CancellationToken(state);
+}
+
+inline void CancellationToken::cancel() const
+{
+  if(state_)
+  {
+    state_->cancelled = true;
+  }
+}
+
+inline bool CancellationToken::isCancelled() const
+{
+  return state_ && (state_->cancelled || state_->parent.isCancelled());
+}
+
+inline CancellationScope::CancellationScope(const CancellationToken& token)
+  : previous_token_(currentToken())
+{
+  currentToken() = token;
+}
+
+inline CancellationScope::~CancellationScope()
+{
+  currentToken() = previous_token_;
+}
+
+inline CancellationToken CancellationScope::getCurrentToken()
+{
+  return currentToken();
+}
+
+inline CancellationToken& CancellationScope::currentToken()
+{
+  static thread_local CancellationToken token;
+  return token;
+}
+
+}
+
+#endif // CANCELLATION_TOKEN_H
@@ -24,6 +24,15 @@ namespace pilz_trajectory_generation
 {
 
 static const std::string SEQUENCE_SERVICE_NAME = "plan_sequence_path";
+static const std::string SEQUENCE_BATCH_SERVICE_NAME = "plan_sequence_path_batch";
+
+static const std::string SEQUENCE_ACTION_STATISTICS_TOPIC = "sequence_move_group_statistics";
+static const std::string SEQUENCE_SERVICE_STATISTICS_TOPIC = "plan_sequence_path_statistics";
+
+static const std::string UPDATE_PLANNING_LIMITS_SERVICE_NAME = "update_planning_limits";
+
+//! Parameter with the name of the pilz_msgs::GetSpeedOverride service queried by the sequence action.
+static const std::string SPEED_OVERRIDE_SERVICE_PARAM = "speed_override_service";
 
 }
 
@@ -18,6 +18,10 @@
 #ifndef CARTESIAN_LIMIT_H
 #define CARTESIAN_LIMIT_H
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
 namespace pilz
 {
 /**
@@ -109,6 +113,97 @@ public:
    */
   double getMaxRotationalVelocity() const;
 
+  // Speed Limit of Frames
+
+  /**
+   * @brief Check if a speed limit of the frames (see getSpeedLimitFrames()) is set.
+   * @return True if limit was set false otherwise
+   */
+  bool hasMaxFrameSpeed() const;
+
+  /**
+   * @brief Set the maximal Cartesian speed of the frames
+   * @param Maximum speed of the frames [m/s]
+   */
+  void setMaxFrameSpeed(double max_frame_speed);
+
+  /**
+   * @brief Return the maximal Cartesian speed of the frames [m/s], 0 if nothing was set
+   * @return maximal speed of the frames, 0 if nothing was set
+   */
+  double getMaxFrameSpeed() const;
+
+  /**
+   * @brief Set the frames (links of the robot model) whose speed is limited by the maximal frame speed
+   */
+  void setSpeedLimitFrames(const std::vector<std::string>& frames);
+
+  /**
+   * @return The frames whose speed is limited by the maximal frame speed
+   */
+  const std::vector<std::string>& getSpeedLimitFrames() const;
+
+  /**
+   * @brief Set whether trajectories exceeding the maximal frame speed are slowed down
+   * (true) or rejected (false, default)
+   */
+  void setScaleToMaxFrameSpeed(bool scale);
+
+  /**
+   * @return True if trajectories exceeding the maximal frame speed are slowed down,
+   * false if they are rejected
+   */
+  bool getScaleToMaxFrameSpeed() const;
+
+  // Path Scan of LIN and CIRC
+
+  /**
+   * @brief Set the number of samples of the path scan of LIN and CIRC, 0 (default) disables the scan
+   */
+  void setPathScanSamples(std::size_t samples);
+
+  /**
+   * @return The number of samples of the path scan, 0 if the scan is disabled
+   */
+  std::size_t getPathScanSamples() const;
+
+  /**
+   * @brief Check if a minimal manipulability of the path is set.
+   * @return True if limit was set false otherwise
+   */
+  bool hasMinManipulability() const;
+
+  /**
+   * @brief Set the minimal manipulability of the path, paths coming closer to a singularity are rejected
+   * @param Minimal manipulability (Yoshikawa measure of the Jacobian of the link)
+   */
+  void setMinManipulability(double min_manipulability);
+
+  /**
+   * @brief Return the minimal manipulability of the path, 0 if nothing was set
+   * @return minimal manipulability, 0 if nothing was set
+   */
+  double getMinManipulability() const;
+
+  /**
+   * @brief Check if a manipulability for a finer sampling of the path is set.
+   * @return True if the manipulability was set false otherwise
+   */
+  bool hasFineSamplingManipulability() const;
+
+  /**
+   * @brief Set the manipulability below which the path is sampled finer: the sampling time is
+   * reduced by the ratio of the minimal manipulability of the scanned path to this value
+   * @param Manipulability (Yoshikawa measure of the Jacobian of the link)
+   */
+  void setFineSamplingManipulability(double manipulability);
+
+  /**
+   * @brief Return the manipulability below which the path is sampled finer, 0 if nothing was set
+   * @return manipulability, 0 if nothing was set
+   */
+  double getFineSamplingManipulability() const;
+
 private:
   ///    Flag if a maximum translational velocity was set
   bool   has_max_trans_vel_;
@@ -133,6 +228,33 @@ private:
 
   ///    Maximum rotational velocity [rad/s]
   double max_rot_vel_;
+
+  ///    Flag if a maximum speed of the frames was set
+  bool   has_max_frame_speed_;
+
+  ///    Maximum speed of the frames [m/s]
+  double max_frame_speed_;
+
+  ///    Frames whose speed is limited
+  std::vector<std::string> speed_limit_frames_;
+
+  ///    Flag if trajectories exceeding the frame speed are slowed down instead of rejected
+  bool   scale_to_max_frame_speed_;
+
+  ///    Number of samples of the path scan, 0 if the scan is disabled
+  std::size_t path_scan_samples_;
+
+  ///    Flag if a minimal manipulability was set
+  bool   has_min_manipulability_;
+
+  ///    Minimal manipulability of the path
+  double min_manipulability_;
+
+  ///    Flag if a manipulability for a finer sampling was set
+  bool   has_fine_sampling_manipulability_;
+
+  ///    Manipulability below which the path is sampled finer
+  double fine_sampling_manipulability_;
 };
 
 }
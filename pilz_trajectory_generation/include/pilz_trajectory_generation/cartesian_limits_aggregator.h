@@ -18,6 +18,8 @@
 #ifndef CARTESIAN_LIMITS_AGGREGATOR_H
 #define CARTESIAN_LIMITS_AGGREGATOR_H
 
+#include <ros/node_handle.h>
+
 #include "pilz_trajectory_generation/cartesian_limit.h"
 
 namespace pilz {
@@ -40,10 +42,26 @@ class CartesianLimitsAggregator
      * - "max_rot_vel", the maximum rotational velocity [rad/s]
      * - "max_rot_acc", the maximum rotational acceleration [rad/s^2]
      * - "max_rot_dec", the maximum rotational deceleration (<= 0)[rad/s^2]
+     * - "max_frame_speed", the maximum Cartesian speed of the frames "speed_limit_frames" [m/s]
+     * - "speed_limit_frames", list of the links whose speed is limited
+     * - "scale_to_max_frame_speed", true to slow down trajectories exceeding the frame speed
+     *   instead of rejecting them
+     * - "path_scan_samples", number of samples of the path scan of LIN and CIRC (0 disables the scan)
+     * - "min_manipulability", the minimal manipulability of the scanned path
+     * - "fine_sampling_manipulability", the manipulability of the scanned path below which the
+     *   sampling time is reduced
      * @param nh node handle to access the parameters
      * @return the obtained cartesian limits
      */
     static CartesianLimit getAggregatedLimits(const ros::NodeHandle& nh);
+
+   /**
+     * @brief Same as getAggregatedLimits(nh), but reads the limits from the already fetched
+     * parameter namespace, see PlanningConfigurationRegistry.
+     * @param param the parameter namespace (a struct) which contains "cartesian_limits"
+     * @return the obtained cartesian limits
+     */
+    static CartesianLimit getAggregatedLimits(XmlRpc::XmlRpcValue& param);
 };
 
 }
@@ -17,6 +17,7 @@
 #ifndef COMMAND_LIST_MANAGER_H
 #define COMMAND_LIST_MANAGER_H
 
+#include <memory>
 #include <string>
 
 #include <boost/optional.hpp>
@@ -26,8 +27,14 @@
 #include <moveit_msgs/MotionPlanResponse.h>
 
 #include "pilz_msgs/MotionSequenceRequest.h"
+#include "pilz_trajectory_generation/cancellation_token.h"
+#include "pilz_trajectory_generation/monotonic_arena.h"
+#include "pilz_trajectory_generation/phase_timings.h"
+#include "pilz_trajectory_generation/planning_configuration.h"
+#include "pilz_trajectory_generation/planning_statistics.h"
 #include "pilz_trajectory_generation/trajectory_blender.h"
 #include "pilz_trajectory_generation/plan_components_builder.h"
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
 #include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
 
 namespace pilz_trajectory_generation
@@ -41,16 +48,37 @@ CREATE_MOVEIT_ERROR_CODE_EXCEPTION(LastBlendRadiusNotZeroException, moveit_msgs:
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(StartStateSetException, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(OverlappingBlendRadiiException, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(PlanningPipelineException, moveit_msgs::MoveItErrorCodes::FAILURE);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(SequenceCancelledException, moveit_msgs::MoveItErrorCodes::PREEMPTED);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(SpeedOverrideInvalidException, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(SpeedOverrideViolatesLimitsException, moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
 
 /**
  * @brief This class orchestrates the planning of single commands and
  * command lists.
+ *
+ * solve() does not modify the CommandListManager and can be called
+ * concurrently (given that the planning pipeline can be used concurrently).
  */
 class CommandListManager
 {
 public:
   CommandListManager(const ros::NodeHandle& nh, const robot_model::RobotModelConstPtr& model);
 
+  /**
+   * @brief Sets the statistics to which the processing times of the planning
+   * phases of each successfully solved request list are added.
+   *
+   * The phases are "check_request_list", "solve_sequence_items" (including
+   * the phases of the pilz planners, e.g. "solve_sequence_items/plan/ik"),
+   * "tip_frame_poses", "check_overlapping_radii", "blend", "build" and "total".
+   */
+  void setStatistics(const std::shared_ptr<PlanningStatistics>& statistics);
+
+  /**
+   * @return The current snapshot of the planning configuration (limits), see pilz::SharedPlanningConfiguration.
+   */
+  pilz::PlanningConfigurationConstPtr getConfiguration() const;
+
   /**
    * @brief Generates trajectories for the specified list of motion commands.
    *
@@ -79,39 +107,148 @@ public:
    * which it belongs to. Starts states can even be incomplete. In this case
    * default values are set for the unset joints.
    *
+   * The sampling times of the request list (if non-zero) override the
+   * sampling times of the planning groups for all requests of the list.
+   *
+   * All requests of the list are planned and blended with the limits of the
+   * payload of the list (see getPayload()), unless a pilz::PayloadScope is active.
+   *
+   * @param cancellation Token to cancel the planning. The token is checked
+   * between the requests, while sampling the trajectories of the pilz planners
+   * and while blending. A cancelled solve() throws an exception with error
+   * code PREEMPTED.
+   *
    * @return Contains the calculated/generated trajectories.
    */
   RobotTrajCont solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
                       const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
-                      const pilz_msgs::MotionSequenceRequest& req_list);
+                      const pilz_msgs::MotionSequenceRequest& req_list,
+                      const pilz::CancellationToken& cancellation = pilz::CancellationToken()) const;
+
+  /**
+   * @brief Same as above, but the motion plan requests are moved out of
+   * the specified request list instead of being copied.
+   */
+  RobotTrajCont solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                      const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                      pilz_msgs::MotionSequenceRequest&& req_list,
+                      const pilz::CancellationToken& cancellation = pilz::CancellationToken()) const;
+
+  /**
+   * @brief Slows already planned trajectories (e.g. the result of solve(), including the blends)
+   * down by a speed override, without planning them again.
+   *
+   * Each trajectory is stretched uniformly in time (see pilz::applySpeedOverride()) and verified
+   * against the joint limits of the current planning configuration (of the payload of the active
+   * pilz::PayloadScope, if any).
+   *
+   * @param trajectories The planned trajectories, they are not modified.
+   * @param speed_override Factor in (0, 1] of the speed of the planned trajectories.
+   * @return The slowed down trajectories.
+   */
+  RobotTrajCont applySpeedOverride(const RobotTrajCont& trajectories, double speed_override) const;
+
+  /**
+   * @brief Determines the payload of a request list from the objects attached in the start state
+   * of its first request, see pilz::getAttachedPayload().
+   * @param planning_scene The planning scene, may be nullptr.
+   * @return The payload [kg], NaN if it is unknown.
+   */
+  static double getPayload(const planning_scene::PlanningScene* planning_scene,
+                           const pilz_msgs::MotionSequenceRequest& req_list);
 
 private:
-  using MotionResponseCont = std::vector<planning_interface::MotionPlanResponse>;
+  // Intermediate results of one solve() call are allocated from an arena, which is freed at once.
+  template <typename T>
+  using ScratchCont = std::vector<T, pilz::ArenaAllocator<T> >;
+
+  using MotionRequestCont = ScratchCont<planning_interface::MotionPlanRequest>;
+  using MotionResponseCont = ScratchCont<planning_interface::MotionPlanResponse>;
   using RobotState_OptRef = boost::optional<const robot_state::RobotState& >;
-  using RadiiCont = std::vector<double>;
+  using RadiiCont = ScratchCont<double>;
   using GroupNamesCont = std::vector<std::string>;
+  using PoseCacheCont = ScratchCont<pilz::TipFramePoseCacheConstPtr>;
 
 private:
+  /**
+   * @brief Solves the specified motion plan requests and merges/blends the
+   * resulting trajectories.
+   *
+   * @param requests The requests of the request list (in the same order).
+   * @param radii The valid blend radii of the request list, see extractBlendRadii().
+   * @param arena Arena used for the intermediate results.
+   * @param timings The processing times of the phases are added to the timings.
+   */
+  RobotTrajCont solveRequests(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                              const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                              MotionRequestCont& requests,
+                              const RadiiCont& radii,
+                              pilz::MonotonicArena& arena,
+                              const pilz::CancellationToken& cancellation,
+                              pilz::PhaseTimings& timings) const;
+
+  /**
+   * @return The limits of the payload of the active pilz::PayloadScope, or the limits of the
+   * configuration with an unknown payload if there is no active scope.
+   */
+  static pilz::PayloadLimits getScopeLimits(const pilz::PlanningConfiguration& configuration);
+
+  /**
+   * @brief Enforces the speed limit of the frames of the cartesian limits (if set) on the blended
+   * trajectories, see CartesianLimit::getSpeedLimitFrames().
+   *
+   * The segments are already limited by the generators, but the blend trajectories are not.
+   * A trajectory exceeding the limit is slowed down uniformly as a whole, so that the blends stay
+   * continuous, provided that scaling is enabled by CartesianLimit::getScaleToMaxFrameSpeed().
+   * @throws pilz::UnknownSpeedLimitFrame if a frame is not a link of the robot model
+   * @throws pilz::FrameSpeedLimitViolated if a frame exceeds the speed limit and scaling is disabled
+   */
+  void enforceFrameSpeedLimit(const pilz::LimitsContainer& limits, RobotTrajCont& trajectories) const;
+
+  /**
+   * @brief Adds the total processing time (and allocation counts) to the
+   * specified timings and passes them to the statistics (if set).
+   */
+  void addToStatistics(pilz::PhaseTimings& timings, const pilz::PhaseTimings::Clock::time_point& start,
+                       const pilz::AllocationCounts& start_counts) const;
+
+  /**
+   * @brief Checks the blend radii and start states of the specified request list.
+   */
+  static void checkRequestList(const pilz_msgs::MotionSequenceRequest &req_list);
+
   /**
    * @brief Validates that two consecutive blending radii do not overlap.
    *
    * @param motion_plan_responses Container of calculated/generated trajectories.
+   * @param pose_cont Container of the tip frame poses of the trajectories.
    * @param radii Container stating the blend radii.
    */
   void checkForOverlappingRadii(const MotionResponseCont& resp_cont,
+                                const PoseCacheCont& pose_cont,
                                 const RadiiCont &radii) const;
 
   /**
    * @brief Solve each sequence item individually.
    *
+   * The start state of each request is set to the end state of the previous
+   * trajectory of the same group, if there is one.
+   *
    * @param planning_scene The planning_scene to be used for trajectory generation.
-   * @param req_list Container of requests for calculation/generation.
+   * @param requests Container of requests for calculation/generation.
+   * @param arena Arena used for the returned container.
+   * @param cancellation Token checked before each request. It is also
+   * active (see pilz::CancellationScope) while the planning pipeline is called.
+   * @param timings The phases of the pilz planners are added to the timings.
    *
    * @return Container of generated trajectories.
    */
   MotionResponseCont solveSequenceItems(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                         const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
-                                        const pilz_msgs::MotionSequenceRequest &req_list) const;
+                                        MotionRequestCont &requests,
+                                        pilz::MonotonicArena& arena,
+                                        const pilz::CancellationToken& cancellation,
+                                        pilz::PhaseTimings& timings) const;
 
   /**
    * @return TRUE if the blending radii of specified trajectories overlap,
@@ -119,10 +256,26 @@ private:
    * different groups or if both trajectories are end-effector groups.
    */
   bool checkRadiiForOverlap(const robot_trajectory::RobotTrajectory& traj_A,
+                            const pilz::TipFramePoseCacheConstPtr& poses_A,
                             const double radii_A,
                             const robot_trajectory::RobotTrajectory& traj_B,
+                            const pilz::TipFramePoseCacheConstPtr& poses_B,
                             const double radii_B) const;
 
+  /**
+   * @brief Computes the poses of the solver tip frame along each of the
+   * specified trajectories which take part in a blend.
+   *
+   * The poses are computed only once per trajectory and are shared by the
+   * blend radii checks and the blending itself.
+   *
+   * @return Container with one entry per trajectory. Trajectories which are
+   * not blended get an empty entry.
+   */
+  PoseCacheCont computeTipFramePoses(const MotionResponseCont& resp_cont,
+                                     const RadiiCont& radii,
+                                     pilz::MonotonicArena& arena) const;
+
 private:
   /**
    * @return The last RobotState of the specified group which can
@@ -148,7 +301,8 @@ private:
    * - blend raddi between different groups.
    */
   static RadiiCont extractBlendRadii(const moveit::core::RobotModel &model,
-                                     const pilz_msgs::MotionSequenceRequest &req_list);
+                                     const pilz_msgs::MotionSequenceRequest &req_list,
+                                     pilz::MonotonicArena& arena);
 
   /**
    * @return True in case of an invalid blend radii between specified
@@ -196,11 +350,23 @@ private:
   //! Robot model
   moveit::core::RobotModelConstPtr model_;
 
-  //! @brief Builder to construct the container containing the final
-  //! trajectories.
-  PlanComponentsBuilder plan_comp_builder_;
+  //! Shared planning configuration, contains the limits used by the blender (updated at runtime).
+  pilz::SharedPlanningConfigurationPtr configuration_;
+
+  //! Rolling statistics of the processing times (optional).
+  std::shared_ptr<PlanningStatistics> statistics_;
 };
 
+inline void CommandListManager::setStatistics(const std::shared_ptr<PlanningStatistics>& statistics)
+{
+  statistics_ = statistics;
+}
+
+inline pilz::PlanningConfigurationConstPtr CommandListManager::getConfiguration() const
+{
+  return configuration_->get();
+}
+
 inline void CommandListManager::checkLastBlendRadiusZero(const pilz_msgs::MotionSequenceRequest &req_list)
 {
   if(req_list.items.back().blend_radius != 0.0)
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPACT_TRAJECTORY_H
+#define COMPACT_TRAJECTORY_H
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Joint trajectory of a fixed set of joints stored as structure of arrays.
+ *
+ * The positions, velocities and accelerations of all waypoints are stored in
+ * three contiguous arrays (the values of one waypoint are next to each other),
+ * the time from start of each waypoint in a fourth array.
+ *
+ * In contrast to robot_trajectory::RobotTrajectory, which stores a complete
+ * RobotState per waypoint, only the values of the given joints are stored.
+ * The trajectory is used internally during trajectory generation and is
+ * converted into a robot_trajectory::RobotTrajectory only when handed over to MoveIt.
+ */
+class CompactTrajectory
+{
+public:
+  CompactTrajectory() = default;
+
+  explicit CompactTrajectory(const std::vector<std::string>& joint_names);
+
+public:
+  /**
+   * @brief Sets the joints of the trajectory and removes all waypoints.
+   */
+  void setJointNames(const std::vector<std::string>& joint_names);
+
+  const std::vector<std::string>& getJointNames() const;
+
+  std::size_t getJointCount() const;
+
+  std::size_t getWayPointCount() const;
+
+  bool empty() const;
+
+  /**
+   * @brief Removes all waypoints. The joint names are kept.
+   */
+  void clear();
+
+  void reserve(std::size_t waypoint_count);
+
+  /**
+   * @brief Appends a waypoint with zero positions, velocities and accelerations.
+   * @return Index of the new waypoint.
+   */
+  std::size_t addWayPoint(double time_from_start);
+
+  /**
+   * @brief Removes the last waypoint.
+   */
+  void removeLastWayPoint();
+
+  double getTimeFromStart(std::size_t index) const;
+
+  void setTimeFromStart(std::size_t index, double time_from_start);
+
+  /**
+   * @return Time between the specified and the previous waypoint. For the first
+   * waypoint the time from start is returned.
+   */
+  double getDurationFromPrevious(std::size_t index) const;
+
+  /**
+   * @return Time from start of the last waypoint, zero if the trajectory is empty.
+   */
+  double getDuration() const;
+
+  double* getPositions(std::size_t index);
+  const double* getPositions(std::size_t index) const;
+
+  double* getVelocities(std::size_t index);
+  const double* getVelocities(std::size_t index) const;
+
+  double* getAccelerations(std::size_t index);
+  const double* getAccelerations(std::size_t index) const;
+
+  /**
+   * @brief Appends the waypoints [first, other.getWayPointCount()) of the
+   * specified trajectory.
+   *
+   * The time from start of the appended waypoints is shifted, so that
+   * the appended part starts time_offset after the end of this trajectory.
+   * Both trajectories must have the same joints.
+   */
+  void append(const CompactTrajectory& other, double time_offset, std::size_t first = 0);
+
+  /**
+   * @brief Stretches the trajectory uniformly in time by the specified factor (> 0).
+   *
+   * The times from start are multiplied by the factor, the velocities are divided by it
+   * and the accelerations by its square, so that the path of the trajectory is kept.
+   * A factor greater than one slows the trajectory down.
+   */
+  void scaleTime(double factor);
+
+  /**
+   * @brief Appends the waypoints [first, traj.getWayPointCount()) of the
+   * specified robot trajectory.
+   *
+   * The time from start of the first appended waypoint is the end of this
+   * trajectory plus the duration from previous of the corresponding waypoint
+   * in the robot trajectory.
+   */
+  void appendRobotTrajectory(const robot_trajectory::RobotTrajectory& traj, std::size_t first = 0);
+
+  /**
+   * @brief Converts the trajectory into a robot trajectory.
+   *
+   * The values of all variables which are not part of this trajectory are
+   * taken from the reference state. The first waypoint of the robot trajectory
+   * gets the time from start of the first waypoint as duration.
+   */
+  void toRobotTrajectory(const robot_state::RobotState& reference_state,
+                         robot_trajectory::RobotTrajectory& traj) const;
+
+  void toJointTrajectoryMsg(trajectory_msgs::JointTrajectory& msg) const;
+
+  /**
+   * @return The variable names of the group of the trajectory, or of the
+   * complete robot if the trajectory has no group.
+   */
+  static const std::vector<std::string>& getVariableNames(const robot_trajectory::RobotTrajectory& traj);
+
+private:
+  std::vector<int> getVariableIndices(const moveit::core::RobotModel& model) const;
+
+private:
+  std::vector<std::string> joint_names_;
+
+  std::vector<double> positions_;
+  std::vector<double> velocities_;
+  std::vector<double> accelerations_;
+  std::vector<double> time_from_start_;
+};
+
+inline const std::vector<std::string>& CompactTrajectory::getJointNames() const
+{
+  return joint_names_;
+}
+
+inline std::size_t CompactTrajectory::getJointCount() const
+{
+  return joint_names_.size();
+}
+
+inline std::size_t CompactTrajectory::getWayPointCount() const
+{
+  return time_from_start_.size();
+}
+
+inline bool CompactTrajectory::empty() const
+{
+  return time_from_start_.empty();
+}
+
+inline double CompactTrajectory::getTimeFromStart(std::size_t index) const
+{
+  assert(index < time_from_start_.size());
+  return time_from_start_[index];
+}
+
+inline void CompactTrajectory::setTimeFromStart(std::size_t index, double time_from_start)
+{
+  assert(index < time_from_start_.size());
+  time_from_start_[index] = time_from_start;
+}
+
+inline double CompactTrajectory::getDurationFromPrevious(std::size_t index) const
+{
+  return index == 0 ? getTimeFromStart(0) : getTimeFromStart(index) - getTimeFromStart(index-1);
+}
+
+inline double CompactTrajectory::getDuration() const
+{
+  return time_from_start_.empty() ? 0. : time_from_start_.back();
+}
+
+inline double* CompactTrajectory::getPositions(std::size_t index)
+{
+  assert(index < time_from_start_.size());
+  return positions_.data() + index * joint_names_.size();
+}
+
+inline const double* CompactTrajectory::getPositions(std::size_t index) const
+{
+  assert(index < time_from_start_.size());
+  return positions_.data() + index * joint_names_.size();
+}
+
+inline double* CompactTrajectory::getVelocities(std::size_t index)
+{
+  assert(index < time_from_start_.size());
+  return velocities_.data() + index * joint_names_.size();
+}
+
+inline const double* CompactTrajectory::getVelocities(std::size_t index) const
+{
+  assert(index < time_from_start_.size());
+  return velocities_.data() + index * joint_names_.size();
+}
+
+inline double* CompactTrajectory::getAccelerations(std::size_t index)
+{
+  assert(index < time_from_start_.size());
+  return accelerations_.data() + index * joint_names_.size();
+}
+
+inline const double* CompactTrajectory::getAccelerations(std::size_t index) const
+{
+  assert(index < time_from_start_.size());
+  return accelerations_.data() + index * joint_names_.size();
+}
+
+}
+
+#endif // COMPACT_TRAJECTORY_H
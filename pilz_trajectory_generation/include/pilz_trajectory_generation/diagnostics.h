@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <ros/console.h>
+#include <ros/node_handle.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Subsystems of the pilz planners. Each subsystem logs to its own named
+ * logger (see Diagnostics::getLoggerName()), whose level can be set separately.
+ */
+enum class LogSubsystem : std::size_t
+{
+  Planner,
+  Generator,
+  IK,
+  Limits,
+  Blender,
+  Sequence,
+  Count
+};
+
+/**
+ * @brief Diagnostics of the pilz planners: counts the log messages per subsystem
+ * and bounds the number of log messages per plan.
+ *
+ * The messages are logged by the PILZ_*_STREAM macros. A message is only formatted,
+ * if the level of the logger of its subsystem is enabled and the message limit of
+ * the active DiagnosticsPlanScope is not reached yet; otherwise the message is
+ * only counted as suppressed. Errors are never suppressed and do not count
+ * against the limit, so that they can not be hidden by preceding warnings.
+ */
+class Diagnostics
+{
+public:
+  //! Default of the maximal number of log messages per plan.
+  static constexpr std::size_t DEFAULT_MESSAGE_LIMIT_PER_PLAN {20};
+
+public:
+  Diagnostics(const Diagnostics&) = delete;
+  Diagnostics& operator=(const Diagnostics&) = delete;
+
+  static Diagnostics& getInstance();
+
+  /**
+   * @return The name of the logger of the subsystem ("pilz.<subsystem>") below the
+   * logger of the package, e.g. "ros.pilz_trajectory_generation.pilz.ik".
+   */
+  static const char* getLoggerName(LogSubsystem subsystem);
+
+  /**
+   * @brief Sets the maximal number of log messages per plan, zero for no limit.
+   */
+  void setMessageLimitPerPlan(std::size_t limit);
+
+  std::size_t getMessageLimitPerPlan() const;
+
+  /**
+   * @brief Sets the message limit from the parameter "log_messages_per_plan" of the
+   * given node handle (if set).
+   */
+  void configureFromParameter(const ros::NodeHandle& nh);
+
+  /**
+   * @brief Counts an (enabled) message of the subsystem.
+   * @return False if the message limit of the active DiagnosticsPlanScope is reached
+   * and the level is below Error, the message is then counted as suppressed and must not be logged.
+   */
+  bool admitMessage(LogSubsystem subsystem, ros::console::Level level = ros::console::levels::Info);
+
+  uint64_t getMessageCount(LogSubsystem subsystem) const;
+
+  uint64_t getSuppressedCount(LogSubsystem subsystem) const;
+
+  void resetCounters();
+
+private:
+  Diagnostics() = default;
+
+  using Counters = std::array<std::atomic<uint64_t>, static_cast<std::size_t>(LogSubsystem::Count)>;
+
+private:
+  std::atomic<std::size_t> message_limit_per_plan_ {DEFAULT_MESSAGE_LIMIT_PER_PLAN};
+
+  Counters message_counts_ {};
+  Counters suppressed_counts_ {};
+};
+
+/**
+ * @brief Bounds the log messages (below Error) of the calling thread while the scope is active
+ * (see Diagnostics::setMessageLimitPerPlan()).
+ *
+ * Nested scopes share the limit of the outermost scope, e.g. the plans of the
+ * commands of a sequence share the limit of the sequence. The outermost scope
+ * logs the number of suppressed messages (if any) on destruction.
+ */
+class DiagnosticsPlanScope
+{
+public:
+  DiagnosticsPlanScope();
+  ~DiagnosticsPlanScope();
+
+  DiagnosticsPlanScope(const DiagnosticsPlanScope&) = delete;
+  DiagnosticsPlanScope& operator=(const DiagnosticsPlanScope&) = delete;
+
+  /**
+   * @return The outermost active scope of the calling thread, or nullptr if there is no active scope.
+   */
+  static DiagnosticsPlanScope* getCurrentScope();
+
+private:
+  friend class Diagnostics;
+
+  static DiagnosticsPlanScope*& currentScope();
+
+private:
+  bool outermost_;
+  std::size_t message_count_ {0};
+  std::size_t suppressed_count_ {0};
+};
+
+inline Diagnostics& Diagnostics::getInstance()
+{
+  // defined inline, so that all libraries of the package share one instance
+  static Diagnostics diagnostics;
+  return diagnostics;
+}
+
+inline const char* Diagnostics::getLoggerName(LogSubsystem subsystem)
+{
+  switch(subsystem)
+  {
+    case LogSubsystem::Planner: return "pilz.planner";
+    case LogSubsystem::Generator: return "pilz.generator";
+    case LogSubsystem::IK: return "pilz.ik";
+    case LogSubsystem::Limits: return "pilz.limits";
+    case LogSubsystem::Blender: return "pilz.blender";
+    case LogSubsystem::Sequence: return "pilz.sequence";
+    default: return "pilz";
+  }
+}
+
+inline void Diagnostics::setMessageLimitPerPlan(std::size_t limit)
+{
+  message_limit_per_plan_ = limit;
+}
+
+inline std::size_t Diagnostics::getMessageLimitPerPlan() const
+{
+  return message_limit_per_plan_;
+}
+
+inline void Diagnostics::configureFromParameter(const ros::NodeHandle& nh)
+{
+  int limit;
+  if(nh.getParam("log_messages_per_plan", limit) && limit >= 0)
+  {
+    setMessageLimitPerPlan(static_cast<std::size_t>(limit));
+  }
+}
+
+inline bool Diagnostics::admitMessage(LogSubsystem subsystem, ros::console::Level level)
+{
+  const std::size_t index {static_cast<std::size_t>(subsystem)};
+  if(level >= ros::console::levels::Error)
+  {
+    ++message_counts_[index];
+    return true;
+  }
+
+  DiagnosticsPlanScope* scope {DiagnosticsPlanScope::getCurrentScope()};
+  const std::size_t limit {message_limit_per_plan_};
+  if(scope && limit != 0 && scope->message_count_ >= limit)
+  {
+    ++scope->suppressed_count_;
+    ++suppressed_counts_[index];
+    return false;
+  }
+
+  if(scope)
+  {
+    ++scope->message_count_;
+  }
+  ++message_counts_[index];
+  return true;
+}
+
+inline uint64_t Diagnostics::getMessageCount(LogSubsystem subsystem) const
+{
+  return message_counts_[static_cast<std::size_t>(subsystem)];
+}
+
+inline uint64_t Diagnostics::getSuppressedCount(LogSubsystem subsystem) const
+{
+  return suppressed_counts_[static_cast<std::size_t>(subsystem)];
+}
+
+inline void Diagnostics::resetCounters()
+{
+  for(std::size_t i = 0; i < message_counts_.size(); ++i)
+  {
+    message_counts_[i] = 0;
+    suppressed_counts_[i] = 0;
+  }
+}
+
+inline DiagnosticsPlanScope::DiagnosticsPlanScope()
+  : outermost_(currentScope() == nullptr)
+{
+  if(outermost_)
+  {
+    currentScope() = this;
+  }
+}
+
+inline DiagnosticsPlanScope::~DiagnosticsPlanScope()
+{
+  if(!outermost_)
+  {
+    return;
+  }
+  currentScope() = nullptr;
+  if(suppressed_count_ > 0)
+  {
+    ROS_WARN_STREAM_NAMED(Diagnostics::getLoggerName(LogSubsystem::Planner),
+                          "Suppressed " << suppressed_count_ << " log messages of the plan (limit "
+                          << Diagnostics::getInstance().getMessageLimitPerPlan() << " messages per plan)");
+  }
+}
+
+inline DiagnosticsPlanScope* DiagnosticsPlanScope::getCurrentScope()
+{
+  return currentScope();
+}
+
+inline DiagnosticsPlanScope*& DiagnosticsPlanScope::currentScope()
+{
+  static thread_local DiagnosticsPlanScope* scope {nullptr};
+  return scope;
+}
+
+}
+
+/**
+ * @brief Logs a message of the subsystem (a pilz::LogSubsystem) with the specified level
+ * to the logger of the subsystem. The arguments are only evaluated, if the message is logged.
+ */
+#define PILZ_LOG_STREAM(level, subsystem, args) \
+  do \
+  { \
+    ROSCONSOLE_DEFINE_LOCATION(true, level, \
+                               std::string(ROSCONSOLE_NAME_PREFIX) + "." + ::pilz::Diagnostics::getLoggerName(subsystem)); \
+    if(ROS_UNLIKELY(__rosconsole_define_location__enabled) \
+       && ::pilz::Diagnostics::getInstance().admitMessage(subsystem, level)) \
+    { \
+      ROSCONSOLE_PRINT_STREAM_AT_LOCATION(args); \
+    } \
+  } while(false)
+
+#define PILZ_DEBUG_STREAM(subsystem, args) PILZ_LOG_STREAM(::ros::console::levels::Debug, subsystem, args)
+#define PILZ_INFO_STREAM(subsystem, args) PILZ_LOG_STREAM(::ros::console::levels::Info, subsystem, args)
+#define PILZ_WARN_STREAM(subsystem, args) PILZ_LOG_STREAM(::ros::console::levels::Warn, subsystem, args)
+#define PILZ_ERROR_STREAM(subsystem, args) PILZ_LOG_STREAM(::ros::console::levels::Error, subsystem, args)
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GOAL_IK_OPTIONS_H
+#define GOAL_IK_OPTIONS_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace pilz
+{
+
+/**
+ * @brief Options of the goal IK of PTP requests with a Cartesian goal.
+ *
+ * By default the goal pose is solved once, seeded with the start state. If further seeds or the
+ * alternative solutions of the solver are configured, all of them are solved and the solution with
+ * the shortest PTP duration is taken. Equally fast solutions are ordered by their
+ * candidate: the start state first, then the configured seeds, then the solver alternatives.
+ */
+struct GoalIkOptions
+{
+  //! Additional seeds of the goal IK (positions of the active joints of the group)
+  std::vector<std::map<std::string, double> > seeds;
+  //! Add all solutions of the solver (if it provides them) as candidates
+  bool solver_alternatives {false};
+
+  /**
+   * @return True if there is more than the start state to solve.
+   */
+  bool hasCandidates() const
+  {
+    return !seeds.empty() || solver_alternatives;
+  }
+};
+
+//! Goal IK options per planning group
+typedef std::map<std::string, GoalIkOptions> GoalIkOptionsMap;
+
+}
+
+#endif // GOAL_IK_OPTIONS_H
@@ -57,7 +57,29 @@ class JointLimitsAggregator
     static JointLimitsContainer getAggregatedLimits(const ros::NodeHandle& nh,
                                            const std::vector<const moveit::core::JointModel*>& joint_models);
 
+  /**
+   * @brief Same as getAggregatedLimits(nh, joint_models), but reads the joint limit parameters from the
+   * already fetched parameter namespace, see PlanningConfigurationRegistry.
+   * @param param The parameter namespace (a struct) which contains the parameter "joint_limits"
+   * @param joint_models The joint models
+   * @return Container containing the limits
+   */
+    static JointLimitsContainer getAggregatedLimits(XmlRpc::XmlRpcValue& param,
+                                           const std::vector<const moveit::core::JointModel*>& joint_models);
+
   protected:
+    /**
+     * @brief Combines the limit of the joint_model with the limit read from the parameter server
+     * according to the rules of getAggregatedLimits().
+     *
+     * @param joint_model The joint model
+     * @param has_parameter_limits True if joint_limit contains the limits of the parameter server
+     * @param joint_limit The joint_limit to be filled with the combined values.
+     */
+    static void aggregateLimit(const moveit::core::JointModel* joint_model,
+                               bool has_parameter_limits,
+                               pilz_extensions::JointLimit& joint_limit);
+
     /**
      * @brief Update the position limits with the ones from the joint_model.
      *
@@ -19,8 +19,11 @@
 #define JOINT_LIMITS_CONTAINER_H
 
 #include "pilz_extensions/joint_limits_extension.h"
+#include "pilz_trajectory_generation/joint_limits_table.h"
 
+#include <limits>
 #include <map>
+#include <memory>
 #include <vector>
 
 namespace pilz
@@ -127,6 +130,39 @@ public:
   bool verifyPositionLimits(const std::vector<std::string> &joint_names,
                             const std::vector<double> &joint_positions) const;
 
+  /**
+   * @brief Returns the compiled limits of the given joints (in the given order), joints without limit
+   * in this container are unlimited.
+   * @param joint_names
+   * @return limits table
+   */
+  JointLimitsTable getTable(const std::vector<std::string> &joint_names) const;
+
+  /**
+   * @brief Compiles and stores the limits table of a planning group, usually in the variable order of the group.
+   * The table is shared between the copies of the container.
+   * @param group_name
+   * @param joint_names
+   */
+  void addGroupTable(const std::string& group_name, const std::vector<std::string> &joint_names);
+
+  /**
+   * @brief Returns the compiled limits of the given joints (in the given order) of a planning group.
+   * The stored table of the group is used if it contains the joints, otherwise the table is compiled.
+   * @param group_name
+   * @param joint_names
+   * @return limits table
+   */
+  JointLimitsTable getTable(const std::string& group_name, const std::vector<std::string> &joint_names) const;
+
+  /**
+   * @brief Sets the payload [kg] of the configuration dependent limits of the returned tables,
+   * NaN if it is unknown (the default), see JointLimitsTable::setPayload().
+   */
+  void setPayload(double payload);
+
+  double getPayload() const;
+
 private:
   /**
    * @brief update the most strict limit with given joint limit
@@ -139,6 +175,12 @@ private:
 protected:
   /// Actual container object containing the data
   std::map<std::string, pilz_extensions::JointLimit> container_;
+
+  /// Compiled limits tables of the planning groups
+  std::map<std::string, std::shared_ptr<const JointLimitsTable> > group_tables_;
+
+  /// Payload of the returned tables
+  double payload_ {std::numeric_limits<double>::quiet_NaN()};
 };
 }
 
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOINT_LIMITS_TABLE_H
+#define JOINT_LIMITS_TABLE_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pilz_extensions/joint_limits_extension.h"
+#include "pilz_extensions/joint_limits_grid.h"
+
+namespace pilz
+{
+
+/**
+ * @brief First limit violation found in a trajectory, see JointLimitsTable::findTrajectoryViolation().
+ */
+struct TrajectoryLimitViolation
+{
+  enum class Type
+  {
+    Position,
+    Velocity,
+    Acceleration,
+    Deceleration
+  };
+
+  //! Index of the violating waypoint.
+  std::size_t waypoint {0};
+  //! Index of the violating joint in the table.
+  std::size_t joint {0};
+  Type type {Type::Position};
+  //! The violating position, velocity or acceleration.
+  double value {0.};
+  //! The violated limit: the position bound, or the maximal absolute velocity or acceleration.
+  double limit {0.};
+};
+
+const char* toString(TrajectoryLimitViolation::Type type);
+
+/**
+ * @brief Compiled joint limits of an ordered list of joints (e.g. the joints of a planning
+ * group), stored as contiguous arrays indexed like the joints.
+ *
+ * Missing limits are stored as infinite bounds, so that the verification functions are
+ * loops over the arrays without lookups. The values to be verified are given as arrays
+ * with one value per joint (in the order of getJointNames()).
+ *
+ * Configuration dependent limits (see pilz_extensions::JointLimitsGrid) tighten the velocity,
+ * acceleration and deceleration limits at the given positions. Axes of a grid which refer to
+ * joints that are not part of the table, and the payload axis while the payload is unknown,
+ * take the worst case over the axis.
+ *
+ * Use JointLimitsContainer::getTable() to build a table.
+ */
+class JointLimitsTable
+{
+public:
+  //! Returned by the find*Violation() functions if no limit is violated.
+  static constexpr std::size_t NO_VIOLATION {std::numeric_limits<std::size_t>::max()};
+
+  /**
+   * @brief Tolerance of findTrajectoryViolation(), absolute for the positions and relative for the
+   * velocities and accelerations, so that numerical noise of the planned values is no violation.
+   */
+  static constexpr double TRAJECTORY_TOLERANCE {1e-6};
+
+  /**
+   * @brief Classification of the accelerations used by all limit checks: an acceleration opposing
+   * the velocity is checked against the deceleration limit, every other against the acceleration limit.
+   */
+  static bool isDeceleration(double velocity, double acceleration);
+
+public:
+  /**
+   * @brief Appends a joint with the specified limit.
+   *
+   * Without a deceleration grid, the acceleration grid (if any) also limits the deceleration.
+   */
+  void addJoint(const std::string& joint_name, const pilz_extensions::JointLimit& joint_limit);
+
+  /**
+   * @brief Appends a joint without limits.
+   */
+  void addUnlimitedJoint(const std::string& joint_name);
+
+  void reserve(std::size_t joint_count);
+
+  std::size_t size() const;
+
+  const std::vector<std::string>& getJointNames() const;
+
+  //! Minimal position of the i-th joint, -infinity if the joint has no position limits.
+  double getMinPosition(std::size_t i) const;
+
+  //! Maximal position of the i-th joint, infinity if the joint has no position limits.
+  double getMaxPosition(std::size_t i) const;
+
+  //! Maximal absolute velocity of the i-th joint, infinity if the joint has no velocity limit.
+  double getMaxVelocity(std::size_t i) const;
+
+  //! Maximal absolute acceleration of the i-th joint, infinity if the joint has no acceleration limit.
+  double getMaxAcceleration(std::size_t i) const;
+
+  //! Maximal absolute deceleration of the i-th joint, infinity if the joint has no deceleration limit.
+  double getMaxDeceleration(std::size_t i) const;
+
+  //! True if a joint of the table has configuration dependent limits.
+  bool hasConfigurationDependentLimits() const;
+
+  /**
+   * @brief Sets the payload [kg] of the configuration dependent limits, NaN if it is unknown (the default).
+   */
+  void setPayload(double payload);
+
+  double getPayload() const;
+
+  //! Maximal absolute velocity of the i-th joint at the positions (one per joint of the table).
+  double getMaxVelocity(std::size_t i, const double* positions) const;
+
+  //! Maximal absolute acceleration of the i-th joint at the positions (one per joint of the table).
+  double getMaxAcceleration(std::size_t i, const double* positions) const;
+
+  //! Maximal absolute deceleration of the i-th joint at the positions (one per joint of the table).
+  double getMaxDeceleration(std::size_t i, const double* positions) const;
+
+  /**
+   * @brief Computes limits of the joints which hold for all positions between the start and the goal
+   * positions, i.e. within the box spanned by them.
+   *
+   * Without configuration dependent limits these are the scalar limits. Otherwise the bounds are
+   * conservative: the minimum of the grid points of the cells intersecting the box.
+   * @param start_positions Start positions (one per joint)
+   * @param goal_positions Goal positions (one per joint)
+   * @param max_velocities Output, maximal absolute velocities (one per joint)
+   * @param max_accelerations Output, maximal absolute accelerations (one per joint)
+   * @param max_decelerations Output, maximal absolute decelerations (one per joint)
+   */
+  void getMinimalLimits(const double* start_positions,
+                        const double* goal_positions,
+                        double* max_velocities,
+                        double* max_accelerations,
+                        double* max_decelerations) const;
+
+  /**
+   * @brief Returns the table of the specified joints (in the specified order).
+   * @throws std::out_of_range if a joint is not contained in the table.
+   */
+  JointLimitsTable select(const std::vector<std::string>& joint_names) const;
+
+  /**
+   * @return The index of the first joint whose position violates the position limits, or NO_VIOLATION.
+   */
+  std::size_t findPositionViolation(const double* positions) const;
+
+  /**
+   * @param positions The positions of the configuration dependent limits, nullptr to check the scalar limits
+   * @return The index of the first joint whose velocity violates the velocity limit, or NO_VIOLATION.
+   */
+  std::size_t findVelocityViolation(const double* velocities, const double* positions = nullptr) const;
+
+  /**
+   * @brief Checks the accelerations between two samples against the acceleration or deceleration limits.
+   *
+   * An acceleration opposing the velocity of the last sample is a deceleration, see isDeceleration().
+   * @param positions The positions of the configuration dependent limits, nullptr to check the scalar limits
+   * @return The index of the first joint violating its limit, or NO_VIOLATION.
+   */
+  std::size_t findAccelerationViolation(const double* velocities_last,
+                                        const double* accelerations,
+                                        const double* positions = nullptr) const;
+
+  /**
+   * @brief Checks the positions, velocities and accelerations of all waypoints of a trajectory.
+   *
+   * The arrays contain the values of the waypoints one after the other, each with one value per joint
+   * (in the order of the table). An acceleration opposing the velocity of its waypoint is checked against
+   * the deceleration limit, every other acceleration against the acceleration limit (see isDeceleration()).
+   * The values of a waypoint are checked in one branch-free loop over the joints, only the waypoint
+   * of a violation is scanned a second time to determine the violation. Configuration dependent limits
+   * are evaluated at the positions of each waypoint before its loop.
+   *
+   * @param waypoint_count Number of waypoints
+   * @param positions Positions of the waypoints
+   * @param velocities Velocities of the waypoints
+   * @param accelerations Accelerations of the waypoints
+   * @param violation Output, the first violation (in the order position, velocity, acceleration of
+   * the first joint of the first violating waypoint), only set if a limit is violated.
+   * @return True if a limit is violated, otherwise false.
+   */
+  bool findTrajectoryViolation(std::size_t waypoint_count,
+                               const double* positions,
+                               const double* velocities,
+                               const double* accelerations,
+                               TrajectoryLimitViolation& violation) const;
+
+private:
+  //! A configuration dependent limit of a joint.
+  struct GridLimit
+  {
+    std::shared_ptr<const pilz_extensions::JointLimitsGrid> grid;
+    //! Per axis of the grid, the index of the joint in the table, PAYLOAD_AXIS or UNKNOWN_AXIS
+    std::vector<std::size_t> axis_joints;
+  };
+
+  static constexpr std::size_t PAYLOAD_AXIS {std::numeric_limits<std::size_t>::max() - 1};
+  static constexpr std::size_t UNKNOWN_AXIS {std::numeric_limits<std::size_t>::max()};
+
+  /**
+   * @brief Determines the joints of the axes of the grids, needed whenever the joints change.
+   */
+  void resolveGridAxes();
+
+  void resolveGridAxes(GridLimit& grid_limit) const;
+
+  /**
+   * @brief Returns the coordinate of an axis of a grid: the position of its joint, the payload or NaN.
+   */
+  double getGridCoordinate(std::size_t axis_joint, const double* positions) const;
+
+  /**
+   * @return The limit tightened by the grid at the positions.
+   */
+  double getGridLimit(const GridLimit& grid_limit, double limit, const double* positions) const;
+
+  /**
+   * @return The limit tightened by the minimum of the grid within the box [start_positions, goal_positions].
+   */
+  double getMinimalGridLimit(const GridLimit& grid_limit, double limit,
+                             const double* start_positions, const double* goal_positions) const;
+
+  /**
+   * @brief Determines the first violation of the waypoint (known to violate a limit).
+   */
+  void getWayPointViolation(std::size_t waypoint,
+                            const double* positions,
+                            const double* velocities,
+                            const double* accelerations,
+                            const double* max_velocities,
+                            const double* max_accelerations,
+                            const double* max_decelerations,
+                            TrajectoryLimitViolation& violation) const;
+
+private:
+  std::vector<std::string> joint_names_;
+  std::vector<double> min_positions_;
+  std::vector<double> max_positions_;
+  std::vector<double> max_velocities_;
+  std::vector<double> max_accelerations_;
+  std::vector<double> max_decelerations_;
+
+  std::vector<GridLimit> velocity_grids_;
+  std::vector<GridLimit> acceleration_grids_;
+  std::vector<GridLimit> deceleration_grids_;
+  bool has_grids_ {false};
+  double payload_ {std::numeric_limits<double>::quiet_NaN()};
+};
+
+inline std::size_t JointLimitsTable::size() const
+{
+  return joint_names_.size();
+}
+
+inline const std::vector<std::string>& JointLimitsTable::getJointNames() const
+{
+  return joint_names_;
+}
+
+inline bool JointLimitsTable::isDeceleration(double velocity, double acceleration)
+{
+  return acceleration * velocity < 0.;
+}
+
+inline double JointLimitsTable::getMinPosition(std::size_t i) const
+{
+  return min_positions_[i];
+}
+
+inline double JointLimitsTable::getMaxPosition(std::size_t i) const
+{
+  return max_positions_[i];
+}
+
+inline double JointLimitsTable::getMaxVelocity(std::size_t i) const
+{
+  return max_velocities_[i];
+}
+
+inline double JointLimitsTable::getMaxAcceleration(std::size_t i) const
+{
+  return max_accelerations_[i];
+}
+
+inline double JointLimitsTable::getMaxDeceleration(std::size_t i) const
+{
+  return max_decelerations_[i];
+}
+
+inline bool JointLimitsTable::hasConfigurationDependentLimits() const
+{
+  return has_grids_;
+}
+
+inline void JointLimitsTable::setPayload(double payload)
+{
+  payload_ = payload;
+}
+
+inline double JointLimitsTable::getPayload() const
+{
+  return payload_;
+}
+
+inline double JointLimitsTable::getMaxVelocity(std::size_t i, const double* positions) const
+{
+  return has_grids_ ? getGridLimit(velocity_grids_[i], max_velocities_[i], positions) : max_velocities_[i];
+}
+
+inline double JointLimitsTable::getMaxAcceleration(std::size_t i, const double* positions) const
+{
+  return has_grids_ ? getGridLimit(acceleration_grids_[i], max_accelerations_[i], positions) : max_accelerations_[i];
+}
+
+inline double JointLimitsTable::getMaxDeceleration(std::size_t i, const double* positions) const
+{
+  return has_grids_ ? getGridLimit(deceleration_grids_[i], max_decelerations_[i], positions) : max_decelerations_[i];
+}
+
+}
+
+#endif // JOINT_LIMITS_TABLE_H
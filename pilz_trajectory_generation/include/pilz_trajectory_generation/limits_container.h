@@ -20,6 +20,7 @@
 
 #include <math.h>
 #include "pilz_trajectory_generation/cartesian_limit.h"
+#include "pilz_trajectory_generation/goal_ik_options.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
 
 namespace pilz {
@@ -69,6 +70,44 @@ class LimitsContainer
      */
     const CartesianLimit& getCartesianLimits() const;
 
+    /**
+     * @brief Return if this LimitsContainer has precomputed most strict joint limits of the planning groups
+     * @return True if container contains the most strict joint limits of the planning groups
+     */
+    bool hasGroupCommonLimits() const;
+
+    /**
+     * @brief Set the most strict joint limits of the planning groups,
+     * see JointLimitsContainer::getCommonLimit(const std::vector<std::string>&)
+     * @param group_common_limits most strict joint limit per group name
+     */
+    void setGroupCommonLimits(const pilz_extensions::JointLimitsMap& group_common_limits);
+
+    /**
+     * @brief Return the most strict joint limits of the planning groups
+     * @return the most strict joint limit per group name
+     */
+    const pilz_extensions::JointLimitsMap& getGroupCommonLimits() const;
+
+    /**
+     * @brief Set the payload [kg] of the configuration dependent joint limits,
+     * see JointLimitsContainer::setPayload()
+     * @param payload the payload, NaN if it is unknown
+     */
+    void setPayload(double payload);
+
+    /**
+     * @brief Set the options of the PTP goal IK of the planning groups
+     * @param goal_ik_options options per group name
+     */
+    void setGoalIkOptions(const GoalIkOptionsMap& goal_ik_options);
+
+    /**
+     * @brief Return the options of the PTP goal IK of the planning groups
+     * @return the options per group name, groups without options solve the goal IK once
+     */
+    const GoalIkOptionsMap& getGoalIkOptions() const;
+
   private:
     /// Flag if joint limits where set
     bool has_joint_limits_;
@@ -82,6 +121,15 @@ class LimitsContainer
     /// The cartesian limits
     CartesianLimit cartesian_limit_;
 
+    /// Flag if the most strict joint limits of the planning groups have been set
+    bool has_group_common_limits_;
+
+    /// The most strict joint limits of the planning groups
+    pilz_extensions::JointLimitsMap group_common_limits_;
+
+    /// The options of the PTP goal IK of the planning groups
+    GoalIkOptionsMap goal_ik_options_;
+
 
 
 };
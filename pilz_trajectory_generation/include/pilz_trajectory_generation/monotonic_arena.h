@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MONOTONIC_ARENA_H
+#define MONOTONIC_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace pilz
+{
+
+/**
+ * @brief Memory arena which hands out memory from a few large blocks and
+ * frees everything at once.
+ *
+ * Deallocation of single objects is a no-op, the memory is returned
+ * when release() is called or the arena is destroyed. Use the arena for
+ * short living scratch containers, e.g. the intermediate results of one
+ * planning request.
+ *
+ * The arena is not thread-safe.
+ */
+class MonotonicArena
+{
+public:
+  explicit MonotonicArena(std::size_t initial_block_size = DEFAULT_BLOCK_SIZE);
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+public:
+  /**
+   * @brief Returns memory for the specified number of bytes with the
+   * specified alignment.
+   */
+  void* allocate(std::size_t bytes, std::size_t alignment);
+
+  /**
+   * @brief Frees all blocks. Memory handed out before must not be used anymore.
+   */
+  void release();
+
+  //! Number of blocks requested from the heap since construction or the last release().
+  std::size_t getBlockCount() const;
+
+private:
+  void addBlock(std::size_t min_size);
+
+private:
+  static constexpr std::size_t DEFAULT_BLOCK_SIZE {4096};
+
+  const std::size_t initial_block_size_;
+  std::size_t next_block_size_;
+
+  std::vector<std::unique_ptr<char[]> > blocks_;
+  //! Free part of the current block.
+  void* current_ {nullptr};
+  std::size_t remaining_ {0};
+};
+
+/**
+ * @brief Allocator handing out the memory of a MonotonicArena, for the use
+ * with standard containers.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(MonotonicArena& arena)
+    : arena_(&arena)
+  {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)
+    : arena_(other.getArena())
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t)
+  {
+    // memory is freed by the arena
+  }
+
+  MonotonicArena* getArena() const
+  {
+    return arena_;
+  }
+
+private:
+  MonotonicArena* arena_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+  return lhs.getArena() == rhs.getArena();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline std::size_t MonotonicArena::getBlockCount() const
+{
+  return blocks_.size();
+}
+
+}
+
+#endif // MONOTONIC_ARENA_H
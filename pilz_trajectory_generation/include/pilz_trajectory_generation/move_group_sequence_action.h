@@ -19,12 +19,17 @@
 #define SEQUENCE_ACTION_CAPABILITY_H
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <moveit/move_group/move_group_capability.h>
 #include <actionlib/server/simple_action_server.h>
 
 #include <pilz_msgs/MoveGroupSequenceAction.h>
 
+#include "pilz_trajectory_generation/cancellation_token.h"
+#include "pilz_trajectory_generation/planning_configuration.h"
+
 namespace pilz_trajectory_generation
 {
 
@@ -50,16 +55,40 @@ private:
 private:
   void executeSequenceCallback(const pilz_msgs::MoveGroupSequenceGoalConstPtr &goal);
   void executeSequenceCallbackPlanAndExecute(const pilz_msgs::MoveGroupSequenceGoalConstPtr& goal,
+                                              const pilz::CancellationToken& cancellation,
                                               pilz_msgs::MoveGroupSequenceResult& action_res);
   void executeMoveCallbackPlanOnly(const pilz_msgs::MoveGroupSequenceGoalConstPtr& goal,
+                                    const pilz::CancellationToken& cancellation,
                                     pilz_msgs::MoveGroupSequenceResult& res);
   void startMoveExecutionCallback();
   void startMoveLookCallback();
   void preemptMoveCallback();
   void setMoveState(move_group::MoveGroupState state);
   bool planUsingSequenceManager(const pilz_msgs::MotionSequenceRequest &req,
+                                const pilz::CancellationToken& cancellation,
                                 plan_execution::ExecutableMotionPlan& plan);
 
+  /**
+   * @brief Gets the current speed override from the speed override service.
+   * @return False if the service cannot be called.
+   */
+  bool getSpeedOverride(double& speed_override);
+
+  /**
+   * @return True if the trajectories of the last planned goal can be executed for the request:
+   * the request equals the last one, the planning configuration (limits) did not change since, the robot
+   * is at the start of the trajectories and the trajectories are still valid (e.g. collision free) in the
+   * current planning scene.
+   */
+  bool isLastPlanReusable(const pilz_msgs::MotionSequenceRequest& req,
+                          const planning_scene::PlanningScene& scene) const;
+
+  /**
+   * @brief Replaces the cancellation token by a new one for the next goal.
+   * @return The new token.
+   */
+  pilz::CancellationToken resetCancellationToken();
+
 private:
   static void convertToMsg(const ExecutableTrajs& trajs,
                            StartStateMsgs& startStatesMsgs,
@@ -72,6 +101,19 @@ private:
   move_group::MoveGroupState move_state_ {move_group::IDLE};
   std::unique_ptr<pilz_trajectory_generation::CommandListManager> command_list_manager_;
 
+  //! Client of the speed override service, only valid if the parameter "speed_override_service" is set.
+  ros::ServiceClient speed_override_client_;
+
+  //! The request and the trajectories (without speed override) of the last planned goal.
+  pilz_msgs::MotionSequenceRequest last_request_;
+  std::vector<robot_trajectory::RobotTrajectoryPtr> last_trajectories_;
+  //! The planning configuration which was current when the last goal was planned.
+  pilz::PlanningConfigurationConstPtr last_configuration_;
+
+  //! Cancels the planning of the current goal, if the goal is preempted.
+  pilz::CancellationToken cancellation_;
+  std::mutex cancellation_mutex_;
+
 };
 }
 
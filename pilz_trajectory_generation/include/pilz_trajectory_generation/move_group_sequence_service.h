@@ -18,9 +18,15 @@
 #ifndef SEQUENCE_SERVICE_CAPABILITY_H
 #define SEQUENCE_SERVICE_CAPABILITY_H
 
+#include <mutex>
+#include <vector>
+
 #include <moveit/move_group/move_group_capability.h>
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
 
 #include <pilz_msgs/GetMotionSequence.h>
+#include <pilz_msgs/GetMotionSequenceBatch.h>
 
 namespace pilz_trajectory_generation
 {
@@ -30,6 +36,9 @@ class CommandListManager;
 
 /**
  * @brief Provide service to blend multiple trajectories in the form of a MoveGroup capability (plugin).
+ *
+ * Besides the service for a single sequence, a batch service is provided which plans a list of
+ * independent sequences concurrently.
  */
 class MoveGroupSequenceService : public move_group::MoveGroupCapability
 {
@@ -44,8 +53,35 @@ private:
   bool plan(pilz_msgs::GetMotionSequence::Request &req,
             pilz_msgs::GetMotionSequence::Response &res);
 
+  /**
+   * @brief Plans all sequences of the request against one snapshot of the planning scene.
+   *
+   * The sequences are planned concurrently by a fixed number of worker threads
+   * (see parameter "batch_planning_threads"). The planning pipeline (its planner and adapters)
+   * is not thread-safe, so with more than one thread every worker uses its own pipeline and
+   * batch requests are planned one after the other.
+   * Every sequence gets its own result and error code, a failing sequence does not affect the others.
+   */
+  bool planBatch(pilz_msgs::GetMotionSequenceBatch::Request &req,
+                 pilz_msgs::GetMotionSequenceBatch::Response &res);
+
+  /**
+   * @brief Plans the specified sequence and writes the result (or the error) into res.
+   */
+  void planSequence(const planning_scene::PlanningSceneConstPtr& scene,
+                    const planning_pipeline::PlanningPipelinePtr& pipeline,
+                    pilz_msgs::MotionSequenceRequest&& req,
+                    pilz_msgs::MotionSequenceResponse& res) const;
+
 private:
   ros::ServiceServer sequence_service_;
+  ros::ServiceServer sequence_batch_service_;
+  //! Number of threads used to plan the sequences of a batch request.
+  unsigned int batch_planning_threads_ {1};
+  //! One planning pipeline per worker thread, only used with more than one thread.
+  std::vector<planning_pipeline::PlanningPipelinePtr> batch_pipelines_;
+  //! Serializes the batch requests, which share the pipelines of the workers.
+  std::mutex batch_mutex_;
   std::unique_ptr<CommandListManager> command_list_manager_ ;
 
 };
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PHASE_TIMINGS_H
+#define PHASE_TIMINGS_H
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pilz_trajectory_generation/allocation_counters.h"
+
+namespace pilz
+{
+
+/**
+ * @brief Processing times of the phases of a planning request.
+ *
+ * The phases are kept in the order in which they are added. Adding a phase
+ * a second time accumulates the processing time.
+ *
+ * In builds with allocation counters, the heap allocations and copies of
+ * each phase are kept as well (see AllocationCounters).
+ */
+class PhaseTimings
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using Entry = std::pair<std::string, double>;
+  using EntryCont = std::vector<Entry>;
+  using AllocationCountsCont = std::vector<AllocationCounts>;
+
+public:
+  /**
+   * @brief Adds the specified processing time (in seconds) and allocation
+   * counts to the specified phase.
+   */
+  void add(const std::string& phase, double seconds, const AllocationCounts& counts = AllocationCounts());
+
+  /**
+   * @brief Adds all phases of the specified timings. The specified prefix is
+   * prepended to the names of the phases.
+   */
+  void add(const PhaseTimings& other, const std::string& prefix = std::string());
+
+  /**
+   * @return The processing time of the specified phase, or zero if the phase
+   * was not recorded.
+   */
+  double get(const std::string& phase) const;
+
+  const EntryCont& getEntries() const;
+
+  /**
+   * @return The allocation counts of the phases, in the order of getEntries().
+   */
+  const AllocationCountsCont& getAllocationCounts() const;
+
+  bool empty() const;
+
+  void clear();
+
+  /**
+   * @return Seconds passed since the specified time point.
+   */
+  static double getSecondsSince(const Clock::time_point& start);
+
+private:
+  EntryCont entries_;
+  AllocationCountsCont allocation_counts_;
+};
+
+/**
+ * @brief Adds the time (and the allocation counts) between construction and
+ * destruction to the specified phase.
+ */
+class ScopedPhaseTimer
+{
+public:
+  ScopedPhaseTimer(PhaseTimings& timings, const std::string& phase);
+  ~ScopedPhaseTimer();
+
+  ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+  ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+  PhaseTimings& timings_;
+  const std::string phase_;
+  const PhaseTimings::Clock::time_point start_;
+  const AllocationCounts start_counts_;
+};
+
+/**
+ * @brief Makes the specified timings the sink of the calling thread for the
+ * lifetime of the scope.
+ *
+ * Used to collect the phases of the planning contexts which are called by
+ * the planning pipeline: Planning contexts add the phases of their solve()
+ * to the sink of the current thread.
+ */
+class PhaseTimingsScope
+{
+public:
+  explicit PhaseTimingsScope(PhaseTimings& timings);
+  ~PhaseTimingsScope();
+
+  PhaseTimingsScope(const PhaseTimingsScope&) = delete;
+  PhaseTimingsScope& operator=(const PhaseTimingsScope&) = delete;
+
+  /**
+   * @return The timings of the innermost active scope of the calling thread,
+   * or nullptr if there is no active scope.
+   */
+  static PhaseTimings* getCurrentTimings();
+
+private:
+  static PhaseTimings*& currentTimings();
+
+private:
+  PhaseTimings* previous_timings_;
+};
+
+inline void PhaseTimings::add(const std::string& phase, double seconds, const AllocationCounts& counts)
+{
+  auto it = std::find_if(entries_.begin(), entries_.end(), [&phase](const Entry& entry){ return entry.first == phase; });
+  if(it == entries_.end())
+  {
+    entries_.emplace_back(phase, seconds);
+    allocation_counts_.push_back(counts);
+    return;
+  }
+  it->second += seconds;
+  allocation_counts_.at(static_cast<std::size_t>(it - entries_.begin())) += counts;
+}
+
+inline void PhaseTimings::add(const PhaseTimings& other, const std::string& prefix)
+{
+  for(std::size_t i = 0; i < other.entries_.size(); ++i)
+  {
+    add(prefix + other.entries_[i].first, other.entries_[i].second, other.allocation_counts_[i]);
+  }
+}
+
+inline double PhaseTimings::get(const std::string& phase) const
+{
+  auto it = std::find_if(entries_.begin(), entries_.end(), [&phase](const Entry& entry){ return entry.first == phase; });
+  return it == entries_.end() ? 0. : it->second;
+}
+
+inline const PhaseTimings::EntryCont& PhaseTimings::getEntries() const
+{
+  return entries_;
+}
+
+inline const PhaseTimings::AllocationCountsCont& PhaseTimings::getAllocationCounts() const
+{
+  return allocation_counts_;
+}
+
+inline bool PhaseTimings::empty() const
+{
+  return entries_.empty();
+}
+
+inline void PhaseTimings::clear()
+{
+  entries_.clear();
+  allocation_counts_.clear();
+}
+
+inline double PhaseTimings::getSecondsSince(const Clock::time_point& start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+inline ScopedPhaseTimer::ScopedPhaseTimer(PhaseTimings& timings, const std::string& phase)
+  : timings_(timings)
+  , phase_(phase)
+  , start_(PhaseTimings::Clock::now())
+  , start_counts_(AllocationCounters::get())
+{
+}
+
+inline ScopedPhaseTimer::~ScopedPhaseTimer()
+{
+  timings_.add(phase_, PhaseTimings::getSecondsSince(start_), AllocationCounters::getSince(start_counts_));
+}
+
+inline PhaseTimingsScope::PhaseTimingsScope(PhaseTimings& timings)
+  : previous_timings_(currentTimings())
+{
+  currentTimings() = &timings;
+}
+
+inline PhaseTimingsScope::~PhaseTimingsScope()
+{
+  currentTimings() = previous_timings_;
+}
+
+inline PhaseTimings* PhaseTimingsScope::getCurrentTimings()
+{
+  return currentTimings();
+}
+
+inline PhaseTimings*& PhaseTimingsScope::currentTimings()
+{
+  static thread_local PhaseTimings* timings {nullptr};
+  return timings;
+}
+
+}
+
+#endif // PHASE_TIMINGS_H
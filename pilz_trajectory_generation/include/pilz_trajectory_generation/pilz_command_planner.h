@@ -20,6 +20,8 @@
 
 #include <ros/ros.h>
 
+#include "pilz_msgs/UpdatePlanningLimits.h"
+#include "pilz_trajectory_generation/planning_configuration.h"
 #include "pilz_trajectory_generation/planning_context_loader.h"
 #include "pilz_extensions/joint_limits_extension.h"
 
@@ -90,6 +92,14 @@ public:
    */
   void registerContextLoader(const pilz::PlanningContextLoaderPtr& planning_context_loader);
 
+private:
+  /**
+   * @brief Updates the limits of the planning configurations, see PlanningConfigurationRegistry::updateConfigurations().
+   * Plans which are already running finish with the previous limits.
+   */
+  bool updatePlanningLimits(pilz_msgs::UpdatePlanningLimits::Request& req,
+                            pilz_msgs::UpdatePlanningLimits::Response& res);
+
 private:
 
   /// Plugin loader
@@ -104,11 +114,11 @@ private:
   /// Namespace where the parameters are stored, obtained at initialize
   std::string namespace_;
 
-  /// aggregated limits of the active joints
-  pilz::JointLimitsContainer aggregated_limit_active_joints_;
+  /// limits and sampling times, shared with the sequence capabilities
+  pilz::SharedPlanningConfigurationPtr configuration_;
 
-  /// cartesian limit
-  pilz::CartesianLimit cartesian_limit_;
+  /// Service to update the limits at runtime
+  ros::ServiceServer update_planning_limits_service_;
 };
 
 MOVEIT_CLASS_FORWARD(CommandPlanner)
@@ -24,10 +24,13 @@
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
+#include "pilz_trajectory_generation/cancellation_token.h"
+#include "pilz_trajectory_generation/compact_trajectory.h"
 #include "pilz_trajectory_generation/trajectory_functions.h"
 #include "pilz_trajectory_generation/trajectory_blend_request.h"
 #include "pilz_trajectory_generation/trajectory_blender.h"
 #include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
 
 namespace pilz_trajectory_generation
 {
@@ -39,6 +42,8 @@ CREATE_MOVEIT_ERROR_CODE_EXCEPTION(NoBlenderSetException, moveit_msgs::MoveItErr
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(NoTipFrameFunctionSetException, moveit_msgs::MoveItErrorCodes::FAILURE);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(NoRobotModelSetException, moveit_msgs::MoveItErrorCodes::FAILURE);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(BlendingFailedException, moveit_msgs::MoveItErrorCodes::FAILURE);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(BlendingCancelledException, moveit_msgs::MoveItErrorCodes::PREEMPTED);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(TrajectoryLimitsViolatedException, moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
 
 /**
  * @brief Helper class to encapsulate the merge and blend process of
@@ -57,6 +62,17 @@ public:
    */
   void setModel(const moveit::core::RobotModelConstPtr &model);
 
+  /**
+   * @brief Sets the token used to cancel the blending.
+   */
+  void setCancellationToken(const pilz::CancellationToken& cancellation);
+
+  /**
+   * @brief Sets the joint limits the built trajectories are verified against.
+   * Without joint limits the trajectories are not verified.
+   */
+  void setJointLimits(const pilz::JointLimitsContainer& joint_limits);
+
   /**
    * @brief Appends the specified trajectory to the trajectory container
    * under construction.
@@ -77,8 +93,13 @@ public:
    *
    * @param blend_radius The blending radius between the previous and the
    * specified trajectory.
+   *
+   * @param other_poses Optional poses of the solver tip frame for every
+   * waypoint of the specified trajectory. If given, the blender reuses them
+   * instead of recomputing them.
    */
-  void append(const robot_trajectory::RobotTrajectoryPtr& other, const double blend_radius);
+  void append(const robot_trajectory::RobotTrajectoryPtr& other, const double blend_radius,
+              const pilz::TipFramePoseCacheConstPtr& other_poses = pilz::TipFramePoseCacheConstPtr());
 
   /**
    * @brief Clears the trajectory container under construction.
@@ -87,12 +108,41 @@ public:
 
   /**
    * @return The final trajectory container which results from the append calls.
+   * @throws TrajectoryLimitsViolatedException if joint limits are set and a trajectory violates them.
    */
   std::vector<robot_trajectory::RobotTrajectoryPtr> build() const;
 
+private:
+  /**
+   * @brief Element of the trajectory container under construction.
+   *
+   * Only the variables of the group are stored for every waypoint. All other
+   * variables are taken from the reference state when the element is
+   * converted into a robot_trajectory::RobotTrajectory.
+   */
+  struct TrajectoryElement
+  {
+    std::string group_name;
+    //! First waypoint appended to the element.
+    robot_state::RobotStateConstPtr reference_state;
+    pilz::CompactTrajectory trajectory;
+  };
+
 private:
   void blend(const robot_trajectory::RobotTrajectoryPtr& other,
-             const double blend_radius);
+             const double blend_radius,
+             const pilz::TipFramePoseCacheConstPtr& other_poses);
+
+  /**
+   * @brief Adds a new empty element for the group of the specified trajectory
+   * to the trajectory container.
+   */
+  void addElement(const robot_trajectory::RobotTrajectory& traj);
+
+  /**
+   * @brief Verifies the trajectory of the element against the joint limits (if set).
+   */
+  void verifyElement(const TrajectoryElement& element) const;
 
 private:
   /**
@@ -104,9 +154,26 @@ private:
    * increasing trajectory. If through appending the last point of the
    * original trajectory gets repeated, it is removed here.
    */
-  static void appendWithStrictTimeIncrease(robot_trajectory::RobotTrajectory &result,
+  static void appendWithStrictTimeIncrease(TrajectoryElement &result,
                                            const robot_trajectory::RobotTrajectory &source);
 
+  /**
+   * @brief Appends the waypoints [first, source.getWayPointCount()) to the
+   * specified element.
+   */
+  static void appendToElement(TrajectoryElement &result,
+                              const robot_trajectory::RobotTrajectory &source,
+                              std::size_t first = 0);
+
+  /**
+   * @return True if the positions, velocities and accelerations of the last
+   * waypoint of the specified trajectory are equal to the ones of the given
+   * state, otherwise false.
+   */
+  static bool isLastWayPointEqual(const pilz::CompactTrajectory& traj,
+                                  const robot_state::RobotState& state,
+                                  double epsilon);
+
 private:
   //! Blender used to blend two trajectories.
   std::unique_ptr<pilz::TrajectoryBlender> blender_;
@@ -114,11 +181,22 @@ private:
   //! Robot model needed to create new trajectory container elements.
   moveit::core::RobotModelConstPtr model_;
 
+  //! Passed on to the blender.
+  pilz::CancellationToken cancellation_;
+
+  //! Joint limits the built trajectories are verified against.
+  pilz::JointLimitsContainer joint_limits_;
+
+  bool has_joint_limits_ {false};
+
   //! The previously added trajectory.
   robot_trajectory::RobotTrajectoryPtr traj_tail_;
 
+  //! Poses of the solver tip frame along the previously added trajectory (if known).
+  pilz::TipFramePoseCacheConstPtr traj_tail_poses_;
+
   //! The trajectory container under construction.
-  std::vector<robot_trajectory::RobotTrajectoryPtr> traj_cont_;
+  std::vector<TrajectoryElement> traj_cont_;
 
 private:
   //! Constant to check for equality of variables of two RobotState instances.
@@ -135,9 +213,21 @@ inline void PlanComponentsBuilder::setModel(const moveit::core::RobotModelConstP
   model_ = model;
 }
 
+inline void PlanComponentsBuilder::setCancellationToken(const pilz::CancellationToken& cancellation)
+{
+  cancellation_ = cancellation;
+}
+
+inline void PlanComponentsBuilder::setJointLimits(const pilz::JointLimitsContainer& joint_limits)
+{
+  joint_limits_ = joint_limits;
+  has_joint_limits_ = true;
+}
+
 inline void PlanComponentsBuilder::reset()
 {
   traj_tail_ = nullptr;
+  traj_tail_poses_ = nullptr;
   traj_cont_.clear();
 }
 
@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANNING_CONFIGURATION_H
+#define PLANNING_CONFIGURATION_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/node_handle.h>
+#include <moveit/robot_model/robot_model.h>
+
+#include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/sampling_times.h"
+
+namespace pilz
+{
+
+/**
+ * @brief Limits of the requests with a payload up to max_payload, see PlanningConfiguration.
+ */
+struct PayloadProfile
+{
+  std::string name;
+  //! Maximal payload [kg] of the profile
+  double max_payload {0.};
+  LimitsContainer limits;
+};
+
+/**
+ * @brief The limits of a payload, see PlanningConfiguration::getPayloadLimits().
+ *
+ * The limits refer to the configuration, which has to outlive them.
+ */
+struct PayloadLimits
+{
+  PayloadLimits(const LimitsContainer& limits, double payload);
+
+  //! The limits of the payload profile, shared by all payloads of the profile (without the payload).
+  const LimitsContainer& limits;
+  //! The payload [kg] of the configuration dependent joint limits (see LimitsContainer::setPayload()),
+  //! NaN if it is unknown.
+  double payload;
+};
+
+/**
+ * @brief Immutable snapshot of the planning configuration of a robot model:
+ * the aggregated limits, the sampling times and the tip frames of the planning groups.
+ *
+ * The limits of the namespace apply to any payload. Payload profiles (parameter "payload_profiles")
+ * override some of them for lighter payloads, e.g. for moves with an empty gripper. The limits of
+ * all profiles are aggregated once, a request only selects the profile of its payload.
+ *
+ * The snapshot is built once per robot model and shared by the command planner
+ * and the sequence capabilities, see PlanningConfigurationRegistry. An update of the
+ * limits creates a new snapshot.
+ *
+ * The getters are defined inline, so that the planning context loaders can use
+ * the snapshot without linking this class.
+ */
+class PlanningConfiguration
+{
+public:
+  /**
+   * @brief Builds the configuration from the parameter namespace of the limits.
+   * @param param The parameter namespace (a struct) containing "joint_limits",
+   * "cartesian_limits", "sampling_times", "payload_profiles" and "ptp_goal_ik"
+   * @param model The robot model
+   * @param reduction_factor Factor in (0, 1] applied to the velocity and acceleration limits
+   * (joint and Cartesian)
+   * @throws AggregationBoundsViolationException if the joint limits violate the limits of the model
+   * @throws std::invalid_argument if a payload profile or the PTP goal IK options are malformed
+   */
+  PlanningConfiguration(XmlRpc::XmlRpcValue& param, const moveit::core::RobotModelConstPtr& model,
+                        double reduction_factor = 1.);
+
+  const moveit::core::RobotModelConstPtr& getRobotModel() const;
+
+  double getReductionFactor() const;
+
+  /**
+   * @return The aggregated joint and cartesian limits, including the most strict joint limits of the groups.
+   */
+  const LimitsContainer& getLimits() const;
+
+  /**
+   * @return The payload profiles, ordered by their maximal payload.
+   */
+  const std::vector<PayloadProfile>& getPayloadProfiles() const;
+
+  /**
+   * @return The profile with the smallest maximal payload not below the payload, nullptr if there is
+   * none or the payload is unknown (NaN).
+   */
+  const PayloadProfile* getPayloadProfile(double payload) const;
+
+  /**
+   * @return The limits of the payload profile (or the limits of the namespace, if there is no profile
+   * of the payload) and the payload for the configuration dependent joint limits. The limits of the
+   * profiles are aggregated once, they are not copied.
+   */
+  PayloadLimits getPayloadLimits(double payload) const;
+
+  const SamplingTimesContainer& getSamplingTimes() const;
+
+  /**
+   * @return True if the solver of the group has exactly one tip frame.
+   */
+  bool hasSolverTipFrame(const std::string& group_name) const;
+
+  /**
+   * @return The tip frame of the solver of the group.
+   * @throws std::out_of_range if the solver of the group has not exactly one tip frame.
+   */
+  const std::string& getSolverTipFrame(const std::string& group_name) const;
+
+private:
+  /**
+   * @brief Aggregates the joint and cartesian limits of the parameter namespace.
+   */
+  LimitsContainer buildLimits(XmlRpc::XmlRpcValue& param) const;
+
+  /**
+   * @brief Reads the options of the PTP goal IK of the planning groups ("ptp_goal_ik").
+   */
+  GoalIkOptionsMap buildGoalIkOptions(XmlRpc::XmlRpcValue& param) const;
+
+  /**
+   * @brief Reads the payload profiles, each overriding members of the limits of the namespace.
+   */
+  void buildPayloadProfiles(XmlRpc::XmlRpcValue& param);
+
+  static JointLimitsContainer reduceJointLimits(const JointLimitsContainer& joint_limits, double reduction_factor);
+
+  static std::shared_ptr<const pilz_extensions::JointLimitsGrid> reduceGrid(
+      const std::shared_ptr<const pilz_extensions::JointLimitsGrid>& grid, double reduction_factor);
+
+  static CartesianLimit reduceCartesianLimit(const CartesianLimit& cartesian_limit, double reduction_factor);
+
+private:
+  const moveit::core::RobotModelConstPtr model_;
+
+  const double reduction_factor_;
+
+  LimitsContainer limits_;
+
+  std::vector<PayloadProfile> payload_profiles_;
+
+  SamplingTimesContainer sampling_times_;
+
+  std::map<std::string, std::string> solver_tip_frames_;
+};
+
+typedef std::shared_ptr<const PlanningConfiguration> PlanningConfigurationConstPtr;
+
+/**
+ * @brief Sets the payload [kg] of the requests planned by the calling thread while the scope
+ * is active (e.g. the payload of a sequence request for all of its requests).
+ *
+ * The planning contexts get the limits of the payload, see PlanningConfiguration::getPayloadLimits().
+ */
+class PayloadScope
+{
+public:
+  explicit PayloadScope(double payload);
+  ~PayloadScope();
+
+  PayloadScope(const PayloadScope&) = delete;
+  PayloadScope& operator=(const PayloadScope&) = delete;
+
+  /**
+   * @return The payload of the innermost active scope of the calling thread,
+   * or nullptr if there is no active scope.
+   */
+  static const double* getCurrentPayload();
+
+private:
+  static const double*& currentPayload();
+
+private:
+  double payload_;
+  const double* previous_payload_;
+};
+
+class SharedPlanningConfiguration;
+
+/**
+ * @brief Fixes the snapshot which SharedPlanningConfiguration::get() returns to the calling thread
+ * while the scope is active (e.g. the snapshot of a sequence request for all of its requests).
+ *
+ * The planning contexts, the blending and the checks of the requests then use the same limits,
+ * even if the configuration is updated while they are planned.
+ */
+class ConfigurationScope
+{
+public:
+  /**
+   * @param shared The shared configuration whose snapshot is fixed
+   * @param configuration The snapshot returned by shared.get() within the scope
+   */
+  ConfigurationScope(const SharedPlanningConfiguration& shared, const PlanningConfigurationConstPtr& configuration);
+  ~ConfigurationScope();
+
+  ConfigurationScope(const ConfigurationScope&) = delete;
+  ConfigurationScope& operator=(const ConfigurationScope&) = delete;
+
+  /**
+   * @return The snapshot of the innermost active scope of the calling thread for the shared
+   * configuration, or nullptr if there is no such scope.
+   */
+  static const PlanningConfigurationConstPtr* getCurrentConfiguration(const SharedPlanningConfiguration& shared);
+
+private:
+  static const ConfigurationScope*& currentScope();
+
+private:
+  const SharedPlanningConfiguration* shared_;
+  PlanningConfigurationConstPtr configuration_;
+  const ConfigurationScope* previous_scope_;
+};
+
+/**
+ * @brief The current planning configuration, which can be replaced while it is used (read-copy-update).
+ *
+ * Readers take the current snapshot with get() and keep using it, e.g. for a complete plan.
+ * Within a ConfigurationScope, get() returns the snapshot of the scope.
+ * set() publishes a new snapshot for the following get() calls; the previous snapshot is released
+ * when its last reader is done. Neither get() nor set() waits for the planning of other threads.
+ *
+ * @note The atomic access to the std::shared_ptr is not lock-free with libstdc++, which guards it by
+ * a spinlock (from a global pool) held only while the pointer is copied. get() is called once per
+ * planned request or sequence, so the lock is not contended by the planning itself.
+ */
+class SharedPlanningConfiguration
+{
+public:
+  explicit SharedPlanningConfiguration(const PlanningConfigurationConstPtr& configuration);
+
+  PlanningConfigurationConstPtr get() const;
+
+  void set(const PlanningConfigurationConstPtr& configuration);
+
+private:
+  PlanningConfigurationConstPtr configuration_;
+};
+
+typedef std::shared_ptr<SharedPlanningConfiguration> SharedPlanningConfigurationPtr;
+
+/**
+ * @brief Registry of the planning configurations, which builds each configuration once
+ * and shares it between the command planner and the sequence capabilities.
+ *
+ * The parameter namespace of the limits is fetched with a single request to the parameter
+ * server. The configuration is rebuilt if it is requested for another robot model (e.g.
+ * after the robot description was reloaded) or after clear().
+ *
+ * updateConfigurations() replaces the configurations at runtime, e.g. to switch between
+ * the limits of different operating modes, see SharedPlanningConfiguration.
+ */
+class PlanningConfigurationRegistry
+{
+public:
+  PlanningConfigurationRegistry(const PlanningConfigurationRegistry&) = delete;
+  PlanningConfigurationRegistry& operator=(const PlanningConfigurationRegistry&) = delete;
+
+  static PlanningConfigurationRegistry& getInstance();
+
+  /**
+   * @brief Returns the configuration of the robot model, which is built on the first call.
+   * @param nh Node handle of the parameter namespace of the limits
+   * @param model The robot model
+   * @throws AggregationBoundsViolationException if the joint limits violate the limits of the model
+   */
+  PlanningConfigurationConstPtr getConfiguration(const ros::NodeHandle& nh,
+                                                 const moveit::core::RobotModelConstPtr& model);
+
+  /**
+   * @brief Same as getConfiguration(), but returns the shared configuration, which reflects
+   * the updates of the configuration.
+   */
+  SharedPlanningConfigurationPtr getSharedConfiguration(const ros::NodeHandle& nh,
+                                                        const moveit::core::RobotModelConstPtr& model);
+
+  /**
+   * @brief Replaces all configurations by configurations with updated limits.
+   *
+   * Either all configurations are replaced or, if one of them cannot be built, none.
+   * @param reload_limits If true, the parameter namespaces are read again from the parameter server
+   * @param reduction_factor Factor in (0, 1] applied to the velocity and acceleration limits
+   * @throws std::invalid_argument if the reduction factor is out of range
+   * @throws AggregationBoundsViolationException if the joint limits violate the limits of a model
+   */
+  void updateConfigurations(bool reload_limits, double reduction_factor);
+
+  /**
+   * @brief Same as above, but every configuration keeps its current reduction factor.
+   */
+  void updateConfigurations(bool reload_limits);
+
+  /**
+   * @brief Removes all configurations, so that they are rebuilt from the parameter server.
+   */
+  void clear();
+
+private:
+  PlanningConfigurationRegistry() = default;
+
+  static void getParam(const std::string& param_namespace, XmlRpc::XmlRpcValue& param);
+
+  /**
+   * @brief Implements updateConfigurations().
+   * @param reduction_factor The new reduction factor, nullptr keeps the reduction factor of each configuration
+   */
+  void replaceConfigurations(bool reload_limits, const double* reduction_factor);
+
+private:
+  struct Entry
+  {
+    //! The fetched parameter namespace of the limits
+    XmlRpc::XmlRpcValue param;
+    double reduction_factor {1.};
+    SharedPlanningConfigurationPtr configuration;
+  };
+
+  std::mutex mutex_;
+
+  //! Configurations per parameter namespace
+  std::map<std::string, Entry> configurations_;
+};
+
+inline PayloadLimits::PayloadLimits(const LimitsContainer& limits, double payload)
+  : limits(limits)
+  , payload(payload)
+{
+}
+
+inline const moveit::core::RobotModelConstPtr& PlanningConfiguration::getRobotModel() const
+{
+  return model_;
+}
+
+inline double PlanningConfiguration::getReductionFactor() const
+{
+  return reduction_factor_;
+}
+
+inline const LimitsContainer& PlanningConfiguration::getLimits() const
+{
+  return limits_;
+}
+
+inline const std::vector<PayloadProfile>& PlanningConfiguration::getPayloadProfiles() const
+{
+  return payload_profiles_;
+}
+
+inline const PayloadProfile* PlanningConfiguration::getPayloadProfile(double payload) const
+{
+  for(const auto& profile : payload_profiles_)
+  {
+    if(payload <= profile.max_payload)
+    {
+      return &profile;
+    }
+  }
+  return nullptr;
+}
+
+inline PayloadLimits PlanningConfiguration::getPayloadLimits(double payload) const
+{
+  const PayloadProfile* profile {getPayloadProfile(payload)};
+  return PayloadLimits(profile ? profile->limits : limits_, payload);
+}
+
+inline const SamplingTimesContainer& PlanningConfiguration::getSamplingTimes() const
+{
+  return sampling_times_;
+}
+
+inline bool PlanningConfiguration::hasSolverTipFrame(const std::string& group_name) const
+{
+  return solver_tip_frames_.find(group_name) != solver_tip_frames_.end();
+}
+
+inline const std::string& PlanningConfiguration::getSolverTipFrame(const std::string& group_name) const
+{
+  return solver_tip_frames_.at(group_name);
+}
+
+inline SharedPlanningConfiguration::SharedPlanningConfiguration(const PlanningConfigurationConstPtr& configuration)
+  : configuration_(configuration)
+{
+}
+
+inline PlanningConfigurationConstPtr SharedPlanningConfiguration::get() const
+{
+  const PlanningConfigurationConstPtr* scope_configuration {ConfigurationScope::getCurrentConfiguration(*this)};
+  return scope_configuration ? *scope_configuration : std::atomic_load(&configuration_);
+}
+
+inline void SharedPlanningConfiguration::set(const PlanningConfigurationConstPtr& configuration)
+{
+  std::atomic_store(&configuration_, configuration);
+}
+
+inline PayloadScope::PayloadScope(double payload)
+  : payload_(payload)
+  , previous_payload_(currentPayload())
+{
+  currentPayload() = &payload_;
+}
+
+inline PayloadScope::~PayloadScope()
+{
+  currentPayload() = previous_payload_;
+}
+
+inline const double* PayloadScope::getCurrentPayload()
+{
+  return currentPayload();
+}
+
+inline const double*& PayloadScope::currentPayload()
+{
+  static thread_local const double* payload {nullptr};
+  return payload;
+}
+
+inline ConfigurationScope::ConfigurationScope(const SharedPlanningConfiguration& shared,
+                                              const PlanningConfigurationConstPtr& configuration)
+  : shared_(&shared)
+  , configuration_(configuration)
+  , previous_scope_(currentScope())
+{
+  currentScope() = this;
+}
+
+inline ConfigurationScope::~ConfigurationScope()
+{
+  currentScope() = previous_scope_;
+}
+
+inline const PlanningConfigurationConstPtr* ConfigurationScope::getCurrentConfiguration(
+    const SharedPlanningConfiguration& shared)
+{
+  for(const ConfigurationScope* scope = currentScope(); scope; scope = scope->previous_scope_)
+  {
+    if(scope->shared_ == &shared)
+    {
+      return &scope->configuration_;
+    }
+  }
+  return nullptr;
+}
+
+inline const ConfigurationScope*& ConfigurationScope::currentScope()
+{
+  static thread_local const ConfigurationScope* scope {nullptr};
+  return scope;
+}
+
+inline PlanningConfigurationRegistry& PlanningConfigurationRegistry::getInstance()
+{
+  // defined inline, so that the planner and the capabilities share one instance
+  static PlanningConfigurationRegistry registry;
+  return registry;
+}
+
+}
+
+#endif // PLANNING_CONFIGURATION_H
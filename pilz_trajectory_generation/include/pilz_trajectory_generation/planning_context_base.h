@@ -18,7 +18,11 @@
 #ifndef PLANNING_CONTEXT_BASE_H
 #define PLANNING_CONTEXT_BASE_H
 
+#include "pilz_trajectory_generation/cancellation_token.h"
+#include "pilz_trajectory_generation/diagnostics.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
+#include "pilz_trajectory_generation/phase_timings.h"
+#include "pilz_trajectory_generation/sampling_times.h"
 #include "pilz_trajectory_generation/trajectory_generator.h"
 
 #include <ros/ros.h>
@@ -29,6 +33,8 @@
 #include <moveit/robot_state/conversions.h>
 
 #include <atomic>
+#include <limits>
+#include <sstream>
 #include <thread>
 
 namespace pilz {
@@ -44,17 +50,31 @@ public:
   PlanningContextBase<GeneratorT>(const std::string& name,
                      const std::string& group,
                      const moveit::core::RobotModelConstPtr& model,
-                     const pilz::LimitsContainer& limits):
+                     const pilz::LimitsContainer& limits,
+                     const pilz::SamplingTimesContainer& sampling_times = pilz::SamplingTimesContainer(),
+                     double payload = std::numeric_limits<double>::quiet_NaN()):
   planning_interface::PlanningContext(name, group),
   terminated_(false),
   model_(model),
-  limits_(limits),
-  generator_(model, limits_){}
+  limits_(createLimits(limits, payload)),
+  sampling_times_(sampling_times),
+  cancellation_(pilz::CancellationToken::createChild(pilz::CancellationScope::getCurrentToken())),
+  generator_(model, limits_)
+  {
+    generator_.setCancellationToken(cancellation_);
+  }
 
   virtual ~PlanningContextBase() {}
 
   /**
    * @brief Calculates a trajectory for the request this context is currently set for
+   *
+   * The trajectory is generated with the sampling times of the planning group,
+   * overridden by the ones of the active SamplingTimesScope (if any).
+   *
+   * The processing times of the planning phases are added to the timings of the
+   * active PhaseTimingsScope (if any).
+   *
    * @param res The result containing the respective trajectory, or error_code on failure
    * @return true on success, false otherwise
    */
@@ -63,7 +83,10 @@ public:
   /**
    * @brief Will return the same trajectory as solve(planning_interface::MotionPlanResponse& res)
    * This function just delegates to the common response however here the same trajectory is stored with the
-   * descriptions "plan", "simplify", "interpolate"
+   * description "plan" and the overall planning time, followed by one entry per planning phase
+   * (see TrajectoryGenerator::getPhaseTimings()) with the processing time of the phase.
+   * In builds with allocation counters, another entry per phase follows, whose description
+   * contains the allocation counts of the phase (e.g. "plan allocations=12 allocated_bytes=...").
    * @param res The detailed response
    * @return true on success, false otherwise
    */
@@ -71,8 +94,13 @@ public:
 
   /**
    * @brief Will terminate solve()
+   *
+   * A running solve() is stopped at the next sample of the trajectory and
+   * fails with error code PREEMPTED.
+   *
+   * @note The context is also terminated, if the token of the CancellationScope
+   * which was active during the construction of the context is cancelled.
    * @return
-   * @note Currently will not stop a runnning solve but
    */
   virtual bool terminate() override;
 
@@ -81,6 +109,12 @@ public:
    */
   virtual void clear() override;
 
+  /**
+   * @return A copy of the limits with the payload [kg] (NaN if it is unknown) of the configuration
+   * dependent joint limits, see LimitsContainer::setPayload().
+   */
+  static pilz::LimitsContainer createLimits(const pilz::LimitsContainer& limits, double payload);
+
   /// Flag if terminated
   std::atomic_bool terminated_;
 
@@ -90,7 +124,13 @@ public:
   /// Joint limits to be used during planning
   pilz::LimitsContainer limits_;
 
+  /// Sampling times of the planning groups
+  pilz::SamplingTimesContainer sampling_times_;
+
 protected:
+  //! Cancelled by terminate(), shared with the generator.
+  pilz::CancellationToken cancellation_;
+
   GeneratorT generator_;
 
 };
@@ -108,13 +148,18 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
       moveit::core::robotStateToRobotStateMsg(getPlanningScene()->getCurrentState(), currentState);
       request_.start_state = currentState;
     }
-    bool result = generator_.generate(request_, res);
+    const pilz::SamplingTimes sampling_times {sampling_times_.getSamplingTimes(request_.group_name)};
+    bool result = generator_.generate(request_, res, sampling_times.planning, sampling_times.output);
+    if(pilz::PhaseTimings* timings = pilz::PhaseTimingsScope::getCurrentTimings())
+    {
+      timings->add(generator_.getPhaseTimings());
+    }
     return result;
     //res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     //return false; // TODO
   }
 
-  ROS_ERROR("Using solve on a terminated planning context!");
+  PILZ_ERROR_STREAM(pilz::LogSubsystem::Planner, "Using solve on a terminated planning context!");
   res.error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
   return false;
 }
@@ -131,13 +176,28 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
    res.trajectory_.push_back(undetailed_response.trajectory_);
    res.processing_time_.push_back(undetailed_response.planning_time_);
 
-   res.description_.push_back("simplify");
-   res.trajectory_.push_back(undetailed_response.trajectory_);
-   res.processing_time_.push_back(0);
-
-   res.description_.push_back("interpolate");
-   res.trajectory_.push_back(undetailed_response.trajectory_);
-   res.processing_time_.push_back(0);
+   for(const auto& phase : generator_.getPhaseTimings().getEntries())
+   {
+     res.description_.push_back(phase.first);
+     res.trajectory_.push_back(undetailed_response.trajectory_);
+     res.processing_time_.push_back(phase.second);
+   }
+
+#ifdef PILZ_ENABLE_ALLOCATION_COUNTERS
+   // the allocation counts are reported as additional entries, the description contains the counts
+   const pilz::PhaseTimings& timings {generator_.getPhaseTimings()};
+   for(std::size_t i = 0; i < timings.getEntries().size(); ++i)
+   {
+     const pilz::AllocationCounts& counts {timings.getAllocationCounts().at(i)};
+     std::ostringstream description;
+     description << timings.getEntries().at(i).first << " allocations=" << counts.allocations
+                 << " allocated_bytes=" << counts.allocated_bytes << " copies=" << counts.copies
+                 << " copied_bytes=" << counts.copied_bytes;
+     res.description_.push_back(description.str());
+     res.trajectory_.push_back(undetailed_response.trajectory_);
+     res.processing_time_.push_back(timings.getEntries().at(i).second);
+   }
+#endif
 
    res.error_code_ = undetailed_response.error_code_;
    return result;
@@ -147,8 +207,9 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
 template <typename GeneratorT>
 bool pilz::PlanningContextBase<GeneratorT>::terminate()
 {
-  ROS_DEBUG_STREAM("Terminate called");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Planner, "Terminate called");
   terminated_ = true;
+  cancellation_.cancel();
   return true;
 }
 
@@ -160,6 +221,15 @@ void pilz::PlanningContextBase<GeneratorT>::clear()
   return;
 }
 
+template <typename GeneratorT>
+pilz::LimitsContainer pilz::PlanningContextBase<GeneratorT>::createLimits(const pilz::LimitsContainer& limits,
+                                                                        double payload)
+{
+  pilz::LimitsContainer result {limits};
+  result.setPayload(payload);
+  return result;
+}
+
 
 } // namespace
 
@@ -45,8 +45,10 @@ class PlanningContextCIRC : public pilz::PlanningContextBase<TrajectoryGenerator
     PlanningContextCIRC(const std::string& name,
                        const std::string& group,
                        const moveit::core::RobotModelConstPtr& model,
-                       const pilz::LimitsContainer& limits):
-    pilz::PlanningContextBase<TrajectoryGeneratorCIRC>(name, group, model, limits){}
+                       const pilz::LimitsContainer& limits,
+                       const pilz::SamplingTimesContainer& sampling_times = pilz::SamplingTimesContainer(),
+                       double payload = std::numeric_limits<double>::quiet_NaN()):
+    pilz::PlanningContextBase<TrajectoryGeneratorCIRC>(name, group, model, limits, sampling_times, payload){}
 };
 
 } // namespace
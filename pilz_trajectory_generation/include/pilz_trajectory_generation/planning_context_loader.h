@@ -19,6 +19,8 @@
 #define PLANNING_CONTEXT_LOADER_H
 
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/planning_configuration.h"
+#include "pilz_trajectory_generation/sampling_times.h"
 
 #include <memory>
 #include <vector>
@@ -57,6 +59,22 @@ public:
    */
   virtual bool setLimits(const pilz::LimitsContainer& limits);
 
+  /**
+   * @brief Sets the sampling times of the planning groups the planner can pass to the contexts
+   * @param sampling_times sampling times, the default sampling times are used for all other groups
+   * @return true if the sampling times could be set
+   */
+  virtual bool setSamplingTimes(const pilz::SamplingTimesContainer& sampling_times);
+
+  /**
+   * @brief Sets the shared planning configuration. Every context gets the limits and sampling times
+   * of the configuration which is current when the context is loaded, instead of the ones set by
+   * setLimits() and setSamplingTimes().
+   * @param configuration the shared planning configuration
+   * @return true if the configuration could be set
+   */
+  virtual bool setConfiguration(const pilz::SharedPlanningConfigurationPtr& configuration);
+
   /**
    * @brief Return the planning context
    * @param planning_context
@@ -93,6 +111,12 @@ protected:
   /// Limits to be used during planning
   pilz::LimitsContainer limits_;
 
+  /// Sampling times of the planning groups
+  pilz::SamplingTimesContainer sampling_times_;
+
+  /// Shared planning configuration (if set), replaces limits_ and sampling_times_
+  pilz::SharedPlanningConfigurationPtr configuration_;
+
   /// True if model is set
   bool model_set_;
 
@@ -110,13 +134,30 @@ bool PlanningContextLoader::loadContext(planning_interface::PlanningContextPtr&
                                                          const std::string& name,
                                                          const std::string& group) const
 {
-  if(limits_set_ && model_set_) {
-    planning_context.reset(new T(name, group, model_, limits_));
+  if(configuration_ && model_set_) {
+    // the context keeps the current snapshot (of the active pilz::ConfigurationScope, e.g. of a sequence),
+    // even if the configuration is updated while planning
+    const pilz::PlanningConfigurationConstPtr configuration {configuration_->get()};
+    const double* payload {pilz::PayloadScope::getCurrentPayload()};
+    if(payload)
+    {
+      const pilz::PayloadLimits payload_limits {configuration->getPayloadLimits(*payload)};
+      planning_context.reset(new T(name, group, model_, payload_limits.limits, configuration->getSamplingTimes(),
+                                   payload_limits.payload));
+    }
+    else
+    {
+      planning_context.reset(new T(name, group, model_, configuration->getLimits(), configuration->getSamplingTimes()));
+    }
+    return true;
+  }
+  else if(limits_set_ && model_set_) {
+    planning_context.reset(new T(name, group, model_, limits_, sampling_times_));
     return true;
   }
   else
   {
-    if(!limits_set_)
+    if(!limits_set_ && !configuration_)
     {
       ROS_ERROR_STREAM("Limits are not defined. Cannot load planning context. Call setLimits loadContext");
     }
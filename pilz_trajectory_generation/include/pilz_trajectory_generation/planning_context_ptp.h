@@ -44,8 +44,10 @@ class PlanningContextPTP : public pilz::PlanningContextBase<TrajectoryGeneratorP
     PlanningContextPTP(const std::string& name,
                        const std::string& group,
                        const moveit::core::RobotModelConstPtr& model,
-                       const pilz::LimitsContainer& limits):
-    pilz::PlanningContextBase<TrajectoryGeneratorPTP>(name, group, model, limits){}
+                       const pilz::LimitsContainer& limits,
+                       const pilz::SamplingTimesContainer& sampling_times = pilz::SamplingTimesContainer(),
+                       double payload = std::numeric_limits<double>::quiet_NaN()):
+    pilz::PlanningContextBase<TrajectoryGeneratorPTP>(name, group, model, limits, sampling_times, payload){}
 };
 
 } // namespace
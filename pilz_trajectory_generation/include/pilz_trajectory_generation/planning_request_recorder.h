@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANNING_REQUEST_RECORDER_H
+#define PLANNING_REQUEST_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ros/node_handle.h>
+#include <rosbag/bag.h>
+#include <moveit/collision_detection/collision_matrix.h>
+#include <moveit/collision_detection/world.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit_msgs/MotionPlanRequest.h>
+#include <pilz_msgs/MotionSequenceRequest.h>
+#include <pilz_msgs/PlanningRequestRecord.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Records the incoming planning requests together with the planning
+ * scene to a bag file, which can be replayed offline by replay_planning_requests.
+ *
+ * The robot description and the kinematics and limits parameters are
+ * recorded once when the recorder is opened (topic PARAMETERS_TOPIC), the
+ * requests are recorded as pilz_msgs::PlanningRequestRecord (topic REQUEST_TOPIC).
+ *
+ * Only the parts of the planning scene which are needed to replay a request are
+ * recorded: the robot state with the attached bodies, the collision objects,
+ * the allowed collision matrix and the fixed frame transforms (no octomap and no
+ * object colors). The calling thread only copies them, the records are
+ * converted and written to the bag by a background thread.
+ */
+class PlanningRequestRecorder
+{
+public:
+  static const std::string PARAMETERS_TOPIC;
+  static const std::string REQUEST_TOPIC;
+
+  /**
+   * @brief Requests of the command planner are not recorded within the scope
+   * of the calling thread, because they belong to an already recorded sequence.
+   */
+  class SequenceScope
+  {
+  public:
+    SequenceScope();
+    ~SequenceScope();
+
+    SequenceScope(const SequenceScope&) = delete;
+    SequenceScope& operator=(const SequenceScope&) = delete;
+
+    static bool isActive();
+
+  private:
+    static bool& active();
+
+  private:
+    const bool previous_active_;
+  };
+
+public:
+  ~PlanningRequestRecorder();
+
+  PlanningRequestRecorder(const PlanningRequestRecorder&) = delete;
+  PlanningRequestRecorder& operator=(const PlanningRequestRecorder&) = delete;
+
+  static PlanningRequestRecorder& getInstance();
+
+  /**
+   * @brief Opens the specified bag file and records the parameters of the
+   * specified robot model.
+   *
+   * @return False if the file could not be opened or the recorder is already
+   * open with another file.
+   */
+  bool open(const std::string& file_name, const moveit::core::RobotModel& model);
+
+  /**
+   * @brief Opens the recorder with the file given by the parameter
+   * "request_log_file" of the specified node handle, if the parameter is set.
+   */
+  bool openFromParameter(const ros::NodeHandle& nh, const moveit::core::RobotModel& model);
+
+  /**
+   * @brief Writes the pending records and closes the bag file.
+   */
+  void close();
+
+  bool isRecording() const;
+
+  /**
+   * @brief Records the specified sequence request, if the recorder is open.
+   *
+   * @param source One of the interfaces defined in pilz_msgs::PlanningRequestRecord.
+   *
+   * The record is queued for the background thread, it is dropped if too many
+   * records are pending.
+   */
+  void record(const std::string& source, const planning_scene::PlanningSceneConstPtr& scene,
+              const pilz_msgs::MotionSequenceRequest& req);
+
+  /**
+   * @brief Records the specified request as sequence with one item, if the
+   * recorder is open and no SequenceScope is active.
+   */
+  void record(const std::string& source, const planning_scene::PlanningSceneConstPtr& scene,
+              const moveit_msgs::MotionPlanRequest& req);
+
+private:
+  /**
+   * @brief A request together with the copied parts of the planning scene,
+   * which are converted to the record message by the background thread.
+   */
+  struct PendingRecord
+  {
+    PendingRecord(const planning_scene::PlanningScene& scene);
+
+    pilz_msgs::PlanningRequestRecord record;
+    moveit::core::RobotState state;
+    std::vector<collision_detection::World::ObjectConstPtr> objects;
+    collision_detection::AllowedCollisionMatrix acm;
+  };
+
+private:
+  PlanningRequestRecorder() = default;
+
+  //! Writes the queued records until the recorder is closed and the queue is empty.
+  void writeRecords();
+
+  void write(PendingRecord& pending);
+
+private:
+  std::atomic_bool recording_ {false};
+
+  //! Serializes open() and close().
+  std::mutex mutex_;
+  rosbag::Bag bag_;
+  std::string file_name_;
+  std::string robot_model_name_;
+
+  //! Guards the queue and the transition of recording_ to false.
+  std::mutex queue_mutex_;
+  std::condition_variable queue_condition_;
+  std::deque<std::unique_ptr<PendingRecord>> queue_;
+  std::thread writer_;
+};
+
+inline PlanningRequestRecorder& PlanningRequestRecorder::getInstance()
+{
+  // defined inline, so that all libraries of the package share one instance
+  static PlanningRequestRecorder recorder;
+  return recorder;
+}
+
+inline bool PlanningRequestRecorder::isRecording() const
+{
+  return recording_.load(std::memory_order_relaxed);
+}
+
+inline PlanningRequestRecorder::SequenceScope::SequenceScope()
+  : previous_active_(active())
+{
+  active() = true;
+}
+
+inline PlanningRequestRecorder::SequenceScope::~SequenceScope()
+{
+  active() = previous_active_;
+}
+
+inline bool PlanningRequestRecorder::SequenceScope::isActive()
+{
+  return active();
+}
+
+inline bool& PlanningRequestRecorder::SequenceScope::active()
+{
+  static thread_local bool active {false};
+  return active;
+}
+
+}
+
+#endif // PLANNING_REQUEST_RECORDER_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLANNING_STATISTICS_H
+#define PLANNING_STATISTICS_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include <pilz_msgs/PlanningStatistics.h>
+
+#include "pilz_trajectory_generation/phase_timings.h"
+
+namespace pilz_trajectory_generation
+{
+
+/**
+ * @brief Keeps the processing times of the planning phases of the last
+ * requests and computes rolling statistics (mean, percentiles, max) of them.
+ * The mean of the allocation counts of the phases is computed as well.
+ *
+ * If a topic is advertised, the statistics are published (latched) after
+ * each added request.
+ *
+ * The class is thread-safe.
+ */
+class PlanningStatistics
+{
+public:
+  explicit PlanningStatistics(std::size_t window_size = DEFAULT_WINDOW_SIZE);
+
+  /**
+   * @brief Publishes the statistics on the specified topic.
+   */
+  void advertise(ros::NodeHandle& nh, const std::string& topic);
+
+  /**
+   * @brief Adds the phases of one planning request and publishes the
+   * updated statistics.
+   */
+  void addRequest(const pilz::PhaseTimings& timings);
+
+  pilz_msgs::PlanningStatistics getStatistics() const;
+
+  /**
+   * @return The percentile (nearest rank) of the specified samples, or zero
+   * if there are no samples.
+   */
+  static double computePercentile(std::vector<double> samples, double percentile);
+
+private:
+  pilz_msgs::PlanningStatistics computeStatistics() const;
+
+private:
+  //! Processing times and allocation counts of one phase of the last requests
+  struct PhaseWindow
+  {
+    std::string phase;
+    std::deque<double> times;
+    std::deque<pilz::AllocationCounts> counts;
+  };
+
+private:
+  static constexpr std::size_t DEFAULT_WINDOW_SIZE {100};
+
+  const std::size_t window_size_;
+
+  mutable std::mutex mutex_;
+  //! Windows of the phases, in the order of the first appearance of the phases.
+  std::vector<PhaseWindow> windows_;
+  uint64_t request_count_ {0};
+  ros::Time last_request_time_;
+
+  ros::Publisher publisher_;
+};
+
+}
+
+#endif // PLANNING_STATISTICS_H
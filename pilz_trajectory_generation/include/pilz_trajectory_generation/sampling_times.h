@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLING_TIMES_H
+#define SAMPLING_TIMES_H
+
+#include <map>
+#include <string>
+
+namespace pilz
+{
+
+/**
+ * @brief Sampling times of a generated trajectory.
+ *
+ * The trajectory is planned with the planning sampling time, i.e. LIN and CIRC
+ * solve the IK at this rate. If an output sampling time is set (e.g. the rate of the
+ * controller), the trajectory handed over to MoveIt is sampled with it: PTP samples
+ * its analytic joint profile, LIN and CIRC interpolate between the planned samples
+ * without solving further IK.
+ */
+struct SamplingTimes
+{
+  static constexpr double DEFAULT_SAMPLING_TIME {0.1};
+
+  //! Sampling time of the planning [s]
+  double planning {DEFAULT_SAMPLING_TIME};
+  //! Sampling time of the output [s], zero to output the planned samples
+  double output {0.};
+};
+
+/**
+ * @brief Sampling times of the planning groups.
+ *
+ * Groups without configured sampling times use the default SamplingTimes.
+ * The sampling times of an active SamplingTimesScope override the ones of the groups.
+ */
+class SamplingTimesContainer
+{
+public:
+  void setSamplingTimes(const std::string& group_name, const SamplingTimes& sampling_times);
+
+  bool hasSamplingTimes(const std::string& group_name) const;
+
+  /**
+   * @return The sampling times of the group, overridden by the non-zero sampling times
+   * of the active SamplingTimesScope (if any).
+   */
+  SamplingTimes getSamplingTimes(const std::string& group_name) const;
+
+private:
+  std::map<std::string, SamplingTimes> group_sampling_times_;
+};
+
+/**
+ * @brief Overrides the sampling times of all planning groups for the calling
+ * thread while the scope is active (e.g. by the sampling times of a sequence request).
+ *
+ * A sampling time of zero does not override the one of the group.
+ */
+class SamplingTimesScope
+{
+public:
+  SamplingTimesScope(double planning_sampling_time, double output_sampling_time);
+  ~SamplingTimesScope();
+
+  SamplingTimesScope(const SamplingTimesScope&) = delete;
+  SamplingTimesScope& operator=(const SamplingTimesScope&) = delete;
+
+  /**
+   * @return The sampling times of the innermost active scope of the calling thread,
+   * or nullptr if there is no active scope.
+   */
+  static const SamplingTimes* getCurrentSamplingTimes();
+
+private:
+  static const SamplingTimes*& currentSamplingTimes();
+
+private:
+  SamplingTimes sampling_times_;
+  const SamplingTimes* previous_sampling_times_;
+};
+
+inline void SamplingTimesContainer::setSamplingTimes(const std::string& group_name,
+                                                     const SamplingTimes& sampling_times)
+{
+  group_sampling_times_[group_name] = sampling_times;
+}
+
+inline bool SamplingTimesContainer::hasSamplingTimes(const std::string& group_name) const
+{
+  return group_sampling_times_.find(group_name) != group_sampling_times_.end();
+}
+
+inline SamplingTimes SamplingTimesContainer::getSamplingTimes(const std::string& group_name) const
+{
+  auto it = group_sampling_times_.find(group_name);
+  SamplingTimes sampling_times {it == group_sampling_times_.end() ? SamplingTimes() : it->second};
+
+  if(const SamplingTimes* overrides = SamplingTimesScope::getCurrentSamplingTimes())
+  {
+    if(overrides->planning != 0.)
+    {
+      sampling_times.planning = overrides->planning;
+    }
+    if(overrides->output != 0.)
+    {
+      sampling_times.output = overrides->output;
+    }
+  }
+  return sampling_times;
+}
+
+inline SamplingTimesScope::SamplingTimesScope(double planning_sampling_time, double output_sampling_time)
+  : previous_sampling_times_(currentSamplingTimes())
+{
+  sampling_times_.planning = planning_sampling_time;
+  sampling_times_.output = output_sampling_time;
+  currentSamplingTimes() = &sampling_times_;
+}
+
+inline SamplingTimesScope::~SamplingTimesScope()
+{
+  currentSamplingTimes() = previous_sampling_times_;
+}
+
+inline const SamplingTimes* SamplingTimesScope::getCurrentSamplingTimes()
+{
+  return currentSamplingTimes();
+}
+
+inline const SamplingTimes*& SamplingTimesScope::currentSamplingTimes()
+{
+  static thread_local const SamplingTimes* sampling_times {nullptr};
+  return sampling_times;
+}
+
+}
+
+#endif // SAMPLING_TIMES_H
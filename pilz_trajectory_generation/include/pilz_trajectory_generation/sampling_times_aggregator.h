@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLING_TIMES_AGGREGATOR_H
+#define SAMPLING_TIMES_AGGREGATOR_H
+
+#include <ros/node_handle.h>
+
+#include "pilz_trajectory_generation/sampling_times.h"
+
+namespace pilz {
+
+/**
+ * @brief Obtains the sampling times of the planning groups from the parameter server
+ */
+class SamplingTimesAggregator
+{
+  public:
+
+   /**
+     * @brief Loads the sampling times from the parameter server
+     *
+     * The parameters are expected to be under "~/sampling_times/<group_name>" of the given
+     * node handle. The following sampling times can be specified per group:
+     * - "sampling_time", the sampling time of the planning [s]
+     * - "output_sampling_time", the sampling time of the output, e.g. the controller rate [s]
+     *
+     * The values are validated when a trajectory is generated.
+     * @param nh node handle to access the parameters
+     * @return the obtained sampling times
+     */
+    static SamplingTimesContainer getAggregatedSamplingTimes(const ros::NodeHandle& nh);
+
+   /**
+     * @brief Same as getAggregatedSamplingTimes(nh), but reads the sampling times from the already
+     * fetched parameter namespace, see PlanningConfigurationRegistry.
+     * @param param the parameter namespace (a struct) which contains "sampling_times"
+     * @return the obtained sampling times
+     */
+    static SamplingTimesContainer getAggregatedSamplingTimes(XmlRpc::XmlRpcValue& param);
+
+  private:
+    /**
+     * @brief Reads the sampling times from the parameter "sampling_times".
+     */
+    static SamplingTimesContainer getSamplingTimes(XmlRpc::XmlRpcValue& sampling_times_param);
+};
+
+}
+
+#endif // SAMPLING_TIMES_AGGREGATOR_H
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIP_FRAME_POSE_CACHE_H
+#define TIP_FRAME_POSE_CACHE_H
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Stores the pose of one frame (usually the solver tip frame) for every
+ * waypoint of a planned trajectory in one contiguous array.
+ *
+ * Blending and the blend radius checks repeatedly need the tip frame pose of
+ * the same waypoints. Computing them once per trajectory avoids repeated
+ * forward kinematics and transform lookups on the individual RobotStates.
+ *
+ * The cache does not keep a reference to the trajectory it was created from.
+ * It is the responsibility of the owner to keep both in sync.
+ */
+class TipFramePoseCache
+{
+public:
+  using PoseCont = std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d> >;
+
+public:
+  /**
+   * @brief Computes the pose of the specified frame for all waypoints of the
+   * specified trajectory.
+   */
+  TipFramePoseCache(const robot_trajectory::RobotTrajectory& traj, const std::string& frame_name);
+
+  /**
+   * @brief Creates a cache containing the poses [first, size()) of the
+   * specified cache.
+   *
+   * Use this if only the tail of a trajectory is kept (e.g. after blending).
+   */
+  TipFramePoseCache(const TipFramePoseCache& other, std::size_t first);
+
+public:
+  const std::string& getFrameName() const;
+
+  std::size_t size() const;
+
+  bool empty() const;
+
+  const Eigen::Isometry3d& getPose(std::size_t index) const;
+
+  const Eigen::Isometry3d& getLastPose() const;
+
+  /**
+   * @return Translational part of the pose stored at the given index.
+   */
+  Eigen::Vector3d getPosition(std::size_t index) const;
+
+private:
+  //! Name of the frame the poses belong to.
+  std::string frame_name_;
+
+  //! Poses of the frame in model frame, one for each waypoint.
+  PoseCont poses_;
+};
+
+typedef std::shared_ptr<const TipFramePoseCache> TipFramePoseCacheConstPtr;
+
+inline const std::string& TipFramePoseCache::getFrameName() const
+{
+  return frame_name_;
+}
+
+inline std::size_t TipFramePoseCache::size() const
+{
+  return poses_.size();
+}
+
+inline bool TipFramePoseCache::empty() const
+{
+  return poses_.empty();
+}
+
+inline const Eigen::Isometry3d& TipFramePoseCache::getPose(std::size_t index) const
+{
+  assert(index < poses_.size());
+  return poses_[index];
+}
+
+inline const Eigen::Isometry3d& TipFramePoseCache::getLastPose() const
+{
+  assert(!poses_.empty());
+  return poses_.back();
+}
+
+inline Eigen::Vector3d TipFramePoseCache::getPosition(std::size_t index) const
+{
+  return getPose(index).translation();
+}
+
+}
+
+#endif // TIP_FRAME_POSE_CACHE_H
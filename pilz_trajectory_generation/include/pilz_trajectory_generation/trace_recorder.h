@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ros/node_handle.h>
+
+namespace pilz
+{
+
+/**
+ * @brief Records nested spans (name, start, duration, thread) of the planning
+ * and writes them as Chrome trace JSON, which can be viewed with
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Spans are only recorded between open() and close(). The spans are kept in
+ * memory and written to the file when the recorder is closed, at the latest
+ * when the process exits.
+ *
+ * The spans are added by the PILZ_TRACE_SCOPE macro, which only records
+ * something if the package is built with -DCATKIN_ENABLE_TRACING=ON.
+ */
+class TraceRecorder
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  //! Maximal number of recorded spans, further spans are dropped.
+  static constexpr std::size_t MAX_SPAN_COUNT {1000000};
+
+public:
+  ~TraceRecorder();
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  static TraceRecorder& getInstance();
+
+  /**
+   * @brief Starts the recording of spans, which are written to the specified
+   * file on close().
+   *
+   * @return False if the recorder is already open with another file.
+   */
+  bool open(const std::string& file_name);
+
+  /**
+   * @brief Opens the recorder with the file given by the parameter "trace_file"
+   * of the specified node handle, if the parameter is set.
+   */
+  bool openFromParameter(const ros::NodeHandle& nh);
+
+  /**
+   * @brief Stops the recording and writes the recorded spans to the file.
+   */
+  void close();
+
+  bool isRecording() const;
+
+  void addSpan(const std::string& name, const char* category,
+               const Clock::time_point& start, const Clock::time_point& end);
+
+  /**
+   * @brief Writes the spans recorded so far as Chrome trace JSON.
+   */
+  void write(std::ostream& os) const;
+
+  //! Removes all recorded spans.
+  void clear();
+
+private:
+  TraceRecorder() = default;
+
+  bool writeFile() const;
+
+private:
+  struct Span
+  {
+    std::string name;
+    const char* category;
+    Clock::time_point start;
+    Clock::duration duration;
+    std::thread::id thread_id;
+  };
+
+  std::atomic_bool recording_ {false};
+
+  mutable std::mutex mutex_;
+  std::string file_name_;
+  std::vector<Span> spans_;
+  std::size_t dropped_span_count_ {0};
+  Clock::time_point origin_ {Clock::now()};
+};
+
+/**
+ * @brief Adds a span from construction to destruction to the TraceRecorder.
+ *
+ * Nothing is recorded if the recorder is not recording at construction.
+ */
+class TraceSpan
+{
+public:
+  TraceSpan(const char* category, std::string name);
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+  const bool recording_;
+  const char* category_;
+  std::string name_;
+  TraceRecorder::Clock::time_point start_;
+};
+
+inline TraceRecorder& TraceRecorder::getInstance()
+{
+  // defined inline, so that all libraries of the package share one instance
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+inline bool TraceRecorder::isRecording() const
+{
+  return recording_.load(std::memory_order_relaxed);
+}
+
+inline TraceSpan::TraceSpan(const char* category, std::string name)
+  : recording_(TraceRecorder::getInstance().isRecording())
+  , category_(category)
+  , name_(recording_ ? std::move(name) : std::string())
+  , start_(recording_ ? TraceRecorder::Clock::now() : TraceRecorder::Clock::time_point())
+{
+}
+
+inline TraceSpan::~TraceSpan()
+{
+  if(recording_)
+  {
+    TraceRecorder::getInstance().addSpan(name_, category_, start_, TraceRecorder::Clock::now());
+  }
+}
+
+}
+
+#define PILZ_TRACE_CONCAT_IMPL(a, b) a##b
+#define PILZ_TRACE_CONCAT(a, b) PILZ_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Records a span with the specified category and name for the rest
+ * of the enclosing scope. Without PILZ_ENABLE_TRACING, the macro and its
+ * arguments are compiled out.
+ */
+#ifdef PILZ_ENABLE_TRACING
+#define PILZ_TRACE_SCOPE(category, name) \
+  ::pilz::TraceSpan PILZ_TRACE_CONCAT(pilz_trace_span_, __LINE__)(category, name)
+#else
+#define PILZ_TRACE_SCOPE(category, name) static_cast<void>(0)
+#endif
+
+#endif // TRACE_RECORDER_H
@@ -22,6 +22,9 @@
 
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
+#include "pilz_trajectory_generation/cancellation_token.h"
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
+
 namespace pilz
 {
 
@@ -37,8 +40,16 @@ struct TrajectoryBlendRequest
   robot_trajectory::RobotTrajectoryPtr first_trajectory;
   robot_trajectory::RobotTrajectoryPtr second_trajectory;
 
+  // Optional poses of the link for every waypoint of the trajectories to be blended.
+  // If not set, the blender computes them itself.
+  TipFramePoseCacheConstPtr first_trajectory_poses;
+  TipFramePoseCacheConstPtr second_trajectory_poses;
+
   // Blend radius in meter
   double blend_radius;
+
+  // Optional token to cancel the blending, e.g. if the sequence is preempted
+  CancellationToken cancellation;
 };
 
 
@@ -22,6 +22,8 @@
 
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
+
 namespace pilz
 {
 
@@ -35,6 +37,9 @@ struct TrajectoryBlendResponse
   robot_trajectory::RobotTrajectoryPtr blend_trajectory;
   robot_trajectory::RobotTrajectoryPtr second_trajectory;
 
+  // Poses of the link for every waypoint of the second trajectory after blending
+  TipFramePoseCacheConstPtr second_trajectory_poses;
+
   // Error code
   moveit_msgs::MoveItErrorCodes error_code;
 };
@@ -23,6 +23,7 @@
 #include "pilz_trajectory_generation/trajectory_blend_request.h"
 #include "pilz_trajectory_generation/cartesian_trajectory.h"
 #include "pilz_trajectory_generation/cartesian_trajectory_point.h"
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
 
 namespace pilz {
 
@@ -43,8 +44,9 @@ public:
 
 
   /**
-   * @brief Blend two trajectories using transition window. The trajectories have to be equally and uniformly
-   * discretized.
+   * @brief Blend two trajectories using transition window. The blending is done in time, so the trajectories
+   * do not need to be uniformly discretized. The time from start of both trajectories has to be strictly
+   * increasing.
    * @param req: following fields need to be filled for a valid request:
    *    - group_name : name of the planning group
    *    - link_name : name of the target link
@@ -71,20 +73,22 @@ private:
   /**
    * @brief validate trajectory blend request
    * @param req
-   * @param sampling_time: get the same sampling time of the two input trajectories
    * @param error_code
    * @return
    */
   bool validateRequest(const pilz::TrajectoryBlendRequest& req,
-                       double &sampling_time,
                        moveit_msgs::MoveItErrorCodes& error_code) const;
   /**
    * @brief searchBlendPoint
-   * @param req: trajectory blend request
+   * @param first_poses: poses of the target link along the first trajectory
+   * @param second_poses: poses of the target link along the second trajectory
+   * @param blend_radius: radius of the blend sphere
    * @param first_interse_index: index of the first point of the first trajectory that is inside the blend sphere
    * @param second_interse_index: index of the last point of the second trajectory that is still inside the blend sphere
    */
-  bool searchIntersectionPoints(const pilz::TrajectoryBlendRequest& req,
+  bool searchIntersectionPoints(const pilz::TipFramePoseCache& first_poses,
+                                const pilz::TipFramePoseCache& second_poses,
+                                const double blend_radius,
                                 std::size_t& first_interse_index,
                                 std::size_t& second_interse_index) const;
 
@@ -107,35 +111,72 @@ private:
    *    blend phase:               |----------------------------------|
    *    </pre>
    *
-   * @param req: trajectory blend request
+   * @param first_times: time from start of the waypoints of the first trajectory
+   * @param second_times: time from start of the waypoints of the second trajectory
    * @param first_interse_index: index of the intersection point between first trajectory and blend sphere
    * @param second_interse_index: index of the intersection point between second trajectory and blend sphere
-   * @param blend_align_index: index on the first trajectory, to which the first point on the second trajectory should
-   * be aligned to for motion blend. It is now always same as first_interse_index
-   * @param blend_time: time of the motion blend period
+   * @param second_start_time: time on the first trajectory, to which the first point on the second trajectory
+   * is aligned to for motion blend
    */
-  void determineTrajectoryAlignment(const pilz::TrajectoryBlendRequest& req,
+  void determineTrajectoryAlignment(const std::vector<double>& first_times,
+                                    const std::vector<double>& second_times,
                                     std::size_t first_interse_index,
                                     std::size_t second_interse_index,
-                                    std::size_t& blend_align_index) const;
+                                    double& second_start_time) const;
 
   /**
    * @brief blend two trajectories in Cartesian space, result in a MultiDOFJointTrajectory which consists
    * of a list of transforms for the blend phase.
+   *
+   * The poses of both trajectories are interpolated at the sample times of the blend phase.
+   * The blend phase is sampled with the smallest waypoint interval of both trajectories inside the blend sphere.
    * @param req
+   * @param first_poses: poses of the target link along the first trajectory
+   * @param second_poses: poses of the target link along the second trajectory
+   * @param first_times: time from start of the waypoints of the first trajectory
+   * @param second_times: time from start of the waypoints of the second trajectory
    * @param first_interse_index
    * @param second_interse_index
-   * @param blend_begin_index
-   * @param sampling_time
+   * @param second_start_time: see determineTrajectoryAlignment()
    * @param trajectory: the resulting blend trajectory inside the blending sphere
    */
   void blendTrajectoryCartesian(const pilz::TrajectoryBlendRequest& req,
+                                const pilz::TipFramePoseCache& first_poses,
+                                const pilz::TipFramePoseCache& second_poses,
+                                const std::vector<double>& first_times,
+                                const std::vector<double>& second_times,
                                 const std::size_t first_interse_index,
                                 const std::size_t second_interse_index,
-                                const std::size_t blend_align_index,
-                                double sampling_time,
+                                const double second_start_time,
                                 pilz::CartesianTrajectory &trajectory) const;
 
+  /**
+   * @return The given poses if they belong to the specified trajectory and link,
+   * otherwise newly computed poses.
+   */
+  static pilz::TipFramePoseCacheConstPtr getPoses(const robot_trajectory::RobotTrajectoryPtr& traj,
+                                                  const pilz::TipFramePoseCacheConstPtr& poses,
+                                                  const std::string& link_name);
+
+  /**
+   * @return Time from start of every waypoint relative to the first waypoint of the trajectory.
+   */
+  static std::vector<double> getTimesFromStart(const robot_trajectory::RobotTrajectory& traj);
+
+  /**
+   * @return True if the duration of every waypoint (except the first one) is positive, otherwise false.
+   */
+  static bool hasStrictlyIncreasingTime(const robot_trajectory::RobotTrajectory& traj);
+
+  /**
+   * @brief Interpolates the pose at the specified time (linear for the position, slerp for the orientation).
+   *
+   * Times before the first or after the last waypoint result in the first or last pose, respectively.
+   */
+  static Eigen::Isometry3d interpolatePose(const pilz::TipFramePoseCache& poses,
+                                           const std::vector<double>& times,
+                                           double time);
+
 private: // static members
   // Constant to check for equality of values.
   static constexpr double epsilon = 1e-4;
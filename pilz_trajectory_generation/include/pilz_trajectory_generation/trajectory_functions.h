@@ -18,6 +18,8 @@
 #ifndef TRAJECTORY_FUNCTIONS_H
 #define TRAJECTORY_FUNCTIONS_H
 
+#include <limits>
+
 #include <Eigen/Geometry>
 #include <kdl/trajectory.hpp>
 #include <moveit/robot_model/robot_model.h>
@@ -26,14 +28,25 @@
 #include <eigen_conversions/eigen_msg.h>
 #include <trajectory_msgs/MultiDOFJointTrajectory.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit_msgs/RobotState.h>
 #include <tf/transform_datatypes.h>
 
+#include "pilz_trajectory_generation/cancellation_token.h"
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/phase_timings.h"
 #include "pilz_trajectory_generation/cartesian_trajectory.h"
+#include "pilz_trajectory_generation/compact_trajectory.h"
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
+#include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
 
 
 namespace pilz {
 
+using pilz_trajectory_generation::TemplatedMoveItErrorCodeException;
+
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(UnknownSpeedLimitFrame, moveit_msgs::MoveItErrorCodes::FAILURE);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(FrameSpeedLimitViolated, moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
+
 /**
  * @brief compute the inverse kinematics of a given pose, also check robot self collision
  * @param robot_model: kinematic model of the robot
@@ -67,6 +80,31 @@ bool computePoseIK(const robot_model::RobotModelConstPtr& robot_model,
                    bool check_self_collision = true,
                    const double timeout = 0.1);
 
+/**
+ * @brief compute all inverse kinematics solutions of a given pose the IK solver of the group provides
+ * (e.g. the branches of an analytic solver), also check robot self collision
+ *
+ * Only a solver with the link as single tip frame is asked. Solutions violating the joint bounds
+ * or in self collision are dropped.
+ * @param robot_model: kinematic model of the robot
+ * @param group_name: name of planning group
+ * @param link_name: name of target link
+ * @param pose: target pose in IK solver Frame
+ * @param frame_id: reference frame of the target pose
+ * @param seed: seed state of IK solver, also defines the pose of the solver base
+ * @param solutions: solutions of IK, in the order of the solver
+ * @param check_self_collision: true to enable self collision checking after IK computation
+ * @return true if at least one solution was found
+ */
+bool computePoseIKSolutions(const robot_model::RobotModelConstPtr& robot_model,
+                            const std::string& group_name,
+                            const std::string& link_name,
+                            const Eigen::Isometry3d& pose,
+                            const std::string& frame_id,
+                            const std::map<std::string, double>& seed,
+                            std::vector<std::map<std::string, double> >& solutions,
+                            bool check_self_collision = true);
+
 /**
  * @brief compute the pose of a link at give robot state
  * @param robot_model: kinematic model of the robot
@@ -105,9 +143,171 @@ bool verifySampleJointLimits(const std::map<std::string, double>& position_last,
                              double duration_current,
                              const JointLimitsContainer &joint_limits);
 
+/**
+ * @brief Same as above, but for the joints of a compiled limits table. All arrays contain one
+ * value per joint of the table (in the order of the table). Configuration dependent limits
+ * of the table are evaluated at the current position.
+ * @param position_last: position of last sample
+ * @param velocity_last: velocity of last sample
+ * @param position_current: position of current sample
+ * @param duration_last: duration of last sample
+ * @param duration_current: duration of current sample
+ * @param joint_limits: compiled joint limits
+ * @param velocity_current: output, velocity of current sample
+ * @param acceleration_current: output, acceleration of current sample
+ * @return true if no limit is violated
+ */
+bool verifySampleJointLimits(const double* position_last,
+                             const double* velocity_last,
+                             const double* position_current,
+                             double duration_last,
+                             double duration_current,
+                             const JointLimitsTable &joint_limits,
+                             double* velocity_current,
+                             double* acceleration_current);
+
+/**
+ * @brief Verifies the positions, velocities and accelerations of all waypoints of a complete
+ * trajectory, e.g. after blending or after a transformation of the trajectory.
+ *
+ * In contrast to verifySampleJointLimits() the stored velocities and accelerations are checked,
+ * see JointLimitsTable::findTrajectoryViolation(). The first violation is logged.
+ * @param trajectory: trajectory to verify
+ * @param joint_limits: compiled joint limits of the joints of the trajectory (in the same order)
+ * @param violation: optional output, the first violation
+ * @return true if no limit is violated
+ */
+bool verifyTrajectoryLimits(const pilz::CompactTrajectory& trajectory,
+                            const JointLimitsTable& joint_limits,
+                            TrajectoryLimitViolation* violation = nullptr);
+
+/**
+ * @brief Applies a speed override to a planned trajectory (e.g. a blended sequence) without planning it again.
+ *
+ * The trajectory is stretched uniformly in time: the durations are divided by the speed override,
+ * the velocities are multiplied by it and the accelerations by its square (see CompactTrajectory::scaleTime()),
+ * so that the path is kept. The effort is linear in the number of waypoints.
+ * The slowed down trajectory is verified against the joint limits, see verifyTrajectoryLimits().
+ * @param trajectory: the planned trajectory
+ * @param speed_override: factor in (0, 1] of the speed of the planned trajectory
+ * @param joint_limits: compiled joint limits of the variables of the trajectory
+ * (see CompactTrajectory::getVariableNames())
+ * @param scaled_trajectory: output, the slowed down trajectory, must not be the planned trajectory
+ * @return true if the slowed down trajectory does not violate the joint limits
+ */
+bool applySpeedOverride(const robot_trajectory::RobotTrajectory& trajectory,
+                        double speed_override,
+                        const JointLimitsTable& joint_limits,
+                        robot_trajectory::RobotTrajectory& scaled_trajectory);
+
+/**
+ * @brief Maximal Cartesian speed of a set of frames along a trajectory, see computeMaxFrameSpeed().
+ */
+struct FrameSpeed
+{
+  //! The maximal speed [m/s].
+  double speed {0.};
+  //! Index of the waypoint at the end of the sampling interval with the maximal speed.
+  std::size_t waypoint {0};
+  //! Index of the frame with the maximal speed.
+  std::size_t frame {0};
+};
+
+/**
+ * @brief Computes the maximal Cartesian speed of the specified links along a trajectory.
+ *
+ * The positions of all links are computed with one forward kinematics update per waypoint.
+ * The speed of a link in a sampling interval is the distance between its positions at the
+ * waypoints of the interval divided by the duration of the interval. On a curved path this chord
+ * underestimates the travelled distance: by the factor sin(a/2)/(a/2), if the link turns by the
+ * angle a within the interval.
+ * @param reference_state: state providing the positions of the joints not contained in the trajectory
+ * @param trajectory: the trajectory
+ * @param links: the links whose speed is computed
+ * @return The maximal speed, zero if the trajectory has less than two waypoints
+ */
+FrameSpeed computeMaxFrameSpeed(const robot_state::RobotState& reference_state,
+                                const pilz::CompactTrajectory& trajectory,
+                                const std::vector<const moveit::core::LinkModel*>& links);
+
+/**
+ * @brief Enforces the speed limit of the frames of the cartesian limit (if set), see
+ * CartesianLimit::getSpeedLimitFrames().
+ *
+ * If a frame exceeds the speed limit, the trajectory is slowed down uniformly (see
+ * CompactTrajectory::scaleTime()) and resampled with the sampling time (if not zero),
+ * provided that scaling is enabled by CartesianLimit::getScaleToMaxFrameSpeed().
+ * A slower trajectory does not violate the joint limits.
+ * @param reference_state: state providing the positions of the joints not contained in the trajectory
+ * @param cartesian_limit: the cartesian limit with the speed limit of the frames
+ * @param sampling_time: sampling time restored after slowing down, zero to keep the waypoints
+ * @param trajectory: the trajectory, slowed down if necessary
+ * @return true if the trajectory was slowed down
+ * @throws UnknownSpeedLimitFrame if a frame is not a link of the robot model
+ * @throws FrameSpeedLimitViolated if a frame exceeds the speed limit and scaling is disabled
+ * or does not succeed
+ */
+bool enforceFrameSpeedLimit(const robot_state::RobotState& reference_state,
+                            const pilz::CartesianLimit& cartesian_limit,
+                            double sampling_time,
+                            pilz::CompactTrajectory& trajectory);
+
+/**
+ * @brief Result of scanCartesianPath().
+ */
+struct PathScanResult
+{
+  enum class Status
+  {
+    Feasible,
+    Unreachable,
+    Singular
+  };
+
+  Status status {Status::Feasible};
+  //! Fraction [0, 1] of the path length at the failing sample (only set if the scan failed).
+  double path_fraction {0.};
+  //! The minimal manipulability of the scanned samples (up to the failing sample).
+  double min_manipulability {std::numeric_limits<double>::infinity()};
+};
+
+/**
+ * @brief Scans a Cartesian path at a few equidistant samples, e.g. before it is sampled with the
+ * sampling time, so that unreachable and singular paths fail without solving the inverse kinematics
+ * of all samples.
+ *
+ * The inverse kinematics of each sample is seeded with the solution of the previous sample, like the
+ * sampling of generateJointTrajectory(). The manipulability of a sample is the Yoshikawa measure of the
+ * Jacobian of the link, i.e. the product of its singular values. The scan stops at the first sample
+ * without inverse kinematics solution or with a manipulability below the minimum.
+ * @param robot_model: robot kinematics model
+ * @param group_name: name of the planning group
+ * @param link_name: name of the target robot link
+ * @param path: Cartesian path of the link in the model frame
+ * @param initial_joint_position: joint positions at the start of the path
+ * @param sample_count: number of samples after the start of the path, the last one is the end of the path
+ * @param min_manipulability: minimal manipulability of the samples, 0 to check the reachability only
+ * @param result: output, the result of the scan
+ * @return true if all samples are reachable and not singular
+ */
+bool scanCartesianPath(const robot_model::RobotModelConstPtr& robot_model,
+                       const std::string& group_name,
+                       const std::string& link_name,
+                       const KDL::Path& path,
+                       const std::map<std::string, double>& initial_joint_position,
+                       std::size_t sample_count,
+                       double min_manipulability,
+                       PathScanResult& result);
+
 
 /**
  * @brief Generate joint trajectory from a KDL Cartesian trajectory
+ *
+ * The joint positions of the samples are the inverse kinematics solutions of the Cartesian poses.
+ * The joint velocities and accelerations are computed from the twist and the acceleration of the
+ * Cartesian trajectory by the Jacobian of the link, so that the limits are verified with the exact
+ * values at every sample. Groups with more than six variables and singular samples fall back to
+ * finite differences of the inverse kinematics solutions.
  * @param robot_model: robot kinematics model
  * @param joint_limits: joint limits
  * @param trajectory: KDL Cartesian trajectory
@@ -132,6 +332,28 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
                              moveit_msgs::MoveItErrorCodes& error_code,
                              bool check_self_collision = false);
 
+/**
+ * @brief Same as above but the joint trajectory is returned as CompactTrajectory.
+ *
+ * The cancellation token is checked once per sample. If it is cancelled, the
+ * function returns false with error code PREEMPTED.
+ *
+ * If timings are given, the processing times of the phases "ik", "limit_check"
+ * and "waypoints" are added to them.
+ */
+bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
+                             const JointLimitsContainer& joint_limits,
+                             const KDL::Trajectory& trajectory,
+                             const std::string& group_name,
+                             const std::string& link_name,
+                             const std::map<std::string, double>& initial_joint_position,
+                             const double& sampling_time,
+                             pilz::CompactTrajectory& joint_trajectory,
+                             moveit_msgs::MoveItErrorCodes& error_code,
+                             bool check_self_collision = false,
+                             const pilz::CancellationToken& cancellation = pilz::CancellationToken(),
+                             pilz::PhaseTimings* timings = nullptr);
+
 /**
  * @brief Generate joint trajectory from a MultiDOFJointTrajectory
  * @param trajectory: Cartesian trajectory
@@ -152,6 +374,40 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
                              moveit_msgs::MoveItErrorCodes& error_code,
                              bool check_self_collision = false);
 
+/**
+ * @brief Same as above but the joint trajectory is returned as CompactTrajectory.
+ *
+ * The cancellation token and the timings are handled as above.
+ */
+bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
+                             const JointLimitsContainer& joint_limits,
+                             const pilz::CartesianTrajectory& trajectory,
+                             const std::string& group_name,
+                             const std::string& link_name,
+                             const std::map<std::string, double>& initial_joint_position,
+                             const std::map<std::string, double>& initial_joint_velocity,
+                             pilz::CompactTrajectory& joint_trajectory,
+                             moveit_msgs::MoveItErrorCodes& error_code,
+                             bool check_self_collision = false,
+                             const pilz::CancellationToken& cancellation = pilz::CancellationToken(),
+                             pilz::PhaseTimings* timings = nullptr);
+
+
+/**
+ * @brief Resamples the joint trajectory with the specified sampling time.
+ *
+ * Between the waypoints the positions are interpolated by cubic Hermite splines,
+ * whose velocities at the waypoints are the velocities of the waypoints (e.g. the exact
+ * joint velocities computed by generateJointTrajectory()). The velocities and
+ * accelerations of the samples are the derivatives of the splines.
+ * The first and the last waypoint are kept, so the last sampling interval can be shorter.
+ * @param trajectory: trajectory to resample
+ * @param sampling_time: sampling time of the resampled trajectory (> 0)
+ * @param resampled_trajectory: the resampled trajectory
+ */
+void resampleJointTrajectory(const pilz::CompactTrajectory& trajectory,
+                             double sampling_time,
+                             pilz::CompactTrajectory& resampled_trajectory);
 
 /**
  * @brief Determines the sampling time and checks that both trajectroies use the
@@ -206,6 +462,16 @@ bool linearSearchIntersectionPoint(const std::string &link_name,
                                    bool inverseOrder,
                                    std::size_t &index);
 
+/**
+ * @brief Same as above but operates on the precomputed poses of the trajectory.
+ * @param poses Poses of the link for every waypoint of the trajectory.
+ */
+bool linearSearchIntersectionPoint(const TipFramePoseCache &poses,
+                                   const Eigen::Vector3d &center_position,
+                                   const double &r,
+                                   bool inverseOrder,
+                                   std::size_t &index);
+
 
 bool intersectionFound(const Eigen::Vector3d &p_center,
                        const Eigen::Vector3d &p_current,
@@ -226,6 +492,18 @@ bool isStateColliding(const bool test_for_self_collision,
                       robot_state::RobotState* state,
                       const robot_state::JointModelGroup * const group,
                       const double * const ik_solution);
+
+/**
+ * @brief Determines the payload of the robot from the weights of the objects attached in the start state.
+ *
+ * If the start state is a diff (or contains no joint state), the objects attached in the current state
+ * which are not mentioned in the start state are attached as well; their weight is unknown.
+ * @param start_state The start state of the request.
+ * @param current_state The current state of the planning scene, may be nullptr.
+ * @return The payload [kg], 0 without attached objects, NaN if the weight of an attached object is unknown.
+ */
+double getAttachedPayload(const moveit_msgs::RobotState& start_state,
+                          const moveit::core::RobotState* current_state);
 }
 
 void normalizeQuaternion(geometry_msgs::Quaternion & quat);
@@ -28,7 +28,11 @@
 #include <kdl/trajectory.hpp>
 
 #include "pilz_extensions/joint_limits_extension.h"
+#include "pilz_trajectory_generation/cancellation_token.h"
+#include "pilz_trajectory_generation/compact_trajectory.h"
+#include "pilz_trajectory_generation/diagnostics.h"
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/phase_timings.h"
 #include "pilz_trajectory_generation/trajectory_functions.h"
 #include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
 
@@ -41,6 +45,7 @@ CREATE_MOVEIT_ERROR_CODE_EXCEPTION(TrajectoryGeneratorInvalidLimitsException, mo
 
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(VelocityScalingIncorrect, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(AccelerationScalingIncorrect, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(SamplingTimeIncorrect, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(UnknownPlanningGroup, moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME);
 
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(NoJointNamesInStartState, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE);
@@ -61,6 +66,12 @@ CREATE_MOVEIT_ERROR_CODE_EXCEPTION(PositionOrientationConstraintNameMismatch, mo
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(NoIKSolverAvailable, moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION);
 CREATE_MOVEIT_ERROR_CODE_EXCEPTION(NoPrimitivePoseGiven, moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS);
 
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(PlanningCancelled, moveit_msgs::MoveItErrorCodes::PREEMPTED);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(TrajectoryViolatesLimits, moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
+
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(PathUnreachable, moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION);
+CREATE_MOVEIT_ERROR_CODE_EXCEPTION(PathNearSingularity, moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
+
 /**
  * @brief Base class of trajectory generators
  *
@@ -81,14 +92,38 @@ public:
 
   /**
    * @brief generate robot trajectory with given sampling time
+   *
+   * If an output sampling time is given, the returned trajectory is sampled with it:
+   * Generators with an analytic joint space profile (PTP) plan directly with the output
+   * sampling time, the others (LIN, CIRC) interpolate the trajectory planned with the
+   * sampling time (see resampleJointTrajectory()), so that no further IK is solved.
    * @param req: motion plan request
    * @param res: motion plan response
    * @param sampling_time: sampling time of the generate trajectory
+   * @param output_sampling_time: sampling time of the returned trajectory, not greater than
+   * sampling_time; zero returns the trajectory with the sampling time
    * @return motion plan succeed/fail, detailed information in motion plan responce
    */
   bool generate(const planning_interface::MotionPlanRequest& req,
                 planning_interface::MotionPlanResponse&  res,
-                double sampling_time=0.1);
+                double sampling_time=0.1,
+                double output_sampling_time=0.);
+
+  /**
+   * @brief Sets the token which cancels a running generate().
+   *
+   * A cancelled generate() fails with error code PREEMPTED.
+   */
+  void setCancellationToken(const pilz::CancellationToken& cancellation);
+
+  /**
+   * @return The processing times of the phases of the last generate() call:
+   * "validate_request", "extract_motion_plan_info", "plan" (with the sub-phases
+   * "plan/path_scan", "plan/ik", "plan/limit_check" and "plan/waypoints" of the Cartesian generators),
+   * "resample" (only if the Cartesian generators return an output sampling time)
+   * and "set_success_response".
+   */
+  const pilz::PhaseTimings& getPhaseTimings() const;
 
 protected:
   /**
@@ -120,6 +155,12 @@ protected:
 private:
   virtual void cmdSpecificRequestValidation(const planning_interface::MotionPlanRequest &req) const;
 
+  /**
+   * @return True if plan() samples an analytic joint space profile, so that the
+   * trajectory can be planned directly with the output sampling time.
+   */
+  virtual bool hasJointSpaceProfile() const;
+
   /**
    * @brief Extract needed information from a motion plan request in order to simplify
    * further usages.
@@ -132,7 +173,7 @@ private:
   virtual void plan(const planning_interface::MotionPlanRequest &req,
                     const MotionPlanInfo& plan_info,
                     const double& sampling_time,
-                    trajectory_msgs::JointTrajectory& joint_trajectory) = 0;
+                    pilz::CompactTrajectory& joint_trajectory) = 0;
 
 private:
   /**
@@ -164,7 +205,7 @@ private:
    */
   void setSuccessResponse(const std::string& group_name,
                           const moveit_msgs::RobotState& start_state,
-                          const trajectory_msgs::JointTrajectory& joint_trajectory,
+                          const pilz::CompactTrajectory& joint_trajectory,
                           const ros::Time &planning_start,
                           planning_interface::MotionPlanResponse& res) const;
 
@@ -195,10 +236,32 @@ private:
   void checkCartesianGoalConstraint(const moveit_msgs::Constraints& constraint,
                                     const std::string &group_name) const;
 
-  void convertToRobotTrajectory(const trajectory_msgs::JointTrajectory& joint_trajectory,
+  void convertToRobotTrajectory(const pilz::CompactTrajectory& joint_trajectory,
                                 const moveit_msgs::RobotState &start_state,
                                 robot_trajectory::RobotTrajectory& robot_trajectory) const;
 
+  /**
+   * @brief Enforces the speed limit of the frames of the cartesian limits (if set), see
+   * pilz::enforceFrameSpeedLimit(). The trajectory is resampled with the output sampling time (if given).
+   */
+  void enforceFrameSpeedLimit(const moveit_msgs::RobotState& start_state,
+                              double output_sampling_time,
+                              pilz::CompactTrajectory& joint_trajectory) const;
+
+  /**
+   * @brief Scans the Cartesian path of LIN and CIRC before it is sampled, if enabled by the cartesian
+   * limits (see CartesianLimit::getPathScanSamples() and scanCartesianPath()), so that an unreachable
+   * or singular path fails before the inverse kinematics of all samples is solved.
+   *
+   * The processing time is added to the plan phase "path_scan".
+   * @return The sampling time of the path: the given sampling time, reduced by the ratio of the minimal
+   * manipulability of the path to CartesianLimit::getFineSamplingManipulability() if it is below
+   * (at most by MIN_FINE_SAMPLING_FACTOR)
+   * @throws PathUnreachable if a sample of the path has no inverse kinematics solution
+   * @throws PathNearSingularity if the manipulability of a sample is below CartesianLimit::getMinManipulability()
+   */
+  double scanPath(const KDL::Path& path, const MotionPlanInfo& plan_info, double sampling_time);
+
 private:
   /**
    * @return True if scaling factor is valid, otherwise false.
@@ -207,6 +270,12 @@ private:
   static void checkVelocityScaling(const double& scaling_factor);
   static void checkAccelerationScaling(const double& scaling_factor);
 
+  /**
+   * @brief Checks that the sampling time is in [MIN_SAMPLING_TIME, MAX_SAMPLING_TIME]
+   * and the output sampling time is zero or in [MIN_SAMPLING_TIME, sampling_time].
+   */
+  static void checkSamplingTimes(double sampling_time, double output_sampling_time);
+
   /**
    * @return True if ONE position + ONE orientation constraint given,
    * otherwise false.
@@ -230,8 +299,31 @@ protected:
   static constexpr double MIN_SCALING_FACTOR {0.0001};
   static constexpr double MAX_SCALING_FACTOR {1.};
   static constexpr double VELOCITY_TOLERANCE {1e-8};
+  static constexpr double MIN_SAMPLING_TIME {0.0001};
+  static constexpr double MAX_SAMPLING_TIME {1.};
+  //! Minimal factor by which scanPath() reduces the sampling time.
+  static constexpr double MIN_FINE_SAMPLING_FACTOR {0.1};
+
+  //! Checked by the generators during the sampling of the trajectory.
+  pilz::CancellationToken cancellation_;
+
+  //! Phases of plan(), filled by the generators.
+  pilz::PhaseTimings plan_phase_timings_;
+
+private:
+  pilz::PhaseTimings phase_timings_;
 };
 
+inline void TrajectoryGenerator::setCancellationToken(const pilz::CancellationToken& cancellation)
+{
+  cancellation_ = cancellation;
+}
+
+inline const pilz::PhaseTimings& TrajectoryGenerator::getPhaseTimings() const
+{
+  return phase_timings_;
+}
+
 inline bool TrajectoryGenerator::isScalingFactorValid(const double& scaling_factor)
 {
   return (scaling_factor > MIN_SCALING_FACTOR && scaling_factor <= MAX_SCALING_FACTOR);
@@ -73,7 +73,7 @@ private:
   virtual void plan(const planning_interface::MotionPlanRequest &req,
                     const MotionPlanInfo& plan_info,
                     const double& sampling_time,
-                    trajectory_msgs::JointTrajectory& joint_trajectory) override;
+                    pilz::CompactTrajectory& joint_trajectory) override;
 
   /**
    * @brief Construct a KDL::Path object for a Cartesian path of an arc.
@@ -63,7 +63,7 @@ private:
   virtual void plan(const planning_interface::MotionPlanRequest &req,
                     const MotionPlanInfo& plan_info,
                     const double& sampling_time,
-                    trajectory_msgs::JointTrajectory& joint_trajectory) override;
+                    pilz::CompactTrajectory& joint_trajectory) override;
 
   /**
    * @brief construct a KDL::Path object for a Cartesian straight line
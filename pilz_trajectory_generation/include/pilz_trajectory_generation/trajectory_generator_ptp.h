@@ -55,8 +55,49 @@ private:
   virtual void extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
                                      MotionPlanInfo& info) const override;
 
+  /**
+   * @brief Solves the goal pose from all candidates of the goal IK options (the start state, the configured
+   * seeds and the solutions of the solver) and sets the solution with the shortest PTP duration as goal.
+   * Equally fast solutions are ordered by their candidate.
+   *
+   * The candidates are solved one after the other by the solver of the group.
+   * The solutions are only checked for self collisions, the generators have no planning scene.
+   * @throw PtpNoIkSolutionForGoalPose if no candidate has a solution
+   */
+  void solveGoalIK(const planning_interface::MotionPlanRequest& req,
+                   const std::string& link_name,
+                   const Eigen::Isometry3d& goal_pose,
+                   const GoalIkOptions& options,
+                   MotionPlanInfo& info) const;
+
+  /**
+   * @return The limit of all joints of a PTP motion: the most strict limit of the group, reduced to the
+   * minimum of the configuration dependent limits between the start and the goal positions.
+   */
+  pilz_extensions::JointLimit getMotionLimit(const std::map<std::string, double>& start_pos,
+                                             const std::map<std::string, double>& goal_pos,
+                                             const std::vector<std::string>& joint_names,
+                                             const std::string& group_name) const;
+
+  /**
+   * @return The duration of the PTP motion planned by planPTP(), without sampling it.
+   */
+  double getPTPDuration(const std::map<std::string, double>& start_pos,
+                        const std::map<std::string, double>& goal_pos,
+                        const std::string& group_name,
+                        double velocity_scaling_factor,
+                        double acceleration_scaling_factor) const;
+
+  /**
+   * @return True, the trajectory is sampled from the analytic joint space profile.
+   */
+  virtual bool hasJointSpaceProfile() const override;
+
   /**
    * @brief plan ptp joint trajectory with zero start velocity
+   *
+   * All joints use the most strict limits of the group, reduced to the minimum of the configuration
+   * dependent limits between the start and the goal positions.
    * @param start_pos
    * @param goal_pos
    * @param joint_trajectory
@@ -67,7 +108,7 @@ private:
    */
   void planPTP(const std::map<std::string, double>& start_pos,
                const std::map<std::string, double>& goal_pos,
-               trajectory_msgs::JointTrajectory& joint_trajectory,
+               pilz::CompactTrajectory& joint_trajectory,
                const std::string &group_name,
                const double& velocity_scaling_factor,
                const double& acceleration_scaling_factor,
@@ -76,10 +117,12 @@ private:
   virtual void plan(const planning_interface::MotionPlanRequest &req,
                     const MotionPlanInfo& plan_info,
                     const double& sampling_time,
-                    trajectory_msgs::JointTrajectory& joint_trajectory) override;
+                    pilz::CompactTrajectory& joint_trajectory) override;
 
 private:
   const double MIN_MOVEMENT = 0.001;
+  //! Goal IK solutions with durations closer than this [s] are equally fast
+  const double DURATION_TOLERANCE = 1e-6;
   pilz::JointLimitsContainer joint_limits_;
   // most strict joint limits for each group
   std::map<std::string, pilz_extensions::JointLimit> most_strict_limits_;
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Allocation counter library, which is meant to be preloaded (LD_PRELOAD):
+ * Replaces the global operator new/delete and counts the allocations per
+ * thread. The counts are read via pilz_get_heap_allocation_counts() (see
+ * allocation_counters.h).
+ *
+ * Allocations by malloc() directly are not counted.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+// initial-exec: the library is preloaded, accessing the counters must not allocate
+__attribute__((tls_model("initial-exec"))) thread_local uint64_t allocation_count {0};
+__attribute__((tls_model("initial-exec"))) thread_local uint64_t allocated_byte_count {0};
+
+void* allocate(std::size_t size)
+{
+  ++allocation_count;
+  allocated_byte_count += size;
+  if(size == 0)
+  {
+    size = 1;
+  }
+
+  void* ptr;
+  while((ptr = std::malloc(size)) == nullptr)
+  {
+    std::new_handler handler {std::get_new_handler()};
+    if(!handler)
+    {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+  return ptr;
+}
+
+void* allocateNoThrow(std::size_t size) noexcept
+{
+  try
+  {
+    return allocate(size);
+  }
+  catch(const std::bad_alloc&)
+  {
+    return nullptr;
+  }
+}
+
+}
+
+extern "C" __attribute__((visibility("default")))
+void pilz_get_heap_allocation_counts(uint64_t* allocations, uint64_t* allocated_bytes)
+{
+  *allocations = allocation_count;
+  *allocated_bytes = allocated_byte_count;
+}
+
+void* operator new(std::size_t size)
+{
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+  return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocateNoThrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocateNoThrow(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
@@ -25,7 +25,15 @@ pilz::CartesianLimit::CartesianLimit():
   has_max_trans_dec_(false),
   max_trans_dec_(0.0),
   has_max_rot_vel_(false),
-  max_rot_vel_(0.0)
+  max_rot_vel_(0.0),
+  has_max_frame_speed_(false),
+  max_frame_speed_(0.0),
+  scale_to_max_frame_speed_(false),
+  path_scan_samples_(0),
+  has_min_manipulability_(false),
+  min_manipulability_(0.0),
+  has_fine_sampling_manipulability_(false),
+  fine_sampling_manipulability_(0.0)
 {
 
 }
@@ -102,3 +110,84 @@ double pilz::CartesianLimit::getMaxRotationalVelocity() const
   return max_rot_vel_;
 }
 
+// Speed Limit of Frames
+
+bool pilz::CartesianLimit::hasMaxFrameSpeed() const
+{
+  return has_max_frame_speed_;
+}
+
+void pilz::CartesianLimit::setMaxFrameSpeed(double max_frame_speed)
+{
+  has_max_frame_speed_ = true;
+  max_frame_speed_ = max_frame_speed;
+}
+
+double pilz::CartesianLimit::getMaxFrameSpeed() const
+{
+  return max_frame_speed_;
+}
+
+void pilz::CartesianLimit::setSpeedLimitFrames(const std::vector<std::string>& frames)
+{
+  speed_limit_frames_ = frames;
+}
+
+const std::vector<std::string>& pilz::CartesianLimit::getSpeedLimitFrames() const
+{
+  return speed_limit_frames_;
+}
+
+void pilz::CartesianLimit::setScaleToMaxFrameSpeed(bool scale)
+{
+  scale_to_max_frame_speed_ = scale;
+}
+
+bool pilz::CartesianLimit::getScaleToMaxFrameSpeed() const
+{
+  return scale_to_max_frame_speed_;
+}
+
+// Path Scan of LIN and CIRC
+
+void pilz::CartesianLimit::setPathScanSamples(std::size_t samples)
+{
+  path_scan_samples_ = samples;
+}
+
+std::size_t pilz::CartesianLimit::getPathScanSamples() const
+{
+  return path_scan_samples_;
+}
+
+bool pilz::CartesianLimit::hasMinManipulability() const
+{
+  return has_min_manipulability_;
+}
+
+void pilz::CartesianLimit::setMinManipulability(double min_manipulability)
+{
+  has_min_manipulability_ = true;
+  min_manipulability_ = min_manipulability;
+}
+
+double pilz::CartesianLimit::getMinManipulability() const
+{
+  return min_manipulability_;
+}
+
+bool pilz::CartesianLimit::hasFineSamplingManipulability() const
+{
+  return has_fine_sampling_manipulability_;
+}
+
+void pilz::CartesianLimit::setFineSamplingManipulability(double manipulability)
+{
+  has_fine_sampling_manipulability_ = true;
+  fine_sampling_manipulability_ = manipulability;
+}
+
+double pilz::CartesianLimit::getFineSamplingManipulability() const
+{
+  return fine_sampling_manipulability_;
+}
@@ -27,6 +27,12 @@ static const std::string PARAM_MAX_TRANS_DEC = "max_trans_dec";
 static const std::string PARAM_MAX_ROT_VEL = "max_rot_vel";
 static const std::string PARAM_MAX_ROT_ACC = "max_rot_acc";
 static const std::string PARAM_MAX_ROT_DEC = "max_rot_dec";
+static const std::string PARAM_MAX_FRAME_SPEED = "max_frame_speed";
+static const std::string PARAM_SPEED_LIMIT_FRAMES = "speed_limit_frames";
+static const std::string PARAM_SCALE_TO_MAX_FRAME_SPEED = "scale_to_max_frame_speed";
+static const std::string PARAM_PATH_SCAN_SAMPLES = "path_scan_samples";
+static const std::string PARAM_MIN_MANIPULABILITY = "min_manipulability";
+static const std::string PARAM_FINE_SAMPLING_MANIPULABILITY = "fine_sampling_manipulability";
 
 pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(const ros::NodeHandle& nh)
 {
@@ -63,6 +69,40 @@ pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(const
     cartesian_limit.setMaxRotationalVelocity(max_rot_vel);
   }
 
+  // speed limit of frames
+  double max_frame_speed;
+  if(nh.getParam(param_prefix + PARAM_MAX_FRAME_SPEED, max_frame_speed))
+  {
+    cartesian_limit.setMaxFrameSpeed(max_frame_speed);
+  }
+  std::vector<std::string> speed_limit_frames;
+  if(nh.getParam(param_prefix + PARAM_SPEED_LIMIT_FRAMES, speed_limit_frames))
+  {
+    cartesian_limit.setSpeedLimitFrames(speed_limit_frames);
+  }
+  bool scale_to_max_frame_speed;
+  if(nh.getParam(param_prefix + PARAM_SCALE_TO_MAX_FRAME_SPEED, scale_to_max_frame_speed))
+  {
+    cartesian_limit.setScaleToMaxFrameSpeed(scale_to_max_frame_speed);
+  }
+
+  // path scan of LIN and CIRC
+  int path_scan_samples;
+  if(nh.getParam(param_prefix + PARAM_PATH_SCAN_SAMPLES, path_scan_samples) && path_scan_samples >= 0)
+  {
+    cartesian_limit.setPathScanSamples(static_cast<std::size_t>(path_scan_samples));
+  }
+  double min_manipulability;
+  if(nh.getParam(param_prefix + PARAM_MIN_MANIPULABILITY, min_manipulability))
+  {
+    cartesian_limit.setMinManipulability(min_manipulability);
+  }
+  double fine_sampling_manipulability;
+  if(nh.getParam(param_prefix + PARAM_FINE_SAMPLING_MANIPULABILITY, fine_sampling_manipulability))
+  {
+    cartesian_limit.setFineSamplingManipulability(fine_sampling_manipulability);
+  }
+
   // rotational acceleration + deceleration deprecated
   // LCOV_EXCL_START
   if(nh.hasParam(param_prefix + PARAM_MAX_ROT_ACC)
@@ -77,3 +117,128 @@ pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(const
   return cartesian_limit;
 
 }
+
+/**
+ * @brief Reads the specified member of the cartesian limits, which may be given as int or double.
+ */
+static bool getLimit(XmlRpc::XmlRpcValue& limits_param, const std::string& name, double& limit)
+{
+  if(!limits_param.hasMember(name))
+  {
+    return false;
+  }
+  XmlRpc::XmlRpcValue& value {limits_param[name]};
+  if(value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+  {
+    limit = static_cast<double>(value);
+    return true;
+  }
+  if(value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    limit = static_cast<int>(value);
+    return true;
+  }
+  ROS_WARN_STREAM("Ignoring cartesian limit " << name << ", it is not a number");
+  return false;
+}
+
+/**
+ * @brief Reads the frames of the speed limit, given as list of link names.
+ */
+static bool getFrames(XmlRpc::XmlRpcValue& limits_param, const std::string& name, std::vector<std::string>& frames)
+{
+  if(!limits_param.hasMember(name))
+  {
+    return false;
+  }
+  XmlRpc::XmlRpcValue& value {limits_param[name]};
+  if(value.getType() != XmlRpc::XmlRpcValue::TypeArray)
+  {
+    ROS_WARN_STREAM("Ignoring " << name << ", it is not a list of frames");
+    return false;
+  }
+  frames.clear();
+  for(int i = 0; i < value.size(); ++i)
+  {
+    if(value[i].getType() != XmlRpc::XmlRpcValue::TypeString)
+    {
+      ROS_WARN_STREAM("Ignoring " << name << ", it is not a list of frames");
+      return false;
+    }
+    frames.push_back(static_cast<std::string>(value[i]));
+  }
+  return true;
+}
+
+pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(XmlRpc::XmlRpcValue& param)
+{
+  pilz::CartesianLimit cartesian_limit;
+
+  if(param.getType() != XmlRpc::XmlRpcValue::TypeStruct || !param.hasMember(PARAM_CARTESIAN_LIMITS_NS)
+     || param[PARAM_CARTESIAN_LIMITS_NS].getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    return cartesian_limit;
+  }
+  XmlRpc::XmlRpcValue& limits_param {param[PARAM_CARTESIAN_LIMITS_NS]};
+
+  double limit;
+  if(getLimit(limits_param, PARAM_MAX_TRANS_VEL, limit))
+  {
+    cartesian_limit.setMaxTranslationalVelocity(limit);
+  }
+  if(getLimit(limits_param, PARAM_MAX_TRANS_ACC, limit))
+  {
+    cartesian_limit.setMaxTranslationalAcceleration(limit);
+  }
+  if(getLimit(limits_param, PARAM_MAX_TRANS_DEC, limit))
+  {
+    cartesian_limit.setMaxTranslationalDeceleration(limit);
+  }
+  if(getLimit(limits_param, PARAM_MAX_ROT_VEL, limit))
+  {
+    cartesian_limit.setMaxRotationalVelocity(limit);
+  }
+  if(getLimit(limits_param, PARAM_MAX_FRAME_SPEED, limit))
+  {
+    cartesian_limit.setMaxFrameSpeed(limit);
+  }
+  std::vector<std::string> frames;
+  if(getFrames(limits_param, PARAM_SPEED_LIMIT_FRAMES, frames))
+  {
+    cartesian_limit.setSpeedLimitFrames(frames);
+  }
+  if(limits_param.hasMember(PARAM_SCALE_TO_MAX_FRAME_SPEED)
+     && limits_param[PARAM_SCALE_TO_MAX_FRAME_SPEED].getType() == XmlRpc::XmlRpcValue::TypeBoolean)
+  {
+    cartesian_limit.setScaleToMaxFrameSpeed(static_cast<bool>(limits_param[PARAM_SCALE_TO_MAX_FRAME_SPEED]));
+  }
+  if(limits_param.hasMember(PARAM_PATH_SCAN_SAMPLES)
+     && limits_param[PARAM_PATH_SCAN_SAMPLES].getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    const int samples {static_cast<int>(limits_param[PARAM_PATH_SCAN_SAMPLES])};
+    if(samples >= 0)
+    {
+      cartesian_limit.setPathScanSamples(static_cast<std::size_t>(samples));
+    }
+  }
+  if(getLimit(limits_param, PARAM_MIN_MANIPULABILITY, limit))
+  {
+    cartesian_limit.setMinManipulability(limit);
+  }
+  if(getLimit(limits_param, PARAM_FINE_SAMPLING_MANIPULABILITY, limit))
+  {
+    cartesian_limit.setFineSamplingManipulability(limit);
+  }
+
+  // rotational acceleration + deceleration deprecated
+  // LCOV_EXCL_START
+  if(limits_param.hasMember(PARAM_MAX_ROT_ACC) || limits_param.hasMember(PARAM_MAX_ROT_DEC))
+  {
+    ROS_WARN_STREAM("Ignoring cartesian limits parameters for rotational acceleration / deceleration;"
+                    << "these parameters are deprecated and are automatically calculated from"
+                    << "translational to rotational ratio.");
+  }
+  // LCOV_EXCL_STOP
+
+  return cartesian_limit;
+}
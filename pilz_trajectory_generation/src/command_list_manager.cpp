@@ -17,84 +17,298 @@
 
 #include "pilz_trajectory_generation/command_list_manager.h"
 
+#include <algorithm>
 #include <sstream>
 #include <functional>
+#include <limits>
 #include <cassert>
+#include <utility>
 
 #include <ros/ros.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_state/conversions.h>
 
-#include "pilz_trajectory_generation/joint_limits_aggregator.h"
-#include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/diagnostics.h"
 #include "pilz_trajectory_generation/trajectory_blender_transition_window.h"
 #include "pilz_trajectory_generation/trajectory_blend_request.h"
 #include "pilz_trajectory_generation/tip_frame_getter.h"
+#include "pilz_trajectory_generation/planning_request_recorder.h"
+#include "pilz_trajectory_generation/sampling_times.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
 
 namespace pilz_trajectory_generation
 {
 
 static const std::string PARAM_NAMESPACE_LIMITS = "robot_description_planning";
 
+/**
+ * @brief Formats the timings (and allocation counts, if counted) of the phases, one phase per line.
+ */
+static std::string formatPhaseTimings(const pilz::PhaseTimings& timings)
+{
+  std::ostringstream os;
+  for(std::size_t i = 0; i < timings.getEntries().size(); ++i)
+  {
+    const pilz::PhaseTimings::Entry& phase {timings.getEntries().at(i)};
+    os << "\n  " << phase.first << ": " << phase.second * 1000. << " ms";
+#ifdef PILZ_ENABLE_ALLOCATION_COUNTERS
+    const pilz::AllocationCounts& counts {timings.getAllocationCounts().at(i)};
+    os << ", " << counts.allocations << " allocations (" << counts.allocated_bytes << " bytes), "
+       << counts.copies << " copies (" << counts.copied_bytes << " bytes)";
+#endif
+  }
+  return os.str();
+}
+
 CommandListManager::CommandListManager(const ros::NodeHandle &nh, const moveit::core::RobotModelConstPtr &model):
   nh_(nh),
   model_(model)
 {
-  // Obtain the aggregated joint limits
-  pilz::JointLimitsContainer aggregated_limit_active_joints;
+  // Obtain the limits, shared with the command planner and the other capabilities
+  configuration_ = pilz::PlanningConfigurationRegistry::getInstance().getSharedConfiguration(
+        ros::NodeHandle(PARAM_NAMESPACE_LIMITS), model_);
 
-  aggregated_limit_active_joints = pilz::JointLimitsAggregator::getAggregatedLimits(
-        ros::NodeHandle(PARAM_NAMESPACE_LIMITS),model_->getActiveJointModels());
-
-
-  // Obtain cartesian limits
-  pilz::CartesianLimit cartesian_limit = pilz::CartesianLimitsAggregator::getAggregatedLimits(ros::NodeHandle(PARAM_NAMESPACE_LIMITS));
-
-  pilz::LimitsContainer limits;
-  limits.setJointLimits(aggregated_limit_active_joints);
-  limits.setCartesianLimits(cartesian_limit);
+  pilz::TraceRecorder::getInstance().openFromParameter(nh_);
+}
 
-  plan_comp_builder_.setModel(model);
-  plan_comp_builder_.setBlender(std::unique_ptr<pilz::TrajectoryBlender>(new pilz::TrajectoryBlenderTransitionWindow(limits)));
+RobotTrajCont CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                        const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                                        const pilz_msgs::MotionSequenceRequest& req_list,
+                                        const pilz::CancellationToken& cancellation) const
+{
+  return solve(planning_scene, planning_pipeline, pilz_msgs::MotionSequenceRequest(req_list), cancellation);
 }
 
 RobotTrajCont CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                         const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
-                                        const pilz_msgs::MotionSequenceRequest& req_list)
+                                        pilz_msgs::MotionSequenceRequest&& req_list,
+                                        const pilz::CancellationToken& cancellation) const
 {
   if(req_list.items.empty())
   {
     return RobotTrajCont();
   }
 
-  checkForNegativeRadii(req_list);
-  checkLastBlendRadiusZero(req_list);
-  checkStartStates(req_list);
+  PILZ_TRACE_SCOPE("sequence", "solve");
+  pilz::DiagnosticsPlanScope diagnostics_scope;
+  const double* scope_payload {pilz::PayloadScope::getCurrentPayload()};
+  const double payload {scope_payload ? *scope_payload : getPayload(planning_scene.get(), req_list)};
+  const pilz::PhaseTimings::Clock::time_point start {pilz::PhaseTimings::Clock::now()};
+  const pilz::AllocationCounts start_counts {pilz::AllocationCounters::get()};
+  pilz::PhaseTimings timings;
+  pilz::MonotonicArena arena;
+  MotionRequestCont requests {pilz::ArenaAllocator<planning_interface::MotionPlanRequest>(arena)};
+  RadiiCont radii {pilz::ArenaAllocator<double>(arena)};
+  {
+    PILZ_TRACE_SCOPE("sequence", "check_request_list");
+    pilz::ScopedPhaseTimer timer(timings, "check_request_list");
+    checkRequestList(req_list);
+
+    assert(model_);
+    radii = extractBlendRadii(*model_, req_list, arena);
 
+    requests.reserve(req_list.items.size());
+    for(auto& seq_item : req_list.items)
+    {
+      requests.emplace_back(std::move(seq_item.req));
+    }
+  }
+  // The sampling times of the sequence override the ones of the planning groups
+  pilz::SamplingTimesScope sampling_times_scope(req_list.sampling_time, req_list.output_sampling_time);
+  // All requests of the sequence are planned with the limits of its payload
+  pilz::PayloadScope payload_scope(payload);
+  // ... and with one snapshot of the limits, even if they are updated meanwhile
+  pilz::ConfigurationScope configuration_scope(*configuration_, configuration_->get());
+  RobotTrajCont res {solveRequests(planning_scene, planning_pipeline, requests, radii, arena, cancellation, timings)};
+  addToStatistics(timings, start, start_counts);
+  return res;
+}
+
+double CommandListManager::getPayload(const planning_scene::PlanningScene* planning_scene,
+                                      const pilz_msgs::MotionSequenceRequest& req_list)
+{
+  if(req_list.items.empty())
+  {
+    return 0.;
+  }
+  // Only the first request of a group may have a start state, the objects stay attached for the sequence
+  return pilz::getAttachedPayload(req_list.items.front().req.start_state,
+                                  planning_scene ? &planning_scene->getCurrentState() : nullptr);
+}
+
+pilz::PayloadLimits CommandListManager::getScopeLimits(const pilz::PlanningConfiguration& configuration)
+{
+  const double* payload {pilz::PayloadScope::getCurrentPayload()};
+  return payload ? configuration.getPayloadLimits(*payload)
+                 : pilz::PayloadLimits(configuration.getLimits(), std::numeric_limits<double>::quiet_NaN());
+}
+
+RobotTrajCont CommandListManager::applySpeedOverride(const RobotTrajCont& trajectories, double speed_override) const
+{
+  if(!(speed_override > 0. && speed_override <= 1.))
+  {
+    std::ostringstream os;
+    os << "Speed override not in range (0, 1], actual value is: " << speed_override;
+    throw SpeedOverrideInvalidException(os.str());
+  }
+
+  PILZ_TRACE_SCOPE("sequence", "apply_speed_override");
+  const pilz::PlanningConfigurationConstPtr configuration {configuration_->get()};
+  const pilz::PayloadLimits limits {getScopeLimits(*configuration)};
+  RobotTrajCont res;
+  res.reserve(trajectories.size());
+  for(const auto& trajectory : trajectories)
+  {
+    pilz::JointLimitsTable limits_table {limits.limits.getJointLimitContainer().getTable(
+                                           trajectory->getGroupName(),
+                                           pilz::CompactTrajectory::getVariableNames(*trajectory))};
+    limits_table.setPayload(limits.payload);
+    robot_trajectory::RobotTrajectoryPtr scaled_trajectory {
+      std::make_shared<robot_trajectory::RobotTrajectory>(model_, trajectory->getGroupName())};
+    if(!pilz::applySpeedOverride(*trajectory, speed_override, limits_table, *scaled_trajectory))
+    {
+      throw SpeedOverrideViolatesLimitsException("Trajectory of group " + trajectory->getGroupName()
+                                                 + " violates the joint limits with speed override "
+                                                 + std::to_string(speed_override));
+    }
+    res.push_back(scaled_trajectory);
+  }
+  return res;
+}
+
+RobotTrajCont CommandListManager::solveRequests(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                                                MotionRequestCont& requests,
+                                                const RadiiCont& radii,
+                                                pilz::MonotonicArena& arena,
+                                                const pilz::CancellationToken& cancellation,
+                                                pilz::PhaseTimings& timings) const
+{
+  pilz::PhaseTimings::Clock::time_point phase_start {pilz::PhaseTimings::Clock::now()};
+  pilz::AllocationCounts phase_start_counts {pilz::AllocationCounters::get()};
+  pilz::PhaseTimings planner_timings;
   MotionResponseCont resp_cont
   {
-    solveSequenceItems(planning_scene, planning_pipeline, req_list)
+    solveSequenceItems(planning_scene, planning_pipeline, requests, arena, cancellation, planner_timings)
   };
+  timings.add("solve_sequence_items", pilz::PhaseTimings::getSecondsSince(phase_start),
+              pilz::AllocationCounters::getSince(phase_start_counts));
+  timings.add(planner_timings, "solve_sequence_items/");
+
+  phase_start = pilz::PhaseTimings::Clock::now();
+  phase_start_counts = pilz::AllocationCounters::get();
+  PoseCacheCont pose_cont {computeTipFramePoses(resp_cont, radii, arena)};
+  timings.add("tip_frame_poses", pilz::PhaseTimings::getSecondsSince(phase_start),
+              pilz::AllocationCounters::getSince(phase_start_counts));
+
+  phase_start = pilz::PhaseTimings::Clock::now();
+  phase_start_counts = pilz::AllocationCounters::get();
+  checkForOverlappingRadii(resp_cont, pose_cont, radii);
+  timings.add("check_overlapping_radii", pilz::PhaseTimings::getSecondsSince(phase_start),
+              pilz::AllocationCounters::getSince(phase_start_counts));
+
+  // The builder is created per call, so that solve() can be called concurrently.
+  // The snapshot is the one of the active ConfigurationScope, i.e. the one the requests were planned with.
+  const pilz::PlanningConfigurationConstPtr configuration {configuration_->get()};
+  const pilz::PayloadLimits scope_limits {getScopeLimits(*configuration)};
+  // the blender and the builder keep their own copy
+  pilz::LimitsContainer limits {scope_limits.limits};
+  limits.setPayload(scope_limits.payload);
+  PlanComponentsBuilder plan_comp_builder;
+  plan_comp_builder.setModel(model_);
+  plan_comp_builder.setBlender(std::unique_ptr<pilz::TrajectoryBlender>(
+                                 new pilz::TrajectoryBlenderTransitionWindow(limits)));
+  plan_comp_builder.setCancellationToken(cancellation);
+  plan_comp_builder.setJointLimits(limits.getJointLimitContainer());
+  {
+    PILZ_TRACE_SCOPE("sequence", "blend");
+    pilz::ScopedPhaseTimer timer(timings, "blend");
+    for(MotionResponseCont::size_type i = 0; i < resp_cont.size(); ++i)
+    {
+      plan_comp_builder.append(resp_cont.at(i).trajectory_,
+                                // The blend radii has to be "attached" to
+                                // the second part of a blend trajectory,
+                                // therefore: "i-1".
+                                ( i>0? radii.at(i-1) : 0.),
+                                pose_cont.at(i) );
+    }
+  }
 
-  assert(model_);
-  RadiiCont radii {extractBlendRadii(*model_, req_list)};
-  checkForOverlappingRadii(resp_cont, radii);
+  RobotTrajCont trajectories;
+  {
+    PILZ_TRACE_SCOPE("sequence", "build");
+    pilz::ScopedPhaseTimer timer(timings, "build");
+    trajectories = plan_comp_builder.build();
+  }
 
-  plan_comp_builder_.reset();
-  for(MotionResponseCont::size_type i = 0; i < resp_cont.size(); ++i)
+  // the trajectories without blends consist of segments which are already limited
+  if(std::any_of(radii.begin(), radii.end(), [](double radius){ return radius > 0.; }))
+  {
+    PILZ_TRACE_SCOPE("sequence", "frame_speed_limit");
+    pilz::ScopedPhaseTimer timer(timings, "frame_speed_limit");
+    enforceFrameSpeedLimit(limits, trajectories);
+  }
+  return trajectories;
+}
+
+void CommandListManager::enforceFrameSpeedLimit(const pilz::LimitsContainer& limits,
+                                                RobotTrajCont& trajectories) const
+{
+  const pilz::CartesianLimit& cartesian_limit {limits.getCartesianLimits()};
+  if(!cartesian_limit.hasMaxFrameSpeed() || cartesian_limit.getSpeedLimitFrames().empty())
+  {
+    return;
+  }
+
+  for(auto& trajectory : trajectories)
   {
-    plan_comp_builder_.append(resp_cont.at(i).trajectory_,
-                              // The blend radii has to be "attached" to
-                              // the second part of a blend trajectory,
-                              // therefore: "i-1".
-                              ( i>0? radii.at(i-1) : 0.) );
+    if(trajectory->empty())
+    {
+      continue;
+    }
+    pilz::CompactTrajectory compact_trajectory {pilz::CompactTrajectory::getVariableNames(*trajectory)};
+    compact_trajectory.appendRobotTrajectory(*trajectory);
+    if(!pilz::enforceFrameSpeedLimit(trajectory->getFirstWayPoint(), cartesian_limit, 0., compact_trajectory))
+    {
+      continue;
+    }
+
+    robot_trajectory::RobotTrajectoryPtr scaled_trajectory {
+      std::make_shared<robot_trajectory::RobotTrajectory>(model_, trajectory->getGroupName())};
+    compact_trajectory.toRobotTrajectory(trajectory->getFirstWayPoint(), *scaled_trajectory);
+    trajectory = scaled_trajectory;
   }
-  return plan_comp_builder_.build();
+}
+
+void CommandListManager::addToStatistics(pilz::PhaseTimings& timings,
+                                         const pilz::PhaseTimings::Clock::time_point& start,
+                                         const pilz::AllocationCounts& start_counts) const
+{
+  timings.add("total", pilz::PhaseTimings::getSecondsSince(start), pilz::AllocationCounters::getSince(start_counts));
+
+  // The timings are only formatted, if the message is logged
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Sequence, "Processing times of sequence:" << formatPhaseTimings(timings));
+
+  if(statistics_)
+  {
+    statistics_->addRequest(timings);
+  }
+}
+
+void CommandListManager::checkRequestList(const pilz_msgs::MotionSequenceRequest &req_list)
+{
+  checkForNegativeRadii(req_list);
+  checkLastBlendRadiusZero(req_list);
+  checkStartStates(req_list);
 }
 
 bool CommandListManager::checkRadiiForOverlap(const robot_trajectory::RobotTrajectory& traj_A,
+                                              const pilz::TipFramePoseCacheConstPtr& poses_A,
                                               const double radii_A,
                                               const robot_trajectory::RobotTrajectory& traj_B,
+                                              const pilz::TipFramePoseCacheConstPtr& poses_B,
                                               const double radii_B) const
 {
   // No blending between trajectories from different groups
@@ -109,22 +323,54 @@ bool CommandListManager::checkRadiiForOverlap(const robot_trajectory::RobotTraje
     return false;
   }
 
-  const std::string& blend_frame {getSolverTipFrame(model_->getJointModelGroup(traj_A.getGroupName()))};
-  auto distance_endpoints = (traj_A.getLastWayPoint().getFrameTransform(blend_frame).translation() -
-                             traj_B.getLastWayPoint().getFrameTransform(blend_frame).translation()).norm();
+  // The poses of all trajectories taking part in a blend are known, see computeTipFramePoses()
+  assert(poses_A && !poses_A->empty());
+  assert(poses_B && !poses_B->empty());
+  auto distance_endpoints = (poses_A->getLastPose().translation() - poses_B->getLastPose().translation()).norm();
   return distance_endpoints <= sum_radii;
 }
 
+CommandListManager::PoseCacheCont CommandListManager::computeTipFramePoses(const MotionResponseCont& resp_cont,
+                                                                          const RadiiCont& radii,
+                                                                          pilz::MonotonicArena& arena) const
+{
+  PILZ_TRACE_SCOPE("sequence", "tip_frame_poses");
+  PoseCacheCont pose_cont(resp_cont.size(), pilz::TipFramePoseCacheConstPtr(),
+                          pilz::ArenaAllocator<pilz::TipFramePoseCacheConstPtr>(arena));
+  const pilz::PlanningConfigurationConstPtr configuration {configuration_->get()};
+  for(MotionResponseCont::size_type i = 0; i < resp_cont.size(); ++i)
+  {
+    const robot_trajectory::RobotTrajectory& traj {*(resp_cont.at(i).trajectory_)};
+
+    // Only trajectories which are blended or checked against the blend radius
+    // of their successor need the poses (invalid blend radii are already set to zero at this point).
+    const bool is_blended {radii.at(i) > 0. || (i > 0 && radii.at(i-1) > 0.)};
+    const bool next_is_blended {(i+1) < resp_cont.size() && radii.at(i+1) > 0. &&
+                                resp_cont.at(i+1).trajectory_->getGroupName() == traj.getGroupName()};
+    if (!is_blended && !next_is_blended)
+    {
+      continue;
+    }
+    const std::string& tip_frame {configuration->hasSolverTipFrame(traj.getGroupName()) ?
+          configuration->getSolverTipFrame(traj.getGroupName()) :
+          getSolverTipFrame(model_->getJointModelGroup(traj.getGroupName()))};
+    pose_cont.at(i) = std::make_shared<pilz::TipFramePoseCache>(traj, tip_frame);
+  }
+  return pose_cont;
+}
+
 void CommandListManager::checkForOverlappingRadii(const MotionResponseCont &resp_cont,
+                                                  const PoseCacheCont& pose_cont,
                                                   const RadiiCont &radii) const
 {
+  PILZ_TRACE_SCOPE("sequence", "check_overlapping_radii");
   if(resp_cont.empty()) { return; }
   if(resp_cont.size() < 3) { return; }
 
   for(MotionResponseCont::size_type i = 0; i < resp_cont.size()-2; ++i)
   {
-    if (checkRadiiForOverlap(*(resp_cont.at(i).trajectory_), radii.at(i),
-                             *(resp_cont.at(i+1).trajectory_), radii.at(i+1)))
+    if (checkRadiiForOverlap(*(resp_cont.at(i).trajectory_), pose_cont.at(i), radii.at(i),
+                             *(resp_cont.at(i+1).trajectory_), pose_cont.at(i+1), radii.at(i+1)))
     {
       std::ostringstream os;
       os << "Overlapping blend radii between command [" << i << "] and [" << i+1 << "].";
@@ -154,6 +400,7 @@ void CommandListManager::setStartState(const MotionResponseCont &motion_plan_res
   if (rob_state_op)
   {
     moveit::core::robotStateToRobotStateMsg(rob_state_op.value(), start_state);
+    PILZ_COUNT_COPY(ros::serialization::serializationLength(start_state));
   }
 }
 
@@ -170,16 +417,17 @@ bool CommandListManager::isInvalidBlendRadii(const moveit::core::RobotModel &mod
   // No blending between different groups
   if (item_A.req.group_name != item_B.req.group_name)
   {
-    ROS_WARN_STREAM("Blending between different groups (in this case: \""
-                    << item_A.req.group_name << "\" and \""
-                    << item_B.req.group_name << "\") not allowed");
+    PILZ_WARN_STREAM(pilz::LogSubsystem::Sequence,
+                     "Blending between different groups (in this case: \""
+                     << item_A.req.group_name << "\" and \""
+                     << item_B.req.group_name << "\") not allowed");
     return true;
   }
 
   // No blending for groups without solver
   if(!hasSolver(model.getJointModelGroup(item_A.req.group_name)))
   {
-    ROS_WARN_STREAM("Blending for groups without solver not allowed");
+    PILZ_WARN_STREAM(pilz::LogSubsystem::Sequence, "Blending for groups without solver not allowed");
     return true;
   }
 
@@ -187,14 +435,16 @@ bool CommandListManager::isInvalidBlendRadii(const moveit::core::RobotModel &mod
 }
 
 CommandListManager::RadiiCont CommandListManager::extractBlendRadii(const moveit::core::RobotModel& model,
-                                                                    const pilz_msgs::MotionSequenceRequest &req_list)
+                                                                    const pilz_msgs::MotionSequenceRequest &req_list,
+                                                                    pilz::MonotonicArena& arena)
 {
-  RadiiCont radii(req_list.items.size(), 0.);
+  RadiiCont radii(req_list.items.size(), 0., pilz::ArenaAllocator<double>(arena));
   for(RadiiCont::size_type i = 0; i < (radii.size()-1); ++i)
   {
     if (isInvalidBlendRadii(model, req_list.items.at(i), req_list.items.at(i+1)))
     {
-      ROS_WARN_STREAM("Invalid blend radii between commands: [" << i << "] and [" << i+1 << "] => Blend radii set to zero");
+      PILZ_WARN_STREAM(pilz::LogSubsystem::Sequence,
+                       "Invalid blend radii between commands: [" << i << "] and [" << i+1 << "] => Blend radii set to zero");
       continue;
     }
     radii.at(i) = req_list.items.at(i).blend_radius;
@@ -205,26 +455,45 @@ CommandListManager::RadiiCont CommandListManager::extractBlendRadii(const moveit
 CommandListManager::MotionResponseCont CommandListManager::solveSequenceItems(
     const planning_scene::PlanningSceneConstPtr& planning_scene,
     const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
-    const pilz_msgs::MotionSequenceRequest &req_list) const
+    MotionRequestCont &requests,
+    pilz::MonotonicArena& arena,
+    const pilz::CancellationToken& cancellation,
+    pilz::PhaseTimings& timings) const
 {
-  MotionResponseCont motion_plan_responses;
+  MotionResponseCont motion_plan_responses {pilz::ArenaAllocator<planning_interface::MotionPlanResponse>(arena)};
+  motion_plan_responses.reserve(requests.size());
   size_t curr_req_index {0};
-  const size_t num_req {req_list.items.size()};
-  for(const auto& seq_item : req_list.items)
+  const size_t num_req {requests.size()};
+  for(auto& req : requests)
   {
-    planning_interface::MotionPlanRequest req {seq_item.req};
+    if (cancellation.isCancelled())
+    {
+      std::ostringstream os;
+      os << "Planning of sequence cancelled after [" << curr_req_index << "/" << num_req << "] requests";
+      throw SequenceCancelledException(os.str());
+    }
+
+    PILZ_TRACE_SCOPE("sequence", "sequence_item " + std::to_string(curr_req_index) + " " + req.planner_id);
     setStartState(motion_plan_responses, req.group_name, req.start_state);
 
     planning_interface::MotionPlanResponse res;
-    planning_pipeline->generatePlan(planning_scene, req, res);
+    {
+      // Planning contexts of the pilz planners created by the pipeline are cancelled together with the sequence
+      pilz::CancellationScope cancellation_scope(cancellation);
+      // ... and report their phases
+      pilz::PhaseTimingsScope timings_scope(timings);
+      // ... and are not recorded again as single requests
+      pilz::PlanningRequestRecorder::SequenceScope recorder_scope;
+      planning_pipeline->generatePlan(planning_scene, req, res);
+    }
     if (res.error_code_.val != res.error_code_.SUCCESS)
     {
       std::ostringstream os;
       os << "Could not solve request\n---\n" << req << "\n---\n";
       throw PlanningPipelineException(os.str(), res.error_code_.val);
     }
-    motion_plan_responses.emplace_back(res);
-    ROS_DEBUG_STREAM("Solved [" << ++curr_req_index << "/" << num_req << "]");
+    motion_plan_responses.emplace_back(std::move(res));
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Sequence, "Solved [" << ++curr_req_index << "/" << num_req << "]");
   }
   return motion_plan_responses;
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/compact_trajectory.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "pilz_trajectory_generation/allocation_counters.h"
+
+namespace pilz
+{
+
+CompactTrajectory::CompactTrajectory(const std::vector<std::string>& joint_names)
+  : joint_names_(joint_names)
+{
+}
+
+void CompactTrajectory::setJointNames(const std::vector<std::string>& joint_names)
+{
+  joint_names_ = joint_names;
+  clear();
+}
+
+void CompactTrajectory::clear()
+{
+  positions_.clear();
+  velocities_.clear();
+  accelerations_.clear();
+  time_from_start_.clear();
+}
+
+void CompactTrajectory::reserve(std::size_t waypoint_count)
+{
+  positions_.reserve(waypoint_count * joint_names_.size());
+  velocities_.reserve(waypoint_count * joint_names_.size());
+  accelerations_.reserve(waypoint_count * joint_names_.size());
+  time_from_start_.reserve(waypoint_count);
+}
+
+std::size_t CompactTrajectory::addWayPoint(double time_from_start)
+{
+  positions_.resize(positions_.size() + joint_names_.size(), 0.);
+  velocities_.resize(velocities_.size() + joint_names_.size(), 0.);
+  accelerations_.resize(accelerations_.size() + joint_names_.size(), 0.);
+  time_from_start_.push_back(time_from_start);
+  return time_from_start_.size() - 1;
+}
+
+void CompactTrajectory::removeLastWayPoint()
+{
+  if(time_from_start_.empty())
+  {
+    return;
+  }
+  positions_.resize(positions_.size() - joint_names_.size());
+  velocities_.resize(velocities_.size() - joint_names_.size());
+  accelerations_.resize(accelerations_.size() - joint_names_.size());
+  time_from_start_.pop_back();
+}
+
+void CompactTrajectory::append(const CompactTrajectory& other, double time_offset, std::size_t first)
+{
+  assert(other.joint_names_ == joint_names_);
+  if(first >= other.getWayPointCount())
+  {
+    return;
+  }
+
+  const double end_time {getDuration()};
+  const double other_start_time {first == 0 ? 0. : other.getTimeFromStart(first-1)};
+  for(std::size_t i = first; i < other.getWayPointCount(); ++i)
+  {
+    time_from_start_.push_back(end_time + time_offset + other.getTimeFromStart(i) - other_start_time);
+  }
+
+  const std::size_t offset {first * joint_names_.size()};
+  positions_.insert(positions_.end(), other.positions_.begin() + offset, other.positions_.end());
+  velocities_.insert(velocities_.end(), other.velocities_.begin() + offset, other.velocities_.end());
+  accelerations_.insert(accelerations_.end(), other.accelerations_.begin() + offset, other.accelerations_.end());
+}
+
+void CompactTrajectory::scaleTime(double factor)
+{
+  assert(factor > 0.);
+  const double velocity_factor {1. / factor};
+  const double acceleration_factor {velocity_factor * velocity_factor};
+  for(double& time_from_start : time_from_start_)
+  {
+    time_from_start *= factor;
+  }
+  for(double& velocity : velocities_)
+  {
+    velocity *= velocity_factor;
+  }
+  for(double& acceleration : accelerations_)
+  {
+    acceleration *= acceleration_factor;
+  }
+}
+
+void CompactTrajectory::appendRobotTrajectory(const robot_trajectory::RobotTrajectory& traj, std::size_t first)
+{
+  if(first >= traj.getWayPointCount())
+  {
+    return;
+  }
+
+  const std::vector<int> indices {getVariableIndices(*traj.getRobotModel())};
+  reserve(getWayPointCount() + traj.getWayPointCount() - first);
+
+  double time_from_start {getDuration()};
+  for(std::size_t i = first; i < traj.getWayPointCount(); ++i)
+  {
+    time_from_start += traj.getWayPointDurationFromPrevious(i);
+    const std::size_t index {addWayPoint(time_from_start)};
+
+    const robot_state::RobotState& state {traj.getWayPoint(i)};
+    double* positions {getPositions(index)};
+    double* velocities {getVelocities(index)};
+    double* accelerations {getAccelerations(index)};
+    for(std::size_t j = 0; j < indices.size(); ++j)
+    {
+      positions[j] = state.getVariablePosition(indices[j]);
+      velocities[j] = state.hasVelocities() ? state.getVariableVelocity(indices[j]) : 0.;
+      accelerations[j] = state.hasAccelerations() ? state.getVariableAcceleration(indices[j]) : 0.;
+    }
+  }
+}
+
+void CompactTrajectory::toRobotTrajectory(const robot_state::RobotState& reference_state,
+                                          robot_trajectory::RobotTrajectory& traj) const
+{
+  // make a copy in case the reference state belongs to the trajectory
+  const robot_state::RobotState reference_copy {reference_state};
+  traj.clear();
+
+  const std::vector<int> indices {getVariableIndices(*reference_state.getRobotModel())};
+  for(std::size_t i = 0; i < getWayPointCount(); ++i)
+  {
+    robot_state::RobotStatePtr state {std::make_shared<robot_state::RobotState>(reference_copy)};
+    PILZ_COUNT_COPY(reference_copy.getVariableCount() * 3 * sizeof(double));
+    const double* positions {getPositions(i)};
+    const double* velocities {getVelocities(i)};
+    const double* accelerations {getAccelerations(i)};
+    for(std::size_t j = 0; j < indices.size(); ++j)
+    {
+      state->setVariablePosition(indices[j], positions[j]);
+      state->setVariableVelocity(indices[j], velocities[j]);
+      state->setVariableAcceleration(indices[j], accelerations[j]);
+    }
+    // the users of the waypoints (e.g. TipFramePoseCache) read the link transforms with const access
+    state->update();
+    traj.addSuffixWayPoint(state, getDurationFromPrevious(i));
+  }
+}
+
+void CompactTrajectory::toJointTrajectoryMsg(trajectory_msgs::JointTrajectory& msg) const
+{
+  msg.joint_names = joint_names_;
+  msg.points.resize(getWayPointCount());
+  for(std::size_t i = 0; i < getWayPointCount(); ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& point {msg.points[i]};
+    point.time_from_start = ros::Duration(getTimeFromStart(i));
+    point.positions.assign(getPositions(i), getPositions(i) + getJointCount());
+    point.velocities.assign(getVelocities(i), getVelocities(i) + getJointCount());
+    point.accelerations.assign(getAccelerations(i), getAccelerations(i) + getJointCount());
+  }
+}
+
+const std::vector<std::string>& CompactTrajectory::getVariableNames(const robot_trajectory::RobotTrajectory& traj)
+{
+  return traj.getGroup() ? traj.getGroup()->getVariableNames() : traj.getRobotModel()->getVariableNames();
+}
+
+std::vector<int> CompactTrajectory::getVariableIndices(const moveit::core::RobotModel& model) const
+{
+  std::vector<int> indices;
+  indices.reserve(joint_names_.size());
+  for(const auto& joint_name : joint_names_)
+  {
+    indices.push_back(model.getVariableIndex(joint_name));
+  }
+  return indices;
+}
+
+}
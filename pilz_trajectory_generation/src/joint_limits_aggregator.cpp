@@ -26,6 +26,8 @@
 
 using namespace pilz_extensions;
 
+static const std::string PARAM_JOINT_LIMITS = "joint_limits";
+
 pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(const ros::NodeHandle& nh,
                                                              const std::vector<const moveit::core::JointModel*>& joint_models)
 {
@@ -39,47 +41,81 @@ pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(cons
     JointLimit joint_limit;
 
     // If there is something defined for the joint on the parameter server
-    if(pilz_extensions::joint_limits_interface::getJointLimits(joint_model->getName(), nh, joint_limit))
+    const bool has_parameter_limits {
+      pilz_extensions::joint_limits_interface::getJointLimits(joint_model->getName(), nh, joint_limit)};
+    aggregateLimit(joint_model, has_parameter_limits, joint_limit);
+
+    // Insert the joint limit into the map
+    container.addLimit(joint_model->getName(), joint_limit);
+  }
+
+  return container;
+}
+
+pilz::JointLimitsContainer pilz::JointLimitsAggregator::getAggregatedLimits(XmlRpc::XmlRpcValue& param,
+                                                             const std::vector<const moveit::core::JointModel*>& joint_models)
+{
+  JointLimitsContainer container;
+
+  XmlRpc::XmlRpcValue joint_limits_param;
+  if(param.getType() == XmlRpc::XmlRpcValue::TypeStruct && param.hasMember(PARAM_JOINT_LIMITS))
+  {
+    joint_limits_param = param[PARAM_JOINT_LIMITS];
+  }
+
+  for(auto joint_model : joint_models)
+  {
+    JointLimit joint_limit;
+
+    const bool has_parameter_limits {
+      pilz_extensions::joint_limits_interface::getJointLimits(joint_model->getName(), joint_limits_param, joint_limit)};
+    aggregateLimit(joint_model, has_parameter_limits, joint_limit);
+
+    container.addLimit(joint_model->getName(), joint_limit);
+  }
+
+  return container;
+}
+
+void pilz::JointLimitsAggregator::aggregateLimit(const moveit::core::JointModel* joint_model,
+                                                 bool has_parameter_limits,
+                                                 JointLimit& joint_limit)
+{
+  if(has_parameter_limits)
+  {
+    if(joint_limit.has_position_limits)
     {
-      if(joint_limit.has_position_limits)
-      {
-        checkPositionBoundsThrowing(joint_model, joint_limit);
-      }
-      else
-      {
-        updatePositionLimitFromJointModel(joint_model, joint_limit);
-      }
-
-
-      if(joint_limit.has_velocity_limits)
-      {
-        checkVelocityBoundsThrowing(joint_model, joint_limit);
-      }
-      else
-      {
-        updateVelocityLimitFromJointModel(joint_model, joint_limit);
-      }
+      checkPositionBoundsThrowing(joint_model, joint_limit);
     }
     else
     {
-      // If there is nothing defined for this joint on the parameter server just update the values by the values of
-      // the urdf
-
       updatePositionLimitFromJointModel(joint_model, joint_limit);
-      updateVelocityLimitFromJointModel(joint_model, joint_limit);
     }
 
-    // Update max_deceleration if no max_acceleration has been set
-    if(joint_limit.has_acceleration_limits && !joint_limit.has_deceleration_limits){
-      joint_limit.max_deceleration = -joint_limit.max_acceleration;
-      joint_limit.has_deceleration_limits = true;
+
+    if(joint_limit.has_velocity_limits)
+    {
+      checkVelocityBoundsThrowing(joint_model, joint_limit);
     }
+    else
+    {
+      updateVelocityLimitFromJointModel(joint_model, joint_limit);
+    }
+  }
+  else
+  {
+    // If there is nothing defined for this joint on the parameter server just update the values by the values of
+    // the urdf
 
-    // Insert the joint limit into the map
-    container.addLimit(joint_model->getName(), joint_limit);
+    updatePositionLimitFromJointModel(joint_model, joint_limit);
+    updateVelocityLimitFromJointModel(joint_model, joint_limit);
   }
 
-  return container;
+  // Update max_deceleration if no max_acceleration has been set
+  if(joint_limit.has_acceleration_limits && !joint_limit.has_deceleration_limits){
+    joint_limit.max_deceleration = -joint_limit.max_acceleration;
+    joint_limit.has_deceleration_limits = true;
+  }
 }
 
 void pilz::JointLimitsAggregator::updatePositionLimitFromJointModel(const moveit::core::JointModel* joint_model,
@@ -37,6 +37,8 @@ bool JointLimitsContainer::addLimit(const std::string &joint_name, pilz_extensio
     ROS_ERROR_STREAM("joint_limit for joint " << joint_name << " already contained.");
     return false;
   }
+  // the tables of the groups do not contain the new limit
+  group_tables_.clear();
   return true;
 }
 
@@ -93,19 +95,21 @@ std::map<std::string, pilz_extensions::JointLimit>::const_iterator JointLimitsCo
 bool JointLimitsContainer::verifyVelocityLimit(const std::string &joint_name,
                                                      const double &joint_velocity) const
 {
-  return (!(hasLimit(joint_name)
-          && getLimit(joint_name).has_velocity_limits
-          && fabs(joint_velocity) > getLimit(joint_name).max_velocity));
+  auto it = container_.find(joint_name);
+  return (!(it != container_.end()
+          && it->second.has_velocity_limits
+          && fabs(joint_velocity) > it->second.max_velocity));
 }
 
 
 bool JointLimitsContainer::verifyPositionLimit(const std::string &joint_name,
                                                      const double &joint_position) const
 {
-  return (!( hasLimit(joint_name)
-             && getLimit(joint_name).has_position_limits
-             && (joint_position < getLimit(joint_name).min_position
-                || joint_position > getLimit(joint_name).max_position) ) );
+  auto it = container_.find(joint_name);
+  return (!( it != container_.end()
+             && it->second.has_position_limits
+             && (joint_position < it->second.min_position
+                || joint_position > it->second.max_position) ) );
 }
 
 
@@ -128,6 +132,67 @@ bool JointLimitsContainer::verifyPositionLimits(const std::vector<std::string> &
   return true;
 }
 
+JointLimitsTable JointLimitsContainer::getTable(const std::vector<std::string> &joint_names) const
+{
+  JointLimitsTable table;
+  table.reserve(joint_names.size());
+  for(const auto& joint_name : joint_names)
+  {
+    auto it = container_.find(joint_name);
+    if(it != container_.end())
+    {
+      table.addJoint(joint_name, it->second);
+    }
+    else
+    {
+      table.addUnlimitedJoint(joint_name);
+    }
+  }
+  table.setPayload(payload_);
+  return table;
+}
+
+void JointLimitsContainer::addGroupTable(const std::string &group_name, const std::vector<std::string> &joint_names)
+{
+  group_tables_[group_name] = std::make_shared<JointLimitsTable>(getTable(joint_names));
+}
+
+JointLimitsTable JointLimitsContainer::getTable(const std::string &group_name,
+                                                const std::vector<std::string> &joint_names) const
+{
+  auto it = group_tables_.find(group_name);
+  if(it != group_tables_.end())
+  {
+    if(it->second->getJointNames() == joint_names)
+    {
+      JointLimitsTable table {*(it->second)};
+      table.setPayload(payload_);
+      return table;
+    }
+    try
+    {
+      JointLimitsTable table {it->second->select(joint_names)};
+      table.setPayload(payload_);
+      return table;
+    }
+    catch(const std::out_of_range&)
+    {
+      // the joints are not (all) part of the group, compile the table below
+    }
+  }
+  return getTable(joint_names);
+}
+
+void JointLimitsContainer::setPayload(double payload)
+{
+  payload_ = payload;
+}
+
+double JointLimitsContainer::getPayload() const
+{
+  return payload_;
+}
+
 void JointLimitsContainer::updateCommonLimit(const pilz_extensions::JointLimit& joint_limit,
                                                    pilz_extensions::JointLimit& common_limit)
 {
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/joint_limits_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pilz
+{
+
+constexpr std::size_t JointLimitsTable::NO_VIOLATION;
+constexpr double JointLimitsTable::TRAJECTORY_TOLERANCE;
+constexpr std::size_t JointLimitsTable::PAYLOAD_AXIS;
+constexpr std::size_t JointLimitsTable::UNKNOWN_AXIS;
+
+static constexpr double UNLIMITED {std::numeric_limits<double>::infinity()};
+
+const char* toString(TrajectoryLimitViolation::Type type)
+{
+  switch(type)
+  {
+    case TrajectoryLimitViolation::Type::Position: return "position";
+    case TrajectoryLimitViolation::Type::Velocity: return "velocity";
+    case TrajectoryLimitViolation::Type::Acceleration: return "acceleration";
+    case TrajectoryLimitViolation::Type::Deceleration: return "deceleration";
+  }
+  return "unknown"; // LCOV_EXCL_LINE
+}
+
+void JointLimitsTable::addJoint(const std::string& joint_name, const pilz_extensions::JointLimit& joint_limit)
+{
+  joint_names_.push_back(joint_name);
+  min_positions_.push_back(joint_limit.has_position_limits ? joint_limit.min_position : -UNLIMITED);
+  max_positions_.push_back(joint_limit.has_position_limits ? joint_limit.max_position : UNLIMITED);
+  max_velocities_.push_back(joint_limit.has_velocity_limits ? joint_limit.max_velocity : UNLIMITED);
+  max_accelerations_.push_back(joint_limit.has_acceleration_limits ? std::fabs(joint_limit.max_acceleration)
+                                                                   : UNLIMITED);
+  max_decelerations_.push_back(joint_limit.has_deceleration_limits ? std::fabs(joint_limit.max_deceleration)
+                                                                   : UNLIMITED);
+
+  velocity_grids_.push_back(GridLimit{joint_limit.velocity_grid, {}});
+  acceleration_grids_.push_back(GridLimit{joint_limit.acceleration_grid, {}});
+  // like the scalar limits, the deceleration defaults to the acceleration
+  deceleration_grids_.push_back(GridLimit{joint_limit.deceleration_grid ? joint_limit.deceleration_grid
+                                                                        : joint_limit.acceleration_grid, {}});
+  if(joint_limit.velocity_grid || joint_limit.acceleration_grid || joint_limit.deceleration_grid)
+  {
+    has_grids_ = true;
+  }
+  if(has_grids_)
+  {
+    resolveGridAxes();
+  }
+}
+
+void JointLimitsTable::addUnlimitedJoint(const std::string& joint_name)
+{
+  addJoint(joint_name, pilz_extensions::JointLimit());
+}
+
+void JointLimitsTable::reserve(std::size_t joint_count)
+{
+  joint_names_.reserve(joint_count);
+  min_positions_.reserve(joint_count);
+  max_positions_.reserve(joint_count);
+  max_velocities_.reserve(joint_count);
+  max_accelerations_.reserve(joint_count);
+  max_decelerations_.reserve(joint_count);
+  velocity_grids_.reserve(joint_count);
+  acceleration_grids_.reserve(joint_count);
+  deceleration_grids_.reserve(joint_count);
+}
+
+JointLimitsTable JointLimitsTable::select(const std::vector<std::string>& joint_names) const
+{
+  JointLimitsTable table;
+  table.reserve(joint_names.size());
+  for(const auto& joint_name : joint_names)
+  {
+    auto it = std::find(joint_names_.begin(), joint_names_.end(), joint_name);
+    if(it == joint_names_.end())
+    {
+      throw std::out_of_range("No limits of joint " + joint_name + " in the table");
+    }
+    const std::size_t i {static_cast<std::size_t>(it - joint_names_.begin())};
+    table.joint_names_.push_back(joint_name);
+    table.min_positions_.push_back(min_positions_[i]);
+    table.max_positions_.push_back(max_positions_[i]);
+    table.max_velocities_.push_back(max_velocities_[i]);
+    table.max_accelerations_.push_back(max_accelerations_[i]);
+    table.max_decelerations_.push_back(max_decelerations_[i]);
+    table.velocity_grids_.push_back(velocity_grids_[i]);
+    table.acceleration_grids_.push_back(acceleration_grids_[i]);
+    table.deceleration_grids_.push_back(deceleration_grids_[i]);
+  }
+  table.has_grids_ = has_grids_;
+  table.payload_ = payload_;
+  if(table.has_grids_)
+  {
+    table.resolveGridAxes();
+  }
+  return table;
+}
+
+void JointLimitsTable::resolveGridAxes()
+{
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    resolveGridAxes(velocity_grids_[i]);
+    resolveGridAxes(acceleration_grids_[i]);
+    resolveGridAxes(deceleration_grids_[i]);
+  }
+}
+
+void JointLimitsTable::resolveGridAxes(GridLimit& grid_limit) const
+{
+  grid_limit.axis_joints.clear();
+  if(!grid_limit.grid)
+  {
+    return;
+  }
+  for(const auto& axis : grid_limit.grid->getAxes())
+  {
+    if(axis.name == pilz_extensions::JointLimitsGrid::getPayloadAxisName())
+    {
+      grid_limit.axis_joints.push_back(PAYLOAD_AXIS);
+      continue;
+    }
+    auto it = std::find(joint_names_.begin(), joint_names_.end(), axis.name);
+    grid_limit.axis_joints.push_back(it != joint_names_.end() ? static_cast<std::size_t>(it - joint_names_.begin())
+                                                              : UNKNOWN_AXIS);
+  }
+}
+
+double JointLimitsTable::getGridCoordinate(std::size_t axis_joint, const double* positions) const
+{
+  if(axis_joint == PAYLOAD_AXIS)
+  {
+    return payload_;
+  }
+  return axis_joint == UNKNOWN_AXIS ? std::numeric_limits<double>::quiet_NaN() : positions[axis_joint];
+}
+
+double JointLimitsTable::getGridLimit(const GridLimit& grid_limit, double limit, const double* positions) const
+{
+  if(!grid_limit.grid || !positions)
+  {
+    return limit;
+  }
+  double coordinates[pilz_extensions::JointLimitsGrid::MAX_AXES];
+  for(std::size_t k = 0; k < grid_limit.axis_joints.size(); ++k)
+  {
+    coordinates[k] = getGridCoordinate(grid_limit.axis_joints[k], positions);
+  }
+  return std::min(limit, grid_limit.grid->interpolate(coordinates));
+}
+
+double JointLimitsTable::getMinimalGridLimit(const GridLimit& grid_limit, double limit,
+                                             const double* start_positions, const double* goal_positions) const
+{
+  if(!grid_limit.grid)
+  {
+    return limit;
+  }
+  double lower[pilz_extensions::JointLimitsGrid::MAX_AXES];
+  double upper[pilz_extensions::JointLimitsGrid::MAX_AXES];
+  for(std::size_t k = 0; k < grid_limit.axis_joints.size(); ++k)
+  {
+    const double start {getGridCoordinate(grid_limit.axis_joints[k], start_positions)};
+    const double goal {getGridCoordinate(grid_limit.axis_joints[k], goal_positions)};
+    lower[k] = std::min(start, goal);
+    upper[k] = std::max(start, goal);
+    if(std::isnan(start) || std::isnan(goal))
+    {
+      lower[k] = upper[k] = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+  return std::min(limit, grid_limit.grid->getMinimum(lower, upper));
+}
+
+void JointLimitsTable::getMinimalLimits(const double* start_positions,
+                                        const double* goal_positions,
+                                        double* max_velocities,
+                                        double* max_accelerations,
+                                        double* max_decelerations) const
+{
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    max_velocities[i] = max_velocities_[i];
+    max_accelerations[i] = max_accelerations_[i];
+    max_decelerations[i] = max_decelerations_[i];
+    if(has_grids_)
+    {
+      max_velocities[i] = getMinimalGridLimit(velocity_grids_[i], max_velocities[i], start_positions, goal_positions);
+      max_accelerations[i] = getMinimalGridLimit(acceleration_grids_[i], max_accelerations[i],
+                                                 start_positions, goal_positions);
+      max_decelerations[i] = getMinimalGridLimit(deceleration_grids_[i], max_decelerations[i],
+                                                 start_positions, goal_positions);
+    }
+  }
+}
+
+std::size_t JointLimitsTable::findPositionViolation(const double* positions) const
+{
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    if(positions[i] < min_positions_[i] || positions[i] > max_positions_[i])
+    {
+      return i;
+    }
+  }
+  return NO_VIOLATION;
+}
+
+std::size_t JointLimitsTable::findVelocityViolation(const double* velocities, const double* positions) const
+{
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    if(std::fabs(velocities[i]) > getMaxVelocity(i, positions))
+    {
+      return i;
+    }
+  }
+  return NO_VIOLATION;
+}
+
+std::size_t JointLimitsTable::findAccelerationViolation(const double* velocities_last,
+                                                        const double* accelerations,
+                                                        const double* positions) const
+{
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    const double max_acceleration {isDeceleration(velocities_last[i], accelerations[i])
+                                   ? getMaxDeceleration(i, positions) : getMaxAcceleration(i, positions)};
+    if(std::fabs(accelerations[i]) > max_acceleration)
+    {
+      return i;
+    }
+  }
+  return NO_VIOLATION;
+}
+
+bool JointLimitsTable::findTrajectoryViolation(std::size_t waypoint_count,
+                                               const double* positions,
+                                               const double* velocities,
+                                               const double* accelerations,
+                                               TrajectoryLimitViolation& violation) const
+{
+  const std::size_t joint_count {joint_names_.size()};
+  const double factor {1. + TRAJECTORY_TOLERANCE};
+
+  // the limits of the current waypoint, the scalar limits unless there are configuration dependent limits
+  std::vector<double> waypoint_limits(has_grids_ ? 3 * joint_count : 0);
+  const double* max_velocities {has_grids_ ? waypoint_limits.data() : max_velocities_.data()};
+  const double* max_accelerations {has_grids_ ? waypoint_limits.data() + joint_count : max_accelerations_.data()};
+  const double* max_decelerations {has_grids_ ? waypoint_limits.data() + 2 * joint_count
+                                              : max_decelerations_.data()};
+
+  for(std::size_t i = 0; i < waypoint_count; ++i)
+  {
+    const double* p {positions + i * joint_count};
+    const double* v {velocities + i * joint_count};
+    const double* a {accelerations + i * joint_count};
+
+    if(has_grids_)
+    {
+      for(std::size_t j = 0; j < joint_count; ++j)
+      {
+        waypoint_limits[j] = getGridLimit(velocity_grids_[j], max_velocities_[j], p);
+        waypoint_limits[joint_count + j] = getGridLimit(acceleration_grids_[j], max_accelerations_[j], p);
+        waypoint_limits[2 * joint_count + j] = getGridLimit(deceleration_grids_[j], max_decelerations_[j], p);
+      }
+    }
+
+    // no early exit, so that the compiler can vectorize the loop
+    bool violated {false};
+    for(std::size_t j = 0; j < joint_count; ++j)
+    {
+      const double max_acceleration {isDeceleration(v[j], a[j]) ? max_decelerations[j] : max_accelerations[j]};
+      violated |= (p[j] < min_positions_[j] - TRAJECTORY_TOLERANCE)
+                | (p[j] > max_positions_[j] + TRAJECTORY_TOLERANCE)
+                | (std::fabs(v[j]) > max_velocities[j] * factor)
+                | (std::fabs(a[j]) > max_acceleration * factor);
+    }
+
+    if(violated)
+    {
+      getWayPointViolation(i, p, v, a, max_velocities, max_accelerations, max_decelerations, violation);
+      return true;
+    }
+  }
+  return false;
+}
+
+void JointLimitsTable::getWayPointViolation(std::size_t waypoint,
+                                            const double* positions,
+                                            const double* velocities,
+                                            const double* accelerations,
+                                            const double* max_velocities,
+                                            const double* max_accelerations,
+                                            const double* max_decelerations,
+                                            TrajectoryLimitViolation& violation) const
+{
+  violation.waypoint = waypoint;
+  const double factor {1. + TRAJECTORY_TOLERANCE};
+  for(std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    violation.joint = j;
+    if(positions[j] < min_positions_[j] - TRAJECTORY_TOLERANCE)
+    {
+      violation.type = TrajectoryLimitViolation::Type::Position;
+      violation.value = positions[j];
+      violation.limit = min_positions_[j];
+      return;
+    }
+    if(positions[j] > max_positions_[j] + TRAJECTORY_TOLERANCE)
+    {
+      violation.type = TrajectoryLimitViolation::Type::Position;
+      violation.value = positions[j];
+      violation.limit = max_positions_[j];
+      return;
+    }
+    if(std::fabs(velocities[j]) > max_velocities[j] * factor)
+    {
+      violation.type = TrajectoryLimitViolation::Type::Velocity;
+      violation.value = velocities[j];
+      violation.limit = max_velocities[j];
+      return;
+    }
+    const bool is_deceleration {isDeceleration(velocities[j], accelerations[j])};
+    const double max_acceleration {is_deceleration ? max_decelerations[j] : max_accelerations[j]};
+    if(std::fabs(accelerations[j]) > max_acceleration * factor)
+    {
+      violation.type = is_deceleration ? TrajectoryLimitViolation::Type::Deceleration
+                                       : TrajectoryLimitViolation::Type::Acceleration;
+      violation.value = accelerations[j];
+      violation.limit = max_acceleration;
+      return;
+    }
+  }
+}
+
+}
@@ -19,7 +19,8 @@
 
 pilz::LimitsContainer::LimitsContainer():
   has_joint_limits_(false),
-  has_cartesian_limits_(false)
+  has_cartesian_limits_(false),
+  has_group_common_limits_(false)
 {
 
 }
@@ -59,3 +60,34 @@ const pilz::CartesianLimit& pilz::LimitsContainer::getCartesianLimits() const
 {
   return cartesian_limit_;
 }
+
+bool pilz::LimitsContainer::hasGroupCommonLimits() const
+{
+  return has_group_common_limits_;
+}
+
+void pilz::LimitsContainer::setGroupCommonLimits(const pilz_extensions::JointLimitsMap& group_common_limits)
+{
+  has_group_common_limits_ = true;
+  group_common_limits_ = group_common_limits;
+}
+
+const pilz_extensions::JointLimitsMap& pilz::LimitsContainer::getGroupCommonLimits() const
+{
+  return group_common_limits_;
+}
+
+void pilz::LimitsContainer::setPayload(double payload)
+{
+  joint_limits_.setPayload(payload);
+}
+
+void pilz::LimitsContainer::setGoalIkOptions(const GoalIkOptionsMap& goal_ik_options)
+{
+  goal_ik_options_ = goal_ik_options;
+}
+
+const pilz::GoalIkOptionsMap& pilz::LimitsContainer::getGoalIkOptions() const
+{
+  return goal_ik_options_;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/monotonic_arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace pilz
+{
+
+constexpr std::size_t MonotonicArena::DEFAULT_BLOCK_SIZE;
+
+MonotonicArena::MonotonicArena(std::size_t initial_block_size)
+  : initial_block_size_(std::max(initial_block_size, static_cast<std::size_t>(1)))
+  , next_block_size_(initial_block_size_)
+{
+}
+
+void* MonotonicArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+  if (bytes == 0)
+  {
+    bytes = 1;
+  }
+
+  if (!current_ || !std::align(alignment, bytes, current_, remaining_))
+  {
+    addBlock(bytes + alignment);
+    if (!std::align(alignment, bytes, current_, remaining_))
+    {
+      throw std::bad_alloc(); // LCOV_EXCL_LINE
+    }
+  }
+
+  void* res {current_};
+  current_ = static_cast<char*>(current_) + bytes;
+  remaining_ -= bytes;
+  return res;
+}
+
+void MonotonicArena::release()
+{
+  blocks_.clear();
+  current_ = nullptr;
+  remaining_ = 0;
+  next_block_size_ = initial_block_size_;
+}
+
+void MonotonicArena::addBlock(std::size_t min_size)
+{
+  const std::size_t block_size {std::max(next_block_size_, min_size)};
+  blocks_.emplace_back(new char[block_size]);
+  current_ = blocks_.back().get();
+  remaining_ = block_size;
+  // grow geometrically to keep the number of blocks small
+  next_block_size_ = 2 * block_size;
+}
+
+}
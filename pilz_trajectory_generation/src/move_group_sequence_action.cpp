@@ -38,6 +38,7 @@
 
 #include "pilz_trajectory_generation/move_group_sequence_action.h"
 
+#include <algorithm>
 #include <time.h>
 
 #include <moveit/planning_pipeline/planning_pipeline.h>
@@ -46,10 +47,43 @@
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/robot_state/conversions.h>
+#include <ros/serialization.h>
 
+#include <pilz_msgs/GetSpeedOverride.h>
+
+#include "pilz_trajectory_generation/capability_names.h"
 #include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/planning_request_recorder.h"
+#include "pilz_trajectory_generation/planning_statistics.h"
 #include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
 
+namespace
+{
+
+//! Maximal distance of the current robot state from the start of a reused trajectory.
+constexpr double REUSE_START_STATE_TOLERANCE {1e-4};
+
+/**
+ * @return True if both requests are serialized to the same bytes.
+ */
+bool isSameRequest(const pilz_msgs::MotionSequenceRequest& req_a, const pilz_msgs::MotionSequenceRequest& req_b)
+{
+  const uint32_t length {ros::serialization::serializationLength(req_a)};
+  if(length != ros::serialization::serializationLength(req_b))
+  {
+    return false;
+  }
+  std::vector<uint8_t> buffer_a(length);
+  std::vector<uint8_t> buffer_b(length);
+  ros::serialization::OStream stream_a(buffer_a.data(), length);
+  ros::serialization::OStream stream_b(buffer_b.data(), length);
+  ros::serialization::serialize(stream_a, req_a);
+  ros::serialization::serialize(stream_b, req_b);
+  return buffer_a == buffer_b;
+}
+
+}
+
 namespace pilz_trajectory_generation
 {
 
@@ -71,10 +105,29 @@ void MoveGroupSequenceAction::initialize()
   command_list_manager_.reset(new pilz_trajectory_generation::CommandListManager (
                             ros::NodeHandle("~"), context_->planning_scene_monitor_->getRobotModel()));
 
+  std::shared_ptr<PlanningStatistics> statistics {std::make_shared<PlanningStatistics>()};
+  statistics->advertise(root_node_handle_, SEQUENCE_ACTION_STATISTICS_TOPIC);
+  command_list_manager_->setStatistics(statistics);
+
+  pilz::PlanningRequestRecorder::getInstance().openFromParameter(ros::NodeHandle("~"),
+                                                                 *context_->planning_scene_monitor_->getRobotModel());
+
+  std::string speed_override_service;
+  if(ros::NodeHandle("~").getParam(SPEED_OVERRIDE_SERVICE_PARAM, speed_override_service)
+     && !speed_override_service.empty())
+  {
+    ROS_INFO_STREAM("Applying the speed override of " << speed_override_service << " to executed sequences");
+    speed_override_client_ = root_node_handle_.serviceClient<pilz_msgs::GetSpeedOverride>(speed_override_service);
+  }
 }
 
 void MoveGroupSequenceAction::executeSequenceCallback(const pilz_msgs::MoveGroupSequenceGoalConstPtr& goal)
 {
+  const pilz::CancellationToken cancellation {resetCancellationToken()};
+  if(move_action_server_->isPreemptRequested())
+  {
+    cancellation.cancel();
+  }
   setMoveState(move_group::PLANNING);
 
   // Handle empty requests
@@ -99,11 +152,11 @@ void MoveGroupSequenceAction::executeSequenceCallback(const pilz_msgs::MoveGroup
     {
       ROS_WARN("Only plan will be calculated, although plan_only == false."); //LCOV_EXCL_LINE
     }
-    executeMoveCallbackPlanOnly(goal, action_res);
+    executeMoveCallbackPlanOnly(goal, cancellation, action_res);
   }
   else
   {
-    executeSequenceCallbackPlanAndExecute(goal, action_res);
+    executeSequenceCallbackPlanAndExecute(goal, cancellation, action_res);
   }
 
   switch(action_res.error_code.val)
@@ -123,6 +176,7 @@ void MoveGroupSequenceAction::executeSequenceCallback(const pilz_msgs::MoveGroup
 }
 
 void MoveGroupSequenceAction::executeSequenceCallbackPlanAndExecute(const pilz_msgs::MoveGroupSequenceGoalConstPtr& goal,
+                                                                     const pilz::CancellationToken& cancellation,
                                                                      pilz_msgs::MoveGroupSequenceResult& action_res)
 {
   ROS_INFO("Combined planning and execution request received for MoveGroupSequenceAction.");
@@ -140,7 +194,8 @@ void MoveGroupSequenceAction::executeSequenceCallbackPlanAndExecute(const pilz_m
   opt.before_execution_callback_ = boost::bind(&MoveGroupSequenceAction::startMoveExecutionCallback, this);
 
   opt.plan_callback_ =
-      boost::bind(&MoveGroupSequenceAction::planUsingSequenceManager, this, boost::cref(goal->request), _1);
+      boost::bind(&MoveGroupSequenceAction::planUsingSequenceManager, this, boost::cref(goal->request),
+                  cancellation, _1);
 
   if (goal->planning_options.look_around && context_->plan_with_sensing_)
   {
@@ -168,6 +223,7 @@ void MoveGroupSequenceAction::convertToMsg(const ExecutableTrajs& trajs,
 }
 
 void MoveGroupSequenceAction::executeMoveCallbackPlanOnly(const pilz_msgs::MoveGroupSequenceGoalConstPtr& goal,
+                                                           const pilz::CancellationToken& cancellation,
                                                            pilz_msgs::MoveGroupSequenceResult& res)
 {
   ROS_INFO("Planning request received for MoveGroupSequenceAction action.");
@@ -180,11 +236,14 @@ void MoveGroupSequenceAction::executeMoveCallbackPlanOnly(const pilz_msgs::MoveG
         static_cast<const planning_scene::PlanningSceneConstPtr&>(lscene) :
         lscene->diff(goal->planning_options.planning_scene_diff);
 
+  pilz::PlanningRequestRecorder::getInstance().record(pilz_msgs::PlanningRequestRecord::SEQUENCE_ACTION,
+                                                      the_scene, goal->request);
+
   ros::Time planning_start = ros::Time::now();
   RobotTrajCont traj_vec;
   try
   {
-    traj_vec = command_list_manager_->solve(the_scene, context_->planning_pipeline_, goal->request);
+    traj_vec = command_list_manager_->solve(the_scene, context_->planning_pipeline_, goal->request, cancellation);
   }
   catch(const MoveItErrorCodeException& ex)
   {
@@ -215,13 +274,52 @@ void MoveGroupSequenceAction::executeMoveCallbackPlanOnly(const pilz_msgs::MoveG
 }
 
 bool MoveGroupSequenceAction::planUsingSequenceManager(const pilz_msgs::MotionSequenceRequest& req,
+                                                       const pilz::CancellationToken& cancellation,
                                                        plan_execution::ExecutableMotionPlan& plan)
 {
   setMoveState(move_group::PLANNING);
 
   planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor_);
+  pilz::PlanningRequestRecorder::getInstance().record(pilz_msgs::PlanningRequestRecord::SEQUENCE_ACTION,
+                                                      plan.planning_scene_, req);
+
+  // The speed override is applied to the planned trajectories, so that a changed override does not need a new plan
+  double speed_override {1.};
+  if(speed_override_client_ && !getSpeedOverride(speed_override))
+  {
+    plan.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+    return false;
+  }
+
   RobotTrajCont traj_vec;
-  try { traj_vec = command_list_manager_->solve(plan.planning_scene_, context_->planning_pipeline_, req); }
+  try
+  {
+    // The reused trajectories are slowed down with the limits of the payload they were planned with
+    pilz::PayloadScope payload_scope(CommandListManager::getPayload(plan.planning_scene_.get(), req));
+    if(speed_override_client_ && isLastPlanReusable(req, *plan.planning_scene_))
+    {
+      ROS_INFO_STREAM("Executing the trajectories of the last goal with speed override " << speed_override);
+      traj_vec = last_trajectories_;
+    }
+    else
+    {
+      last_trajectories_.clear();
+      // taken before planning, a configuration updated while planning leads to a new plan for the next goal
+      pilz::PlanningConfigurationConstPtr configuration {command_list_manager_->getConfiguration()};
+      traj_vec = command_list_manager_->solve(plan.planning_scene_, context_->planning_pipeline_, req, cancellation);
+      if(speed_override_client_)
+      {
+        last_request_ = req;
+        last_trajectories_ = traj_vec;
+        last_configuration_ = configuration;
+      }
+    }
+
+    if(speed_override_client_)
+    {
+      traj_vec = command_list_manager_->applySpeedOverride(traj_vec, speed_override);
+    }
+  }
   catch(const MoveItErrorCodeException& ex)
   {
     ROS_ERROR_STREAM("Planning pipeline threw an exception (error code: "
@@ -251,6 +349,66 @@ bool MoveGroupSequenceAction::planUsingSequenceManager(const pilz_msgs::MotionSe
   return true;
 }
 
+bool MoveGroupSequenceAction::getSpeedOverride(double& speed_override)
+{
+  pilz_msgs::GetSpeedOverride srv;
+  if(!speed_override_client_.call(srv))
+  {
+    ROS_ERROR_STREAM("Failed to get the speed override from " << speed_override_client_.getService());
+    return false;
+  }
+  speed_override = srv.response.speed_override;
+  return true;
+}
+
+bool MoveGroupSequenceAction::isLastPlanReusable(const pilz_msgs::MotionSequenceRequest& req,
+                                                 const planning_scene::PlanningScene& scene) const
+{
+  if(last_trajectories_.empty() || !isSameRequest(req, last_request_))
+  {
+    return false;
+  }
+
+  // The speed override only slows the trajectories down, so they keep the joint and cartesian limits
+  // (including the frame speed limit) they were planned with. Reduced or reloaded limits require a new plan.
+  if(command_list_manager_->getConfiguration() != last_configuration_)
+  {
+    ROS_INFO_STREAM("Planning configuration changed since the last goal was planned, replanning");
+    return false;
+  }
+
+  // the robot must be at the start of the first trajectory of each group
+  const robot_state::RobotState& current_state {scene.getCurrentState()};
+  std::vector<std::string> group_names;
+  for(const auto& trajectory : last_trajectories_)
+  {
+    const std::string& group_name {trajectory->getGroupName()};
+    if(trajectory->empty() || std::find(group_names.begin(), group_names.end(), group_name) != group_names.end())
+    {
+      continue;
+    }
+    group_names.push_back(group_name);
+    const robot_state::RobotState& start_state {trajectory->getFirstWayPoint()};
+    const double distance {trajectory->getGroup() ? start_state.distance(current_state, trajectory->getGroup())
+                                                  : start_state.distance(current_state)};
+    if(distance > REUSE_START_STATE_TOLERANCE)
+    {
+      return false;
+    }
+  }
+
+  // the scene may have changed since the last goal was planned
+  for(const auto& trajectory : last_trajectories_)
+  {
+    if(!scene.isPathValid(*trajectory, trajectory->getGroupName()))
+    {
+      ROS_INFO_STREAM("Trajectories of the last goal are not valid in the current planning scene, replanning");
+      return false;
+    }
+  }
+  return true;
+}
+
 void MoveGroupSequenceAction::startMoveExecutionCallback()
 {
   setMoveState(move_group::MONITOR);
@@ -258,9 +416,20 @@ void MoveGroupSequenceAction::startMoveExecutionCallback()
 
 void MoveGroupSequenceAction::preemptMoveCallback()
 {
+  {
+    std::lock_guard<std::mutex> lock(cancellation_mutex_);
+    cancellation_.cancel();
+  }
   context_->plan_execution_->stop();
 }
 
+pilz::CancellationToken MoveGroupSequenceAction::resetCancellationToken()
+{
+  std::lock_guard<std::mutex> lock(cancellation_mutex_);
+  cancellation_ = pilz::CancellationToken::create();
+  return cancellation_;
+}
+
 void MoveGroupSequenceAction::setMoveState(move_group::MoveGroupState state)
 {
   move_state_ = state;
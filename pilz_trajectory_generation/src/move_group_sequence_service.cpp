@@ -38,13 +38,24 @@
 
 #include "pilz_trajectory_generation/move_group_sequence_service.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "pilz_trajectory_generation/capability_names.h"
 #include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/planning_request_recorder.h"
+#include "pilz_trajectory_generation/planning_statistics.h"
 #include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
 
 namespace pilz_trajectory_generation
 {
 
+static const std::string PARAM_BATCH_PLANNING_THREADS = "batch_planning_threads";
+
 MoveGroupSequenceService::MoveGroupSequenceService() : MoveGroupCapability("SequenceService")
 {
 }
@@ -58,9 +69,39 @@ void MoveGroupSequenceService::initialize()
   command_list_manager_.reset(new pilz_trajectory_generation::CommandListManager(ros::NodeHandle("~"),
                                                                              context_->planning_scene_monitor_->getRobotModel()));
 
+  std::shared_ptr<PlanningStatistics> statistics {std::make_shared<PlanningStatistics>()};
+  statistics->advertise(root_node_handle_, SEQUENCE_SERVICE_STATISTICS_TOPIC);
+  command_list_manager_->setStatistics(statistics);
+
+  pilz::PlanningRequestRecorder::getInstance().openFromParameter(ros::NodeHandle("~"),
+                                                                 *context_->planning_scene_monitor_->getRobotModel());
+
   sequence_service_ = root_node_handle_.advertiseService(SEQUENCE_SERVICE_NAME,
                                                          &MoveGroupSequenceService::plan,
                                                          this);
+
+  // The planning pipeline is not thread-safe, so every worker thread gets its own instance.
+  int threads {1};
+  ros::NodeHandle("~").param(PARAM_BATCH_PLANNING_THREADS, threads, threads);
+  batch_planning_threads_ = static_cast<unsigned int>(std::max(threads, 1));
+  if(batch_planning_threads_ > 1)
+  {
+    // same parameters as the pipeline of the move_group node, without publishing the plans of the workers
+    for(unsigned int i = 0; i < batch_planning_threads_; ++i)
+    {
+      planning_pipeline::PlanningPipelinePtr pipeline {std::make_shared<planning_pipeline::PlanningPipeline>(
+                                                         context_->planning_scene_monitor_->getRobotModel(),
+                                                         ros::NodeHandle("~"))};
+      pipeline->displayComputedMotionPlans(false);
+      pipeline->publishReceivedRequests(false);
+      pipeline->checkSolutionPaths(context_->planning_pipeline_->getCheckSolutionPaths());
+      batch_pipelines_.push_back(pipeline);
+    }
+  }
+
+  sequence_batch_service_ = root_node_handle_.advertiseService(SEQUENCE_BATCH_SERVICE_NAME,
+                                                               &MoveGroupSequenceService::planBatch,
+                                                               this);
 }
 
 bool MoveGroupSequenceService::plan(pilz_msgs::GetMotionSequence::Request& req,
@@ -69,9 +110,12 @@ bool MoveGroupSequenceService::plan(pilz_msgs::GetMotionSequence::Request& req,
   // TODO: Do we lock on the correct scene? Does the lock belong to the scene used for planning?
   planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_);
 
+  pilz::PlanningRequestRecorder::getInstance().record(pilz_msgs::PlanningRequestRecord::SEQUENCE_SERVICE,
+                                                      ps, req.commands);
+
   ros::Time planning_start = ros::Time::now();
   RobotTrajCont traj_vec;
-  try { traj_vec = command_list_manager_->solve(ps, context_->planning_pipeline_, req.commands); }
+  try { traj_vec = command_list_manager_->solve(ps, context_->planning_pipeline_, std::move(req.commands)); }
   catch(const MoveItErrorCodeException& ex)
   {
     ROS_ERROR_STREAM("Planner threw an exception (error code: "
@@ -101,6 +145,93 @@ bool MoveGroupSequenceService::plan(pilz_msgs::GetMotionSequence::Request& req,
   return true;
 }
 
+bool MoveGroupSequenceService::planBatch(pilz_msgs::GetMotionSequenceBatch::Request& req,
+                                         pilz_msgs::GetMotionSequenceBatch::Response& res)
+{
+  ros::Time planning_start = ros::Time::now();
+
+  // Plan all sequences against the same snapshot, so that the scene is only locked while copying it
+  planning_scene::PlanningSceneConstPtr scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_);
+    scene = planning_scene::PlanningScene::clone(ps);
+  }
+
+  res.results.resize(req.sequences.size());
+  std::atomic<std::size_t> next_index {0};
+  auto worker = [this, &req, &res, &scene, &next_index](const planning_pipeline::PlanningPipelinePtr& pipeline)
+  {
+    for(std::size_t i = next_index++; i < req.sequences.size(); i = next_index++)
+    {
+      planSequence(scene, pipeline, std::move(req.sequences.at(i)), res.results.at(i));
+    }
+  };
+
+  const std::size_t num_threads {std::min<std::size_t>(batch_planning_threads_, req.sequences.size())};
+  if(batch_pipelines_.empty())
+  {
+    worker(context_->planning_pipeline_);
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for(std::size_t i = 0; i < num_threads; ++i)
+    {
+      threads.emplace_back(worker, batch_pipelines_.at(i));
+    }
+    for(auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  res.planning_time = (ros::Time::now() - planning_start).toSec();
+  ROS_DEBUG_STREAM("Planned batch of " << req.sequences.size() << " sequences with " << num_threads
+                   << " threads in " << res.planning_time << "s");
+  return true;
+}
+
+void MoveGroupSequenceService::planSequence(const planning_scene::PlanningSceneConstPtr& scene,
+                                            const planning_pipeline::PlanningPipelinePtr& pipeline,
+                                            pilz_msgs::MotionSequenceRequest&& req,
+                                            pilz_msgs::MotionSequenceResponse& res) const
+{
+  pilz::PlanningRequestRecorder::getInstance().record(pilz_msgs::PlanningRequestRecord::SEQUENCE_SERVICE,
+                                                      scene, req);
+
+  ros::Time planning_start = ros::Time::now();
+  RobotTrajCont traj_vec;
+  try { traj_vec = command_list_manager_->solve(scene, pipeline, std::move(req)); }
+  catch(const MoveItErrorCodeException& ex)
+  {
+    ROS_ERROR_STREAM("Planner threw an exception (error code: "
+                     << ex.getErrorCode() << "): " << ex.what());
+    res.error_code.val = ex.getErrorCode();
+    return;
+  }
+  // LCOV_EXCL_START // Keep moveit up even if lower parts throw
+  catch (const std::exception& ex)
+  {
+    ROS_ERROR_STREAM("Planner threw an exception: " << ex.what());
+    res.error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+    return;
+  }
+  // LCOV_EXCL_STOP
+
+  res.trajectory_start.resize(traj_vec.size());
+  res.planned_trajectory.resize(traj_vec.size());
+  for (RobotTrajCont::size_type i = 0; i < traj_vec.size(); ++i)
+  {
+    move_group::MoveGroupCapability::convertToMsg(traj_vec.at(i),
+                                                  res.trajectory_start.at(i),
+                                                  res.planned_trajectory.at(i));
+  }
+  res.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  res.planning_time = (ros::Time::now() - planning_start).toSec();
+}
+
 } // namespace pilz_trajectory_generation
 
 #include <pluginlib/class_list_macros.h>
@@ -21,8 +21,11 @@
 #include "pilz_trajectory_generation/planning_context_loader_ptp.h"
 #include "pilz_trajectory_generation/planning_exceptions.h"
 
-#include "pilz_trajectory_generation/joint_limits_aggregator.h"
-#include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/capability_names.h"
+#include "pilz_trajectory_generation/diagnostics.h"
+#include "pilz_trajectory_generation/planning_request_recorder.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
 
 // Boost includes
 #include <boost/scoped_ptr.hpp>
@@ -44,12 +47,9 @@ bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, c
   model_ = model;
   namespace_ = ns;
 
-  // Obtain the aggregated joint limits
-  aggregated_limit_active_joints_ = pilz::JointLimitsAggregator::getAggregatedLimits(
-        ros::NodeHandle(PARAM_NAMESPACE_LIMTS),model->getActiveJointModels());
-
-  // Obtain cartesian limits
-  cartesian_limit_ = pilz::CartesianLimitsAggregator::getAggregatedLimits(ros::NodeHandle(PARAM_NAMESPACE_LIMTS));
+  // Obtain the limits and the sampling times of the planning groups (built once, shared with the capabilities)
+  configuration_ = pilz::PlanningConfigurationRegistry::getInstance().getSharedConfiguration(
+        ros::NodeHandle(PARAM_NAMESPACE_LIMTS), model_);
 
   // Load the planning context loader
   planner_context_loader.reset(new pluginlib::ClassLoader<PlanningContextLoader>("pilz_trajectory_generation",
@@ -72,17 +72,27 @@ bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, c
     ROS_INFO_STREAM("About to load: " << factory);
     PlanningContextLoaderPtr loader_pointer(planner_context_loader->createInstance(factory));
 
-    pilz::LimitsContainer limits;
-    limits.setJointLimits(aggregated_limit_active_joints_);
-    limits.setCartesianLimits(cartesian_limit_);
-
-    loader_pointer->setLimits(limits);
+    // The contexts get the limits which are current when they are loaded
+    loader_pointer->setConfiguration(configuration_);
     loader_pointer->setModel(model_);
 
     registerContextLoader(loader_pointer);
 
   }
 
+  // Allow to switch the limits (e.g. of another operating mode) without restarting the node
+  update_planning_limits_service_ = ros::NodeHandle("~").advertiseService(
+        pilz_trajectory_generation::UPDATE_PLANNING_LIMITS_SERVICE_NAME, &CommandPlanner::updatePlanningLimits, this);
+
+  // Bound the log messages per plan, if configured for the node
+  pilz::Diagnostics::getInstance().configureFromParameter(ros::NodeHandle("~"));
+
+  // Record the planning spans, if a trace file is configured for the node
+  pilz::TraceRecorder::getInstance().openFromParameter(ros::NodeHandle("~"));
+
+  // Record the planning requests, if a request log file is configured for the node
+  pilz::PlanningRequestRecorder::getInstance().openFromParameter(ros::NodeHandle("~"), *model_);
+
   return true;
 }
 
@@ -106,20 +116,41 @@ planning_interface::PlanningContextPtr CommandPlanner::getPlanningContext(
                                                       const moveit_msgs::MotionPlanRequest& req,
                                                       moveit_msgs::MoveItErrorCodes& error_code) const
 {
-  ROS_DEBUG_STREAM("Loading PlanningContext for request\n<request>\n" << req << "\n</request>");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Planner,
+                    "Loading PlanningContext for planner_id " << req.planner_id << " group: " << req.group_name);
 
   // Check that a loaded for this request exists
   if(!canServiceRequest(req))
   {
-    ROS_ERROR_STREAM("No ContextLoader for planner_id " << req.planner_id.c_str() << " found. Planning not possible.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Planner,
+                      "No ContextLoader for planner_id " << req.planner_id.c_str() << " found. Planning not possible.");
     return nullptr;
   }
 
+  // Requests of a sequence are already recorded by the sequence capabilities
+  pilz::PlanningRequestRecorder::getInstance().record(pilz_msgs::PlanningRequestRecord::COMMAND_PLANNER,
+                                                      planning_scene, req);
+
+  // The payload of a sequence is set by the sequence capabilities
+  const double* scope_payload {pilz::PayloadScope::getCurrentPayload()};
+  const double payload {scope_payload ? *scope_payload
+                                      : getAttachedPayload(req.start_state,
+                                                           planning_scene ? &planning_scene->getCurrentState()
+                                                                          : nullptr)};
+  pilz::PayloadScope payload_scope(payload);
+  if(configuration_)
+  {
+    const pilz::PayloadProfile* profile {configuration_->get()->getPayloadProfile(payload)};
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Planner,
+                      "Payload " << payload << " kg, limits of profile " << (profile ? profile->name : "(none)"));
+  }
+
   planning_interface::PlanningContextPtr planning_context;
 
   if(context_loader_map_.at(req.planner_id)->loadContext(planning_context, req.planner_id, req.group_name))
   {
-    ROS_DEBUG_STREAM("Found planning context loader for " << req.planner_id << " group:" << req.group_name);
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Planner,
+                      "Found planning context loader for " << req.planner_id << " group:" << req.group_name);
     planning_context->setMotionPlanRequest(req);
     planning_context->setPlanningScene(planning_scene);
     return planning_context;
@@ -151,6 +182,32 @@ void CommandPlanner::registerContextLoader(const pilz::PlanningContextLoaderPtr&
   }
 }
 
+bool CommandPlanner::updatePlanningLimits(pilz_msgs::UpdatePlanningLimits::Request& req,
+                                          pilz_msgs::UpdatePlanningLimits::Response& res)
+{
+  try
+  {
+    // 0 (the default of the field) keeps the current reduction factor
+    if(req.reduction_factor == 0.)
+    {
+      pilz::PlanningConfigurationRegistry::getInstance().updateConfigurations(req.reload_limits);
+    }
+    else
+    {
+      pilz::PlanningConfigurationRegistry::getInstance().updateConfigurations(req.reload_limits,
+                                                                             req.reduction_factor);
+    }
+    res.success = true;
+  }
+  catch(const std::exception& ex)
+  {
+    ROS_ERROR_STREAM("Failed to update the planning limits: " << ex.what());
+    res.success = false;
+    res.error_msg = ex.what();
+  }
+  return true;
+}
+
 } // namespace pilz
 
 PLUGINLIB_EXPORT_CLASS(pilz::CommandPlanner, planning_interface::PlannerManager)
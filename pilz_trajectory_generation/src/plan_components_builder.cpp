@@ -18,6 +18,7 @@
 #include "pilz_trajectory_generation/plan_components_builder.h"
 
 #include <cassert>
+#include <cmath>
 
 #include <pilz_trajectory_generation/tip_frame_getter.h>
 
@@ -26,33 +27,120 @@ namespace pilz_trajectory_generation
 
 std::vector<robot_trajectory::RobotTrajectoryPtr> PlanComponentsBuilder::build() const
 {
-  std::vector<robot_trajectory::RobotTrajectoryPtr> res_vec {traj_cont_};
-  if (traj_tail_)
+  std::vector<robot_trajectory::RobotTrajectoryPtr> res_vec;
+  res_vec.reserve(traj_cont_.size());
+  for (std::size_t i = 0; i < traj_cont_.size(); ++i)
   {
-    assert(!res_vec.empty());
-    appendWithStrictTimeIncrease(*(res_vec.back()), *traj_tail_);
+    robot_trajectory::RobotTrajectoryPtr res_traj {
+      new robot_trajectory::RobotTrajectory(model_, traj_cont_[i].group_name) };
+
+    // The previously added trajectory still has to be attached to the last element
+    if (traj_tail_ && (i == traj_cont_.size() - 1))
+    {
+      TrajectoryElement last_element {traj_cont_[i]};
+      appendWithStrictTimeIncrease(last_element, *traj_tail_);
+      verifyElement(last_element);
+      if (last_element.reference_state)
+      {
+        last_element.trajectory.toRobotTrajectory(*last_element.reference_state, *res_traj);
+      }
+    }
+    else if (traj_cont_[i].reference_state)
+    {
+      verifyElement(traj_cont_[i]);
+      traj_cont_[i].trajectory.toRobotTrajectory(*traj_cont_[i].reference_state, *res_traj);
+    }
+    res_vec.push_back(res_traj);
   }
   return res_vec;
 }
 
-void PlanComponentsBuilder::appendWithStrictTimeIncrease(robot_trajectory::RobotTrajectory &result, const robot_trajectory::RobotTrajectory &source)
+void PlanComponentsBuilder::verifyElement(const TrajectoryElement& element) const
 {
-  if (result.empty() ||
-      !pilz::isRobotStateEqual(result.getLastWayPoint(), source.getFirstWayPoint(),
-                               result.getGroupName(), ROBOT_STATE_EQUALITY_EPSILON) )
+  if (!has_joint_limits_)
   {
-    result.append(source, 0.0);
     return;
   }
 
-  for (size_t i = 1; i < source.getWayPointCount(); ++i)
+  const pilz::JointLimitsTable limits_table {joint_limits_.getTable(element.group_name,
+                                                                    element.trajectory.getJointNames())};
+  if (!pilz::verifyTrajectoryLimits(element.trajectory, limits_table))
   {
-    result.addSuffixWayPoint(source.getWayPoint(i), source.getWayPointDurationFromPrevious(i));
+    throw TrajectoryLimitsViolatedException("Trajectory of group " + element.group_name
+                                            + " violates the joint limits");
   }
 }
 
+void PlanComponentsBuilder::appendWithStrictTimeIncrease(TrajectoryElement &result,
+                                                         const robot_trajectory::RobotTrajectory &source)
+{
+  if (source.empty())
+  {
+    return;
+  }
+
+  if (result.trajectory.empty() ||
+      !isLastWayPointEqual(result.trajectory, source.getFirstWayPoint(), ROBOT_STATE_EQUALITY_EPSILON) )
+  {
+    appendToElement(result, source);
+    return;
+  }
+
+  appendToElement(result, source, 1);
+}
+
+void PlanComponentsBuilder::appendToElement(TrajectoryElement &result,
+                                            const robot_trajectory::RobotTrajectory &source,
+                                            std::size_t first)
+{
+  if (source.empty())
+  {
+    return;
+  }
+
+  if (!result.reference_state)
+  {
+    result.reference_state = std::make_shared<const robot_state::RobotState>(source.getFirstWayPoint());
+  }
+  result.trajectory.appendRobotTrajectory(source, first);
+}
+
+bool PlanComponentsBuilder::isLastWayPointEqual(const pilz::CompactTrajectory& traj,
+                                                const robot_state::RobotState& state,
+                                                double epsilon)
+{
+  assert(!traj.empty());
+  const std::size_t last_index {traj.getWayPointCount() - 1};
+  const double* positions {traj.getPositions(last_index)};
+  const double* velocities {traj.getVelocities(last_index)};
+  const double* accelerations {traj.getAccelerations(last_index)};
+
+  double position_diff {0.}, velocity_diff {0.}, acceleration_diff {0.};
+  for (std::size_t j = 0; j < traj.getJointCount(); ++j)
+  {
+    const int index {state.getRobotModel()->getVariableIndex(traj.getJointNames()[j])};
+    position_diff += std::pow(positions[j] - state.getVariablePosition(index), 2);
+    const double velocity {state.hasVelocities() ? state.getVariableVelocity(index) : 0.};
+    velocity_diff += std::pow(velocities[j] - velocity, 2);
+    const double acceleration {state.hasAccelerations() ? state.getVariableAcceleration(index) : 0.};
+    acceleration_diff += std::pow(accelerations[j] - acceleration, 2);
+  }
+
+  return std::sqrt(position_diff) <= epsilon
+      && std::sqrt(velocity_diff) <= epsilon
+      && std::sqrt(acceleration_diff) <= epsilon;
+}
+
+void PlanComponentsBuilder::addElement(const robot_trajectory::RobotTrajectory& traj)
+{
+  traj_cont_.emplace_back();
+  traj_cont_.back().group_name = traj.getGroupName();
+  traj_cont_.back().trajectory.setJointNames(pilz::CompactTrajectory::getVariableNames(traj));
+}
+
 void PlanComponentsBuilder::blend(const robot_trajectory::RobotTrajectoryPtr& other,
-                                  const double blend_radius)
+                                  const double blend_radius,
+                                  const pilz::TipFramePoseCacheConstPtr& other_poses)
 {
   if (!blender_)
   {
@@ -61,29 +149,43 @@ void PlanComponentsBuilder::blend(const robot_trajectory::RobotTrajectoryPtr& ot
 
   assert(other->getGroupName() == traj_tail_->getGroupName());
 
+  if (cancellation_.isCancelled())
+  {
+    throw BlendingCancelledException("Blending cancelled");
+  }
+
   pilz::TrajectoryBlendRequest blend_request;
 
   blend_request.first_trajectory = traj_tail_;
   blend_request.second_trajectory = other;
+  blend_request.first_trajectory_poses = traj_tail_poses_;
+  blend_request.second_trajectory_poses = other_poses;
   blend_request.blend_radius = blend_radius;
   blend_request.group_name = traj_tail_->getGroupName();
   blend_request.link_name = getSolverTipFrame(model_->getJointModelGroup(blend_request.group_name));
+  blend_request.cancellation = cancellation_;
 
   pilz::TrajectoryBlendResponse blend_response;
   if (!blender_->blend(blend_request, blend_response))
   {
+    if (blend_response.error_code.val == moveit_msgs::MoveItErrorCodes::PREEMPTED)
+    {
+      throw BlendingCancelledException("Blending cancelled");
+    }
     throw BlendingFailedException("Blending failed");
   }
 
   // Append the new trajectory elements
-  appendWithStrictTimeIncrease(*(traj_cont_.back()),*blend_response.first_trajectory);
-  traj_cont_.back()->append(*blend_response.blend_trajectory, 0.0);
+  appendWithStrictTimeIncrease(traj_cont_.back(), *blend_response.first_trajectory);
+  appendToElement(traj_cont_.back(), *blend_response.blend_trajectory);
   // Store the last new trajectory element for future processing
   traj_tail_ = blend_response.second_trajectory; // first for next blending segment
+  traj_tail_poses_ = blend_response.second_trajectory_poses;
 }
 
 void PlanComponentsBuilder::append(const robot_trajectory::RobotTrajectoryPtr& other,
-                                   const double blend_radius)
+                                   const double blend_radius,
+                                   const pilz::TipFramePoseCacheConstPtr& other_poses)
 {
   if (!model_)
   {
@@ -93,30 +195,33 @@ void PlanComponentsBuilder::append(const robot_trajectory::RobotTrajectoryPtr& o
   if (!traj_tail_)
   {
     traj_tail_ = other;
+    traj_tail_poses_ = other_poses;
     // Reserve space in container for new trajectory
-    traj_cont_.emplace_back( new robot_trajectory::RobotTrajectory(model_, other->getGroupName()) );
+    addElement(*other);
     return;
   }
 
   // Create new trajectory for every group change
   if (other->getGroupName() != traj_tail_->getGroupName())
   {
-    appendWithStrictTimeIncrease(*(traj_cont_.back()), *traj_tail_);
+    appendWithStrictTimeIncrease(traj_cont_.back(), *traj_tail_);
     traj_tail_ = other;
+    traj_tail_poses_ = other_poses;
     // Create new container element
-    traj_cont_.emplace_back( new robot_trajectory::RobotTrajectory(model_, other->getGroupName()) );
+    addElement(*other);
     return;
   }
 
   // No blending
   if (blend_radius <= 0.0)
   {
-    appendWithStrictTimeIncrease(*(traj_cont_.back()), *traj_tail_);
+    appendWithStrictTimeIncrease(traj_cont_.back(), *traj_tail_);
     traj_tail_ = other;
+    traj_tail_poses_ = other_poses;
     return;
   }
 
-  blend(other, blend_radius);
+  blend(other, blend_radius, other_poses);
 }
 
 } // namespace pilz_trajectory_generation
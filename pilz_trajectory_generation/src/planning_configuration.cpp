@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/planning_configuration.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <ros/ros.h>
+
+#include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/sampling_times_aggregator.h"
+#include "pilz_trajectory_generation/tip_frame_getter.h"
+
+namespace pilz
+{
+
+static const std::string PARAM_PAYLOAD_PROFILES {"payload_profiles"};
+static const std::string PARAM_MAX_PAYLOAD {"max_payload"};
+static const std::string PARAM_JOINT_LIMITS {"joint_limits"};
+static const std::string PARAM_CARTESIAN_LIMITS {"cartesian_limits"};
+static const std::string PARAM_PTP_GOAL_IK {"ptp_goal_ik"};
+static const std::string PARAM_SEEDS {"seeds"};
+static const std::string PARAM_SOLVER_ALTERNATIVES {"solver_alternatives"};
+
+/**
+ * @brief Reads a number, which may be given as int or double.
+ * @throws std::invalid_argument if the value is not a number
+ */
+static double getNumber(XmlRpc::XmlRpcValue& value, const std::string& name)
+{
+  if(value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+  {
+    return static_cast<double>(value);
+  }
+  if(value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    return static_cast<int>(value);
+  }
+  throw std::invalid_argument(name + " is not a number");
+}
+
+PlanningConfiguration::PlanningConfiguration(XmlRpc::XmlRpcValue& param,
+                                             const moveit::core::RobotModelConstPtr& model,
+                                             double reduction_factor)
+  : model_(model)
+  , reduction_factor_(reduction_factor)
+{
+  if(!(reduction_factor > 0. && reduction_factor <= 1.))
+  {
+    throw std::invalid_argument("Reduction factor of the limits must be in (0, 1], got "
+                                + std::to_string(reduction_factor));
+  }
+
+  limits_ = buildLimits(param);
+
+  for(const auto& jmg : model_->getJointModelGroups())
+  {
+    if(pilz_trajectory_generation::hasSolver(jmg)
+       && jmg->getSolverInstance()->getTipFrames().size() == 1)
+    {
+      solver_tip_frames_[jmg->getName()] = pilz_trajectory_generation::getSolverTipFrame(jmg);
+    }
+  }
+
+  if(param.getType() == XmlRpc::XmlRpcValue::TypeStruct && param.hasMember(PARAM_PAYLOAD_PROFILES))
+  {
+    buildPayloadProfiles(param);
+  }
+
+  sampling_times_ = SamplingTimesAggregator::getAggregatedSamplingTimes(param);
+}
+
+LimitsContainer PlanningConfiguration::buildLimits(XmlRpc::XmlRpcValue& param) const
+{
+  JointLimitsContainer joint_limits {reduceJointLimits(
+          JointLimitsAggregator::getAggregatedLimits(param, model_->getActiveJointModels()), reduction_factor_)};
+  CartesianLimit cartesian_limit {reduceCartesianLimit(CartesianLimitsAggregator::getAggregatedLimits(param),
+                                                       reduction_factor_)};
+
+  // The most strict joint limits of the groups, needed for every PTP context
+  pilz_extensions::JointLimitsMap group_common_limits;
+  for(const auto& jmg : model_->getJointModelGroups())
+  {
+    try
+    {
+      group_common_limits[jmg->getName()] = joint_limits.getCommonLimit(jmg->getActiveJointModelNames());
+    }
+    // LCOV_EXCL_START
+    catch(const std::out_of_range&)
+    {
+      ROS_DEBUG_STREAM("No common joint limit for group " << jmg->getName());
+    }
+    // LCOV_EXCL_STOP
+
+    // The limits in the variable order of the group, used to verify the samples
+    joint_limits.addGroupTable(jmg->getName(), jmg->getActiveJointModelNames());
+  }
+
+  LimitsContainer limits;
+  limits.setJointLimits(joint_limits);
+  limits.setCartesianLimits(cartesian_limit);
+  limits.setGroupCommonLimits(group_common_limits);
+  limits.setGoalIkOptions(buildGoalIkOptions(param));
+  return limits;
+}
+
+GoalIkOptionsMap PlanningConfiguration::buildGoalIkOptions(XmlRpc::XmlRpcValue& param) const
+{
+  GoalIkOptionsMap goal_ik_options;
+  if(param.getType() != XmlRpc::XmlRpcValue::TypeStruct || !param.hasMember(PARAM_PTP_GOAL_IK))
+  {
+    return goal_ik_options;
+  }
+
+  XmlRpc::XmlRpcValue& goal_ik_param {param[PARAM_PTP_GOAL_IK]};
+  if(goal_ik_param.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    throw std::invalid_argument(PARAM_PTP_GOAL_IK + " must be a struct of planning groups");
+  }
+
+  for(auto it = goal_ik_param.begin(); it != goal_ik_param.end(); ++it)
+  {
+    const std::string& group_name {it->first};
+    XmlRpc::XmlRpcValue& group_param {it->second};
+    if(!model_->hasJointModelGroup(group_name) || group_param.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      throw std::invalid_argument(PARAM_PTP_GOAL_IK + " of " + group_name
+                                  + " must be a struct and name a planning group");
+    }
+    const std::vector<std::string>& joint_names
+        {model_->getJointModelGroup(group_name)->getActiveJointModelNames()};
+
+    GoalIkOptions options;
+    if(group_param.hasMember(PARAM_SEEDS))
+    {
+      XmlRpc::XmlRpcValue& seeds_param {group_param[PARAM_SEEDS]};
+      if(seeds_param.getType() != XmlRpc::XmlRpcValue::TypeArray)
+      {
+        throw std::invalid_argument(PARAM_SEEDS + " of " + group_name + " must be a list of joint positions");
+      }
+      for(int i = 0; i < seeds_param.size(); ++i)
+      {
+        XmlRpc::XmlRpcValue& seed_param {seeds_param[i]};
+        if(seed_param.getType() != XmlRpc::XmlRpcValue::TypeArray
+           || static_cast<std::size_t>(seed_param.size()) != joint_names.size())
+        {
+          throw std::invalid_argument("Seed " + std::to_string(i) + " of " + group_name + " needs "
+                                      + std::to_string(joint_names.size()) + " joint positions");
+        }
+        std::map<std::string, double> seed;
+        for(std::size_t j = 0; j < joint_names.size(); ++j)
+        {
+          seed[joint_names[j]] = getNumber(seed_param[static_cast<int>(j)], "Seed position of " + joint_names[j]);
+        }
+        options.seeds.push_back(seed);
+      }
+    }
+    if(group_param.hasMember(PARAM_SOLVER_ALTERNATIVES))
+    {
+      if(group_param[PARAM_SOLVER_ALTERNATIVES].getType() != XmlRpc::XmlRpcValue::TypeBoolean)
+      {
+        throw std::invalid_argument(PARAM_SOLVER_ALTERNATIVES + " of " + group_name + " must be a boolean");
+      }
+      options.solver_alternatives = static_cast<bool>(group_param[PARAM_SOLVER_ALTERNATIVES]);
+    }
+
+    ROS_DEBUG_STREAM("Goal IK of group " << group_name << ": " << options.seeds.size() << " seeds, solver alternatives "
+                     << (options.solver_alternatives ? "on" : "off"));
+    goal_ik_options[group_name] = options;
+  }
+  return goal_ik_options;
+}
+
+void PlanningConfiguration::buildPayloadProfiles(XmlRpc::XmlRpcValue& param)
+{
+  XmlRpc::XmlRpcValue& profiles_param {param[PARAM_PAYLOAD_PROFILES]};
+  if(profiles_param.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    throw std::invalid_argument(PARAM_PAYLOAD_PROFILES + " must be a struct of profiles");
+  }
+
+  for(auto it = profiles_param.begin(); it != profiles_param.end(); ++it)
+  {
+    XmlRpc::XmlRpcValue& profile_param {it->second};
+    PayloadProfile profile;
+    profile.name = it->first;
+    if(profile_param.getType() != XmlRpc::XmlRpcValue::TypeStruct || !profile_param.hasMember(PARAM_MAX_PAYLOAD)
+       || (profile_param[PARAM_MAX_PAYLOAD].getType() != XmlRpc::XmlRpcValue::TypeDouble
+           && profile_param[PARAM_MAX_PAYLOAD].getType() != XmlRpc::XmlRpcValue::TypeInt))
+    {
+      throw std::invalid_argument("Payload profile " + profile.name + " needs a " + PARAM_MAX_PAYLOAD);
+    }
+    profile.max_payload = profile_param[PARAM_MAX_PAYLOAD].getType() == XmlRpc::XmlRpcValue::TypeInt
+        ? static_cast<int>(profile_param[PARAM_MAX_PAYLOAD]) : static_cast<double>(profile_param[PARAM_MAX_PAYLOAD]);
+
+    // The profile overrides single limits of the namespace, e.g. only the accelerations
+    XmlRpc::XmlRpcValue limits_param {param};
+    if(profile_param.hasMember(PARAM_JOINT_LIMITS)
+       && profile_param[PARAM_JOINT_LIMITS].getType() == XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      XmlRpc::XmlRpcValue& joint_limits_param {profile_param[PARAM_JOINT_LIMITS]};
+      for(auto joint_it = joint_limits_param.begin(); joint_it != joint_limits_param.end(); ++joint_it)
+      {
+        if(joint_it->second.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+        {
+          continue;
+        }
+        for(auto limit_it = joint_it->second.begin(); limit_it != joint_it->second.end(); ++limit_it)
+        {
+          limits_param[PARAM_JOINT_LIMITS][joint_it->first][limit_it->first] = limit_it->second;
+        }
+      }
+    }
+    if(profile_param.hasMember(PARAM_CARTESIAN_LIMITS)
+       && profile_param[PARAM_CARTESIAN_LIMITS].getType() == XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      XmlRpc::XmlRpcValue& cartesian_limits_param {profile_param[PARAM_CARTESIAN_LIMITS]};
+      for(auto limit_it = cartesian_limits_param.begin(); limit_it != cartesian_limits_param.end(); ++limit_it)
+      {
+        limits_param[PARAM_CARTESIAN_LIMITS][limit_it->first] = limit_it->second;
+      }
+    }
+
+    profile.limits = buildLimits(limits_param);
+    payload_profiles_.push_back(profile);
+  }
+
+  std::stable_sort(payload_profiles_.begin(), payload_profiles_.end(),
+                   [](const PayloadProfile& lhs, const PayloadProfile& rhs){ return lhs.max_payload < rhs.max_payload; });
+}
+
+JointLimitsContainer PlanningConfiguration::reduceJointLimits(const JointLimitsContainer& joint_limits,
+                                                              double reduction_factor)
+{
+  if(reduction_factor == 1.)
+  {
+    return joint_limits;
+  }
+
+  JointLimitsContainer reduced_limits;
+  for(auto it = joint_limits.begin(); it != joint_limits.end(); ++it)
+  {
+    pilz_extensions::JointLimit joint_limit {it->second};
+    joint_limit.max_velocity *= reduction_factor;
+    joint_limit.max_acceleration *= reduction_factor;
+    joint_limit.max_deceleration *= reduction_factor;
+    joint_limit.velocity_grid = reduceGrid(joint_limit.velocity_grid, reduction_factor);
+    joint_limit.acceleration_grid = reduceGrid(joint_limit.acceleration_grid, reduction_factor);
+    joint_limit.deceleration_grid = reduceGrid(joint_limit.deceleration_grid, reduction_factor);
+    reduced_limits.addLimit(it->first, joint_limit);
+  }
+  return reduced_limits;
+}
+
+std::shared_ptr<const pilz_extensions::JointLimitsGrid> PlanningConfiguration::reduceGrid(
+    const std::shared_ptr<const pilz_extensions::JointLimitsGrid>& grid, double reduction_factor)
+{
+  if(!grid)
+  {
+    return grid;
+  }
+  return std::make_shared<const pilz_extensions::JointLimitsGrid>(grid->scaled(reduction_factor));
+}
+
+CartesianLimit PlanningConfiguration::reduceCartesianLimit(const CartesianLimit& cartesian_limit,
+                                                           double reduction_factor)
+{
+  CartesianLimit reduced_limit {cartesian_limit};
+  if(cartesian_limit.hasMaxTranslationalVelocity())
+  {
+    reduced_limit.setMaxTranslationalVelocity(reduction_factor * cartesian_limit.getMaxTranslationalVelocity());
+  }
+  if(cartesian_limit.hasMaxTranslationalAcceleration())
+  {
+    reduced_limit.setMaxTranslationalAcceleration(reduction_factor
+                                                  * cartesian_limit.getMaxTranslationalAcceleration());
+  }
+  if(cartesian_limit.hasMaxTranslationalDeceleration())
+  {
+    reduced_limit.setMaxTranslationalDeceleration(reduction_factor
+                                                  * cartesian_limit.getMaxTranslationalDeceleration());
+  }
+  if(cartesian_limit.hasMaxRotationalVelocity())
+  {
+    reduced_limit.setMaxRotationalVelocity(reduction_factor * cartesian_limit.getMaxRotationalVelocity());
+  }
+  if(cartesian_limit.hasMaxFrameSpeed())
+  {
+    reduced_limit.setMaxFrameSpeed(reduction_factor * cartesian_limit.getMaxFrameSpeed());
+  }
+  return reduced_limit;
+}
+
+PlanningConfigurationConstPtr PlanningConfigurationRegistry::getConfiguration(
+    const ros::NodeHandle& nh, const moveit::core::RobotModelConstPtr& model)
+{
+  return getSharedConfiguration(nh, model)->get();
+}
+
+SharedPlanningConfigurationPtr PlanningConfigurationRegistry::getSharedConfiguration(
+    const ros::NodeHandle& nh, const moveit::core::RobotModelConstPtr& model)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const std::string& param_namespace {nh.getNamespace()};
+  auto it = configurations_.find(param_namespace);
+  if(it != configurations_.end() && it->second.configuration->get()->getRobotModel() == model)
+  {
+    return it->second.configuration;
+  }
+
+  ROS_INFO_STREAM("Reading limits from namespace " << param_namespace);
+
+  // The users of the configuration of the previous robot model keep it, only the reduction is taken over
+  Entry entry;
+  getParam(param_namespace, entry.param);
+  entry.reduction_factor = it != configurations_.end() ? it->second.reduction_factor : 1.;
+  entry.configuration = std::make_shared<SharedPlanningConfiguration>(
+        std::make_shared<PlanningConfiguration>(entry.param, model, entry.reduction_factor));
+  configurations_[param_namespace] = entry;
+  return entry.configuration;
+}
+
+void PlanningConfigurationRegistry::updateConfigurations(bool reload_limits, double reduction_factor)
+{
+  replaceConfigurations(reload_limits, &reduction_factor);
+}
+
+void PlanningConfigurationRegistry::updateConfigurations(bool reload_limits)
+{
+  replaceConfigurations(reload_limits, nullptr);
+}
+
+void PlanningConfigurationRegistry::replaceConfigurations(bool reload_limits, const double* reduction_factor)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Build all configurations first, so that a failure leaves all of them unchanged
+  std::vector<XmlRpc::XmlRpcValue> params;
+  std::vector<PlanningConfigurationConstPtr> configurations;
+  for(auto& entry : configurations_)
+  {
+    params.push_back(entry.second.param);
+    if(reload_limits)
+    {
+      ROS_INFO_STREAM("Reading limits from namespace " << entry.first);
+      getParam(entry.first, params.back());
+    }
+    configurations.push_back(std::make_shared<PlanningConfiguration>(
+                               params.back(), entry.second.configuration->get()->getRobotModel(),
+                               reduction_factor ? *reduction_factor : entry.second.reduction_factor));
+  }
+
+  std::size_t i {0};
+  for(auto& entry : configurations_)
+  {
+    entry.second.param = params.at(i);
+    entry.second.reduction_factor = configurations.at(i)->getReductionFactor();
+    entry.second.configuration->set(configurations.at(i));
+    ++i;
+  }
+  if(reduction_factor)
+  {
+    ROS_INFO_STREAM("Updated the limits of " << configurations_.size() << " planning configuration(s)"
+                    << " (reduction factor " << *reduction_factor << ")");
+  }
+  else
+  {
+    ROS_INFO_STREAM("Updated the limits of " << configurations_.size() << " planning configuration(s)");
+  }
+}
+
+void PlanningConfigurationRegistry::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  configurations_.clear();
+}
+
+void PlanningConfigurationRegistry::getParam(const std::string& param_namespace, XmlRpc::XmlRpcValue& param)
+{
+  // One request for the whole namespace instead of one per joint and limit
+  if(!ros::NodeHandle().getParam(param_namespace, param))
+  {
+    ROS_DEBUG_STREAM("No parameters in namespace " << param_namespace << ", using the limits of the robot model");
+  }
+}
+
+}
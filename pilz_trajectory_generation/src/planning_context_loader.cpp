@@ -40,6 +40,18 @@ bool pilz::PlanningContextLoader::setLimits(const pilz::LimitsContainer &limits)
   return true;
 }
 
+bool pilz::PlanningContextLoader::setSamplingTimes(const pilz::SamplingTimesContainer &sampling_times)
+{
+  sampling_times_ = sampling_times;
+  return true;
+}
+
+bool pilz::PlanningContextLoader::setConfiguration(const pilz::SharedPlanningConfigurationPtr &configuration)
+{
+  configuration_ = configuration;
+  return true;
+}
+
 std::string pilz::PlanningContextLoader::getAlgorithm() const
 {
   return alg_;
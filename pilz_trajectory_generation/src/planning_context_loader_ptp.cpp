@@ -35,22 +35,7 @@ bool pilz::PlanningContextLoaderPTP::loadContext(planning_interface::PlanningCon
                                                  const std::string& name,
                                                  const std::string& group) const
 {
-  if(limits_set_ && model_set_) {
-    planning_context.reset(new PlanningContextPTP(name, group, model_, limits_));
-    return true;
-  }
-  else
-  {
-    if(!limits_set_)
-    {
-      ROS_ERROR_STREAM("Joint Limits are not defined. Cannot load planning context. Call setLimits loadContext");
-    }
-    if(!model_set_)
-    {
-      ROS_ERROR_STREAM("Robot model was not set");
-    }
-    return false;
-  }
+  return PlanningContextLoader::loadContext<PlanningContextPTP>(planning_context, name, group);
 }
 
 PLUGINLIB_EXPORT_CLASS(pilz::PlanningContextLoaderPTP, pilz::PlanningContextLoader)
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/planning_request_recorder.h"
+
+#include <boost/variant/get.hpp>
+#include <eigen_conversions/eigen_msg.h>
+#include <geometric_shapes/shape_operations.h>
+#include <moveit/robot_state/conversions.h>
+#include <ros/console.h>
+#include <ros/param.h>
+#include <rosbag/exceptions.h>
+#include <pilz_msgs/PlanningParametersRecord.h>
+
+namespace pilz
+{
+
+const std::string PlanningRequestRecorder::PARAMETERS_TOPIC {"planning_parameters"};
+const std::string PlanningRequestRecorder::REQUEST_TOPIC {"planning_requests"};
+
+static const std::string PARAM_REQUEST_LOG_FILE = "request_log_file";
+static const std::string PARAM_ROBOT_DESCRIPTION = "robot_description";
+//! Records are dropped if the background thread falls behind by more records.
+static constexpr std::size_t MAX_PENDING_RECORDS {100};
+
+/**
+ * @brief Returns the XML-RPC encoding of the specified parameter, or an empty
+ * string if the parameter is not set.
+ */
+static std::string getParameterXml(const std::string& name)
+{
+  XmlRpc::XmlRpcValue value;
+  return ros::param::get(name, value) ? value.toXml() : std::string();
+}
+
+/**
+ * @brief Adds the shapes of the specified world object to the collision object message.
+ */
+static void addShapesToMsg(const collision_detection::World::Object& object, moveit_msgs::CollisionObject& msg)
+{
+  for(std::size_t i = 0; i < object.shapes_.size(); ++i)
+  {
+    shapes::ShapeMsg shape_msg;
+    if(!shapes::constructMsgFromShape(object.shapes_.at(i).get(), shape_msg))
+    {
+      continue;
+    }
+    geometry_msgs::Pose pose;
+    tf::poseEigenToMsg(object.shape_poses_.at(i), pose);
+    if(const shape_msgs::SolidPrimitive* primitive = boost::get<shape_msgs::SolidPrimitive>(&shape_msg))
+    {
+      msg.primitives.push_back(*primitive);
+      msg.primitive_poses.push_back(pose);
+    }
+    else if(const shape_msgs::Mesh* mesh = boost::get<shape_msgs::Mesh>(&shape_msg))
+    {
+      msg.meshes.push_back(*mesh);
+      msg.mesh_poses.push_back(pose);
+    }
+    else if(const shape_msgs::Plane* plane = boost::get<shape_msgs::Plane>(&shape_msg))
+    {
+      msg.planes.push_back(*plane);
+      msg.plane_poses.push_back(pose);
+    }
+  }
+}
+
+PlanningRequestRecorder::PendingRecord::PendingRecord(const planning_scene::PlanningScene& scene)
+  : state(scene.getCurrentState())
+  , acm(scene.getAllowedCollisionMatrix())
+{
+  // the objects are immutable, the world copies an object before it is changed
+  for(const auto& object : *scene.getWorld())
+  {
+    if(object.first != planning_scene::PlanningScene::OCTOMAP_NS)
+    {
+      objects.push_back(object.second);
+    }
+  }
+  record.planning_scene.name = scene.getName();
+  record.planning_scene.robot_model_name = scene.getRobotModel()->getName();
+  scene.getTransforms().copyTransforms(record.planning_scene.fixed_frame_transforms);
+}
+
+PlanningRequestRecorder::~PlanningRequestRecorder()
+{
+  // no logging here, rosconsole might already be shut down at process exit
+  close();
+}
+
+bool PlanningRequestRecorder::open(const std::string& file_name, const moveit::core::RobotModel& model)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(recording_)
+  {
+    if(file_name != file_name_)
+    {
+      ROS_WARN_STREAM("Planning requests are already recorded to " << file_name_ << ", ignoring " << file_name);
+      return false;
+    }
+    return true;
+  }
+
+  pilz_msgs::PlanningParametersRecord parameters;
+  parameters.robot_model_name = model.getName();
+  ros::param::get(PARAM_ROBOT_DESCRIPTION, parameters.robot_description);
+  ros::param::get(PARAM_ROBOT_DESCRIPTION + "_semantic", parameters.robot_description_semantic);
+  parameters.robot_description_kinematics = getParameterXml(PARAM_ROBOT_DESCRIPTION + "_kinematics");
+  parameters.robot_description_planning = getParameterXml(PARAM_ROBOT_DESCRIPTION + "_planning");
+
+  try
+  {
+    bag_.open(file_name, rosbag::bagmode::Write);
+    bag_.setCompression(rosbag::compression::LZ4);
+    bag_.write(PARAMETERS_TOPIC, ros::Time::now(), parameters);
+  }
+  catch(const rosbag::BagException& ex)
+  {
+    ROS_ERROR_STREAM("Failed to open planning request log " << file_name << ": " << ex.what());
+    bag_.close();
+    return false;
+  }
+
+  file_name_ = file_name;
+  robot_model_name_ = model.getName();
+  recording_ = true;
+  writer_ = std::thread(&PlanningRequestRecorder::writeRecords, this);
+  ROS_INFO_STREAM("Recording planning requests to " << file_name_);
+  return true;
+}
+
+bool PlanningRequestRecorder::openFromParameter(const ros::NodeHandle& nh, const moveit::core::RobotModel& model)
+{
+  std::string file_name;
+  return nh.getParam(PARAM_REQUEST_LOG_FILE, file_name) && open(file_name, model);
+}
+
+void PlanningRequestRecorder::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  {
+    std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+    if(!recording_.exchange(false))
+    {
+      return;
+    }
+  }
+  queue_condition_.notify_one();
+  writer_.join();
+  bag_.close();
+}
+
+void PlanningRequestRecorder::record(const std::string& source, const planning_scene::PlanningSceneConstPtr& scene,
+                                     const pilz_msgs::MotionSequenceRequest& req)
+{
+  if(!isRecording())
+  {
+    return;
+  }
+
+  std::unique_ptr<PendingRecord> pending {new PendingRecord(*scene)};
+  pending->record.stamp = ros::Time::now();
+  pending->record.source = source;
+  pending->record.robot_model_name = robot_model_name_;
+  pending->record.request = req;
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if(!recording_)
+    {
+      return;
+    }
+    if(queue_.size() >= MAX_PENDING_RECORDS)
+    {
+      ROS_WARN_STREAM_THROTTLE(1.0, "Too many pending planning requests, dropping the request to record");
+      return;
+    }
+    queue_.push_back(std::move(pending));
+  }
+  queue_condition_.notify_one();
+}
+
+void PlanningRequestRecorder::writeRecords()
+{
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while(true)
+  {
+    queue_condition_.wait(lock, [this]{ return !queue_.empty() || !recording_; });
+    if(queue_.empty())
+    {
+      return;
+    }
+    std::unique_ptr<PendingRecord> pending {std::move(queue_.front())};
+    queue_.pop_front();
+
+    lock.unlock();
+    write(*pending);
+    lock.lock();
+  }
+}
+
+void PlanningRequestRecorder::write(PendingRecord& pending)
+{
+  moveit_msgs::PlanningScene& scene_msg {pending.record.planning_scene};
+  moveit::core::robotStateToRobotStateMsg(pending.state, scene_msg.robot_state);
+  pending.acm.getMessage(scene_msg.allowed_collision_matrix);
+  scene_msg.world.collision_objects.reserve(pending.objects.size());
+  for(const auto& object : pending.objects)
+  {
+    moveit_msgs::CollisionObject object_msg;
+    object_msg.header.frame_id = pending.state.getRobotModel()->getModelFrame();
+    object_msg.id = object->id_;
+    object_msg.operation = moveit_msgs::CollisionObject::ADD;
+    addShapesToMsg(*object, object_msg);
+    scene_msg.world.collision_objects.push_back(std::move(object_msg));
+  }
+
+  try
+  {
+    bag_.write(REQUEST_TOPIC, pending.record.stamp, pending.record);
+  }
+  catch(const rosbag::BagException& ex)
+  {
+    ROS_ERROR_STREAM("Failed to record planning request: " << ex.what());
+  }
+}
+
+void PlanningRequestRecorder::record(const std::string& source, const planning_scene::PlanningSceneConstPtr& scene,
+                                     const moveit_msgs::MotionPlanRequest& req)
+{
+  if(!isRecording() || SequenceScope::isActive())
+  {
+    return;
+  }
+
+  pilz_msgs::MotionSequenceRequest seq_req;
+  seq_req.items.resize(1);
+  seq_req.items.front().req = req;
+  seq_req.items.front().blend_radius = 0.;
+  record(source, scene, seq_req);
+}
+
+}
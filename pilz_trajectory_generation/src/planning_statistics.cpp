@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/planning_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace pilz_trajectory_generation
+{
+
+constexpr std::size_t PlanningStatistics::DEFAULT_WINDOW_SIZE;
+
+PlanningStatistics::PlanningStatistics(std::size_t window_size)
+  : window_size_(std::max(window_size, static_cast<std::size_t>(1)))
+{
+}
+
+void PlanningStatistics::advertise(ros::NodeHandle& nh, const std::string& topic)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  publisher_ = nh.advertise<pilz_msgs::PlanningStatistics>(topic, 1, true);
+}
+
+void PlanningStatistics::addRequest(const pilz::PhaseTimings& timings)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for(std::size_t i = 0; i < timings.getEntries().size(); ++i)
+  {
+    const pilz::PhaseTimings::Entry& phase {timings.getEntries().at(i)};
+    auto it = std::find_if(windows_.begin(), windows_.end(),
+                           [&phase](const PhaseWindow& window){ return window.phase == phase.first; });
+    if(it == windows_.end())
+    {
+      windows_.push_back(PhaseWindow());
+      it = windows_.end() - 1;
+      it->phase = phase.first;
+    }
+
+    it->times.push_back(phase.second);
+    it->counts.push_back(timings.getAllocationCounts().at(i));
+    if(it->times.size() > window_size_)
+    {
+      it->times.pop_front();
+      it->counts.pop_front();
+    }
+  }
+  ++request_count_;
+  last_request_time_ = ros::Time::now();
+
+  if(publisher_)
+  {
+    publisher_.publish(computeStatistics());
+  }
+}
+
+pilz_msgs::PlanningStatistics PlanningStatistics::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return computeStatistics();
+}
+
+pilz_msgs::PlanningStatistics PlanningStatistics::computeStatistics() const
+{
+  pilz_msgs::PlanningStatistics msg;
+  msg.stamp = last_request_time_;
+  msg.request_count = request_count_;
+  msg.phases.reserve(windows_.size());
+  for(const auto& window : windows_)
+  {
+    const std::vector<double> samples(window.times.begin(), window.times.end());
+
+    pilz_msgs::PlanningPhaseStatistics phase;
+    phase.phase = window.phase;
+    phase.sample_count = samples.size();
+    phase.mean = std::accumulate(samples.begin(), samples.end(), 0.) / samples.size();
+    phase.p50 = computePercentile(samples, 50.);
+    phase.p90 = computePercentile(samples, 90.);
+    phase.p99 = computePercentile(samples, 99.);
+    phase.max = *std::max_element(samples.begin(), samples.end());
+
+    pilz::AllocationCounts counts;
+    for(const auto& request_counts : window.counts)
+    {
+      counts += request_counts;
+    }
+    phase.mean_allocations = static_cast<double>(counts.allocations) / samples.size();
+    phase.mean_allocated_bytes = static_cast<double>(counts.allocated_bytes) / samples.size();
+    phase.mean_copies = static_cast<double>(counts.copies) / samples.size();
+    phase.mean_copied_bytes = static_cast<double>(counts.copied_bytes) / samples.size();
+    msg.phases.push_back(phase);
+  }
+  return msg;
+}
+
+double PlanningStatistics::computePercentile(std::vector<double> samples, double percentile)
+{
+  if(samples.empty())
+  {
+    return 0.;
+  }
+
+  const double rank {std::ceil(percentile / 100. * samples.size())};
+  const std::size_t index {static_cast<std::size_t>(std::max(rank, 1.)) - 1};
+  const auto nth {samples.begin() + std::min(index, samples.size() - 1)};
+  std::nth_element(samples.begin(), nth, samples.end());
+  return *nth;
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ros/ros.h"
+
+#include "pilz_trajectory_generation/sampling_times_aggregator.h"
+
+static const std::string PARAM_SAMPLING_TIMES_NS = "sampling_times";
+
+static const std::string PARAM_SAMPLING_TIME = "sampling_time";
+static const std::string PARAM_OUTPUT_SAMPLING_TIME = "output_sampling_time";
+
+/**
+ * @brief Reads the specified member of the group parameters, which may be given as int or double.
+ */
+static bool getSamplingTime(XmlRpc::XmlRpcValue& group_param, const std::string& name, double& sampling_time)
+{
+  if(!group_param.hasMember(name))
+  {
+    return false;
+  }
+  XmlRpc::XmlRpcValue& value {group_param[name]};
+  if(value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+  {
+    sampling_time = static_cast<double>(value);
+    return true;
+  }
+  if(value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    sampling_time = static_cast<int>(value);
+    return true;
+  }
+  ROS_WARN_STREAM("Ignoring parameter " << name << ", it is not a number");
+  return false;
+}
+
+pilz::SamplingTimesContainer pilz::SamplingTimesAggregator::getAggregatedSamplingTimes(const ros::NodeHandle& nh)
+{
+  XmlRpc::XmlRpcValue param;
+  if(!nh.getParam(PARAM_SAMPLING_TIMES_NS, param))
+  {
+    return pilz::SamplingTimesContainer();
+  }
+  return getSamplingTimes(param);
+}
+
+pilz::SamplingTimesContainer pilz::SamplingTimesAggregator::getAggregatedSamplingTimes(XmlRpc::XmlRpcValue& param)
+{
+  if(param.getType() != XmlRpc::XmlRpcValue::TypeStruct || !param.hasMember(PARAM_SAMPLING_TIMES_NS))
+  {
+    return pilz::SamplingTimesContainer();
+  }
+  return getSamplingTimes(param[PARAM_SAMPLING_TIMES_NS]);
+}
+
+pilz::SamplingTimesContainer pilz::SamplingTimesAggregator::getSamplingTimes(XmlRpc::XmlRpcValue& param)
+{
+  pilz::SamplingTimesContainer container;
+
+  if(param.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    ROS_WARN_STREAM("Ignoring parameter " << PARAM_SAMPLING_TIMES_NS
+                    << ", expected the sampling times per planning group");
+    return container;
+  }
+
+  for(auto& group_param : param)
+  {
+    if(group_param.second.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      ROS_WARN_STREAM("Ignoring sampling times of group " << group_param.first);
+      continue;
+    }
+
+    pilz::SamplingTimes sampling_times;
+    getSamplingTime(group_param.second, PARAM_SAMPLING_TIME, sampling_times.planning);
+    getSamplingTime(group_param.second, PARAM_OUTPUT_SAMPLING_TIME, sampling_times.output);
+    ROS_DEBUG_STREAM("Sampling times of group " << group_param.first << ": " << sampling_times.planning
+                     << "s (planning), " << sampling_times.output << "s (output)");
+    container.setSamplingTimes(group_param.first, sampling_times);
+  }
+
+  return container;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/tip_frame_pose_cache.h"
+
+#include <algorithm>
+
+namespace pilz
+{
+
+TipFramePoseCache::TipFramePoseCache(const robot_trajectory::RobotTrajectory& traj, const std::string& frame_name)
+  : frame_name_(frame_name)
+{
+  const std::size_t waypoint_num {traj.getWayPointCount()};
+  poses_.reserve(waypoint_num);
+  for(std::size_t i = 0; i < waypoint_num; ++i)
+  {
+    poses_.push_back(traj.getWayPoint(i).getFrameTransform(frame_name_));
+  }
+}
+
+TipFramePoseCache::TipFramePoseCache(const TipFramePoseCache& other, std::size_t first)
+  : frame_name_(other.frame_name_)
+{
+  first = std::min(first, other.poses_.size());
+  poses_.assign(other.poses_.begin() + static_cast<PoseCont::difference_type>(first), other.poses_.end());
+}
+
+}
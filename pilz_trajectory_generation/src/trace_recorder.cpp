@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include <unistd.h>
+
+#include <ros/console.h>
+
+namespace pilz
+{
+
+static const std::string PARAM_TRACE_FILE = "trace_file";
+
+constexpr std::size_t TraceRecorder::MAX_SPAN_COUNT;
+
+namespace
+{
+
+void writeJsonString(std::ostream& os, const std::string& str)
+{
+  os << '"';
+  for(const char c : str)
+  {
+    if(c == '"' || c == '\\')
+    {
+      os << '\\';
+    }
+    os << c;
+  }
+  os << '"';
+}
+
+double toMicroseconds(const TraceRecorder::Clock::duration& duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+}
+
+TraceRecorder::~TraceRecorder()
+{
+  // no logging here, rosconsole might already be shut down at process exit
+  if(recording_.exchange(false))
+  {
+    writeFile();
+  }
+}
+
+bool TraceRecorder::open(const std::string& file_name)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(recording_)
+  {
+    if(file_name != file_name_)
+    {
+      ROS_WARN_STREAM("Trace is already recorded to " << file_name_ << ", ignoring " << file_name);
+      return false;
+    }
+    return true;
+  }
+
+  file_name_ = file_name;
+  spans_.clear();
+  dropped_span_count_ = 0;
+  origin_ = Clock::now();
+  recording_ = true;
+  ROS_INFO_STREAM("Recording planning trace to " << file_name_);
+  return true;
+}
+
+bool TraceRecorder::openFromParameter(const ros::NodeHandle& nh)
+{
+  std::string file_name;
+  if(!nh.getParam(PARAM_TRACE_FILE, file_name))
+  {
+    return false;
+  }
+#ifndef PILZ_ENABLE_TRACING
+  ROS_WARN_STREAM("Parameter " << nh.resolveName(PARAM_TRACE_FILE) << " is set, but the package is built without "
+                  "tracing (CATKIN_ENABLE_TRACING). The trace will be empty.");
+#endif
+  return open(file_name);
+}
+
+void TraceRecorder::close()
+{
+  if(!recording_.exchange(false))
+  {
+    return;
+  }
+  if(!writeFile())
+  {
+    ROS_ERROR_STREAM("Failed to write planning trace to " << file_name_);
+  }
+}
+
+void TraceRecorder::addSpan(const std::string& name, const char* category,
+                            const Clock::time_point& start, const Clock::time_point& end)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(spans_.size() >= MAX_SPAN_COUNT)
+  {
+    ++dropped_span_count_;
+    return;
+  }
+  spans_.push_back(Span {name, category, start, end - start, std::this_thread::get_id()});
+}
+
+void TraceRecorder::write(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Chrome trace expects small integers as thread ids
+  std::vector<std::thread::id> thread_ids;
+  const int pid {static_cast<int>(::getpid())};
+
+  os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  for(std::size_t i = 0; i < spans_.size(); ++i)
+  {
+    const Span& span {spans_.at(i)};
+    auto it = std::find(thread_ids.begin(), thread_ids.end(), span.thread_id);
+    const std::size_t tid {static_cast<std::size_t>(it - thread_ids.begin())};
+    if(it == thread_ids.end())
+    {
+      thread_ids.push_back(span.thread_id);
+    }
+
+    os << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+    writeJsonString(os, span.name);
+    os << ",\"cat\":";
+    writeJsonString(os, span.category);
+    os << ",\"ph\":\"X\",\"ts\":" << toMicroseconds(span.start - origin_)
+       << ",\"dur\":" << toMicroseconds(span.duration)
+       << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_spans\":\"" << dropped_span_count_ << "\"}}\n";
+}
+
+void TraceRecorder::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  spans_.clear();
+  dropped_span_count_ = 0;
+}
+
+bool TraceRecorder::writeFile() const
+{
+  std::ofstream file(file_name_);
+  if(!file)
+  {
+    return false;
+  }
+  write(file);
+  return static_cast<bool>(file);
+}
+
+}
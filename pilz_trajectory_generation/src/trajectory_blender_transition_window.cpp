@@ -18,42 +18,67 @@
 #include "pilz_trajectory_generation/trajectory_blender_transition_window.h"
 
 #include <algorithm>
+#include <cassert>
+#include <limits>
 #include <math.h>
 
+#include "pilz_trajectory_generation/diagnostics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
+
 bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendRequest& req,
                                          pilz::TrajectoryBlendResponse& res)
 {
-  ROS_INFO("Start trajectory blending using transition window.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender, "Start trajectory blending using transition window.");
+  PILZ_TRACE_SCOPE("blend", "blend");
 
-  double sampling_time = 0.;
-  if(!validateRequest(req, sampling_time, res.error_code))
+  if(!validateRequest(req, res.error_code))
   {
-    ROS_ERROR("Trajectory blend request is not valid.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Trajectory blend request is not valid.");
     return false;
   }
 
+  // poses of the target link, needed by the intersection search as well as by the blending itself
+  const pilz::TipFramePoseCacheConstPtr first_poses {getPoses(req.first_trajectory, req.first_trajectory_poses,
+                                                              req.link_name)};
+  const pilz::TipFramePoseCacheConstPtr second_poses {getPoses(req.second_trajectory, req.second_trajectory_poses,
+                                                               req.link_name)};
+
+  // time from start of every waypoint, relative to the first waypoint of the respective trajectory
+  const std::vector<double> first_times {getTimesFromStart(*req.first_trajectory)};
+  const std::vector<double> second_times {getTimesFromStart(*req.second_trajectory)};
+
   // search for intersection points of the two trajectories with the blending sphere
   // intersection points belongs to blend trajectory after blending
   std::size_t first_intersection_index;
   std::size_t second_intersection_index;
-  if(!searchIntersectionPoints(req, first_intersection_index, second_intersection_index))
+  bool intersection_found;
   {
-    ROS_ERROR("Blend radius to large.");
+    PILZ_TRACE_SCOPE("blend", "search_intersection_points");
+    intersection_found = searchIntersectionPoints(*first_poses, *second_poses, req.blend_radius,
+                                                  first_intersection_index, second_intersection_index);
+  }
+  if(!intersection_found)
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Blend radius to large.");
     res.error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     return false;
   }
 
   // Select blending period and adjust the start and end point of the blend phase
-  std::size_t blend_align_index;
-  determineTrajectoryAlignment(req, first_intersection_index, second_intersection_index, blend_align_index);
+  double second_start_time;
+  determineTrajectoryAlignment(first_times, second_times, first_intersection_index, second_intersection_index,
+                               second_start_time);
 
   // blend the trajectories in Cartesian space
   pilz::CartesianTrajectory blend_trajectory_cartesian;
   blendTrajectoryCartesian(req,
+                           *first_poses,
+                           *second_poses,
+                           first_times,
+                           second_times,
                            first_intersection_index,
                            second_intersection_index,
-                           blend_align_index,
-                           sampling_time,
+                           second_start_time,
                            blend_trajectory_cartesian);
 
   // generate the blending trajectory in joint space
@@ -66,7 +91,7 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
     initial_joint_velocity[joint_name]
         = req.first_trajectory->getWayPoint(first_intersection_index-1).getVariableVelocity(joint_name);
   }
-  trajectory_msgs::JointTrajectory blend_joint_trajectory;
+  pilz::CompactTrajectory blend_joint_trajectory;
   moveit_msgs::MoveItErrorCodes error_code;
   if(!generateJointTrajectory(req.first_trajectory->getFirstWayPointPtr()->getRobotModel(),
                               limits_.getJointLimitContainer(),
@@ -77,15 +102,26 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
                               initial_joint_velocity,
                               blend_joint_trajectory,
                               error_code,
-                              true))
+                              true,
+                              req.cancellation))
   {
     // LCOV_EXCL_START
-    ROS_INFO("Failed to generate joint trajectory for blending trajectory.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Failed to generate joint trajectory for blending trajectory.");
     res.error_code.val = error_code.val;
     return false;
     // LCOV_EXCL_STOP
   }
 
+  // verify the blend trajectory as a whole, it is handed over without further checks
+  if(!verifyTrajectoryLimits(blend_joint_trajectory,
+                             limits_.getJointLimitContainer().getTable(req.group_name,
+                                                                       blend_joint_trajectory.getJointNames())))
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Blend trajectory violates the joint limits.");
+    res.error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    return false;
+  }
+
   res.first_trajectory = std::shared_ptr<robot_trajectory::RobotTrajectory>(new robot_trajectory::RobotTrajectory(
                                                                               req.first_trajectory->getRobotModel(),
                                                                               req.first_trajectory->getGroup()));
@@ -105,7 +141,7 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
   }
 
   // append the blend trajectory
-  res.blend_trajectory->setRobotTrajectoryMsg(req.first_trajectory->getFirstWayPoint(), blend_joint_trajectory);
+  blend_joint_trajectory.toRobotTrajectory(req.first_trajectory->getFirstWayPoint(), *res.blend_trajectory);
   // copy the points [second_intersection_index, len] from the second trajectory
   for(size_t i = second_intersection_index+1; i < req.second_trajectory->getWayPointCount(); ++i)
   {
@@ -114,23 +150,23 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
                                           req.second_trajectory->getWayPointDurationFromPrevious(i));
   }
 
-  // adjust the time from start
-  res.second_trajectory->setWayPointDurationFromPrevious(0, sampling_time);
+  // the blend trajectory ends at the second intersection point, so the duration of the first waypoint
+  // of the second trajectory is already correct
+  res.second_trajectory_poses = std::make_shared<pilz::TipFramePoseCache>(*second_poses, second_intersection_index+1);
 
   res.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   return true;
 }
 
 bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::TrajectoryBlendRequest &req,
-                                                   double& sampling_time,
                                                    moveit_msgs::MoveItErrorCodes &error_code) const
 {
-  ROS_DEBUG("Validate the trajectory blend request.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender, "Validate the trajectory blend request.");
 
   // check planning group
   if (!req.first_trajectory->getRobotModel()->hasJointModelGroup(req.group_name))
   {
-    ROS_ERROR_STREAM("Unknown planning group: " << req.group_name);
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Unknown planning group: " << req.group_name);
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME;
     return false;
   }
@@ -139,14 +175,14 @@ bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::Trajec
   if (!req.first_trajectory->getRobotModel()->hasLinkModel(req.link_name) &&
       !req.first_trajectory->getLastWayPoint().hasAttachedBody(req.link_name))
   {
-    ROS_ERROR_STREAM("Unknown link name: " << req.link_name);
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Unknown link name: " << req.link_name);
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_LINK_NAME;
     return false;
   }
 
   if(req.blend_radius <=0 )
   {
-    ROS_ERROR("Blending radius must be positive");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Blending radius must be positive");
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     return false;
   }
@@ -157,20 +193,19 @@ bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::Trajec
                               req.group_name,
                               epsilon))
   {
-    ROS_ERROR_STREAM("During blending the last point (" << req.first_trajectory->getLastWayPoint()
-                     << " of the preceding and the first point of the succeding trajectory ("
-                     << req.second_trajectory->getFirstWayPoint() << " do not match");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender,
+                      "During blending the last point (" << req.first_trajectory->getLastWayPoint()
+                      << " of the preceding and the first point of the succeding trajectory ("
+                      << req.second_trajectory->getFirstWayPoint() << " do not match");
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     return false;
   }
 
-  // same uniform sampling time
-  if (!pilz::determineAndCheckSamplingTime(req.first_trajectory,
-                                           req.second_trajectory,
-                                           epsilon,
-                                           sampling_time))
+  // the blending works in time, the waypoints do not need to be sampled uniformly
+  if(!hasStrictlyIncreasingTime(*req.first_trajectory) || !hasStrictlyIncreasingTime(*req.second_trajectory))
   {
-
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender,
+                      "Time from start of the blending trajectories is not strictly increasing.");
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     return false;
   }
@@ -179,7 +214,8 @@ bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::Trajec
   if(!pilz::isRobotStateStationary(req.first_trajectory->getLastWayPoint(), req.group_name, epsilon) ||
      !pilz::isRobotStateStationary(req.second_trajectory->getFirstWayPoint(), req.group_name, epsilon) )
   {
-    ROS_ERROR("Intersection point of the blending trajectories has non-zero velocities/accelerations.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender,
+                      "Intersection point of the blending trajectories has non-zero velocities/accelerations.");
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     return false;
   }
@@ -188,46 +224,51 @@ bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::Trajec
 }
 
 void pilz::TrajectoryBlenderTransitionWindow::blendTrajectoryCartesian(const pilz::TrajectoryBlendRequest &req,
+                                                            const pilz::TipFramePoseCache &first_poses,
+                                                            const pilz::TipFramePoseCache &second_poses,
+                                                            const std::vector<double> &first_times,
+                                                            const std::vector<double> &second_times,
                                                             const std::size_t first_interse_index,
                                                             const std::size_t second_interse_index,
-                                                            const std::size_t blend_align_index,
-                                                            double sampling_time,
+                                                            const double second_start_time,
                                                             pilz::CartesianTrajectory& trajectory) const
 {
   // other fields of the trajectory
   trajectory.group_name = req.group_name;
   trajectory.link_name = req.link_name;
 
-  // Pose on first trajectory
-  Eigen::Isometry3d blend_sample_pose1
-      = req.first_trajectory->getWayPoint(first_interse_index).getFrameTransform(req.link_name);
+  // blend phase on the time axis of the first trajectory,
+  // starting at the last waypoint of the first trajectory which is kept
+  const double blend_begin_time = first_times.at(first_interse_index-1);
+  const double blend_end_time = second_start_time + second_times.at(second_interse_index);
 
-  // Pose on second trajectory
-  Eigen::Isometry3d blend_sample_pose2
-      = req.second_trajectory->getWayPoint(second_interse_index).getFrameTransform(req.link_name);
+  // sample the blend phase at least as fine as the original trajectories inside the blend sphere
+  double sampling_time = std::numeric_limits<double>::max();
+  for(std::size_t i = first_interse_index; i < first_times.size(); ++i)
+  {
+    sampling_time = std::min(sampling_time, first_times.at(i) - first_times.at(i-1));
+  }
+  for(std::size_t i = 1; i <= second_interse_index; ++i)
+  {
+    sampling_time = std::min(sampling_time, second_times.at(i) - second_times.at(i-1));
+  }
+  const double blend_sample_num = std::max(1.0, std::ceil((blend_end_time - blend_begin_time)/sampling_time - epsilon));
+  sampling_time = (blend_end_time - blend_begin_time)/blend_sample_num;
 
-  // blend the trajectory
-  double blend_sample_num = second_interse_index + blend_align_index - first_interse_index +1 ;
   pilz::CartesianTrajectoryPoint waypoint;
   geometry_msgs::Pose waypoint_pose;
-  blend_sample_pose2 = req.second_trajectory->getFirstWayPoint().getFrameTransform(req.link_name);
 
   // Pose on blending trajectory
   Eigen::Isometry3d  blend_sample_pose;
   for(std::size_t i = 0; i < blend_sample_num; ++i)
   {
-    // if the first trajectory does not reach the last sample, update
-    if((first_interse_index+i) < req.first_trajectory->getWayPointCount())
-    {
-      blend_sample_pose1 = req.first_trajectory->getWayPoint(first_interse_index+i).getFrameTransform(req.link_name);
-    }
+    const double blend_sample_time = blend_begin_time + (i+1.0)*sampling_time;
 
-    // if after the alignment, the second trajectory starts, update
-    if((first_interse_index+i) > blend_align_index)
-    {
-      blend_sample_pose2
-         = req.second_trajectory->getWayPoint(first_interse_index+i-blend_align_index).getFrameTransform(req.link_name);
-    }
+    // Pose on first trajectory (stays at the end, if the first trajectory is already finished)
+    const Eigen::Isometry3d blend_sample_pose1 {interpolatePose(first_poses, first_times, blend_sample_time)};
+    // Pose on second trajectory (stays at the start, if the second trajectory has not started yet)
+    const Eigen::Isometry3d blend_sample_pose2 {interpolatePose(second_poses, second_times,
+                                                                blend_sample_time - second_start_time)};
 
     double s = (i+1)/blend_sample_num;
     double alpha = 6*std::pow(s,5) - 15*std::pow(s,4) + 10*std::pow(s,3);
@@ -250,50 +291,128 @@ void pilz::TrajectoryBlenderTransitionWindow::blendTrajectoryCartesian(const pil
   }
 }
 
-bool pilz::TrajectoryBlenderTransitionWindow::searchIntersectionPoints(const pilz::TrajectoryBlendRequest &req,
+bool pilz::TrajectoryBlenderTransitionWindow::searchIntersectionPoints(const pilz::TipFramePoseCache &first_poses,
+                                                            const pilz::TipFramePoseCache &second_poses,
+                                                            const double blend_radius,
                                                             std::size_t &first_interse_index,
                                                             std::size_t &second_interse_index) const
 {
-  ROS_INFO("Search for start and end point of blending trajectory.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender, "Search for start and end point of blending trajectory.");
 
   // compute the position of the center of the blend sphere
   // (last point of the first trajectory, first point of the second trajectory)
-  Eigen::Isometry3d circ_pose = req.first_trajectory->getLastWayPoint().getFrameTransform(req.link_name);
+  const Eigen::Vector3d circ_position = first_poses.getLastPose().translation();
 
   // Searh for intersection points according to distance
-  if(!linearSearchIntersectionPoint(req.link_name, circ_pose.translation(), req.blend_radius,
-                                    req.first_trajectory, true, first_interse_index))
+  if(!linearSearchIntersectionPoint(first_poses, circ_position, blend_radius, true, first_interse_index))
   {
-    ROS_ERROR_STREAM("Intersection point of first trajectory not found.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Intersection point of first trajectory not found.");
     return false;
   }
-  ROS_INFO_STREAM("Intersection point of first trajectory found, index: " << first_interse_index);
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender,
+                    "Intersection point of first trajectory found, index: " << first_interse_index);
 
-  if(!linearSearchIntersectionPoint(req.link_name, circ_pose.translation(), req.blend_radius,
-                                    req.second_trajectory, false, second_interse_index))
+  if(!linearSearchIntersectionPoint(second_poses, circ_position, blend_radius, false, second_interse_index))
   {
-    ROS_ERROR_STREAM("Intersection point of second trajectory not found.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Intersection point of second trajectory not found.");
     return false;
   }
 
-  ROS_INFO_STREAM("Intersection point of second trajectory found, index: " << second_interse_index);
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender,
+                    "Intersection point of second trajectory found, index: " << second_interse_index);
   return true;
 }
 
-void pilz::TrajectoryBlenderTransitionWindow::determineTrajectoryAlignment(const pilz::TrajectoryBlendRequest &req,
+void pilz::TrajectoryBlenderTransitionWindow::determineTrajectoryAlignment(const std::vector<double> &first_times,
+                                                                const std::vector<double> &second_times,
                                                                 std::size_t first_interse_index,
                                                                 std::size_t second_interse_index,
-                                                                std::size_t &blend_align_index) const
+                                                                double &second_start_time) const
 {
-  size_t way_point_count_1 = req.first_trajectory->getWayPointCount() - first_interse_index;
-  size_t way_point_count_2 = second_interse_index+1;
+  const double first_duration = first_times.back();
+  const double tau_1 = first_duration - first_times.at(first_interse_index);
+  const double tau_2 = second_times.at(second_interse_index);
 
-  if(way_point_count_1 > way_point_count_2)
+  if(tau_1 > tau_2)
   {
-    blend_align_index = req.first_trajectory->getWayPointCount() - second_interse_index -1;
+    second_start_time = first_duration - tau_2;
   }
   else
   {
-    blend_align_index = first_interse_index;
+    second_start_time = first_times.at(first_interse_index);
   }
 }
+
+pilz::TipFramePoseCacheConstPtr pilz::TrajectoryBlenderTransitionWindow::getPoses(
+    const robot_trajectory::RobotTrajectoryPtr& traj,
+    const pilz::TipFramePoseCacheConstPtr& poses,
+    const std::string& link_name)
+{
+  if(poses && poses->getFrameName() == link_name && poses->size() == traj->getWayPointCount())
+  {
+    return poses;
+  }
+  return std::make_shared<pilz::TipFramePoseCache>(*traj, link_name);
+}
+
+std::vector<double> pilz::TrajectoryBlenderTransitionWindow::getTimesFromStart(
+    const robot_trajectory::RobotTrajectory& traj)
+{
+  std::vector<double> times;
+  times.reserve(traj.getWayPointCount());
+  double time_from_start = 0.;
+  for(std::size_t i = 0; i < traj.getWayPointCount(); ++i)
+  {
+    // the duration of the first waypoint is not part of the trajectory
+    if(i > 0)
+    {
+      time_from_start += traj.getWayPointDurationFromPrevious(i);
+    }
+    times.push_back(time_from_start);
+  }
+  return times;
+}
+
+bool pilz::TrajectoryBlenderTransitionWindow::hasStrictlyIncreasingTime(const robot_trajectory::RobotTrajectory& traj)
+{
+  for(std::size_t i = 1; i < traj.getWayPointCount(); ++i)
+  {
+    if(traj.getWayPointDurationFromPrevious(i) <= 0.)
+    {
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender, "Duration of waypoint " << i << " is not positive.");
+      return false;
+    }
+  }
+  return true;
+}
+
+Eigen::Isometry3d pilz::TrajectoryBlenderTransitionWindow::interpolatePose(const pilz::TipFramePoseCache& poses,
+                                                                           const std::vector<double>& times,
+                                                                           double time)
+{
+  assert(poses.size() == times.size() && !times.empty());
+
+  if(time <= times.front())
+  {
+    return poses.getPose(0);
+  }
+  if(time >= times.back())
+  {
+    return poses.getLastPose();
+  }
+
+  // first waypoint after the specified time
+  const std::size_t index = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), time)
+                                                     - times.begin());
+  const Eigen::Isometry3d& pose_before {poses.getPose(index-1)};
+  const Eigen::Isometry3d& pose_after {poses.getPose(index)};
+  const double ratio = (time - times.at(index-1))/(times.at(index) - times.at(index-1));
+
+  Eigen::Isometry3d pose;
+  pose.translation() = pose_before.translation() + ratio*(pose_after.translation() - pose_before.translation());
+  Eigen::Quaterniond quat_before(pose_before.rotation());
+  Eigen::Quaterniond quat_after(pose_after.rotation());
+  pose.linear() = quat_before.slerp(ratio, quat_after).toRotationMatrix();
+  pose.makeAffine();
+  return pose;
+}
@@ -17,8 +17,206 @@
 
 #include "pilz_trajectory_generation/trajectory_functions.h"
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <Eigen/SVD>
+#include <moveit/kinematics_base/kinematics_base.h>
 #include <moveit/planning_scene/planning_scene.h>
 
+#include "pilz_trajectory_generation/allocation_counters.h"
+#include "pilz_trajectory_generation/diagnostics.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+namespace
+{
+
+//! Relative tolerance of the speed limit of the frames.
+constexpr double FRAME_SPEED_TOLERANCE {1e-6};
+//! Maximal number of times a trajectory is slowed down to satisfy the speed limit of the frames.
+constexpr std::size_t MAX_FRAME_SPEED_SCALINGS {3};
+
+/**
+ * @brief Processing time and allocation counts of a phase of the sampling loop of generateJointTrajectory().
+ */
+struct SamplingPhase
+{
+  double time {0.};
+  pilz::AllocationCounts counts;
+};
+
+/**
+ * @brief Adds the phases of the sampling loop of generateJointTrajectory() to the timings (if given).
+ */
+void addSamplingPhaseTimings(const SamplingPhase& ik, const SamplingPhase& limit_check, const SamplingPhase& waypoints,
+                             pilz::PhaseTimings* timings)
+{
+  if(!timings)
+  {
+    return;
+  }
+  timings->add("ik", ik.time, ik.counts);
+  timings->add("limit_check", limit_check.time, limit_check.counts);
+  timings->add("waypoints", waypoints.time, waypoints.counts);
+}
+
+/**
+ * @brief Adds the time and the allocation counts since the specified start to the specified phase
+ * and restarts the measurement.
+ */
+void addSamplingPhase(pilz::PhaseTimings::Clock::time_point& phase_start, pilz::AllocationCounts& phase_start_counts,
+                      SamplingPhase& phase)
+{
+  phase.time += pilz::PhaseTimings::getSecondsSince(phase_start);
+  phase.counts += pilz::AllocationCounters::getSince(phase_start_counts);
+  phase_start = pilz::PhaseTimings::Clock::now();
+  phase_start_counts = pilz::AllocationCounters::get();
+}
+
+/**
+ * @brief Computes the joint velocities and accelerations of a planning group from the twist and the
+ * acceleration of a link along a Cartesian trajectory:
+ *
+ *   qd = J^+ * v and qdd = J^+ * (a - Jd * qd)
+ *
+ * with the Jacobian J of the link at the joint positions of the sample. Jd * qd, the derivative of the
+ * Jacobian along the motion, is computed by a central difference in direction of the joint velocities.
+ *
+ * The derivatives are only computed for groups without redundancy (at most six variables), since the
+ * pseudo-inverse does not contain the null space motion of the inverse kinematics solutions.
+ */
+class JointDerivativesSolver
+{
+public:
+  //! Step of the central difference of the Jacobian, as time along the joint velocities [s]
+  static constexpr double JACOBIAN_DIFFERENCE_STEP {1e-6};
+
+  //! Relative threshold of the singular values of the Jacobian below which a sample is singular
+  static constexpr double SINGULAR_VALUE_THRESHOLD {1e-6};
+
+public:
+  /**
+   * @param joint_names The joints of the samples, in the order of the arrays of compute()
+   */
+  JointDerivativesSolver(const moveit::core::RobotModelConstPtr& robot_model,
+                         const std::string& group_name,
+                         const std::string& link_name,
+                         const std::vector<std::string>& joint_names)
+    : state_(robot_model)
+  {
+    state_.setToDefaultValues();
+    group_ = robot_model->getJointModelGroup(group_name);
+    link_ = robot_model->getLinkModel(link_name);
+    if(!group_ || !link_ || group_->getVariableCount() > 6 || group_->getJointModels().empty())
+    {
+      return;
+    }
+    // the Jacobian is expressed in the frame of the parent link of the first joint of the group
+    root_link_ = group_->getJointModels().front()->getParentLinkModel();
+
+    for(const auto& joint_name : joint_names)
+    {
+      variable_indices_.push_back(robot_model->getVariableIndex(joint_name));
+      columns_.push_back(group_->hasJointModel(joint_name) ? group_->getVariableGroupIndex(joint_name) : -1);
+    }
+    svd_.setThreshold(SINGULAR_VALUE_THRESHOLD);
+    available_ = true;
+  }
+
+  bool isAvailable() const
+  {
+    return available_;
+  }
+
+  /**
+   * @brief Computes the joint velocities and accelerations of a sample.
+   * @param positions The joint positions of the sample (the inverse kinematics solution)
+   * @param twist The twist of the link at the sample, in the model frame
+   * @param acceleration The acceleration of the link at the sample, in the model frame
+   * @return False if the Jacobian is singular (the outputs are then undefined), otherwise true.
+   */
+  bool compute(const double* positions, const KDL::Twist& twist, const KDL::Twist& acceleration,
+               double* velocities, double* accelerations)
+  {
+    assert(available_);
+    setPositions(positions, velocities, 0.);
+    state_.getJacobian(group_, link_, Eigen::Vector3d::Zero(), jacobian_);
+    svd_.compute(jacobian_, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    if(svd_.rank() < jacobian_.cols())
+    {
+      return false;
+    }
+
+    const Eigen::Matrix3d rotation {root_link_ ? state_.getGlobalLinkTransform(root_link_).linear().transpose()
+                                               : Eigen::Matrix3d::Identity()};
+    setVector(twist, rotation, cartesian_velocity_);
+    setVector(acceleration, rotation, cartesian_acceleration_);
+
+    group_velocities_ = svd_.solve(cartesian_velocity_);
+    toJointOrder(group_velocities_, velocities);
+
+    setPositions(positions, velocities, JACOBIAN_DIFFERENCE_STEP);
+    state_.getJacobian(group_, link_, Eigen::Vector3d::Zero(), jacobian_forward_);
+    setPositions(positions, velocities, -JACOBIAN_DIFFERENCE_STEP);
+    state_.getJacobian(group_, link_, Eigen::Vector3d::Zero(), jacobian_backward_);
+    cartesian_acceleration_ -= (jacobian_forward_ - jacobian_backward_) * group_velocities_
+                               / (2. * JACOBIAN_DIFFERENCE_STEP);
+
+    group_accelerations_ = svd_.solve(cartesian_acceleration_);
+    toJointOrder(group_accelerations_, accelerations);
+    return true;
+  }
+
+private:
+  //! Sets the positions + step * velocities and updates the link transforms.
+  void setPositions(const double* positions, const double* velocities, double step)
+  {
+    for(std::size_t j = 0; j < variable_indices_.size(); ++j)
+    {
+      state_.setVariablePosition(variable_indices_[j],
+                                 step == 0. ? positions[j] : positions[j] + step * velocities[j]);
+    }
+    state_.updateLinkTransforms();
+  }
+
+  void toJointOrder(const Eigen::VectorXd& group_values, double* values) const
+  {
+    for(std::size_t j = 0; j < columns_.size(); ++j)
+    {
+      values[j] = columns_[j] >= 0 ? group_values(columns_[j]) : 0.;
+    }
+  }
+
+  //! Rotates the linear and the angular part of the twist and stacks them like the rows of the Jacobian.
+  static void setVector(const KDL::Twist& twist, const Eigen::Matrix3d& rotation, Eigen::Matrix<double, 6, 1>& vector)
+  {
+    vector.head<3>() = rotation * Eigen::Vector3d(twist.vel.x(), twist.vel.y(), twist.vel.z());
+    vector.tail<3>() = rotation * Eigen::Vector3d(twist.rot.x(), twist.rot.y(), twist.rot.z());
+  }
+
+private:
+  bool available_ {false};
+  robot_state::RobotState state_;
+  const moveit::core::JointModelGroup* group_ {nullptr};
+  const moveit::core::LinkModel* link_ {nullptr};
+  const moveit::core::LinkModel* root_link_ {nullptr};
+
+  //! Index of the joints in the robot model and in the columns of the Jacobian (-1 if not in the group)
+  std::vector<int> variable_indices_;
+  std::vector<int> columns_;
+
+  Eigen::MatrixXd jacobian_, jacobian_forward_, jacobian_backward_;
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd_;
+  Eigen::Matrix<double, 6, 1> cartesian_velocity_, cartesian_acceleration_;
+  Eigen::VectorXd group_velocities_, group_accelerations_;
+};
+
+constexpr double JointDerivativesSolver::JACOBIAN_DIFFERENCE_STEP;
+constexpr double JointDerivativesSolver::SINGULAR_VALUE_THRESHOLD;
+
+}
+
 bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                          const std::string &group_name,
                          const std::string &link_name,
@@ -31,19 +229,21 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
 {
   if(!robot_model->hasJointModelGroup(group_name))
   {
-    ROS_ERROR_STREAM("Robot model has no planning group named as " << group_name);
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::IK, "Robot model has no planning group named as " << group_name);
     return false;
   }
 
   if(!robot_model->getJointModelGroup(group_name)->canSetStateFromIK(link_name))
   {
-    ROS_ERROR_STREAM("No valid IK solver exists for " << link_name << " in planning group " << group_name);
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                      "No valid IK solver exists for " << link_name << " in planning group " << group_name);
     return false;
   }
 
   if(frame_id != robot_model->getModelFrame())
   {
-    ROS_ERROR_STREAM("Given frame (" << frame_id << ") is unequal to model frame(" << robot_model->getModelFrame() << ")");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                      "Given frame (" << frame_id << ") is unequal to model frame(" << robot_model->getModelFrame() << ")");
     return false;
   }
 
@@ -72,9 +272,10 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
   }
   else
   {
-    ROS_ERROR_STREAM("Inverse kinematics for pose \n"
-                     << pose.translation()
-                     << " has no solution.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                      "Inverse kinematics for pose \n"
+                      << pose.translation()
+                      << " has no solution.");
     return false;
   }
 }
@@ -103,6 +304,92 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                        timeout);
 }
 
+bool pilz::computePoseIKSolutions(const moveit::core::RobotModelConstPtr &robot_model,
+                                  const std::string &group_name,
+                                  const std::string &link_name,
+                                  const Eigen::Isometry3d &pose,
+                                  const std::string &frame_id,
+                                  const std::map<std::string, double> &seed,
+                                  std::vector<std::map<std::string, double> > &solutions,
+                                  bool check_self_collision)
+{
+  solutions.clear();
+  if(!robot_model->hasJointModelGroup(group_name) || frame_id != robot_model->getModelFrame())
+  {
+    return false;
+  }
+
+  const robot_state::JointModelGroup* group {robot_model->getJointModelGroup(group_name)};
+  const kinematics::KinematicsBaseConstPtr& solver {group->getSolverInstance()};
+  if(!solver || solver->getTipFrames().size() != 1 || solver->getTipFrame() != link_name)
+  {
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::IK,
+                      "The solver of group " << group_name << " provides no solutions for link " << link_name);
+    return false;
+  }
+
+  robot_state::RobotState rstate(robot_model);
+  rstate.setToDefaultValues();
+  rstate.setVariablePositions(seed);
+  rstate.update();
+
+  // the solver expects the pose relative to its base frame
+  std::string base_frame {solver->getBaseFrame()};
+  if(!base_frame.empty() && base_frame.front() == '/')
+  {
+    base_frame.erase(0, 1);
+  }
+  if(!rstate.knowsFrameTransform(base_frame))
+  {
+    return false;
+  }
+  geometry_msgs::Pose solver_pose;
+  tf::poseEigenToMsg(rstate.getFrameTransform(base_frame).inverse() * pose, solver_pose);
+
+  const std::vector<std::string>& solver_joint_names {solver->getJointNames()};
+  std::vector<double> ik_seed;
+  ik_seed.reserve(solver_joint_names.size());
+  for(const auto& joint_name : solver_joint_names)
+  {
+    ik_seed.push_back(rstate.getVariablePosition(joint_name));
+  }
+
+  std::vector<std::vector<double> > ik_solutions;
+  kinematics::KinematicsResult result;
+  if(!solver->getPositionIK({solver_pose}, ik_seed, ik_solutions, result, kinematics::KinematicsQueryOptions()))
+  {
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::IK, "The solver of group " << group_name << " found no solutions");
+    return false;
+  }
+
+  std::vector<double> group_positions;
+  for(const auto& ik_solution : ik_solutions)
+  {
+    if(ik_solution.size() != solver_joint_names.size())
+    {
+      continue;
+    }
+    for(std::size_t j = 0; j < solver_joint_names.size(); ++j)
+    {
+      rstate.setVariablePosition(solver_joint_names[j], ik_solution[j]);
+    }
+    rstate.copyJointGroupPositions(group, group_positions);
+    if(!rstate.satisfiesBounds(group)
+       || !isStateColliding(check_self_collision, robot_model, &rstate, group, group_positions.data()))
+    {
+      continue;
+    }
+
+    std::map<std::string, double> solution;
+    for(const auto& joint_name : group->getActiveJointModelNames())
+    {
+      solution[joint_name] = rstate.getVariablePosition(joint_name);
+    }
+    solutions.push_back(solution);
+  }
+  return !solutions.empty();
+}
+
 bool pilz::computeLinkFK(const moveit::core::RobotModelConstPtr &robot_model,
                          const std::string &link_name,
                          const std::map<std::string, double> &joint_state,
@@ -114,7 +401,7 @@ bool pilz::computeLinkFK(const moveit::core::RobotModelConstPtr &robot_model,
   // check the reference frame of the target pose
   if(!rstate.knowsFrameTransform(link_name))
   {
-    ROS_ERROR_STREAM("The target link " << link_name << " is not known by robot.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::IK, "The target link " << link_name << " is not known by robot.");
     return false;
   }
 
@@ -138,7 +425,7 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
   const double epsilon = 10e-6;
   if(duration_current <= epsilon)
   {
-    ROS_ERROR("Sample duration too small, cannot compute the velocity");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits, "Sample duration too small, cannot compute the velocity");
     return false;
   }
 
@@ -150,25 +437,27 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
 
     if(!joint_limits.verifyVelocityLimit(pos.first, velocity_current))
     {
-      ROS_ERROR_STREAM("Joint velocity limit of " << pos.first << " violated. Set the velocity scaling factor lower!"
-                       << " Actual joint velocity is " << velocity_current
-                       << ", while the limit is " << joint_limits.getLimit(pos.first).max_velocity
-                       << ". ");
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                        "Joint velocity limit of " << pos.first << " violated. Set the velocity scaling factor lower!"
+                        << " Actual joint velocity is " << velocity_current
+                        << ", while the limit is " << joint_limits.getLimit(pos.first).max_velocity
+                        << ". ");
       return false;
     }
 
     acceleration_current = (velocity_current - velocity_last.at(pos.first))/(duration_last + duration_current)*2;
     // acceleration case
-    if(fabs(velocity_last.at(pos.first))<=fabs(velocity_current))
+    if(!pilz::JointLimitsTable::isDeceleration(velocity_last.at(pos.first), acceleration_current))
     {
       if(joint_limits.getLimit(pos.first).has_acceleration_limits &&
          fabs(acceleration_current)>fabs(joint_limits.getLimit(pos.first).max_acceleration))
       {
-        ROS_ERROR_STREAM("Joint acceleration limit of " << pos.first
-                         << " violated. Set the acceleration scaling factor lower!"
-                         << " Actual joint acceleration is " << acceleration_current
-                         << ", while the limit is " << joint_limits.getLimit(pos.first).max_acceleration
-                         << ". ");
+        PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                          "Joint acceleration limit of " << pos.first
+                          << " violated. Set the acceleration scaling factor lower!"
+                          << " Actual joint acceleration is " << acceleration_current
+                          << ", while the limit is " << joint_limits.getLimit(pos.first).max_acceleration
+                          << ". ");
         return false;
       }
     }
@@ -178,11 +467,12 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
       if(joint_limits.getLimit(pos.first).has_deceleration_limits &&
          fabs(acceleration_current)>fabs(joint_limits.getLimit(pos.first).max_deceleration))
       {
-        ROS_ERROR_STREAM("Joint deceleration limit of " << pos.first
-                         << " violated. Set the acceleration scaling factor lower!"
-                         << " Actual joint deceleration is " << acceleration_current
-                         << ", while the limit is " << joint_limits.getLimit(pos.first).max_deceleration
-                         << ". ");
+        PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                          "Joint deceleration limit of " << pos.first
+                          << " violated. Set the acceleration scaling factor lower!"
+                          << " Actual joint deceleration is " << acceleration_current
+                          << ", while the limit is " << joint_limits.getLimit(pos.first).max_deceleration
+                          << ". ");
         return false;
       }
     }
@@ -191,6 +481,292 @@ bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position
   return true;
 }
 
+bool pilz::verifySampleJointLimits(const double* position_last,
+                                   const double* velocity_last,
+                                   const double* position_current,
+                                   double duration_last,
+                                   double duration_current,
+                                   const pilz::JointLimitsTable& joint_limits,
+                                   double* velocity_current,
+                                   double* acceleration_current)
+{
+  const double epsilon = 10e-6;
+  if(duration_current <= epsilon)
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits, "Sample duration too small, cannot compute the velocity");
+    return false;
+  }
+
+  const std::size_t joint_count {joint_limits.size()};
+  for(std::size_t i = 0; i < joint_count; ++i)
+  {
+    velocity_current[i] = (position_current[i] - position_last[i])/duration_current;
+    acceleration_current[i] = (velocity_current[i] - velocity_last[i])/(duration_last + duration_current)*2;
+  }
+
+  std::size_t violation {joint_limits.findVelocityViolation(velocity_current, position_current)};
+  if(violation != pilz::JointLimitsTable::NO_VIOLATION)
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                      "Joint velocity limit of " << joint_limits.getJointNames()[violation]
+                      << " violated. Set the velocity scaling factor lower!"
+                      << " Actual joint velocity is " << velocity_current[violation]
+                      << ", while the limit is " << joint_limits.getMaxVelocity(violation, position_current)
+                      << ". ");
+    return false;
+  }
+
+  violation = joint_limits.findAccelerationViolation(velocity_last, acceleration_current, position_current);
+  if(violation != pilz::JointLimitsTable::NO_VIOLATION)
+  {
+    const bool is_deceleration {pilz::JointLimitsTable::isDeceleration(velocity_last[violation],
+                                                                        acceleration_current[violation])};
+    const char* kind {is_deceleration ? "deceleration" : "acceleration"};
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                      "Joint " << kind << " limit of " << joint_limits.getJointNames()[violation]
+                      << " violated. Set the acceleration scaling factor lower!"
+                      << " Actual joint " << kind << " is " << acceleration_current[violation]
+                      << ", while the limit is " << (is_deceleration
+                                                ? joint_limits.getMaxDeceleration(violation, position_current)
+                                                : joint_limits.getMaxAcceleration(violation, position_current))
+                      << ". ");
+    return false;
+  }
+
+  return true;
+}
+
+bool pilz::verifyTrajectoryLimits(const pilz::CompactTrajectory& trajectory,
+                                  const pilz::JointLimitsTable& joint_limits,
+                                  pilz::TrajectoryLimitViolation* violation)
+{
+  assert(trajectory.getJointNames() == joint_limits.getJointNames());
+  if(trajectory.empty())
+  {
+    return true;
+  }
+
+  pilz::TrajectoryLimitViolation first_violation;
+  if(!joint_limits.findTrajectoryViolation(trajectory.getWayPointCount(),
+                                           trajectory.getPositions(0),
+                                           trajectory.getVelocities(0),
+                                           trajectory.getAccelerations(0),
+                                           first_violation))
+  {
+    return true;
+  }
+
+  PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                    "Joint " << toString(first_violation.type) << " limit of "
+                    << joint_limits.getJointNames()[first_violation.joint]
+                    << " violated at waypoint " << first_violation.waypoint
+                    << " (" << trajectory.getTimeFromStart(first_violation.waypoint) << "s)."
+                    << " Actual joint " << toString(first_violation.type) << " is " << first_violation.value
+                    << ", while the limit is " << first_violation.limit << ".");
+  if(violation)
+  {
+    *violation = first_violation;
+  }
+  return false;
+}
+
+bool pilz::applySpeedOverride(const robot_trajectory::RobotTrajectory& trajectory,
+                              double speed_override,
+                              const pilz::JointLimitsTable& joint_limits,
+                              robot_trajectory::RobotTrajectory& scaled_trajectory)
+{
+  assert(speed_override > 0. && speed_override <= 1.);
+  assert(&trajectory != &scaled_trajectory);
+  scaled_trajectory.clear();
+  if(trajectory.empty())
+  {
+    return true;
+  }
+
+  pilz::CompactTrajectory compact_trajectory {pilz::CompactTrajectory::getVariableNames(trajectory)};
+  compact_trajectory.appendRobotTrajectory(trajectory);
+  compact_trajectory.scaleTime(1. / speed_override);
+  if(!verifyTrajectoryLimits(compact_trajectory, joint_limits))
+  {
+    return false;
+  }
+  compact_trajectory.toRobotTrajectory(trajectory.getFirstWayPoint(), scaled_trajectory);
+  return true;
+}
+
+pilz::FrameSpeed pilz::computeMaxFrameSpeed(const robot_state::RobotState& reference_state,
+                                             const pilz::CompactTrajectory& trajectory,
+                                             const std::vector<const moveit::core::LinkModel*>& links)
+{
+  pilz::FrameSpeed max_speed;
+  if(trajectory.getWayPointCount() < 2 || links.empty())
+  {
+    return max_speed;
+  }
+
+  const moveit::core::RobotModel& model {*reference_state.getRobotModel()};
+  std::vector<int> indices;
+  indices.reserve(trajectory.getJointCount());
+  for(const auto& joint_name : trajectory.getJointNames())
+  {
+    indices.push_back(model.getVariableIndex(joint_name));
+  }
+
+  // the positions of the links at the previous and the current waypoint
+  robot_state::RobotState state {reference_state};
+  std::vector<Eigen::Vector3d> last_positions(links.size());
+  std::vector<Eigen::Vector3d> current_positions(links.size());
+  for(std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    const double* positions {trajectory.getPositions(i)};
+    for(std::size_t j = 0; j < indices.size(); ++j)
+    {
+      state.setVariablePosition(indices[j], positions[j]);
+    }
+    // one update of the link transforms for all links
+    state.updateLinkTransforms();
+    for(std::size_t k = 0; k < links.size(); ++k)
+    {
+      current_positions[k] = state.getGlobalLinkTransform(links[k]).translation();
+    }
+
+    const double duration {trajectory.getDurationFromPrevious(i)};
+    if(i > 0 && duration > 0.)
+    {
+      for(std::size_t k = 0; k < links.size(); ++k)
+      {
+        const double speed {(current_positions[k] - last_positions[k]).norm() / duration};
+        if(speed > max_speed.speed)
+        {
+          max_speed.speed = speed;
+          max_speed.waypoint = i;
+          max_speed.frame = k;
+        }
+      }
+    }
+    last_positions.swap(current_positions);
+  }
+  return max_speed;
+}
+
+bool pilz::enforceFrameSpeedLimit(const robot_state::RobotState& reference_state,
+                                  const pilz::CartesianLimit& cartesian_limit,
+                                  double sampling_time,
+                                  pilz::CompactTrajectory& trajectory)
+{
+  if(!cartesian_limit.hasMaxFrameSpeed() || cartesian_limit.getSpeedLimitFrames().empty())
+  {
+    return false;
+  }
+
+  const moveit::core::RobotModel& model {*reference_state.getRobotModel()};
+  std::vector<const moveit::core::LinkModel*> links;
+  for(const auto& frame : cartesian_limit.getSpeedLimitFrames())
+  {
+    if(!model.hasLinkModel(frame))
+    {
+      throw UnknownSpeedLimitFrame("Frame \"" + frame + "\" of the speed limit is not a link of the robot model");
+    }
+    links.push_back(model.getLinkModel(frame));
+  }
+
+  const double max_speed {cartesian_limit.getMaxFrameSpeed()};
+  for(std::size_t scalings = 0; ; ++scalings)
+  {
+    const pilz::FrameSpeed frame_speed {computeMaxFrameSpeed(reference_state, trajectory, links)};
+    if(frame_speed.speed <= max_speed * (1. + FRAME_SPEED_TOLERANCE))
+    {
+      return scalings > 0;
+    }
+
+    std::ostringstream os;
+    os << "Frame \"" << links[frame_speed.frame]->getName() << "\" moves with " << frame_speed.speed
+       << "m/s at " << trajectory.getTimeFromStart(frame_speed.waypoint) << "s, while the speed limit is "
+       << max_speed << "m/s";
+    if(!cartesian_limit.getScaleToMaxFrameSpeed() || scalings == MAX_FRAME_SPEED_SCALINGS)
+    {
+      throw FrameSpeedLimitViolated(os.str());
+    }
+
+    PILZ_INFO_STREAM(pilz::LogSubsystem::Limits, os.str() << ", slowing down the trajectory");
+    trajectory.scaleTime(frame_speed.speed / max_speed);
+    if(sampling_time == 0.)
+    {
+      // the distances between the waypoints are kept, so one scaling is sufficient
+      return true;
+    }
+    // restore the sampling time, the resampled waypoints can move slightly faster
+    pilz::CompactTrajectory resampled_trajectory;
+    resampleJointTrajectory(trajectory, sampling_time, resampled_trajectory);
+    trajectory = std::move(resampled_trajectory);
+  }
+}
+
+bool pilz::scanCartesianPath(const moveit::core::RobotModelConstPtr& robot_model,
+                             const std::string& group_name,
+                             const std::string& link_name,
+                             const KDL::Path& path,
+                             const std::map<std::string, double>& initial_joint_position,
+                             std::size_t sample_count,
+                             double min_manipulability,
+                             pilz::PathScanResult& result)
+{
+  PILZ_TRACE_SCOPE("ik", "scan_cartesian_path");
+  result = pilz::PathScanResult();
+  if(!robot_model->hasJointModelGroup(group_name) || !robot_model->hasLinkModel(link_name))
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                      "Cannot scan the path of link " << link_name << " of planning group " << group_name);
+    result.status = pilz::PathScanResult::Status::Unreachable;
+    return false;
+  }
+  const moveit::core::JointModelGroup* group {robot_model->getJointModelGroup(group_name)};
+  const moveit::core::LinkModel* link {robot_model->getLinkModel(link_name)};
+
+  robot_state::RobotState state(robot_model);
+  state.setToDefaultValues();
+  std::map<std::string, double> seed {initial_joint_position}, solution;
+  Eigen::Isometry3d pose;
+  Eigen::MatrixXd jacobian;
+  for(std::size_t k = 0; k <= sample_count; ++k)
+  {
+    const double path_fraction {sample_count == 0 ? 0. : static_cast<double>(k) / static_cast<double>(sample_count)};
+    // the start of the path is given by the initial joint positions
+    if(k > 0)
+    {
+      tf::transformKDLToEigen(path.Pos(path_fraction * path.PathLength()), pose);
+      if(!computePoseIK(robot_model, group_name, link_name, pose, robot_model->getModelFrame(), seed, solution))
+      {
+        PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                          "Path scan: no inverse kinematics solution at " << path_fraction * 100. << "% of the path.");
+        result.status = pilz::PathScanResult::Status::Unreachable;
+        result.path_fraction = path_fraction;
+        return false;
+      }
+      for(const auto& joint_position : solution)
+      {
+        seed[joint_position.first] = joint_position.second;
+      }
+    }
+
+    state.setVariablePositions(seed);
+    state.updateLinkTransforms();
+    state.getJacobian(group, link, Eigen::Vector3d::Zero(), jacobian);
+    const double manipulability {jacobian.jacobiSvd().singularValues().prod()};
+    result.min_manipulability = std::min(result.min_manipulability, manipulability);
+    if(manipulability < min_manipulability)
+    {
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                        "Path scan: manipulability " << manipulability << " at " << path_fraction * 100.
+                        << "% of the path is below the minimum " << min_manipulability << ".");
+      result.status = pilz::PathScanResult::Status::Singular;
+      result.path_fraction = path_fraction;
+      return false;
+    }
+  }
+  return true;
+}
+
 bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
                                    const pilz::JointLimitsContainer& joint_limits,
                                    const KDL::Trajectory &trajectory,
@@ -202,7 +778,32 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                                    moveit_msgs::MoveItErrorCodes &error_code,
                                    bool check_self_collision)
 {
-  ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
+  pilz::CompactTrajectory compact_trajectory;
+  if(!generateJointTrajectory(robot_model, joint_limits, trajectory, group_name, link_name, initial_joint_position,
+                              sampling_time, compact_trajectory, error_code, check_self_collision))
+  {
+    joint_trajectory.points.clear();
+    return false;
+  }
+  compact_trajectory.toJointTrajectoryMsg(joint_trajectory);
+  return true;
+}
+
+bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
+                                   const pilz::JointLimitsContainer& joint_limits,
+                                   const KDL::Trajectory &trajectory,
+                                   const std::string &group_name,
+                                   const std::string &link_name,
+                                   const std::map<std::string, double> &initial_joint_position,
+                                   const double &sampling_time,
+                                   pilz::CompactTrajectory &joint_trajectory,
+                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                   bool check_self_collision,
+                                   const pilz::CancellationToken& cancellation,
+                                   pilz::PhaseTimings* timings)
+{
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Generate joint trajectory from a Cartesian trajectory.");
+  PILZ_TRACE_SCOPE("ik", "generate_joint_trajectory");
 
   ros::Time generation_begin = ros::Time::now();
 
@@ -215,17 +816,47 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
   }
   time_samples.push_back(trajectory.Duration());
 
+  // set joint names
+  std::vector<std::string> joint_names;
+  for(const auto& start_joint : initial_joint_position)
+  {
+    joint_names.push_back(start_joint.first);
+  }
+  joint_trajectory.setJointNames(joint_names);
+  joint_trajectory.reserve(time_samples.size());
+
+  // the limits and the values of the last and the current sample in the order of the joint names
+  const pilz::JointLimitsTable limits_table {joint_limits.getTable(group_name, joint_names)};
+  const std::size_t joint_count {joint_names.size()};
+  std::vector<double> positions_last(joint_count), positions_current(joint_count);
+  std::vector<double> velocities_last(joint_count, 0.), velocities_current(joint_count, 0.);
+  std::vector<double> accelerations_current(joint_count, 0.);
+  for(std::size_t j = 0; j < joint_count; ++j)
+  {
+    positions_last[j] = initial_joint_position.at(joint_names[j]);
+  }
+
+  // the exact joint velocities and accelerations from the twist of the trajectory, if available for the group
+  JointDerivativesSolver derivatives_solver(robot_model, group_name, link_name, joint_names);
+
   // sample the trajectory and solve the inverse kinematics
   Eigen::Isometry3d pose_sample;
-  std::map<std::string, double> ik_solution_last, ik_solution, joint_velocity_last;
+  std::map<std::string, double> ik_solution_last, ik_solution;
   ik_solution_last = initial_joint_position;
-  for(const auto& item: ik_solution_last)
-  {
-    joint_velocity_last[item.first] = 0.0;
-  }
 
+  SamplingPhase ik_phase, limit_check_phase, waypoints_phase;
   for(std::vector<double>::const_iterator time_iter=time_samples.begin();  time_iter!=time_samples.end(); ++time_iter )
   {
+    if(cancellation.isCancelled())
+    {
+      PILZ_WARN_STREAM(pilz::LogSubsystem::Generator, "Generation of joint trajectory cancelled.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      joint_trajectory.clear();
+      return false;
+    }
+
+    pilz::PhaseTimings::Clock::time_point phase_start {pilz::PhaseTimings::Clock::now()};
+    pilz::AllocationCounts phase_start_counts {pilz::AllocationCounters::get()};
     tf::transformKDLToEigen(trajectory.Pos(*time_iter), pose_sample);
 
     if(!computePoseIK(robot_model,
@@ -237,11 +868,13 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                       ik_solution,
                       check_self_collision))
     {
-      ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                        "Failed to compute inverse kinematics solution for sampled Cartesian pose.");
       error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
     }
+    addSamplingPhase(phase_start, phase_start_counts, ik_phase);
 
     //check the joint limits
     double duration_current_sample = sampling_time;
@@ -255,62 +888,93 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
       duration_current_sample = *time_iter;
     }
 
+    for(std::size_t j = 0; j < joint_count; ++j)
+    {
+      positions_current[j] = ik_solution.at(joint_names[j]);
+    }
+
+    if(derivatives_solver.isAvailable() && derivatives_solver.compute(positions_current.data(),
+                                                                      trajectory.Vel(*time_iter),
+                                                                      trajectory.Acc(*time_iter),
+                                                                      velocities_current.data(),
+                                                                      accelerations_current.data()))
+    {
+      // all samples are checked, including the first one
+      pilz::TrajectoryLimitViolation violation;
+      if(limits_table.findTrajectoryViolation(1, positions_current.data(), velocities_current.data(),
+                                              accelerations_current.data(), violation))
+      {
+        PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                          "Joint " << toString(violation.type) << " limit of "
+                          << limits_table.getJointNames()[violation.joint]
+                          << " violated by the inverse kinematics solution at " << *time_iter << "s."
+                          << " Actual joint " << toString(violation.type) << " is " << violation.value
+                          << ", while the limit is " << violation.limit << ".");
+        error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+        joint_trajectory.clear();
+        return false;
+      }
+    }
+    // otherwise (redundant group or singular sample) finite differences of the samples,
     // skip the first sample with zero time from start for limits checking
-    if(time_iter!=time_samples.begin() && !verifySampleJointLimits(ik_solution_last,
-                                                                   joint_velocity_last,
-                                                                   ik_solution,
+    else if(time_iter!=time_samples.begin() && !verifySampleJointLimits(positions_last.data(),
+                                                                   velocities_last.data(),
+                                                                   positions_current.data(),
                                                                    sampling_time,
                                                                    duration_current_sample,
-                                                                   joint_limits))
+                                                                   limits_table,
+                                                                   velocities_current.data(),
+                                                                   accelerations_current.data()))
     {
-      ROS_ERROR_STREAM("Inverse kinematics solution at " << *time_iter
-                       << "s violates the joint velocity/acceleration/deceleration limits.");
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                        "Inverse kinematics solution at " << *time_iter
+                        << "s violates the joint velocity/acceleration/deceleration limits.");
       error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
     }
+    addSamplingPhase(phase_start, phase_start_counts, limit_check_phase);
 
     // fill the point with joint values
-    trajectory_msgs::JointTrajectoryPoint point;
-
-    // set joint names
-    joint_trajectory.joint_names.clear();
-    for(const auto& start_joint : initial_joint_position)
+    const std::size_t point_index {joint_trajectory.addWayPoint(*time_iter)};
+    double* positions {joint_trajectory.getPositions(point_index)};
+    double* velocities {joint_trajectory.getVelocities(point_index)};
+    double* accelerations {joint_trajectory.getAccelerations(point_index)};
+
+    // the velocities and accelerations were computed by the limits check,
+    // the trajectory starts and ends at rest
+    const bool is_inner_point {time_iter!=time_samples.begin() && time_iter!=time_samples.end()-1};
+    for(std::size_t j = 0; j < joint_count; ++j)
     {
-      joint_trajectory.joint_names.push_back(start_joint.first);
-    }
+      positions[j] = positions_current[j];
 
-    point.time_from_start =  ros::Duration(*time_iter);
-    for(const auto& joint_name : joint_trajectory.joint_names)
-    {
-      point.positions.push_back(ik_solution.at(joint_name));
-
-      if(time_iter!=time_samples.begin() && time_iter!=time_samples.end()-1)
+      if(is_inner_point)
       {
-        double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name))/duration_current_sample;
-        point.velocities.push_back(joint_velocity);
-        point.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name))/(duration_current_sample
-                                                                                             +sampling_time)*2);
-        joint_velocity_last[joint_name] = joint_velocity;
+        velocities[j] = velocities_current[j];
+        accelerations[j] = accelerations_current[j];
+        velocities_last[j] = velocities_current[j];
       }
       else
       {
-        point.velocities.push_back(0.);
-        point.accelerations.push_back(0.);
-        joint_velocity_last[joint_name] = 0.;
+        // first and last point have zero velocity and acceleration (already set by addWayPoint)
+        velocities_last[j] = 0.;
       }
     }
 
     // update joint trajectory
-    joint_trajectory.points.push_back(point);
+    PILZ_COUNT_COPY(ik_solution.size() * sizeof(std::map<std::string, double>::value_type));
     ik_solution_last = ik_solution;
+    positions_last.swap(positions_current);
+    addSamplingPhase(phase_start, phase_start_counts, waypoints_phase);
   }
 
+  addSamplingPhaseTimings(ik_phase, limit_check_phase, waypoints_phase, timings);
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   double duration_ms = (ros::Time::now() - generation_begin).toSec() * 1000;
-  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.points.size()
-                  << ") took " << duration_ms << " ms | "
-                  << duration_ms / joint_trajectory.points.size() << " ms per Point");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator,
+                    "Generate trajectory (N-Points: " << joint_trajectory.getWayPointCount()
+                    << ") took " << duration_ms << " ms | "
+                    << duration_ms / joint_trajectory.getWayPointCount() << " ms per Point");
 
   return true;
 }
@@ -326,23 +990,73 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                                    moveit_msgs::MoveItErrorCodes &error_code,
                                    bool check_self_collision)
 {
-  ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
+  pilz::CompactTrajectory compact_trajectory;
+  if(!generateJointTrajectory(robot_model, joint_limits, trajectory, group_name, link_name, initial_joint_position,
+                              initial_joint_velocity, compact_trajectory, error_code, check_self_collision))
+  {
+    joint_trajectory.points.clear();
+    return false;
+  }
+  compact_trajectory.toJointTrajectoryMsg(joint_trajectory);
+  return true;
+}
+
+bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
+                                   const pilz::JointLimitsContainer &joint_limits,
+                                   const pilz::CartesianTrajectory &trajectory,
+                                   const std::string &group_name,
+                                   const std::string &link_name,
+                                   const std::map<std::string, double> &initial_joint_position,
+                                   const std::map<std::string, double> &initial_joint_velocity,
+                                   pilz::CompactTrajectory &joint_trajectory,
+                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                   bool check_self_collision,
+                                   const pilz::CancellationToken& cancellation,
+                                   pilz::PhaseTimings* timings)
+{
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Generate joint trajectory from a Cartesian trajectory.");
+  PILZ_TRACE_SCOPE("ik", "generate_joint_trajectory");
 
   ros::Time generation_begin = ros::Time::now();
 
   std::map<std::string, double> ik_solution_last = initial_joint_position;
-  std::map<std::string, double> joint_velocity_last = initial_joint_velocity;
   double duration_last = 0;
   double duration_current = 0;
-  joint_trajectory.joint_names.clear();
+  std::vector<std::string> joint_names;
   for(const auto& joint_position:ik_solution_last)
   {
-    joint_trajectory.joint_names.push_back(joint_position.first);
+    joint_names.push_back(joint_position.first);
   }
+  joint_trajectory.setJointNames(joint_names);
+  joint_trajectory.reserve(trajectory.points.size());
+
+  // the limits and the values of the last and the current sample in the order of the joint names
+  const pilz::JointLimitsTable limits_table {joint_limits.getTable(group_name, joint_names)};
+  const std::size_t joint_count {joint_names.size()};
+  std::vector<double> positions_last(joint_count), positions_current(joint_count);
+  std::vector<double> velocities_last(joint_count), velocities_current(joint_count);
+  std::vector<double> accelerations_current(joint_count);
+  for(std::size_t j = 0; j < joint_count; ++j)
+  {
+    positions_last[j] = initial_joint_position.at(joint_names[j]);
+    velocities_last[j] = initial_joint_velocity.at(joint_names[j]);
+  }
+
   std::map<std::string, double> ik_solution;
+  SamplingPhase ik_phase, limit_check_phase, waypoints_phase;
   for(size_t i=0; i<trajectory.points.size(); ++i)
   {
+    if(cancellation.isCancelled())
+    {
+      PILZ_WARN_STREAM(pilz::LogSubsystem::Generator, "Generation of joint trajectory cancelled.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      joint_trajectory.clear();
+      return false;
+    }
+
     // compute inverse kinematics
+    pilz::PhaseTimings::Clock::time_point phase_start {pilz::PhaseTimings::Clock::now()};
+    pilz::AllocationCounts phase_start_counts {pilz::AllocationCounters::get()};
     if(!computePoseIK(robot_model,
                       group_name,
                       link_name,
@@ -352,11 +1066,13 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                       ik_solution,
                       check_self_collision))
     {
-      ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::IK,
+                        "Failed to compute inverse kinematics solution for sampled Cartesian pose.");
       error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
     }
+    addSamplingPhase(phase_start, phase_start_counts, ik_phase);
 
     // verify the joint limits
     if(i==0)
@@ -370,54 +1086,137 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
           - trajectory.points.at(i-1).time_from_start.toSec();
     }
 
-    if(!verifySampleJointLimits(ik_solution_last,
-                                joint_velocity_last,
-                                ik_solution,
+    for(std::size_t j = 0; j < joint_count; ++j)
+    {
+      positions_current[j] = ik_solution.at(joint_names[j]);
+    }
+
+    if(!verifySampleJointLimits(positions_last.data(),
+                                velocities_last.data(),
+                                positions_current.data(),
                                 duration_last,
                                 duration_current,
-                                joint_limits))
+                                limits_table,
+                                velocities_current.data(),
+                                accelerations_current.data()))
     {
       // LCOV_EXCL_START since the same code was captured in a test in the other overload generateJointTrajectory(..., KDL::Trajectory, ...)
       // TODO: refactor to avoid code duplication.
-      ROS_ERROR_STREAM("Inverse kinematics solution of the " << i
-                       << "th sample violates the joint velocity/acceleration/deceleration limits.");
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Limits,
+                        "Inverse kinematics solution of the " << i
+                        << "th sample violates the joint velocity/acceleration/deceleration limits.");
       error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      joint_trajectory.points.clear();
+      joint_trajectory.clear();
       return false;
       // LCOV_EXCL_STOP
     }
+    addSamplingPhase(phase_start, phase_start_counts, limit_check_phase);
 
     // compute the waypoint
-    trajectory_msgs::JointTrajectoryPoint waypoint_joint;
-    waypoint_joint.time_from_start =  ros::Duration(trajectory.points.at(i).time_from_start);
-    for(const auto& joint_name : joint_trajectory.joint_names)
-    {
-      waypoint_joint.positions.push_back(ik_solution.at(joint_name));
-      double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name))/duration_current;
-      waypoint_joint.velocities.push_back(joint_velocity);
-      waypoint_joint.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name))/(duration_current
-                                                                                                    +duration_last)*2);
-      //update the joint velocity
-      joint_velocity_last[joint_name] = joint_velocity;
-    }
+    const std::size_t point_index {joint_trajectory.addWayPoint(trajectory.points.at(i).time_from_start.toSec())};
+    double* positions {joint_trajectory.getPositions(point_index)};
+    double* velocities {joint_trajectory.getVelocities(point_index)};
+    double* accelerations {joint_trajectory.getAccelerations(point_index)};
+    // the velocities and accelerations were computed by the limits check
+    std::copy(positions_current.begin(), positions_current.end(), positions);
+    std::copy(velocities_current.begin(), velocities_current.end(), velocities);
+    std::copy(accelerations_current.begin(), accelerations_current.end(), accelerations);
 
     // update joint trajectory
-    joint_trajectory.points.push_back(waypoint_joint);
+    PILZ_COUNT_COPY(ik_solution.size() * sizeof(std::map<std::string, double>::value_type));
     ik_solution_last = ik_solution;
+    positions_last.swap(positions_current);
+    velocities_last.swap(velocities_current);
     duration_last = duration_current;
+    addSamplingPhase(phase_start, phase_start_counts, waypoints_phase);
   }
+  addSamplingPhaseTimings(ik_phase, limit_check_phase, waypoints_phase, timings);
 
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
 
   double duration_ms = (ros::Time::now() - generation_begin).toSec() * 1000;
-  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.points.size()
-                  << ") took " << duration_ms << " ms | "
-                  << duration_ms / joint_trajectory.points.size() << " ms per Point");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator,
+                    "Generate trajectory (N-Points: " << joint_trajectory.getWayPointCount()
+                    << ") took " << duration_ms << " ms | "
+                    << duration_ms / joint_trajectory.getWayPointCount() << " ms per Point");
 
   return true;
 }
 
 
+void pilz::resampleJointTrajectory(const pilz::CompactTrajectory& trajectory,
+                                   double sampling_time,
+                                   pilz::CompactTrajectory& resampled_trajectory)
+{
+  assert(sampling_time > 0.);
+  const std::size_t waypoint_count {trajectory.getWayPointCount()};
+  if(waypoint_count < 2)
+  {
+    resampled_trajectory = trajectory;
+    return;
+  }
+
+  const std::size_t joint_count {trajectory.getJointCount()};
+  resampled_trajectory.setJointNames(trajectory.getJointNames());
+
+  const double start_time {trajectory.getTimeFromStart(0)};
+  const double end_time {trajectory.getDuration()};
+  // samples closer to the last waypoint are dropped, the last waypoint is added instead
+  const double end_tolerance {1e-6 * sampling_time};
+  resampled_trajectory.reserve(static_cast<std::size_t>(std::ceil((end_time - start_time) / sampling_time)) + 1);
+
+  std::size_t segment {0};
+  for(std::size_t k = 0; ; ++k)
+  {
+    const double time {start_time + static_cast<double>(k) * sampling_time};
+    if(time >= end_time - end_tolerance)
+    {
+      break;
+    }
+    while(segment + 2 < waypoint_count && time > trajectory.getTimeFromStart(segment + 1))
+    {
+      ++segment;
+    }
+
+    const double t0 {trajectory.getTimeFromStart(segment)};
+    const double h {trajectory.getTimeFromStart(segment + 1) - t0};
+    const double s {h > 0. ? (time - t0) / h : 0.};
+    const double s2 {s * s};
+    const double s3 {s2 * s};
+    // Hermite basis functions and their derivatives with respect to s
+    const double h00 {2. * s3 - 3. * s2 + 1.}, h10 {s3 - 2. * s2 + s};
+    const double h01 {-2. * s3 + 3. * s2}, h11 {s3 - s2};
+    const double dh00 {6. * s2 - 6. * s}, dh10 {3. * s2 - 4. * s + 1.};
+    const double dh01 {-6. * s2 + 6. * s}, dh11 {3. * s2 - 2. * s};
+    const double ddh00 {12. * s - 6.}, ddh10 {6. * s - 4.};
+    const double ddh01 {-12. * s + 6.}, ddh11 {6. * s - 2.};
+
+    const double* p0 {trajectory.getPositions(segment)};
+    const double* p1 {trajectory.getPositions(segment + 1)};
+    // the velocities of the waypoints are the tangents of the splines
+    const double* m0 {trajectory.getVelocities(segment)};
+    const double* m1 {trajectory.getVelocities(segment + 1)};
+
+    const std::size_t index {resampled_trajectory.addWayPoint(time)};
+    double* positions {resampled_trajectory.getPositions(index)};
+    double* velocities {resampled_trajectory.getVelocities(index)};
+    double* accelerations {resampled_trajectory.getAccelerations(index)};
+    for(std::size_t j = 0; j < joint_count; ++j)
+    {
+      positions[j] = h00 * p0[j] + h10 * h * m0[j] + h01 * p1[j] + h11 * h * m1[j];
+      if(h > 0.)
+      {
+        velocities[j] = (dh00 * p0[j] + dh10 * h * m0[j] + dh01 * p1[j] + dh11 * h * m1[j]) / h;
+        accelerations[j] = (ddh00 * p0[j] + ddh10 * h * m0[j] + ddh01 * p1[j] + ddh11 * h * m1[j]) / (h * h);
+      }
+    }
+  }
+
+  // the last waypoint is kept as it is
+  resampled_trajectory.append(trajectory, 0., waypoint_count - 1);
+  resampled_trajectory.setTimeFromStart(resampled_trajectory.getWayPointCount() - 1, end_time);
+}
+
 bool pilz::determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectoryPtr& first_trajectory,
                                          const robot_trajectory::RobotTrajectoryPtr& second_trajectory,
                                          double epsilon,
@@ -428,7 +1227,8 @@ bool pilz::determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectory
   std::size_t n2 = second_trajectory->getWayPointCount() - 1;
   if ( (n1 < 2) && (n2 < 2) )
   {
-    ROS_ERROR_STREAM("Both trajectories do not have enough points to determine sampling time.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender,
+                      "Both trajectories do not have enough points to determine sampling time.");
     return false;
   }
 
@@ -447,9 +1247,10 @@ bool pilz::determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectory
     {
       if ( fabs(sampling_time - first_trajectory->getWayPointDurationFromPrevious(i)) > epsilon )
       {
-        ROS_ERROR_STREAM("First trajectory violates sampline time " << sampling_time
-                         << " between points "
-                         << (i-1) << "and " << i << " (indices).");
+        PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender,
+                          "First trajectory violates sampline time " << sampling_time
+                          << " between points "
+                          << (i-1) << "and " << i << " (indices).");
         return false;
       }
     }
@@ -458,8 +1259,9 @@ bool pilz::determineAndCheckSamplingTime(const robot_trajectory::RobotTrajectory
     {
       if ( fabs(sampling_time - second_trajectory->getWayPointDurationFromPrevious(i)) > epsilon )
       {
-        ROS_ERROR_STREAM("Second trajectory violates sampline time " << sampling_time << " between points "
-                         << (i-1) << "and " << i << " (indices).");
+        PILZ_ERROR_STREAM(pilz::LogSubsystem::Blender,
+                          "Second trajectory violates sampline time " << sampling_time << " between points "
+                          << (i-1) << "and " << i << " (indices).");
         return false;
       }
     }
@@ -480,8 +1282,9 @@ bool pilz::isRobotStateEqual(const moveit::core::RobotState &state1,
 
   if( (joint_position_1 - joint_position_2).norm() > epsilon)
   {
-    ROS_DEBUG_STREAM("Joint positions of the two states are different. state1: " << joint_position_1 << " state2: "
-                     << joint_position_2);
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender,
+                      "Joint positions of the two states are different. state1: " << joint_position_1 << " state2: "
+                      << joint_position_2);
     return false;
   }
 
@@ -492,8 +1295,9 @@ bool pilz::isRobotStateEqual(const moveit::core::RobotState &state1,
 
   if( (joint_velocity_1 - joint_velocity_2).norm() > epsilon)
   {
-    ROS_DEBUG_STREAM("Joint velocities of the two states are different. state1: " << joint_velocity_1 << " state2: "
-                     << joint_velocity_2);
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender,
+                      "Joint velocities of the two states are different. state1: " << joint_velocity_1 << " state2: "
+                      << joint_velocity_2);
     return false;
   }
 
@@ -504,8 +1308,9 @@ bool pilz::isRobotStateEqual(const moveit::core::RobotState &state1,
 
   if( (joint_acc_1 - joint_acc_2).norm() > epsilon)
   {
-    ROS_DEBUG_STREAM("Joint accelerations of the two states are different. state1: " << joint_acc_1 << " state2: "
-                     << joint_acc_2);
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender,
+                      "Joint accelerations of the two states are different. state1: " << joint_acc_1 << " state2: "
+                      << joint_acc_2);
     return false;
   }
 
@@ -520,13 +1325,13 @@ bool pilz::isRobotStateStationary(const moveit::core::RobotState &state,
   state.copyJointGroupVelocities(group, joint_variable);
   if(joint_variable.norm() > EPSILON)
   {
-    ROS_DEBUG("Joint velocities are not zero.");
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender, "Joint velocities are not zero.");
     return false;
   }
   state.copyJointGroupAccelerations(group, joint_variable);
   if(joint_variable.norm() > EPSILON)
   {
-    ROS_DEBUG("Joint accelerations are not zero.");
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender, "Joint accelerations are not zero.");
     return false;
   }
   return true;
@@ -539,17 +1344,30 @@ bool pilz::linearSearchIntersectionPoint(const std::string &link_name,
                                          bool inverseOrder,
                                          std::size_t &index)
 {
-  ROS_DEBUG("Start linear search for intersection point.");
+  return linearSearchIntersectionPoint(TipFramePoseCache(*traj, link_name), center_position, r, inverseOrder, index);
+}
+
+bool pilz::linearSearchIntersectionPoint(const pilz::TipFramePoseCache &poses,
+                                         const Eigen::Vector3d &center_position,
+                                         const double &r,
+                                         bool inverseOrder,
+                                         std::size_t &index)
+{
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Blender, "Start linear search for intersection point.");
 
-  const size_t waypoint_num = traj->getWayPointCount();
+  const size_t waypoint_num = poses.size();
+  if(waypoint_num == 0)
+  {
+    return false;
+  }
 
   if(inverseOrder)
   {
     for(size_t i = waypoint_num-1; i>0; --i)
     {
       if(intersectionFound(center_position,
-                           traj->getWayPointPtr(i)->getFrameTransform(link_name).translation(),
-                           traj->getWayPointPtr(i-1)->getFrameTransform(link_name).translation(),
+                           poses.getPosition(i),
+                           poses.getPosition(i-1),
                            r))
       {
         index = i;
@@ -562,8 +1380,8 @@ bool pilz::linearSearchIntersectionPoint(const std::string &link_name,
     for(size_t i = 0; i < waypoint_num-1; ++i)
     {
       if(intersectionFound(center_position,
-                           traj->getWayPointPtr(i)->getFrameTransform(link_name).translation(),
-                           traj->getWayPointPtr(i+1)->getFrameTransform(link_name).translation(),
+                           poses.getPosition(i),
+                           poses.getPosition(i+1),
                            r))
       {
         index = i;
@@ -604,6 +1422,42 @@ bool pilz::isStateColliding(const bool test_for_self_collision,
   return !collision_res.collision;
 }
 
+double pilz::getAttachedPayload(const moveit_msgs::RobotState& start_state,
+                               const moveit::core::RobotState* current_state)
+{
+  double payload {0.};
+  for(const auto& attached_object : start_state.attached_collision_objects)
+  {
+    if(attached_object.object.operation == moveit_msgs::CollisionObject::REMOVE)
+    {
+      continue;
+    }
+    if(!(attached_object.weight > 0.))
+    {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    payload += attached_object.weight;
+  }
+
+  if(current_state && (start_state.is_diff || start_state.joint_state.name.empty()))
+  {
+    std::vector<const moveit::core::AttachedBody*> attached_bodies;
+    current_state->getAttachedBodies(attached_bodies);
+    for(const moveit::core::AttachedBody* body : attached_bodies)
+    {
+      const auto stated = std::find_if(start_state.attached_collision_objects.begin(),
+                                       start_state.attached_collision_objects.end(),
+                                       [body](const moveit_msgs::AttachedCollisionObject& attached_object)
+      { return attached_object.object.id == body->getName(); });
+      if(stated == start_state.attached_collision_objects.end())
+      {
+        return std::numeric_limits<double>::quiet_NaN();
+      }
+    }
+  }
+  return payload;
+}
+
 void normalizeQuaternion(geometry_msgs::Quaternion & quat){
   tf::Quaternion q;
   quaternionMsgToTF(quat, q);
@@ -17,6 +17,7 @@
 
 #include "pilz_trajectory_generation/trajectory_generator.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <moveit/robot_state/conversions.h>
@@ -24,7 +25,9 @@
 #include <eigen_conversions/eigen_kdl.h>
 #include <kdl/velocityprofile_trap.hpp>
 
+#include "pilz_trajectory_generation/allocation_counters.h"
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
 
 namespace pilz
 {
@@ -35,6 +38,11 @@ void TrajectoryGenerator::cmdSpecificRequestValidation(const planning_interface:
   // to provide a command specific request validation.
 }
 
+bool TrajectoryGenerator::hasJointSpaceProfile() const
+{
+  return false;
+}
+
 void TrajectoryGenerator::checkVelocityScaling(const double& scaling_factor)
 {
   if( !isScalingFactorValid(scaling_factor) )
@@ -59,6 +67,27 @@ void TrajectoryGenerator::checkAccelerationScaling(const double& scaling_factor)
   }
 }
 
+void TrajectoryGenerator::checkSamplingTimes(double sampling_time, double output_sampling_time)
+{
+  if( !(sampling_time >= MIN_SAMPLING_TIME && sampling_time <= MAX_SAMPLING_TIME) )
+  {
+    std::ostringstream os;
+    os << "Sampling time not in range ["
+       << MIN_SAMPLING_TIME << ", " << MAX_SAMPLING_TIME << "], "
+       << "actual value is: " << sampling_time;
+    throw SamplingTimeIncorrect(os.str());
+  }
+
+  if( output_sampling_time != 0. && !(output_sampling_time >= MIN_SAMPLING_TIME && output_sampling_time <= sampling_time) )
+  {
+    std::ostringstream os;
+    os << "Output sampling time not zero or in range ["
+       << MIN_SAMPLING_TIME << ", " << sampling_time << "] (sampling time), "
+       << "actual value is: " << output_sampling_time;
+    throw SamplingTimeIncorrect(os.str());
+  }
+}
+
 void TrajectoryGenerator::checkForValidGroupName(const std::string& group_name) const
 {
   if( !robot_model_->hasJointModelGroup(group_name) )
@@ -204,19 +233,20 @@ void TrajectoryGenerator::validateRequest(const planning_interface::MotionPlanRe
   checkGoalConstraints(req.goal_constraints, req.start_state.joint_state.name, req.group_name);
 }
 
-void TrajectoryGenerator::convertToRobotTrajectory(const trajectory_msgs::JointTrajectory& joint_trajectory,
+void TrajectoryGenerator::convertToRobotTrajectory(const pilz::CompactTrajectory& joint_trajectory,
                                                    const moveit_msgs::RobotState& start_state,
                                                    robot_trajectory::RobotTrajectory& robot_trajectory) const
 {
   moveit::core::RobotState start_rs(robot_model_);
   start_rs.setToDefaultValues();
   moveit::core::robotStateMsgToRobotState(start_state, start_rs, false);
-  robot_trajectory.setRobotTrajectoryMsg(start_rs,joint_trajectory);
+  PILZ_COUNT_COPY(ros::serialization::serializationLength(start_state));
+  joint_trajectory.toRobotTrajectory(start_rs, robot_trajectory);
 }
 
 void TrajectoryGenerator::setSuccessResponse(const std::string& group_name,
                                              const moveit_msgs::RobotState& start_state,
-                                             const trajectory_msgs::JointTrajectory &joint_trajectory,
+                                             const pilz::CompactTrajectory &joint_trajectory,
                                              const ros::Time& planning_start,
                                              planning_interface::MotionPlanResponse &res) const
 {
@@ -238,6 +268,65 @@ void TrajectoryGenerator::setFailureResponse(const ros::Time &planning_start,
   res.planning_time_ = (ros::Time::now() - planning_start).toSec();
 }
 
+void TrajectoryGenerator::enforceFrameSpeedLimit(const moveit_msgs::RobotState& start_state,
+                                                 double output_sampling_time,
+                                                 pilz::CompactTrajectory& joint_trajectory) const
+{
+  const pilz::CartesianLimit& cartesian_limit {planner_limits_.getCartesianLimits()};
+  if(!cartesian_limit.hasMaxFrameSpeed() || cartesian_limit.getSpeedLimitFrames().empty())
+  {
+    return;
+  }
+
+  moveit::core::RobotState reference_state(robot_model_);
+  reference_state.setToDefaultValues();
+  moveit::core::robotStateMsgToRobotState(start_state, reference_state, false);
+  pilz::enforceFrameSpeedLimit(reference_state, cartesian_limit, output_sampling_time, joint_trajectory);
+}
+
+double TrajectoryGenerator::scanPath(const KDL::Path& path, const MotionPlanInfo& plan_info, double sampling_time)
+{
+  const pilz::CartesianLimit& cartesian_limit {planner_limits_.getCartesianLimits()};
+  if(cartesian_limit.getPathScanSamples() == 0)
+  {
+    return sampling_time;
+  }
+
+  ScopedPhaseTimer timer(plan_phase_timings_, "path_scan");
+  pilz::PathScanResult result;
+  if(!scanCartesianPath(robot_model_, plan_info.group_name, plan_info.link_name, path,
+                        plan_info.start_joint_position, cartesian_limit.getPathScanSamples(),
+                        cartesian_limit.getMinManipulability(), result))
+  {
+    std::ostringstream os;
+    os << "Path scan failed at " << result.path_fraction * 100. << "% of the path length: ";
+    if(result.status == pilz::PathScanResult::Status::Unreachable)
+    {
+      os << "no inverse kinematics solution";
+      throw PathUnreachable(os.str());
+    }
+    os << "manipulability below " << cartesian_limit.getMinManipulability() << " (too close to a singularity)";
+    throw PathNearSingularity(os.str());
+  }
+
+  if(!cartesian_limit.hasFineSamplingManipulability()
+     || result.min_manipulability >= cartesian_limit.getFineSamplingManipulability())
+  {
+    return sampling_time;
+  }
+  // bounded, so that a path close to a singularity (without min_manipulability) is not sampled with
+  // an unbounded number of inverse kinematics solutions
+  const double factor {result.min_manipulability / cartesian_limit.getFineSamplingManipulability()};
+  const double fine_sampling_time {std::max(MIN_SAMPLING_TIME, sampling_time * (factor > MIN_FINE_SAMPLING_FACTOR
+                                                                                ? factor
+                                                                                : MIN_FINE_SAMPLING_FACTOR))};
+  PILZ_INFO_STREAM(pilz::LogSubsystem::Generator,
+                   "Minimal manipulability of the path is " << result.min_manipulability
+                   << ", sampling the path every " << fine_sampling_time << "s instead of every "
+                   << sampling_time << "s");
+  return fine_sampling_time;
+}
+
 std::unique_ptr<KDL::VelocityProfile> TrajectoryGenerator::cartesianTrapVelocityProfile(
     const double& max_velocity_scaling_factor,
     const double& max_acceleration_scaling_factor,
@@ -261,18 +350,26 @@ std::unique_ptr<KDL::VelocityProfile> TrajectoryGenerator::cartesianTrapVelocity
 
 bool TrajectoryGenerator::generate(const planning_interface::MotionPlanRequest& req,
                                    planning_interface::MotionPlanResponse&  res,
-                                   double sampling_time)
+                                   double sampling_time,
+                                   double output_sampling_time)
 {
-  ROS_INFO_STREAM("Generating " << req.planner_id << " trajectory...");
+  pilz::DiagnosticsPlanScope diagnostics_scope;
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Generating " << req.planner_id << " trajectory...");
+  PILZ_TRACE_SCOPE("generator", "generate " + req.planner_id);
   ros::Time planning_begin = ros::Time::now();
+  phase_timings_.clear();
+  plan_phase_timings_.clear();
 
   try
   {
+    PILZ_TRACE_SCOPE("generator", "validate_request");
+    ScopedPhaseTimer timer(phase_timings_, "validate_request");
+    checkSamplingTimes(sampling_time, output_sampling_time);
     validateRequest(req);
   }
   catch(const MoveItErrorCodeException& ex)
   {
-    ROS_ERROR_STREAM(ex.what());
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, ex.what());
     res.error_code_.val = ex.getErrorCode();
     setFailureResponse(planning_begin, res);
     return false;
@@ -280,11 +377,13 @@ bool TrajectoryGenerator::generate(const planning_interface::MotionPlanRequest&
 
   try
   {
+    PILZ_TRACE_SCOPE("generator", "validate_request");
+    ScopedPhaseTimer timer(phase_timings_, "validate_request");
     cmdSpecificRequestValidation(req);
   }
   catch(const MoveItErrorCodeException& ex)
   {
-    ROS_ERROR_STREAM(ex.what());
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, ex.what());
     res.error_code_.val = ex.getErrorCode();
     setFailureResponse(planning_begin, res);
     return false;
@@ -293,31 +392,89 @@ bool TrajectoryGenerator::generate(const planning_interface::MotionPlanRequest&
   MotionPlanInfo plan_info;
   try
   {
+    PILZ_TRACE_SCOPE("generator", "extract_motion_plan_info");
+    ScopedPhaseTimer timer(phase_timings_, "extract_motion_plan_info");
     extractMotionPlanInfo(req, plan_info);
   }
   catch(const MoveItErrorCodeException& ex)
   {
-    ROS_ERROR_STREAM(ex.what());
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, ex.what());
     res.error_code_.val = ex.getErrorCode();
     setFailureResponse(planning_begin, res);
     return false;
   }
 
-  trajectory_msgs::JointTrajectory joint_trajectory;
+  pilz::CompactTrajectory joint_trajectory;
   try
   {
-    plan(req, plan_info, sampling_time, joint_trajectory);
+    PILZ_TRACE_SCOPE("generator", "plan");
+    ScopedPhaseTimer timer(phase_timings_, "plan");
+    if(cancellation_.isCancelled())
+    {
+      throw PlanningCancelled("Planning cancelled before the trajectory was generated");
+    }
+    // The output sampling time is only used for planning, if it does not need further IK
+    const bool plan_with_output_sampling_time {output_sampling_time != 0. && hasJointSpaceProfile()};
+    plan(req, plan_info, plan_with_output_sampling_time ? output_sampling_time : sampling_time, joint_trajectory);
   }
   catch(const MoveItErrorCodeException& ex)
   {
-    ROS_ERROR_STREAM(ex.what());
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, ex.what());
     res.error_code_.val = ex.getErrorCode();
     setFailureResponse(planning_begin, res);
     return false;
   }
+  phase_timings_.add(plan_phase_timings_, "plan/");
 
-  setSuccessResponse(req.group_name, req.start_state, joint_trajectory,
-                     planning_begin, res);
+  if(output_sampling_time != 0. && output_sampling_time < sampling_time && !hasJointSpaceProfile())
+  {
+    PILZ_TRACE_SCOPE("generator", "resample");
+    ScopedPhaseTimer timer(phase_timings_, "resample");
+    pilz::CompactTrajectory resampled_trajectory;
+    resampleJointTrajectory(joint_trajectory, output_sampling_time, resampled_trajectory);
+    joint_trajectory = std::move(resampled_trajectory);
+  }
+
+  try
+  {
+    PILZ_TRACE_SCOPE("generator", "frame_speed_limit");
+    ScopedPhaseTimer timer(phase_timings_, "frame_speed_limit");
+    enforceFrameSpeedLimit(req.start_state, output_sampling_time, joint_trajectory);
+  }
+  catch(const MoveItErrorCodeException& ex)
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, ex.what());
+    res.error_code_.val = ex.getErrorCode();
+    setFailureResponse(planning_begin, res);
+    return false;
+  }
+
+  try
+  {
+    PILZ_TRACE_SCOPE("generator", "verify_limits");
+    ScopedPhaseTimer timer(phase_timings_, "verify_limits");
+    // verify the returned trajectory, the derivatives of a resampled trajectory can exceed the planned ones
+    const JointLimitsTable limits_table {planner_limits_.getJointLimitContainer().getTable(
+                                           req.group_name, joint_trajectory.getJointNames())};
+    if(!verifyTrajectoryLimits(joint_trajectory, limits_table))
+    {
+      throw TrajectoryViolatesLimits("The generated " + req.planner_id + " trajectory violates the joint limits");
+    }
+  }
+  catch(const MoveItErrorCodeException& ex)
+  {
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, ex.what());
+    res.error_code_.val = ex.getErrorCode();
+    setFailureResponse(planning_begin, res);
+    return false;
+  }
+
+  {
+    PILZ_TRACE_SCOPE("generator", "set_success_response");
+    ScopedPhaseTimer timer(phase_timings_, "set_success_response");
+    setSuccessResponse(req.group_name, req.start_state, joint_trajectory,
+                       planning_begin, res);
+  }
   return true;
 }
 
@@ -68,7 +68,7 @@ void TrajectoryGeneratorCIRC::cmdSpecificRequestValidation(const planning_interf
 void TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
                                                     TrajectoryGenerator::MotionPlanInfo &info) const
 {
-  ROS_DEBUG("Extract necessary information from motion plan request.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Extract necessary information from motion plan request.");
 
   info.group_name = req.group_name;
   std::string frame_id {robot_model_->getModelFrame()};
@@ -110,7 +110,8 @@ void TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
     if(req.goal_constraints.front().position_constraints.front().header.frame_id.empty() ||
        req.goal_constraints.front().orientation_constraints.front().header.frame_id.empty())
     {
-      ROS_WARN("Frame id is not set in position/orientation constraints of goal. Use model frame as default");
+      PILZ_WARN_STREAM(pilz::LogSubsystem::Generator,
+                       "Frame id is not set in position/orientation constraints of goal. Use model frame as default");
       frame_id = robot_model_->getModelFrame();
     }
     else
@@ -174,7 +175,7 @@ void TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
 void TrajectoryGeneratorCIRC::plan(const planning_interface::MotionPlanRequest &req,
                                    const MotionPlanInfo& plan_info,
                                    const double& sampling_time,
-                                   trajectory_msgs::JointTrajectory& joint_trajectory)
+                                   pilz::CompactTrajectory& joint_trajectory)
 {
   std::unique_ptr<KDL::Path> cart_path(setPathCIRC(plan_info));
   std::unique_ptr<KDL::VelocityProfile> vel_profile(cartesianTrapVelocityProfile(req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor, cart_path));
@@ -184,6 +185,9 @@ void TrajectoryGeneratorCIRC::plan(const planning_interface::MotionPlanRequest &
   // the ownship of Path and Velocity Profile
   KDL::Trajectory_Segment cart_trajectory(cart_path.get(), vel_profile.get(), false);
 
+  // fail fast on unreachable and singular paths
+  const double path_sampling_time {scanPath(*cart_path, plan_info, sampling_time)};
+
   moveit_msgs::MoveItErrorCodes error_code;
   // sample the Cartesian trajectory and compute joint trajectory using inverse kinematics
   if(!generateJointTrajectory(robot_model_,
@@ -192,9 +196,12 @@ void TrajectoryGeneratorCIRC::plan(const planning_interface::MotionPlanRequest &
                               plan_info.group_name,
                               plan_info.link_name,
                               plan_info.start_joint_position,
-                              sampling_time,
+                              path_sampling_time,
                               joint_trajectory,
-                              error_code))
+                              error_code,
+                              false,
+                              cancellation_,
+                              &plan_phase_timings_))
   {
     throw CircTrajectoryConversionFailure("Failed to generate valid joint trajectory from the Cartesian path",
                                           error_code.val);
@@ -203,7 +210,7 @@ void TrajectoryGeneratorCIRC::plan(const planning_interface::MotionPlanRequest &
 
 std::unique_ptr<KDL::Path> TrajectoryGeneratorCIRC::setPathCIRC(const MotionPlanInfo &info) const
 {
-  ROS_DEBUG("Set Cartesian path for CIRC command.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Set Cartesian path for CIRC command.");
 
   KDL::Frame start_pose, goal_pose;
   tf::transformEigenToKDL(info.start_pose, start_pose);
@@ -39,14 +39,14 @@ TrajectoryGeneratorLIN::TrajectoryGeneratorLIN(const moveit::core::RobotModelCon
 {
   if(!planner_limits_.hasFullCartesianLimits())
   {
-    ROS_ERROR("Cartesian limits not set for LIN trajectory generator.");
+    PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, "Cartesian limits not set for LIN trajectory generator.");
     throw TrajectoryGeneratorInvalidLimitsException("Cartesian limits are not fully set for LIN trajectory generator.");
   }
 }
 
 void TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req, TrajectoryGenerator::MotionPlanInfo &info) const
 {
-  ROS_DEBUG("Extract necessary information from motion plan request.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Extract necessary information from motion plan request.");
 
   info.group_name = req.group_name;
   std::string frame_id {robot_model_->getModelFrame()};
@@ -81,7 +81,8 @@ void TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
     if(req.goal_constraints.front().position_constraints.front().header.frame_id.empty() ||
        req.goal_constraints.front().orientation_constraints.front().header.frame_id.empty())
     {
-      ROS_WARN("Frame id is not set in position/orientation constraints of goal. Use model frame as default");
+      PILZ_WARN_STREAM(pilz::LogSubsystem::Generator,
+                       "Frame id is not set in position/orientation constraints of goal. Use model frame as default");
       frame_id = robot_model_->getModelFrame();
     }
     else
@@ -132,7 +133,7 @@ void TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
 void TrajectoryGeneratorLIN::plan(const planning_interface::MotionPlanRequest &req,
                                   const MotionPlanInfo& plan_info,
                                   const double& sampling_time,
-                                  trajectory_msgs::JointTrajectory& joint_trajectory)
+                                  pilz::CompactTrajectory& joint_trajectory)
 {
   // create Cartesian path for lin
   std::unique_ptr<KDL::Path> path( setPathLIN(plan_info.start_pose, plan_info.goal_pose) );
@@ -145,6 +146,9 @@ void TrajectoryGeneratorLIN::plan(const planning_interface::MotionPlanRequest &r
   // the ownship of Path and Velocity Profile
   KDL::Trajectory_Segment cart_trajectory(path.get(), vp.get(), false);
 
+  // fail fast on unreachable and singular paths
+  const double path_sampling_time {scanPath(*path, plan_info, sampling_time)};
+
   moveit_msgs::MoveItErrorCodes error_code;
   // sample the Cartesian trajectory and compute joint trajectory using inverse kinematics
   if(!generateJointTrajectory(robot_model_,
@@ -153,9 +157,12 @@ void TrajectoryGeneratorLIN::plan(const planning_interface::MotionPlanRequest &r
                               plan_info.group_name,
                               plan_info.link_name,
                               plan_info.start_joint_position,
-                              sampling_time,
+                              path_sampling_time,
                               joint_trajectory,
-                              error_code))
+                              error_code,
+                              false,
+                              cancellation_,
+                              &plan_phase_timings_))
   {
     std::ostringstream os;
     os << "Failed to generate valid joint trajectory from the Cartesian path";
@@ -166,7 +173,7 @@ void TrajectoryGeneratorLIN::plan(const planning_interface::MotionPlanRequest &r
 std::unique_ptr<KDL::Path> TrajectoryGeneratorLIN::setPathLIN(const Eigen::Affine3d& start_pose,
                                                               const Eigen::Affine3d& goal_pose) const
 {
-  ROS_DEBUG("Set Cartesian path for LIN command.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Set Cartesian path for LIN command.");
 
   KDL::Frame kdl_start_pose, kdl_goal_pose;
   tf::transformEigenToKDL(start_pose, kdl_start_pose);
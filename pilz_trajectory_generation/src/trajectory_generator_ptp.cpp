@@ -19,8 +19,13 @@
 #include "ros/ros.h"
 #include "eigen_conversions/eigen_msg.h"
 #include "moveit/robot_state/conversions.h"
+#include "pilz_trajectory_generation/trace_recorder.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <sstream>
 
 namespace pilz {
@@ -37,46 +42,115 @@ TrajectoryGeneratorPTP::TrajectoryGeneratorPTP(const robot_model::RobotModelCons
 
   joint_limits_ = planner_limits_.getJointLimitContainer();
 
-  // collect most strict joint limits for each group in robot model
+  // collect most strict joint limits for each group in robot model (precomputed by the planning configuration)
+  const pilz_extensions::JointLimitsMap& group_common_limits {planner_limits_.getGroupCommonLimits()};
   for(const auto& jmg : robot_model->getJointModelGroups())
   {
-    pilz_extensions::JointLimit most_strict_limit = joint_limits_.getCommonLimit(jmg->getActiveJointModelNames());
+    auto group_common_limit = group_common_limits.find(jmg->getName());
+    pilz_extensions::JointLimit most_strict_limit = group_common_limit != group_common_limits.end() ?
+          group_common_limit->second : joint_limits_.getCommonLimit(jmg->getActiveJointModelNames());
 
     if(!most_strict_limit.has_velocity_limits)
     {
-      ROS_ERROR_STREAM("velocity limit not set for group " << jmg->getName());
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, "velocity limit not set for group " << jmg->getName());
       throw TrajectoryGeneratorInvalidLimitsException("velocity limit not set for group " + jmg->getName());
     }
     if(!most_strict_limit.has_acceleration_limits)
     {
-      ROS_ERROR_STREAM("acceleration limit not set for group " << jmg->getName());
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, "acceleration limit not set for group " << jmg->getName());
       throw TrajectoryGeneratorInvalidLimitsException("acceleration limit not set for group " + jmg->getName());
     }
     if(!most_strict_limit.has_deceleration_limits)
     {
-      ROS_ERROR_STREAM("deceleration limit not set for group " << jmg->getName());
+      PILZ_ERROR_STREAM(pilz::LogSubsystem::Generator, "deceleration limit not set for group " << jmg->getName());
       throw TrajectoryGeneratorInvalidLimitsException("deceleration limit not set for group " + jmg->getName());
     }
 
     most_strict_limits_.insert(std::pair<std::string, pilz_extensions::JointLimit>(jmg->getName(), most_strict_limit));
   }
 
-  ROS_INFO("Initialized Point-to-Point Trajectory Generator.");
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Initialized Point-to-Point Trajectory Generator.");
+}
+
+pilz_extensions::JointLimit TrajectoryGeneratorPTP::getMotionLimit(const std::map<std::string, double>& start_pos,
+                                                                   const std::map<std::string, double>& goal_pos,
+                                                                   const std::vector<std::string>& joint_names,
+                                                                   const std::string& group_name) const
+{
+  pilz_extensions::JointLimit most_strict_limit {most_strict_limits_.at(group_name)};
+
+  // the configuration dependent limits must hold for all positions between start and goal
+  const JointLimitsTable limits_table {joint_limits_.getTable(group_name, joint_names)};
+  if(limits_table.hasConfigurationDependentLimits())
+  {
+    const std::size_t joint_count {joint_names.size()};
+    std::vector<double> start_positions(joint_count), goal_positions(joint_count);
+    for(std::size_t j = 0; j < joint_count; ++j)
+    {
+      start_positions[j] = start_pos.at(joint_names[j]);
+      goal_positions[j] = goal_pos.at(joint_names[j]);
+    }
+    std::vector<double> max_velocities(joint_count), max_accelerations(joint_count), max_decelerations(joint_count);
+    limits_table.getMinimalLimits(start_positions.data(), goal_positions.data(), max_velocities.data(),
+                                  max_accelerations.data(), max_decelerations.data());
+
+    most_strict_limit.max_velocity = std::min(most_strict_limit.max_velocity,
+                                              *std::min_element(max_velocities.begin(), max_velocities.end()));
+    most_strict_limit.max_acceleration = std::min(most_strict_limit.max_acceleration,
+                                                  *std::min_element(max_accelerations.begin(),
+                                                                    max_accelerations.end()));
+    most_strict_limit.max_deceleration = -std::min(std::fabs(most_strict_limit.max_deceleration),
+                                                   *std::min_element(max_decelerations.begin(),
+                                                                     max_decelerations.end()));
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Configuration dependent limits of the motion: velocity "
+                      << most_strict_limit.max_velocity << ", acceleration " << most_strict_limit.max_acceleration
+                      << ", deceleration " << most_strict_limit.max_deceleration);
+  }
+
+  return most_strict_limit;
+}
+
+double TrajectoryGeneratorPTP::getPTPDuration(const std::map<std::string, double>& start_pos,
+                                              const std::map<std::string, double>& goal_pos,
+                                              const std::string& group_name,
+                                              double velocity_scaling_factor,
+                                              double acceleration_scaling_factor) const
+{
+  std::vector<std::string> joint_names;
+  for(const auto& item : goal_pos)
+  {
+    joint_names.push_back(item.first);
+  }
+  const pilz_extensions::JointLimit most_strict_limit {getMotionLimit(start_pos, goal_pos, joint_names, group_name)};
+
+  // the slowest joint defines the duration of the synchronized motion
+  double duration {0.};
+  for(const auto& joint_name : joint_names)
+  {
+    VelocityProfile_ATrap profile(velocity_scaling_factor * most_strict_limit.max_velocity,
+                                  acceleration_scaling_factor * most_strict_limit.max_acceleration,
+                                  acceleration_scaling_factor * most_strict_limit.max_deceleration);
+    profile.SetProfile(start_pos.at(joint_name), goal_pos.at(joint_name));
+    duration = std::max(duration, profile.Duration());
+  }
+  return duration;
 }
 
 void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_pos,
                                      const std::map<std::string, double>& goal_pos,
-                                     trajectory_msgs::JointTrajectory &joint_trajectory,
+                                     pilz::CompactTrajectory &joint_trajectory,
                                      const std::string &group_name,
                                      const double &velocity_scaling_factor,
                                      const double &acceleration_scaling_factor,
                                      const double &sampling_time)
 {
   // initialize joint names
+  std::vector<std::string> joint_names;
   for(const auto& item : goal_pos)
   {
-    joint_trajectory.joint_names.push_back(item.first);
+    joint_names.push_back(item.first);
   }
+  joint_trajectory.setJointNames(joint_names);
 
   // check if goal already reached
   bool goal_reached = true;
@@ -90,36 +164,32 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   }
   if(goal_reached)
   {
-    ROS_INFO_STREAM("Goal already reached, set one goal point explicitly.");
-    if(joint_trajectory.points.empty())
+    PILZ_DEBUG_STREAM(pilz::LogSubsystem::Generator, "Goal already reached, set one goal point explicitly.");
+    const std::size_t point_index {joint_trajectory.addWayPoint(sampling_time)};
+    double* positions {joint_trajectory.getPositions(point_index)};
+    for(std::size_t j = 0; j < joint_names.size(); ++j)
     {
-      trajectory_msgs::JointTrajectoryPoint point;
-      point.time_from_start =  ros::Duration(sampling_time);
-      for(const std::string & joint_name : joint_trajectory.joint_names)
-      {
-        point.positions.push_back(start_pos.at(joint_name));
-        point.velocities.push_back(0);
-        point.accelerations.push_back(0);
-      }
-      joint_trajectory.points.push_back(point);
+      positions[j] = start_pos.at(joint_names[j]);
     }
     return;
   }
 
+  const pilz_extensions::JointLimit most_strict_limit {getMotionLimit(start_pos, goal_pos, joint_names, group_name)};
+
   // compute the fastest trajectory and choose the slowest joint as leading axis
-  std::string leading_axis = joint_trajectory.joint_names.front();
+  std::string leading_axis = joint_names.front();
   double max_duration = -1.0;
 
   std::map<std::string, VelocityProfile_ATrap> velocity_profile;
-  for(const auto& joint_name : joint_trajectory.joint_names)
+  for(const auto& joint_name : joint_names)
   {
     // create vecocity profile if necessary
     velocity_profile.insert(std::make_pair(
                               joint_name,
                               VelocityProfile_ATrap(
-                                velocity_scaling_factor * most_strict_limits_.at(group_name).max_velocity,
-                                acceleration_scaling_factor * most_strict_limits_.at(group_name).max_acceleration,
-                                acceleration_scaling_factor * most_strict_limits_.at(group_name).max_deceleration)));
+                                velocity_scaling_factor * most_strict_limit.max_velocity,
+                                acceleration_scaling_factor * most_strict_limit.max_acceleration,
+                                acceleration_scaling_factor * most_strict_limit.max_deceleration)));
 
     velocity_profile.at(joint_name).SetProfile(start_pos.at(joint_name), goal_pos.at(joint_name));
     if(velocity_profile.at(joint_name).Duration() > max_duration)
@@ -136,7 +206,7 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   double const_time = velocity_profile.at(leading_axis).SecondPhaseDuration();
   double dec_time = velocity_profile.at(leading_axis).ThirdPhaseDuration();
 
-  for(const auto& joint_name : joint_trajectory.joint_names)
+  for(const auto& joint_name : joint_names)
   {
     if(joint_name != leading_axis)
     {
@@ -166,29 +236,38 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   time_samples.push_back(max_duration);
 
   // construct joint trajectory point
+  joint_trajectory.reserve(time_samples.size());
   for(double time_stamp : time_samples)
   {
-    trajectory_msgs::JointTrajectoryPoint point;
-    point.time_from_start =  ros::Duration(time_stamp);
-    for(std::string & joint_name : joint_trajectory.joint_names)
+    const std::size_t point_index {joint_trajectory.addWayPoint(time_stamp)};
+    double* positions {joint_trajectory.getPositions(point_index)};
+    double* velocities {joint_trajectory.getVelocities(point_index)};
+    double* accelerations {joint_trajectory.getAccelerations(point_index)};
+    for(std::size_t j = 0; j < joint_names.size(); ++j)
     {
-      point.positions.push_back(velocity_profile.at(joint_name).Pos(time_stamp));
-      point.velocities.push_back(velocity_profile.at(joint_name).Vel(time_stamp));
-      point.accelerations.push_back(velocity_profile.at(joint_name).Acc(time_stamp));
+      const VelocityProfile_ATrap& profile {velocity_profile.at(joint_names[j])};
+      positions[j] = profile.Pos(time_stamp);
+      velocities[j] = profile.Vel(time_stamp);
+      accelerations[j] = profile.Acc(time_stamp);
     }
-    joint_trajectory.points.push_back(point);
   }
 
   // Set last point velocity and acceleration to zero
-  std::fill(joint_trajectory.points.back().velocities.begin(),
-            joint_trajectory.points.back().velocities.end(),
+  const std::size_t last_index {joint_trajectory.getWayPointCount() - 1};
+  std::fill(joint_trajectory.getVelocities(last_index),
+            joint_trajectory.getVelocities(last_index) + joint_trajectory.getJointCount(),
             0.0);
-  std::fill(joint_trajectory.points.back().accelerations.begin(),
-            joint_trajectory.points.back().accelerations.end(),
+  std::fill(joint_trajectory.getAccelerations(last_index),
+            joint_trajectory.getAccelerations(last_index) + joint_trajectory.getJointCount(),
             0.0);
 }
 
 
+bool TrajectoryGeneratorPTP::hasJointSpaceProfile() const
+{
+  return true;
+}
+
 void TrajectoryGeneratorPTP::extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
                                                    MotionPlanInfo& info) const
 {
@@ -225,23 +304,94 @@ void TrajectoryGeneratorPTP::extractMotionPlanInfo(const planning_interface::Mot
     Eigen::Isometry3d pose_eigen;
     normalizeQuaternion(pose.orientation);
     tf::poseMsgToEigen(pose,pose_eigen);
-    if(!computePoseIK(robot_model_,
-                      req.group_name,
-                      req.goal_constraints.at(0).position_constraints.at(0).link_name,
-                      pose_eigen,
-                      robot_model_->getModelFrame(),
-                      info.start_joint_position,
-                      info.goal_joint_position))
+
+    const std::string& link_name {req.goal_constraints.at(0).position_constraints.at(0).link_name};
+    const GoalIkOptionsMap& goal_ik_options {planner_limits_.getGoalIkOptions()};
+    const auto options = goal_ik_options.find(req.group_name);
+    if(options != goal_ik_options.end() && options->second.hasCandidates())
+    {
+      solveGoalIK(req, link_name, pose_eigen, options->second, info);
+    }
+    else if(!computePoseIK(robot_model_,
+                           req.group_name,
+                           link_name,
+                           pose_eigen,
+                           robot_model_->getModelFrame(),
+                           info.start_joint_position,
+                           info.goal_joint_position))
     {
       throw PtpNoIkSolutionForGoalPose("No IK solution for goal pose");
     }
   }
 }
 
+void TrajectoryGeneratorPTP::solveGoalIK(const planning_interface::MotionPlanRequest& req,
+                                         const std::string& link_name,
+                                         const Eigen::Isometry3d& goal_pose,
+                                         const GoalIkOptions& options,
+                                         MotionPlanInfo& info) const
+{
+  // The seeds: the start state, then the configured seeds (replacing the joints of the group)
+  std::vector<std::map<std::string, double> > seeds {info.start_joint_position};
+  for(const auto& configured_seed : options.seeds)
+  {
+    std::map<std::string, double> seed {info.start_joint_position};
+    for(const auto& joint_position : configured_seed)
+    {
+      seed[joint_position.first] = joint_position.second;
+    }
+    seeds.push_back(seed);
+  }
+
+  // The solutions in the order of their candidates: the seeds, then all solutions of the solver
+  std::vector<std::map<std::string, double> > solutions;
+  {
+    PILZ_TRACE_SCOPE("generator", "goal_ik");
+    for(const auto& seed : seeds)
+    {
+      std::map<std::string, double> solution;
+      if(computePoseIK(robot_model_, req.group_name, link_name, goal_pose, robot_model_->getModelFrame(),
+                       seed, solution))
+      {
+        solutions.push_back(std::move(solution));
+      }
+    }
+    if(options.solver_alternatives)
+    {
+      std::vector<std::map<std::string, double> > alternatives;
+      computePoseIKSolutions(robot_model_, req.group_name, link_name, goal_pose, robot_model_->getModelFrame(),
+                             info.start_joint_position, alternatives);
+      std::move(alternatives.begin(), alternatives.end(), std::back_inserter(solutions));
+    }
+  }
+
+  // The fastest solution, the first one of equally fast solutions
+  const std::map<std::string, double>* fastest {nullptr};
+  double fastest_duration {0.};
+  for(const auto& solution : solutions)
+  {
+    const double duration {getPTPDuration(info.start_joint_position, solution, req.group_name,
+                                          req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor)};
+    if(!fastest || duration < fastest_duration - DURATION_TOLERANCE)
+    {
+      fastest = &solution;
+      fastest_duration = duration;
+    }
+  }
+  if(!fastest)
+  {
+    throw PtpNoIkSolutionForGoalPose("No IK solution for goal pose");
+  }
+
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::IK, "Chose the goal IK solution with a PTP duration of " << fastest_duration
+                    << "s out of " << solutions.size() << " solutions");
+  info.goal_joint_position = *fastest;
+}
+
 void TrajectoryGeneratorPTP::plan(const planning_interface::MotionPlanRequest &req,
                                   const MotionPlanInfo& plan_info,
                                   const double& sampling_time,
-                                  trajectory_msgs::JointTrajectory& joint_trajectory)
+                                  pilz::CompactTrajectory& joint_trajectory)
 {
   // plan the ptp trajectory
   planPTP(plan_info.start_joint_position, plan_info.goal_joint_position, joint_trajectory, plan_info.group_name,
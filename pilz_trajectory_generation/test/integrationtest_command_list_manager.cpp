@@ -29,6 +29,8 @@
 #include <moveit_msgs/MotionPlanResponse.h>
 #include <moveit_msgs/DisplayTrajectory.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
 
 #include <tf2_eigen/tf2_eigen.h>
 
@@ -40,7 +42,10 @@
 #include "test_utils.h"
 
 #include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/planning_configuration.h"
+#include "pilz_trajectory_generation/planning_request_recorder.h"
 #include "pilz_trajectory_generation/tip_frame_getter.h"
+#include "pilz_trajectory_generation/trajectory_functions.h"
 
 const std::string ROBOT_DESCRIPTION_STR {"robot_description"};
 const std::string EMPTY_VALUE {""};
@@ -127,6 +132,12 @@ TEST_F(IntegrationTestCommandListManager, TestExceptionErrorCodeMapping)
 
   std::shared_ptr<PlanningPipelineException> pp_ex {new PlanningPipelineException("")};
   EXPECT_EQ(pp_ex->getErrorCode(), moveit_msgs::MoveItErrorCodes::FAILURE);
+
+  std::shared_ptr<SpeedOverrideInvalidException> soi_ex {new SpeedOverrideInvalidException("")};
+  EXPECT_EQ(soi_ex->getErrorCode(), moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
+
+  std::shared_ptr<SpeedOverrideViolatesLimitsException> sovl_ex {new SpeedOverrideViolatesLimitsException("")};
+  EXPECT_EQ(sovl_ex->getErrorCode(), moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
 }
 
 /**
@@ -338,6 +349,94 @@ TEST_F(IntegrationTestCommandListManager, blendTwoSegments)
   pub.publish(display_trajectory);
 }
 
+/**
+ * @brief Tests applying a speed override to a blended sequence.
+ *
+ * Test Sequence:
+ *    1. Generate the blended trajectory of a sequence.
+ *    2. Apply a speed override of 0.5 to the trajectory.
+ *    3. Apply the speed overrides 0 and 1.5.
+ *
+ * Expected Results:
+ *    1. Generation of the blended trajectory is successful.
+ *    2. The planned trajectory is unchanged. The slowed down trajectory has the same waypoints
+ *       with twice the duration and half the velocities.
+ *    3. Exceptions are thrown.
+ */
+TEST_F(IntegrationTestCommandListManager, applySpeedOverride)
+{
+  Sequence seq {data_loader_->getSequence("SimpleSequence")};
+  pilz_msgs::MotionSequenceRequest req {seq.toRequest()};
+  RobotTrajCont res_vec {manager_->solve(scene_, pipeline_, req)};
+  ASSERT_EQ(1u, res_vec.size());
+  const robot_trajectory::RobotTrajectory& trajectory {*res_vec.front()};
+  const double duration {trajectory.getWayPointDurationFromStart(trajectory.getWayPointCount() - 1)};
+
+  RobotTrajCont scaled_vec {manager_->applySpeedOverride(res_vec, 0.5)};
+  ASSERT_EQ(1u, scaled_vec.size());
+  const robot_trajectory::RobotTrajectory& scaled_trajectory {*scaled_vec.front()};
+  EXPECT_NEAR(duration, trajectory.getWayPointDurationFromStart(trajectory.getWayPointCount() - 1), 1e-9);
+  ASSERT_EQ(trajectory.getWayPointCount(), scaled_trajectory.getWayPointCount());
+  EXPECT_NEAR(2 * duration, scaled_trajectory.getWayPointDurationFromStart(scaled_trajectory.getWayPointCount() - 1),
+              1e-9);
+  for(std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    for(const auto& joint_name : trajectory.getGroup()->getActiveJointModelNames())
+    {
+      EXPECT_NEAR(trajectory.getWayPoint(i).getVariablePosition(joint_name),
+                  scaled_trajectory.getWayPoint(i).getVariablePosition(joint_name), 1e-9);
+      EXPECT_NEAR(0.5 * trajectory.getWayPoint(i).getVariableVelocity(joint_name),
+                  scaled_trajectory.getWayPoint(i).getVariableVelocity(joint_name), 1e-9);
+    }
+  }
+
+  EXPECT_THROW(manager_->applySpeedOverride(res_vec, 0.), SpeedOverrideInvalidException);
+  EXPECT_THROW(manager_->applySpeedOverride(res_vec, 1.5), SpeedOverrideInvalidException);
+}
+
+/**
+ * @brief Tests that the speed limit of the frames is enforced on a blended sequence.
+ *
+ * Test Sequence:
+ *    1. Set a frame speed limit with scaling and generate the blended trajectory of a sequence.
+ *    2. Disable the scaling and generate the trajectory again.
+ *
+ * Expected Results:
+ *    1. Generation of the blended trajectory is successful, no frame exceeds the speed limit
+ *       (including the blend).
+ *    2. Generation fails with an exception.
+ */
+TEST_F(IntegrationTestCommandListManager, blendWithFrameSpeedLimit)
+{
+  const double max_frame_speed {0.1};
+  const std::string frame {"prbt_flange"};
+  ros::NodeHandle limits_nh {"robot_description_planning/cartesian_limits"};
+  limits_nh.setParam("max_frame_speed", max_frame_speed);
+  limits_nh.setParam("speed_limit_frames", std::vector<std::string> {frame});
+  limits_nh.setParam("scale_to_max_frame_speed", true);
+  pilz::PlanningConfigurationRegistry::getInstance().updateConfigurations(true, 1.);
+
+  Sequence seq {data_loader_->getSequence("SimpleSequence")};
+  pilz_msgs::MotionSequenceRequest req {seq.toRequest()};
+  RobotTrajCont res_vec {manager_->solve(scene_, pipeline_, req)};
+  ASSERT_EQ(1u, res_vec.size());
+  const robot_trajectory::RobotTrajectory& trajectory {*res_vec.front()};
+  pilz::CompactTrajectory compact_trajectory {pilz::CompactTrajectory::getVariableNames(trajectory)};
+  compact_trajectory.appendRobotTrajectory(trajectory);
+  EXPECT_LE(pilz::computeMaxFrameSpeed(trajectory.getFirstWayPoint(), compact_trajectory,
+                                       {robot_model_->getLinkModel(frame)}).speed,
+            max_frame_speed * (1. + 1e-6));
+
+  limits_nh.setParam("scale_to_max_frame_speed", false);
+  pilz::PlanningConfigurationRegistry::getInstance().updateConfigurations(true, 1.);
+  EXPECT_THROW(manager_->solve(scene_, pipeline_, req), MoveItErrorCodeException);
+
+  limits_nh.deleteParam("max_frame_speed");
+  limits_nh.deleteParam("speed_limit_frames");
+  limits_nh.deleteParam("scale_to_max_frame_speed");
+  pilz::PlanningConfigurationRegistry::getInstance().updateConfigurations(true, 1.);
+}
+
 // ------------------
 // FAILURE cases
 // ------------------
@@ -635,6 +734,78 @@ TEST_F(IntegrationTestCommandListManager, TestGetSolverTipFrameForSolverlessGrou
   EXPECT_THROW(getSolverTipFrame(robot_model_->getJointModelGroup(gripper_cmd.getPlanningGroup())), NoSolverException);
 }
 
+/**
+ * @brief Checks that a recorded request is replayed with the same result.
+ *
+ * Test Sequence:
+ *    1. Record a sequence request in a scene with a collision object and plan it.
+ *    2. Read the record, restore the planning scene and plan the recorded request.
+ *
+ * Expected Results:
+ *    1. The request is recorded, the planning succeeds.
+ *    2. The record contains the request, the restored scene contains the robot state
+ *       and the collision object, the replayed trajectory equals the one of step 1.
+ */
+TEST_F(IntegrationTestCommandListManager, recordAndReplayRequest)
+{
+  Sequence seq {data_loader_->getSequence("ComplexSequence")};
+  ASSERT_GE(seq.size(), 2u);
+  seq.erase(2, seq.size());
+  const pilz_msgs::MotionSequenceRequest req {seq.toRequest()};
+
+  moveit_msgs::CollisionObject box;
+  box.header.frame_id = robot_model_->getModelFrame();
+  box.id = "box";
+  box.operation = moveit_msgs::CollisionObject::ADD;
+  box.primitives.resize(1);
+  box.primitives.front().type = shape_msgs::SolidPrimitive::BOX;
+  box.primitives.front().dimensions = {0.1, 0.1, 0.1};
+  box.primitive_poses.resize(1);
+  box.primitive_poses.front().position.x = 2.;
+  box.primitive_poses.front().orientation.w = 1.;
+  ASSERT_TRUE(scene_->processCollisionObjectMsg(box));
+
+  // 1. record and plan
+  const std::string file_name {"/tmp/integrationtest_command_list_manager_requests.bag"};
+  pilz::PlanningRequestRecorder& recorder {pilz::PlanningRequestRecorder::getInstance()};
+  ASSERT_TRUE(recorder.open(file_name, *robot_model_));
+  recorder.record(pilz_msgs::PlanningRequestRecord::SEQUENCE_SERVICE, scene_, req);
+  recorder.close();
+
+  RobotTrajCont res_vec {manager_->solve(scene_, pipeline_, req)};
+  ASSERT_EQ(1u, res_vec.size());
+
+  // 2. replay
+  rosbag::Bag bag(file_name, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(pilz::PlanningRequestRecorder::REQUEST_TOPIC));
+  ASSERT_EQ(1u, view.size());
+  const pilz_msgs::PlanningRequestRecordConstPtr record {view.begin()->instantiate<pilz_msgs::PlanningRequestRecord>()};
+  ASSERT_TRUE(record);
+  EXPECT_EQ(pilz_msgs::PlanningRequestRecord::SEQUENCE_SERVICE, record->source);
+  EXPECT_EQ(robot_model_->getName(), record->robot_model_name);
+  EXPECT_EQ(req.items.size(), record->request.items.size());
+
+  const planning_scene::PlanningScenePtr replay_scene {std::make_shared<planning_scene::PlanningScene>(robot_model_)};
+  ASSERT_TRUE(replay_scene->setPlanningSceneMsg(record->planning_scene));
+  EXPECT_TRUE(replay_scene->getWorld()->hasObject(box.id));
+  EXPECT_EQ(scene_->getCurrentState().getVariableCount(), replay_scene->getCurrentState().getVariableCount());
+  for(std::size_t i = 0; i < scene_->getCurrentState().getVariableCount(); ++i)
+  {
+    EXPECT_EQ(scene_->getCurrentState().getVariablePosition(i), replay_scene->getCurrentState().getVariablePosition(i));
+  }
+
+  RobotTrajCont replayed_vec {manager_->solve(replay_scene, pipeline_, record->request)};
+  ASSERT_EQ(res_vec.size(), replayed_vec.size());
+  const robot_trajectory::RobotTrajectory& trajectory {*res_vec.front()};
+  const robot_trajectory::RobotTrajectory& replayed {*replayed_vec.front()};
+  ASSERT_EQ(trajectory.getWayPointCount(), replayed.getWayPointCount());
+  for(std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    EXPECT_NEAR(trajectory.getWayPointDurationFromPrevious(i), replayed.getWayPointDurationFromPrevious(i), 1e-9);
+    EXPECT_TRUE(trajectory.getWayPoint(i).distance(replayed.getWayPoint(i)) < 1e-9) << "waypoint " << i;
+  }
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "integrationtest_command_list_manager");
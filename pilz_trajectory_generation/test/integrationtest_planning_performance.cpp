@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+
+#include <ros/ros.h>
+
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include <pilz_industrial_motion_testutils/xml_testdata_loader.h>
+#include <pilz_industrial_motion_testutils/sequence.h>
+
+#include "pilz_trajectory_generation/allocation_counters.h"
+#include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/planning_statistics.h"
+
+using namespace pilz_industrial_motion_testutils;
+
+const std::string ROBOT_DESCRIPTION_STR {"robot_description"};
+
+// parameters from parameter server
+const std::string PARAM_TEST_DATA_FILE_NAME {"testdata_file_name"};
+const std::string PARAM_BASELINE {"baseline/workloads"};
+const std::string PARAM_BASELINE_FILE_NAME {"baseline_file_name"};
+const std::string PARAM_UPDATE_BASELINE {"update_baseline"};
+const std::string PARAM_TOLERANCE {"tolerance"};
+const std::string PARAM_REPETITIONS {"repetitions"};
+
+const std::string BASELINE_MEDIAN {"median"};
+const std::string BASELINE_P95 {"p95"};
+const std::string BASELINE_ALLOCATIONS {"allocations"};
+
+// defaults of the parameters
+const double DEFAULT_TOLERANCE {0.25};
+const int DEFAULT_REPETITIONS {30};
+const int WARMUP_REPETITIONS {3};
+const int CALIBRATION_REPETITIONS {11};
+const int CALIBRATION_ITERATIONS {200000};
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Planning times (normalized by the calibration time) and heap
+ * allocations of one workload.
+ */
+struct WorkloadResult
+{
+  double median {0.};
+  double p95 {0.};
+  //! Median of the heap allocations, only valid if has_allocations is set.
+  double allocations {0.};
+  bool has_allocations {false};
+};
+
+//! Results of all workloads, written to the baseline file in update mode.
+std::map<std::string, WorkloadResult> results;
+
+/**
+ * @brief Runs representative workloads of the test data and compares their
+ * planning times and heap allocations with the baseline.
+ *
+ * The planning times are normalized by the time of a fixed calibration loop,
+ * so that the baseline can be compared on machines of different speed.
+ * The heap allocations are only compared if the allocation counter library
+ * is preloaded into a build with allocation counters (see README).
+ *
+ * With the parameter update_baseline, the baseline file is written instead.
+ */
+class IntegrationTestPlanningPerformance : public testing::Test
+{
+protected:
+  void SetUp() override;
+
+  /**
+   * @return Median time (in seconds) of a fixed, planner independent computation.
+   */
+  static double calibrate();
+
+  /**
+   * @brief Runs the workload repeatedly and checks the result against the baseline.
+   */
+  void measureAndCheck(const std::string& name, const std::function<void()>& workload);
+
+  WorkloadResult measure(const std::function<void()>& workload) const;
+
+  void checkAgainstBaseline(const std::string& name, const WorkloadResult& result) const;
+
+  void generatePlan(const planning_interface::MotionPlanRequest& req) const;
+
+protected:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_ {
+    robot_model_loader::RobotModelLoader(ROBOT_DESCRIPTION_STR).getModel() };
+  std::unique_ptr<pilz_trajectory_generation::CommandListManager> manager_;
+  planning_scene::PlanningScenePtr scene_;
+  planning_pipeline::PlanningPipelinePtr pipeline_;
+  std::unique_ptr<TestdataLoader> data_loader_;
+
+  double tolerance_ {DEFAULT_TOLERANCE};
+  int repetitions_ {DEFAULT_REPETITIONS};
+  bool update_baseline_ {false};
+
+  static double calibration_time_;
+};
+
+double IntegrationTestPlanningPerformance::calibration_time_ {0.};
+
+void IntegrationTestPlanningPerformance::SetUp()
+{
+  ASSERT_TRUE(robot_model_) << "Robot model could not be loaded.";
+
+  std::string test_data_file_name;
+  ASSERT_TRUE(ph_.getParam(PARAM_TEST_DATA_FILE_NAME, test_data_file_name));
+  ph_.param(PARAM_TOLERANCE, tolerance_, DEFAULT_TOLERANCE);
+  ph_.param(PARAM_REPETITIONS, repetitions_, DEFAULT_REPETITIONS);
+  ph_.param(PARAM_UPDATE_BASELINE, update_baseline_, false);
+  ASSERT_GT(repetitions_, 0);
+
+  data_loader_.reset(new XmlTestdataLoader(test_data_file_name, robot_model_));
+  manager_.reset(new pilz_trajectory_generation::CommandListManager(ph_, robot_model_));
+  scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+  pipeline_ = std::make_shared<planning_pipeline::PlanningPipeline>(robot_model_, ph_);
+
+  if(calibration_time_ == 0.)
+  {
+    calibration_time_ = calibrate();
+    ROS_INFO_STREAM("Calibration time: " << calibration_time_ * 1000. << " ms");
+  }
+}
+
+double IntegrationTestPlanningPerformance::calibrate()
+{
+  std::vector<double> times;
+  for(int i = 0; i < CALIBRATION_REPETITIONS; ++i)
+  {
+    const Clock::time_point start {Clock::now()};
+    // chain of small rigid transformations, similar to forward kinematics
+    const Eigen::Isometry3d step {Eigen::Translation3d(0.001, 0.002, 0.003)
+                                  * Eigen::AngleAxisd(0.001, Eigen::Vector3d::UnitZ())};
+    Eigen::Isometry3d pose {Eigen::Isometry3d::Identity()};
+    for(int j = 0; j < CALIBRATION_ITERATIONS; ++j)
+    {
+      pose = pose * step;
+    }
+    times.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    // keep the compiler from removing the loop
+    volatile double sink {pose.translation().x()};
+    static_cast<void>(sink);
+  }
+  return pilz_trajectory_generation::PlanningStatistics::computePercentile(times, 50.);
+}
+
+void IntegrationTestPlanningPerformance::measureAndCheck(const std::string& name,
+                                                          const std::function<void()>& workload)
+{
+  const WorkloadResult result {measure(workload)};
+  if(::testing::Test::HasFailure())
+  {
+    return;
+  }
+  results[name] = result;
+  ROS_INFO_STREAM("Workload " << name << ": median " << result.median << ", p95 " << result.p95
+                  << " (normalized), allocations "
+                  << (result.has_allocations ? std::to_string(result.allocations) : std::string("not counted")));
+  if(!update_baseline_)
+  {
+    checkAgainstBaseline(name, result);
+  }
+}
+
+WorkloadResult IntegrationTestPlanningPerformance::measure(const std::function<void()>& workload) const
+{
+  for(int i = 0; i < WARMUP_REPETITIONS; ++i)
+  {
+    workload();
+  }
+
+  std::vector<double> times, allocations;
+  for(int i = 0; i < repetitions_; ++i)
+  {
+    const pilz::AllocationCounts start_counts {pilz::AllocationCounters::get()};
+    const Clock::time_point start {Clock::now()};
+    workload();
+    times.push_back(std::chrono::duration<double>(Clock::now() - start).count() / calibration_time_);
+    allocations.push_back(static_cast<double>(pilz::AllocationCounters::getSince(start_counts).allocations));
+  }
+
+  WorkloadResult result;
+  result.median = pilz_trajectory_generation::PlanningStatistics::computePercentile(times, 50.);
+  result.p95 = pilz_trajectory_generation::PlanningStatistics::computePercentile(times, 95.);
+  result.has_allocations = pilz::AllocationCounters::hasHeapAllocations();
+  result.allocations = pilz_trajectory_generation::PlanningStatistics::computePercentile(allocations, 50.);
+  return result;
+}
+
+void IntegrationTestPlanningPerformance::checkAgainstBaseline(const std::string& name,
+                                                              const WorkloadResult& result) const
+{
+  const std::string baseline_ns {PARAM_BASELINE + "/" + name + "/"};
+  double median, p95;
+  if(!ph_.getParam(baseline_ns + BASELINE_MEDIAN, median) || !ph_.getParam(baseline_ns + BASELINE_P95, p95))
+  {
+    ROS_WARN_STREAM("No baseline for workload " << name << ", run the test with "
+                    << PARAM_UPDATE_BASELINE << ":=true to create it.");
+    return;
+  }
+
+  EXPECT_LE(result.median, median * (1. + tolerance_))
+      << "Median planning time of " << name << " regressed (normalized, baseline " << median << ")";
+  EXPECT_LE(result.p95, p95 * (1. + tolerance_))
+      << "p95 planning time of " << name << " regressed (normalized, baseline " << p95 << ")";
+
+  double allocations;
+  if(result.has_allocations && ph_.getParam(baseline_ns + BASELINE_ALLOCATIONS, allocations))
+  {
+    EXPECT_LE(result.allocations, allocations * (1. + tolerance_))
+        << "Heap allocations of " << name << " regressed (baseline " << allocations << ")";
+  }
+}
+
+void IntegrationTestPlanningPerformance::generatePlan(const planning_interface::MotionPlanRequest& req) const
+{
+  planning_interface::MotionPlanResponse res;
+  pipeline_->generatePlan(scene_, req, res);
+  ASSERT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val) << "Planning of " << req.planner_id
+                                                                           << " failed";
+}
+
+TEST_F(IntegrationTestPlanningPerformance, PtpJoint)
+{
+  const planning_interface::MotionPlanRequest req {data_loader_->getPtpJoint("Ptp1").toRequest()};
+  measureAndCheck("ptp", [this, &req](){ generatePlan(req); });
+}
+
+TEST_F(IntegrationTestPlanningPerformance, LinJoint)
+{
+  const planning_interface::MotionPlanRequest req {data_loader_->getLinJoint("lin2").toRequest()};
+  measureAndCheck("lin", [this, &req](){ generatePlan(req); });
+}
+
+TEST_F(IntegrationTestPlanningPerformance, CircJointCenterCart)
+{
+  const planning_interface::MotionPlanRequest req {
+    data_loader_->getCircJointCenterCart("circ1_center_2").toRequest()};
+  measureAndCheck("circ", [this, &req](){ generatePlan(req); });
+}
+
+TEST_F(IntegrationTestPlanningPerformance, ComplexSequence)
+{
+  const pilz_msgs::MotionSequenceRequest req {data_loader_->getSequence("ComplexSequence").toRequest()};
+  measureAndCheck("sequence", [this, &req]()
+  {
+    ASSERT_FALSE(manager_->solve(scene_, pipeline_, req).empty()) << "Planning of sequence failed";
+  });
+}
+
+/**
+ * @brief Writes the results of all workloads as baseline file.
+ */
+bool writeBaseline(const std::string& file_name)
+{
+  std::ofstream file(file_name);
+  file << "# Baseline of integrationtest_planning_performance, created with update_baseline:=true.\n"
+       << "# Planning times are normalized by the time of the calibration loop of the test.\n"
+       << "workloads:\n";
+  for(const auto& result : results)
+  {
+    file << "  " << result.first << ":\n"
+         << "    " << BASELINE_MEDIAN << ": " << result.second.median << "\n"
+         << "    " << BASELINE_P95 << ": " << result.second.p95 << "\n";
+    if(result.second.has_allocations)
+    {
+      file << "    " << BASELINE_ALLOCATIONS << ": " << result.second.allocations << "\n";
+    }
+  }
+  return static_cast<bool>(file);
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "integrationtest_planning_performance");
+  ros::NodeHandle nh;
+  testing::InitGoogleTest(&argc, argv);
+  const int result {RUN_ALL_TESTS()};
+
+  ros::NodeHandle ph("~");
+  std::string baseline_file_name;
+  if(result == 0 && ph.param(PARAM_UPDATE_BASELINE, false) && ph.getParam(PARAM_BASELINE_FILE_NAME, baseline_file_name))
+  {
+    if(!writeBaseline(baseline_file_name))
+    {
+      ROS_ERROR_STREAM("Failed to write baseline " << baseline_file_name);
+      return 1;
+    }
+    ROS_INFO_STREAM("Baseline written to " << baseline_file_name);
+  }
+  return result;
+}
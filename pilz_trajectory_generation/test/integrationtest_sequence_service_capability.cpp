@@ -36,6 +36,7 @@
 #include <pilz_industrial_motion_testutils/sequence.h>
 
 #include "pilz_msgs/GetMotionSequence.h"
+#include "pilz_msgs/GetMotionSequenceBatch.h"
 #include "pilz_msgs/MotionSequenceRequest.h"
 #include "pilz_trajectory_generation/capability_names.h"
 
@@ -57,6 +58,7 @@ protected:
 protected:
   ros::NodeHandle ph_ {"~"};
   ros::ServiceClient client_;
+  ros::ServiceClient batch_client_;
   robot_model::RobotModelPtr robot_model_;
 
   std::string test_data_file_name_;
@@ -77,6 +79,11 @@ void IntegrationTestSequenceService::SetUp()
   ASSERT_TRUE(ros::service::waitForService(pilz_trajectory_generation::SEQUENCE_SERVICE_NAME, ros::Duration(10))) << "Service not available.";
   ros::NodeHandle nh; // connect to service in global namespace, not in ph_
   client_ = nh.serviceClient<pilz_msgs::GetMotionSequence>(pilz_trajectory_generation::SEQUENCE_SERVICE_NAME);
+
+  ASSERT_TRUE(ros::service::waitForService(pilz_trajectory_generation::SEQUENCE_BATCH_SERVICE_NAME, ros::Duration(10)))
+      << "Batch service not available.";
+  batch_client_ = nh.serviceClient<pilz_msgs::GetMotionSequenceBatch>(
+        pilz_trajectory_generation::SEQUENCE_BATCH_SERVICE_NAME);
 }
 
 /**
@@ -388,6 +395,105 @@ TEST_F(IntegrationTestSequenceService, TestComplexSequenceWithBlending)
   EXPECT_GT(srv.response.planned_trajectory.front().joint_trajectory.points.size(), 0u) << "Trajectory should contain points.";
 }
 
+/**
+ * @brief Tests that the batch service plans every sequence independently.
+ *
+ * Test Sequence:
+ *    1. Create batch request with a valid, an invalid and an empty sequence and call batch service.
+ *    2. Evaluate the result.
+ *
+ * Expected Results:
+ *    1. Response is received.
+ *    2. One result per sequence. The valid and the empty sequence are successful,
+ *       the invalid sequence fails without affecting the others.
+ */
+TEST_F(IntegrationTestSequenceService, TestBatchOfSequences)
+{
+  Sequence seq {data_loader_->getSequence("ComplexSequence")};
+  Sequence invalid_seq {data_loader_->getSequence("ComplexSequence")};
+  invalid_seq.getCmd(1).setPlanningGroup("WrongGroupName");
+
+  pilz_msgs::GetMotionSequenceBatch srv;
+  srv.request.sequences.push_back(seq.toRequest());
+  srv.request.sequences.push_back(invalid_seq.toRequest());
+  srv.request.sequences.push_back(pilz_msgs::MotionSequenceRequest());
+  srv.request.sequences.push_back(seq.toRequest());
+
+  ASSERT_TRUE(batch_client_.call(srv));
+
+  ASSERT_EQ(srv.request.sequences.size(), srv.response.results.size());
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, srv.response.results.at(0).error_code.val);
+  EXPECT_EQ(1u, srv.response.results.at(0).planned_trajectory.size());
+
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME, srv.response.results.at(1).error_code.val);
+  EXPECT_TRUE(srv.response.results.at(1).planned_trajectory.empty());
+
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, srv.response.results.at(2).error_code.val);
+  EXPECT_TRUE(srv.response.results.at(2).planned_trajectory.empty());
+
+  // identical sequences have identical results
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, srv.response.results.at(3).error_code.val);
+  ASSERT_EQ(1u, srv.response.results.at(3).planned_trajectory.size());
+  EXPECT_EQ(srv.response.results.at(0).planned_trajectory.front().joint_trajectory.points.size(),
+            srv.response.results.at(3).planned_trajectory.front().joint_trajectory.points.size());
+}
+
+/**
+ * @brief Tests that planning a batch with several threads gives the same results as planning
+ * the sequences one after the other (the test launch file configures three batch planning threads).
+ *
+ * Test Sequence:
+ *    1. Create batch request with more sequences than threads and call batch service.
+ *    2. Plan every sequence of the batch with the (serial) sequence service.
+ *
+ * Expected Results:
+ *    1. Response is received.
+ *    2. Every batch result has the same error code and the same trajectory as the serial result.
+ */
+TEST_F(IntegrationTestSequenceService, TestBatchMatchesSerialPlanning)
+{
+  Sequence seq {data_loader_->getSequence("ComplexSequence")};
+  Sequence seq_without_blending {data_loader_->getSequence("ComplexSequence")};
+  seq_without_blending.setAllBlendRadiiToZero();
+
+  pilz_msgs::GetMotionSequenceBatch batch_srv;
+  for(unsigned int i = 0; i < 4; ++i)
+  {
+    batch_srv.request.sequences.push_back(seq.toRequest());
+    batch_srv.request.sequences.push_back(seq_without_blending.toRequest());
+  }
+
+  ASSERT_TRUE(batch_client_.call(batch_srv));
+  ASSERT_EQ(batch_srv.request.sequences.size(), batch_srv.response.results.size());
+
+  for(std::size_t i = 0; i < batch_srv.request.sequences.size(); ++i)
+  {
+    pilz_msgs::GetMotionSequence srv;
+    srv.request.commands = batch_srv.request.sequences.at(i);
+    ASSERT_TRUE(client_.call(srv));
+
+    const pilz_msgs::MotionSequenceResponse& batch_res {batch_srv.response.results.at(i)};
+    EXPECT_EQ(srv.response.error_code.val, batch_res.error_code.val) << "Differing error code of sequence " << i;
+    ASSERT_EQ(srv.response.planned_trajectory.size(), batch_res.planned_trajectory.size());
+    for(std::size_t j = 0; j < srv.response.planned_trajectory.size(); ++j)
+    {
+      const auto& serial_points {srv.response.planned_trajectory.at(j).joint_trajectory.points};
+      const auto& batch_points {batch_res.planned_trajectory.at(j).joint_trajectory.points};
+      ASSERT_EQ(serial_points.size(), batch_points.size()) << "Differing trajectory of sequence " << i;
+      for(std::size_t k = 0; k < serial_points.size(); ++k)
+      {
+        ASSERT_EQ(serial_points.at(k).positions.size(), batch_points.at(k).positions.size());
+        for(std::size_t l = 0; l < serial_points.at(k).positions.size(); ++l)
+        {
+          EXPECT_NEAR(serial_points.at(k).positions.at(l), batch_points.at(k).positions.at(l), 1e-8)
+              << "Differing position of sequence " << i << " at point " << k;
+        }
+        EXPECT_NEAR(serial_points.at(k).time_from_start.toSec(), batch_points.at(k).time_from_start.toSec(), 1e-8);
+      }
+    }
+  }
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "integrationtest_sequence_service_capability");
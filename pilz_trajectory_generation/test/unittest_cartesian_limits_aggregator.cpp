@@ -42,6 +42,12 @@ TEST_F(CartesianLimitsAggregator, OnlyVelocity)
   EXPECT_FALSE(limit.hasMaxTranslationalAcceleration());
   EXPECT_FALSE(limit.hasMaxTranslationalDeceleration());
   EXPECT_FALSE(limit.hasMaxRotationalVelocity());
+  EXPECT_FALSE(limit.hasMaxFrameSpeed());
+  EXPECT_TRUE(limit.getSpeedLimitFrames().empty());
+  EXPECT_FALSE(limit.getScaleToMaxFrameSpeed());
+  EXPECT_EQ(limit.getPathScanSamples(), 0u);
+  EXPECT_FALSE(limit.hasMinManipulability());
+  EXPECT_FALSE(limit.hasFineSamplingManipulability());
 }
 
 /**
@@ -63,6 +69,39 @@ TEST_F(CartesianLimitsAggregator, AllValues)
 
   EXPECT_TRUE(limit.hasMaxRotationalVelocity());
   EXPECT_EQ(limit.getMaxRotationalVelocity(), 4);
+
+  EXPECT_TRUE(limit.hasMaxFrameSpeed());
+  EXPECT_EQ(limit.getMaxFrameSpeed(), 0.25);
+  EXPECT_EQ(limit.getSpeedLimitFrames(), std::vector<std::string>({"prbt_link_3", "prbt_flange"}));
+  EXPECT_TRUE(limit.getScaleToMaxFrameSpeed());
+
+  EXPECT_EQ(limit.getPathScanSamples(), 8u);
+  EXPECT_TRUE(limit.hasMinManipulability());
+  EXPECT_EQ(limit.getMinManipulability(), 0.001);
+  EXPECT_TRUE(limit.hasFineSamplingManipulability());
+  EXPECT_EQ(limit.getFineSamplingManipulability(), 0.01);
+}
+
+/**
+ * @brief Check that the limits read from the fetched parameter namespace equal the limits read by the node handle
+ */
+TEST_F(CartesianLimitsAggregator, FetchedNamespace)
+{
+  ros::NodeHandle nh("~/all");
+  XmlRpc::XmlRpcValue param;
+  ASSERT_TRUE(nh.getParam(nh.getNamespace(), param));
+
+  pilz::CartesianLimit limit = pilz::CartesianLimitsAggregator::getAggregatedLimits(param);
+  EXPECT_EQ(limit.getMaxTranslationalVelocity(), 1);
+  EXPECT_EQ(limit.getMaxTranslationalAcceleration(), 2);
+  EXPECT_EQ(limit.getMaxTranslationalDeceleration(), -3);
+  EXPECT_EQ(limit.getMaxRotationalVelocity(), 4);
+  EXPECT_EQ(limit.getMaxFrameSpeed(), 0.25);
+  EXPECT_EQ(limit.getSpeedLimitFrames(), std::vector<std::string>({"prbt_link_3", "prbt_flange"}));
+  EXPECT_TRUE(limit.getScaleToMaxFrameSpeed());
+  EXPECT_EQ(limit.getPathScanSamples(), 8u);
+  EXPECT_EQ(limit.getMinManipulability(), 0.001);
+  EXPECT_EQ(limit.getFineSamplingManipulability(), 0.01);
 }
 
 
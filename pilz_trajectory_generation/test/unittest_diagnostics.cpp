@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "pilz_trajectory_generation/diagnostics.h"
+
+class DiagnosticsTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    pilz::Diagnostics::getInstance().resetCounters();
+    pilz::Diagnostics::getInstance().setMessageLimitPerPlan(3);
+  }
+
+  void TearDown() override
+  {
+    pilz::Diagnostics::getInstance().setMessageLimitPerPlan(pilz::Diagnostics::DEFAULT_MESSAGE_LIMIT_PER_PLAN);
+    pilz::Diagnostics::getInstance().resetCounters();
+  }
+};
+
+/**
+ * @brief Checks that messages are not limited without an active plan scope.
+ */
+TEST_F(DiagnosticsTest, testNoLimitWithoutScope)
+{
+  pilz::Diagnostics& diagnostics {pilz::Diagnostics::getInstance()};
+  ASSERT_EQ(nullptr, pilz::DiagnosticsPlanScope::getCurrentScope());
+  for(int i = 0; i < 10; ++i)
+  {
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::IK));
+  }
+  EXPECT_EQ(10u, diagnostics.getMessageCount(pilz::LogSubsystem::IK));
+  EXPECT_EQ(0u, diagnostics.getSuppressedCount(pilz::LogSubsystem::IK));
+}
+
+/**
+ * @brief Checks that the messages of a plan scope are limited and the suppressed
+ * messages are counted per subsystem.
+ */
+TEST_F(DiagnosticsTest, testLimitPerPlan)
+{
+  pilz::Diagnostics& diagnostics {pilz::Diagnostics::getInstance()};
+  {
+    pilz::DiagnosticsPlanScope scope;
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::IK));
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::IK));
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits));
+    EXPECT_FALSE(diagnostics.admitMessage(pilz::LogSubsystem::IK));
+    EXPECT_FALSE(diagnostics.admitMessage(pilz::LogSubsystem::Limits));
+  }
+  EXPECT_EQ(2u, diagnostics.getMessageCount(pilz::LogSubsystem::IK));
+  EXPECT_EQ(1u, diagnostics.getMessageCount(pilz::LogSubsystem::Limits));
+  EXPECT_EQ(1u, diagnostics.getSuppressedCount(pilz::LogSubsystem::IK));
+  EXPECT_EQ(1u, diagnostics.getSuppressedCount(pilz::LogSubsystem::Limits));
+
+  // the next plan has its own limit
+  pilz::DiagnosticsPlanScope scope;
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::IK));
+}
+
+/**
+ * @brief Checks that nested plan scopes share the limit of the outermost scope.
+ */
+TEST_F(DiagnosticsTest, testNestedScopesShareLimit)
+{
+  pilz::Diagnostics& diagnostics {pilz::Diagnostics::getInstance()};
+  pilz::DiagnosticsPlanScope sequence_scope;
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Sequence));
+  {
+    pilz::DiagnosticsPlanScope command_scope;
+    EXPECT_EQ(&sequence_scope, pilz::DiagnosticsPlanScope::getCurrentScope());
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Generator));
+  }
+  {
+    pilz::DiagnosticsPlanScope command_scope;
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Generator));
+    EXPECT_FALSE(diagnostics.admitMessage(pilz::LogSubsystem::Generator));
+  }
+  EXPECT_EQ(&sequence_scope, pilz::DiagnosticsPlanScope::getCurrentScope());
+}
+
+/**
+ * @brief Checks that a limit of zero does not limit the messages.
+ */
+TEST_F(DiagnosticsTest, testZeroLimitIsUnlimited)
+{
+  pilz::Diagnostics& diagnostics {pilz::Diagnostics::getInstance()};
+  diagnostics.setMessageLimitPerPlan(0);
+  pilz::DiagnosticsPlanScope scope;
+  for(int i = 0; i < 100; ++i)
+  {
+    EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Blender));
+  }
+  EXPECT_EQ(0u, diagnostics.getSuppressedCount(pilz::LogSubsystem::Blender));
+}
+
+/**
+ * @brief Checks that errors are admitted after the limit is reached and do not
+ * count against the limit.
+ */
+TEST_F(DiagnosticsTest, testErrorsAreNotLimited)
+{
+  pilz::Diagnostics& diagnostics {pilz::Diagnostics::getInstance()};
+  pilz::DiagnosticsPlanScope scope;
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Error));
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Warn));
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Warn));
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Warn));
+  EXPECT_FALSE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Warn));
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Error));
+  EXPECT_TRUE(diagnostics.admitMessage(pilz::LogSubsystem::Limits, ros::console::levels::Fatal));
+  EXPECT_EQ(6u, diagnostics.getMessageCount(pilz::LogSubsystem::Limits));
+  EXPECT_EQ(1u, diagnostics.getSuppressedCount(pilz::LogSubsystem::Limits));
+}
+
+static int evaluation_count {0};
+
+static std::string evaluate()
+{
+  ++evaluation_count;
+  return "evaluated";
+}
+
+/**
+ * @brief Checks that the arguments of messages of disabled levels are neither
+ * evaluated nor counted.
+ */
+TEST_F(DiagnosticsTest, testDisabledLevelIsNotEvaluated)
+{
+  ros::console::set_logger_level(std::string(ROSCONSOLE_NAME_PREFIX) + ".pilz.ik", ros::console::levels::Info);
+  ros::console::notifyLoggerLevelsChanged();
+
+  evaluation_count = 0;
+  PILZ_DEBUG_STREAM(pilz::LogSubsystem::IK, "Debug " << evaluate());
+  EXPECT_EQ(0, evaluation_count);
+  EXPECT_EQ(0u, pilz::Diagnostics::getInstance().getMessageCount(pilz::LogSubsystem::IK));
+
+  PILZ_INFO_STREAM(pilz::LogSubsystem::IK, "Info " << evaluate());
+  EXPECT_EQ(1, evaluation_count);
+  EXPECT_EQ(1u, pilz::Diagnostics::getInstance().getMessageCount(pilz::LogSubsystem::IK));
+}
+
+/**
+ * @brief Checks that the arguments of suppressed messages are not evaluated.
+ */
+TEST_F(DiagnosticsTest, testSuppressedMessageIsNotEvaluated)
+{
+  evaluation_count = 0;
+  pilz::DiagnosticsPlanScope scope;
+  for(int i = 0; i < 5; ++i)
+  {
+    PILZ_WARN_STREAM(pilz::LogSubsystem::Limits, "Warning " << evaluate());
+  }
+  EXPECT_EQ(3, evaluation_count);
+  EXPECT_EQ(2u, pilz::Diagnostics::getInstance().getSuppressedCount(pilz::LogSubsystem::Limits));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
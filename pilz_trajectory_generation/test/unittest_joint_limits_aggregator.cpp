@@ -15,6 +15,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <limits>
+
 #include <gtest/gtest.h>
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
@@ -24,6 +26,7 @@
 #include "pilz_extensions/joint_limits_interface_extension.h"
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
+#include "pilz_trajectory_generation/planning_configuration.h"
 
 using namespace pilz_extensions;
 
@@ -178,6 +181,274 @@ TEST_F(JointLimitsAggregator, LimitsViolationVelocity)
                pilz::AggregationBoundsViolationException);
 }
 
+/**
+ * @brief Check that the limits read from the fetched parameter namespace equal the limits read
+ * from the parameter server
+ */
+TEST_F(JointLimitsAggregator, AggregatedLimitsFromFetchedParameter)
+{
+  ros::NodeHandle nh("~/valid_1");
+  XmlRpc::XmlRpcValue param;
+  ASSERT_TRUE(nh.getParam(nh.getNamespace(), param));
+
+  pilz::JointLimitsContainer expected_container
+      = pilz::JointLimitsAggregator::getAggregatedLimits(nh, robot_model_->getActiveJointModels());
+  pilz::JointLimitsContainer container
+      = pilz::JointLimitsAggregator::getAggregatedLimits(param, robot_model_->getActiveJointModels());
+
+  ASSERT_EQ(expected_container.getCount(), container.getCount());
+  for(const auto& expected_lim : expected_container)
+  {
+    const JointLimit lim {container.getLimit(expected_lim.first)};
+    EXPECT_EQ(expected_lim.second.has_position_limits, lim.has_position_limits) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.min_position, lim.min_position) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.max_position, lim.max_position) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.has_velocity_limits, lim.has_velocity_limits) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.max_velocity, lim.max_velocity) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.has_acceleration_limits, lim.has_acceleration_limits) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.max_acceleration, lim.max_acceleration) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.has_deceleration_limits, lim.has_deceleration_limits) << expected_lim.first;
+    EXPECT_EQ(expected_lim.second.max_deceleration, lim.max_deceleration) << expected_lim.first;
+  }
+
+  ros::NodeHandle nh_violation("~/violate_velocity");
+  ASSERT_TRUE(nh_violation.getParam(nh_violation.getNamespace(), param));
+  EXPECT_THROW(pilz::JointLimitsAggregator::getAggregatedLimits(param, robot_model_->getActiveJointModels()),
+               pilz::AggregationBoundsViolationException);
+}
+
+/**
+ * @brief Check that the planning configuration is built once per namespace and robot model
+ * and contains the most strict limits of the groups
+ */
+TEST_F(JointLimitsAggregator, PlanningConfigurationIsShared)
+{
+  pilz::PlanningConfigurationRegistry& registry {pilz::PlanningConfigurationRegistry::getInstance()};
+  registry.clear();
+
+  ros::NodeHandle nh("~/valid_1");
+  pilz::PlanningConfigurationConstPtr configuration {registry.getConfiguration(nh, robot_model_)};
+  ASSERT_TRUE(configuration);
+  EXPECT_EQ(configuration, registry.getConfiguration(nh, robot_model_));
+
+  const pilz::LimitsContainer& limits {configuration->getLimits()};
+  ASSERT_TRUE(limits.hasJointLimits());
+  EXPECT_EQ(2, limits.getJointLimitContainer().getLimit("prbt_joint_1").max_position);
+
+  ASSERT_TRUE(limits.hasGroupCommonLimits());
+  for(const auto& jmg : robot_model_->getJointModelGroups())
+  {
+    const pilz_extensions::JointLimit expected_limit
+        {limits.getJointLimitContainer().getCommonLimit(jmg->getActiveJointModelNames())};
+    ASSERT_EQ(1u, limits.getGroupCommonLimits().count(jmg->getName())) << jmg->getName();
+    EXPECT_EQ(expected_limit.max_velocity, limits.getGroupCommonLimits().at(jmg->getName()).max_velocity);
+  }
+
+  // another robot model (e.g. a reloaded robot description) gets a new configuration
+  robot_model_loader::RobotModelLoader other_model_loader(robot_model_loader::RobotModelLoader::Options("robot_description"));
+  EXPECT_NE(configuration, registry.getConfiguration(nh, other_model_loader.getModel()));
+
+  registry.clear();
+}
+
+/**
+ * @brief Check that an update replaces the shared configuration, while the previous configuration
+ * stays valid for its users, and that a failed update leaves the configuration unchanged
+ */
+TEST_F(JointLimitsAggregator, PlanningConfigurationIsUpdated)
+{
+  pilz::PlanningConfigurationRegistry& registry {pilz::PlanningConfigurationRegistry::getInstance()};
+  registry.clear();
+
+  ros::NodeHandle nh("~/valid_1");
+  pilz::SharedPlanningConfigurationPtr shared_configuration {registry.getSharedConfiguration(nh, robot_model_)};
+  const pilz::PlanningConfigurationConstPtr configuration {shared_configuration->get()};
+  EXPECT_EQ(configuration, registry.getConfiguration(nh, robot_model_));
+
+  // reduction of the velocity and acceleration limits
+  registry.updateConfigurations(false, 0.5);
+  const pilz::PlanningConfigurationConstPtr reduced_configuration {shared_configuration->get()};
+  ASSERT_NE(configuration, reduced_configuration);
+  EXPECT_EQ(reduced_configuration, registry.getConfiguration(nh, robot_model_));
+  EXPECT_EQ(0.5, reduced_configuration->getReductionFactor());
+  const pilz::JointLimitsContainer& reduced_limits {reduced_configuration->getLimits().getJointLimitContainer()};
+  EXPECT_DOUBLE_EQ(0.55, reduced_limits.getLimit("prbt_joint_3").max_velocity);
+  EXPECT_DOUBLE_EQ(2.75, reduced_limits.getLimit("prbt_joint_4").max_acceleration);
+  EXPECT_DOUBLE_EQ(-3.3, reduced_limits.getLimit("prbt_joint_5").max_deceleration);
+  EXPECT_EQ(2, reduced_limits.getLimit("prbt_joint_1").max_position);
+  // the previous configuration is unchanged
+  EXPECT_DOUBLE_EQ(1.1, configuration->getLimits().getJointLimitContainer().getLimit("prbt_joint_3").max_velocity);
+
+  EXPECT_THROW(registry.updateConfigurations(false, 0.), std::invalid_argument);
+  EXPECT_THROW(registry.updateConfigurations(false, 1.5), std::invalid_argument);
+  EXPECT_EQ(reduced_configuration, shared_configuration->get());
+
+  // an update without reduction factor keeps the current one
+  registry.updateConfigurations(false);
+  ASSERT_NE(reduced_configuration, shared_configuration->get());
+  EXPECT_EQ(0.5, shared_configuration->get()->getReductionFactor());
+  EXPECT_DOUBLE_EQ(0.55, shared_configuration->get()->getLimits().getJointLimitContainer()
+                   .getLimit("prbt_joint_3").max_velocity);
+
+  // reload of the changed limits
+  nh.setParam("joint_limits/prbt_joint_3/max_velocity", 1.);
+  registry.updateConfigurations(true, 1.);
+  EXPECT_DOUBLE_EQ(1., shared_configuration->get()->getLimits().getJointLimitContainer()
+                   .getLimit("prbt_joint_3").max_velocity);
+
+  // limits violating the robot model are rejected
+  const pilz::PlanningConfigurationConstPtr reloaded_configuration {shared_configuration->get()};
+  nh.setParam("joint_limits/prbt_joint_3/max_velocity", 100.);
+  EXPECT_THROW(registry.updateConfigurations(true, 1.), pilz::AggregationBoundsViolationException);
+  EXPECT_EQ(reloaded_configuration, shared_configuration->get());
+
+  nh.setParam("joint_limits/prbt_joint_3/max_velocity", 1.1);
+  registry.clear();
+}
+
+/**
+ * @brief Check that within a configuration scope, the shared configuration returns the snapshot of the
+ * scope, even if the configuration is updated meanwhile
+ */
+TEST_F(JointLimitsAggregator, ConfigurationScope)
+{
+  pilz::PlanningConfigurationRegistry& registry {pilz::PlanningConfigurationRegistry::getInstance()};
+  registry.clear();
+
+  ros::NodeHandle nh("~/valid_1");
+  pilz::SharedPlanningConfigurationPtr shared_configuration {registry.getSharedConfiguration(nh, robot_model_)};
+  const pilz::PlanningConfigurationConstPtr configuration {shared_configuration->get()};
+  EXPECT_FALSE(pilz::ConfigurationScope::getCurrentConfiguration(*shared_configuration));
+  {
+    pilz::ConfigurationScope scope(*shared_configuration, shared_configuration->get());
+    registry.updateConfigurations(false, 0.5);
+    EXPECT_EQ(configuration, shared_configuration->get());
+    {
+      // nested scopes take the snapshot of the outer scope
+      pilz::ConfigurationScope inner_scope(*shared_configuration, shared_configuration->get());
+      EXPECT_EQ(configuration, shared_configuration->get());
+    }
+    EXPECT_EQ(configuration, shared_configuration->get());
+
+    // another shared configuration is not affected by the scope
+    pilz::SharedPlanningConfiguration other_configuration(configuration);
+    EXPECT_FALSE(pilz::ConfigurationScope::getCurrentConfiguration(other_configuration));
+  }
+  EXPECT_FALSE(pilz::ConfigurationScope::getCurrentConfiguration(*shared_configuration));
+  ASSERT_NE(configuration, shared_configuration->get());
+  EXPECT_EQ(0.5, shared_configuration->get()->getReductionFactor());
+
+  registry.clear();
+}
+
+/**
+ * @brief Check that the payload profiles override single limits of the namespace, are ordered by
+ * their maximal payload and are selected by the payload
+ */
+TEST_F(JointLimitsAggregator, PayloadProfiles)
+{
+  ros::NodeHandle nh("~/valid_1");
+  XmlRpc::XmlRpcValue param;
+  ASSERT_TRUE(nh.getParam(nh.getNamespace(), param));
+  param["payload_profiles"]["heavy"]["max_payload"] = 5;
+  param["payload_profiles"]["heavy"]["joint_limits"]["prbt_joint_4"]["max_acceleration"] = 2.;
+  param["payload_profiles"]["empty"]["max_payload"] = 0.5;
+  param["payload_profiles"]["empty"]["joint_limits"]["prbt_joint_3"]["max_velocity"] = 1.;
+  param["payload_profiles"]["empty"]["cartesian_limits"]["max_trans_vel"] = 0.5;
+
+  const pilz::PlanningConfiguration configuration(param, robot_model_);
+  ASSERT_EQ(2u, configuration.getPayloadProfiles().size());
+  EXPECT_EQ("empty", configuration.getPayloadProfiles().front().name);
+  EXPECT_EQ("heavy", configuration.getPayloadProfiles().back().name);
+
+  ASSERT_TRUE(configuration.getPayloadProfile(0.));
+  EXPECT_EQ("empty", configuration.getPayloadProfile(0.)->name);
+  ASSERT_TRUE(configuration.getPayloadProfile(5.));
+  EXPECT_EQ("heavy", configuration.getPayloadProfile(5.)->name);
+  EXPECT_FALSE(configuration.getPayloadProfile(5.1));
+  EXPECT_FALSE(configuration.getPayloadProfile(std::numeric_limits<double>::quiet_NaN()));
+
+  // the profile overrides only its limits
+  const pilz::PayloadLimits empty_limits {configuration.getPayloadLimits(0.)};
+  EXPECT_EQ(&configuration.getPayloadProfiles().front().limits, &empty_limits.limits) << "limits are copied";
+  EXPECT_DOUBLE_EQ(1., empty_limits.limits.getJointLimitContainer().getLimit("prbt_joint_3").max_velocity);
+  EXPECT_DOUBLE_EQ(5.5, empty_limits.limits.getJointLimitContainer().getLimit("prbt_joint_4").max_acceleration);
+  EXPECT_DOUBLE_EQ(0.5, empty_limits.limits.getCartesianLimits().getMaxTranslationalVelocity());
+  EXPECT_EQ(0., empty_limits.payload);
+  ASSERT_TRUE(empty_limits.limits.hasGroupCommonLimits());
+
+  const pilz::PayloadLimits heavy_limits {configuration.getPayloadLimits(3.)};
+  EXPECT_EQ(&configuration.getPayloadProfiles().back().limits, &heavy_limits.limits) << "limits are copied";
+  EXPECT_DOUBLE_EQ(1.1, heavy_limits.limits.getJointLimitContainer().getLimit("prbt_joint_3").max_velocity);
+  EXPECT_DOUBLE_EQ(2., heavy_limits.limits.getJointLimitContainer().getLimit("prbt_joint_4").max_acceleration);
+  EXPECT_EQ(3., heavy_limits.payload);
+
+  // an unknown or too heavy payload gets the limits of the namespace
+  for(double payload : {std::numeric_limits<double>::quiet_NaN(), 10.})
+  {
+    const pilz::PayloadLimits limits {configuration.getPayloadLimits(payload)};
+    EXPECT_EQ(&configuration.getLimits(), &limits.limits) << "limits are copied";
+    EXPECT_DOUBLE_EQ(1.1, limits.limits.getJointLimitContainer().getLimit("prbt_joint_3").max_velocity);
+    EXPECT_DOUBLE_EQ(5.5, limits.limits.getJointLimitContainer().getLimit("prbt_joint_4").max_acceleration);
+  }
+  EXPECT_DOUBLE_EQ(1.1, configuration.getLimits().getJointLimitContainer().getLimit("prbt_joint_3").max_velocity);
+
+  // the payload scopes are nested
+  EXPECT_FALSE(pilz::PayloadScope::getCurrentPayload());
+  {
+    pilz::PayloadScope outer_scope(1.);
+    {
+      pilz::PayloadScope inner_scope(2.);
+      ASSERT_TRUE(pilz::PayloadScope::getCurrentPayload());
+      EXPECT_EQ(2., *pilz::PayloadScope::getCurrentPayload());
+    }
+    ASSERT_TRUE(pilz::PayloadScope::getCurrentPayload());
+    EXPECT_EQ(1., *pilz::PayloadScope::getCurrentPayload());
+  }
+  EXPECT_FALSE(pilz::PayloadScope::getCurrentPayload());
+
+  // a profile without maximal payload is rejected
+  param["payload_profiles"]["invalid"]["joint_limits"]["prbt_joint_3"]["max_velocity"] = 1.;
+  EXPECT_THROW(pilz::PlanningConfiguration invalid_configuration(param, robot_model_), std::invalid_argument);
+}
+
+/**
+ * @brief Check that the options of the PTP goal IK are read per planning group and that
+ * malformed options are rejected
+ */
+TEST_F(JointLimitsAggregator, PtpGoalIkOptions)
+{
+  ros::NodeHandle nh("~/valid_1");
+  XmlRpc::XmlRpcValue param;
+  ASSERT_TRUE(nh.getParam(nh.getNamespace(), param));
+  XmlRpc::XmlRpcValue& group_param {param["ptp_goal_ik"]["manipulator"]};
+  for(int j = 0; j < 6; ++j)
+  {
+    group_param["seeds"][0][j] = j == 0 ? 2.0 : 0.0;
+  }
+  group_param["seeds"][0][1] = 1;
+  group_param["solver_alternatives"] = true;
+
+  const pilz::PlanningConfiguration configuration(param, robot_model_);
+  const pilz::GoalIkOptionsMap& goal_ik_options {configuration.getLimits().getGoalIkOptions()};
+  ASSERT_EQ(1u, goal_ik_options.count("manipulator"));
+  const pilz::GoalIkOptions& options {goal_ik_options.at("manipulator")};
+  ASSERT_EQ(1u, options.seeds.size());
+  EXPECT_EQ(2.0, options.seeds.front().at("prbt_joint_1"));
+  EXPECT_EQ(1.0, options.seeds.front().at("prbt_joint_2"));
+  EXPECT_TRUE(options.solver_alternatives);
+  EXPECT_TRUE(options.hasCandidates());
+
+  // a seed with the wrong number of joints
+  group_param["seeds"][0][6] = 0.0;
+  EXPECT_THROW(pilz::PlanningConfiguration invalid_configuration(param, robot_model_), std::invalid_argument);
+
+  // an unknown planning group
+  param["ptp_goal_ik"] = XmlRpc::XmlRpcValue();
+  param["ptp_goal_ik"]["unknown_group"]["solver_alternatives"] = true;
+  EXPECT_THROW(pilz::PlanningConfiguration invalid_configuration(param, robot_model_), std::invalid_argument);
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_joint_limits_aggregator");
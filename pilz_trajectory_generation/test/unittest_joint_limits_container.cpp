@@ -17,6 +17,10 @@
 
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "pilz_extensions/joint_limits_extension.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
 
@@ -210,6 +214,249 @@ TEST_F(JointLimitsContainerTest, CheckVerifyPositionLimits)
                std::out_of_range);
 }
 
+/**
+ * @brief Check that the compiled table contains the limits in the order of the given joints and
+ * that joints without limit are unlimited
+ */
+TEST_F(JointLimitsContainerTest, CheckTable)
+{
+  pilz::JointLimitsTable table {container_.getTable({"joint6", "joint1", "unknown"})};
+  ASSERT_EQ(3u, table.size());
+  EXPECT_EQ("joint6", table.getJointNames().at(0));
+
+  EXPECT_EQ(2, table.getMaxVelocity(0));
+  EXPECT_EQ(100, table.getMaxDeceleration(0));
+  EXPECT_EQ(-2, table.getMinPosition(1));
+  EXPECT_EQ(2, table.getMaxPosition(1));
+  EXPECT_EQ(3, table.getMaxAcceleration(1));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), table.getMaxVelocity(1));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), table.getMaxPosition(2));
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), table.getMinPosition(2));
+
+  const double positions_valid[] {100., 2., -1000.};
+  EXPECT_EQ(pilz::JointLimitsTable::NO_VIOLATION, table.findPositionViolation(positions_valid));
+  const double positions_invalid[] {0., -2.1, 0.};
+  EXPECT_EQ(1u, table.findPositionViolation(positions_invalid));
+
+  const double velocities_last[] {1., 0., 0.};
+  const double velocities[] {-2.5, 1., 1.};
+  EXPECT_EQ(0u, table.findVelocityViolation(velocities));
+
+  // joint1 accelerates (limit 3), joint6 decelerates (limit 100)
+  const double accelerations_valid[] {-99., 3., 1000.};
+  EXPECT_EQ(pilz::JointLimitsTable::NO_VIOLATION,
+            table.findAccelerationViolation(velocities_last, accelerations_valid));
+  const double accelerations_invalid[] {0., -3.5, 0.};
+  EXPECT_EQ(1u, table.findAccelerationViolation(velocities_last, accelerations_invalid));
+}
+
+/**
+ * @brief Check that the table of a group is used for a subset of its joints and that it
+ * is invalidated by adding a limit
+ */
+TEST_F(JointLimitsContainerTest, CheckGroupTable)
+{
+  container_.addGroupTable("group", {"joint1", "joint2", "joint3"});
+
+  pilz::JointLimitsTable table {container_.getTable("group", {"joint3", "joint1"})};
+  ASSERT_EQ(2u, table.size());
+  EXPECT_EQ(10, table.getMaxVelocity(0));
+  EXPECT_EQ(3, table.getMaxAcceleration(1));
+
+  // joints which are not part of the group
+  table = container_.getTable("group", {"joint6"});
+  ASSERT_EQ(1u, table.size());
+  EXPECT_EQ(2, table.getMaxVelocity(0));
+
+  pilz_extensions::JointLimit lim;
+  lim.has_velocity_limits = true;
+  lim.max_velocity = 7;
+  container_.addLimit("joint7", lim);
+  table = container_.getTable("group", {"joint7"});
+  EXPECT_EQ(7, table.getMaxVelocity(0));
+}
+
+/**
+ * @brief Check that the whole trajectory check reports the first violation and that accelerations
+ * opposing the velocity are checked against the deceleration limit
+ */
+TEST_F(JointLimitsContainerTest, CheckTrajectoryViolation)
+{
+  // joint2: positions [-1, 1], deceleration 5; joint6: velocity 2, deceleration 100
+  const pilz::JointLimitsTable table {container_.getTable({"joint2", "joint6"})};
+
+  // three waypoints of two joints
+  double positions[] {0., 0., 0.5, 10., 1. + 1e-7, 20.};
+  double velocities[] {0., 0., 1., 2., 0., -2.};
+  double accelerations[] {6., 50., -5., -100., 0., -1000.};
+
+  pilz::TrajectoryLimitViolation violation;
+  EXPECT_FALSE(table.findTrajectoryViolation(3, positions, velocities, accelerations, violation));
+
+  // deceleration of the last waypoint, acceleration limit of joint6 not set
+  accelerations[5] = 1000.;
+  ASSERT_TRUE(table.findTrajectoryViolation(3, positions, velocities, accelerations, violation));
+  EXPECT_EQ(2u, violation.waypoint);
+  EXPECT_EQ(1u, violation.joint);
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Deceleration, violation.type);
+  EXPECT_EQ(1000., violation.value);
+  EXPECT_EQ(100., violation.limit);
+  EXPECT_STREQ("deceleration", pilz::toString(violation.type));
+
+  // the first violating waypoint is reported
+  velocities[3] = 2.5;
+  ASSERT_TRUE(table.findTrajectoryViolation(3, positions, velocities, accelerations, violation));
+  EXPECT_EQ(1u, violation.waypoint);
+  EXPECT_EQ(1u, violation.joint);
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Velocity, violation.type);
+  EXPECT_EQ(2.5, violation.value);
+
+  // the position is checked first and the first violating joint is reported
+  positions[2] = 1.5;
+  ASSERT_TRUE(table.findTrajectoryViolation(3, positions, velocities, accelerations, violation));
+  EXPECT_EQ(1u, violation.waypoint);
+  EXPECT_EQ(0u, violation.joint);
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Position, violation.type);
+  EXPECT_EQ(1., violation.limit);
+
+  // only the given number of waypoints is checked
+  EXPECT_FALSE(table.findTrajectoryViolation(1, positions, velocities, accelerations, violation));
+}
+
+/**
+ * @brief Check that the sample check and the whole trajectory check classify accelerations opposing
+ * the velocity as deceleration, including a change of the direction between two samples
+ */
+TEST_F(JointLimitsContainerTest, CheckAccelerationClassification)
+{
+  // joint6: no acceleration limit, deceleration 100
+  const pilz::JointLimitsTable table {container_.getTable({"joint6"})};
+  const double positions[] {0.};
+  const double accelerations[] {-150.};
+  pilz::TrajectoryLimitViolation violation;
+
+  const double velocities_forward[] {1.};
+  EXPECT_EQ(0u, table.findAccelerationViolation(velocities_forward, accelerations));
+  ASSERT_TRUE(table.findTrajectoryViolation(1, positions, velocities_forward, accelerations, violation));
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Deceleration, violation.type);
+
+  const double velocities_backward[] {-1.};
+  EXPECT_EQ(pilz::JointLimitsTable::NO_VIOLATION,
+            table.findAccelerationViolation(velocities_backward, accelerations));
+  EXPECT_FALSE(table.findTrajectoryViolation(1, positions, velocities_backward, accelerations, violation));
+
+  // the joint decelerates from the last sample, even if it reverses its direction until the next one
+  const double velocities_last[] {0.5};
+  EXPECT_EQ(0u, table.findAccelerationViolation(velocities_last, accelerations));
+}
+
+/**
+ * @brief Check that configuration dependent limits tighten the scalar limits depending on the
+ * positions and the payload, and that unknown coordinates take the worst case
+ */
+TEST_F(JointLimitsContainerTest, CheckConfigurationDependentLimits)
+{
+  // acceleration of joint7 over the position of joint1 and the payload
+  pilz_extensions::JointLimit lim;
+  lim.has_acceleration_limits = true;
+  lim.max_acceleration = 5;
+  lim.acceleration_grid = std::make_shared<const pilz_extensions::JointLimitsGrid>(
+        std::vector<pilz_extensions::JointLimitsGrid::Axis> {{"joint1", {0., 1.}},
+                                                             {pilz_extensions::JointLimitsGrid::getPayloadAxisName(),
+                                                              {0., 10.}}},
+        std::vector<double> {4., 2., 2., 1.});
+  container_.addLimit("joint7", lim);
+
+  pilz::JointLimitsTable table {container_.getTable({"joint7", "joint1"})};
+  ASSERT_TRUE(table.hasConfigurationDependentLimits());
+  EXPECT_EQ(5, table.getMaxAcceleration(0));
+
+  // unknown payload, worst case
+  const double positions[] {0., 0.5};
+  EXPECT_NEAR(1.5, table.getMaxAcceleration(0, positions), 1e-12);
+  table.setPayload(0.);
+  EXPECT_NEAR(3., table.getMaxAcceleration(0, positions), 1e-12);
+
+  // joint1 not part of the table, worst case over its axis
+  pilz::JointLimitsTable selected_table {table.select({"joint7"})};
+  EXPECT_EQ(0., selected_table.getPayload());
+  EXPECT_NEAR(2., selected_table.getMaxAcceleration(0, positions), 1e-12);
+
+  // minimum of the cells between start and goal
+  const double goal_positions[] {0., 0.4};
+  double max_velocities[2], max_accelerations[2], max_decelerations[2];
+  table.getMinimalLimits(positions, goal_positions, max_velocities, max_accelerations, max_decelerations);
+  EXPECT_EQ(2., max_accelerations[0]);
+  EXPECT_EQ(3., max_accelerations[1]);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), max_velocities[0]);
+
+  // the trajectory check uses the limits at the positions of the waypoints
+  double trajectory_positions[] {0., 0., 0., 1.};
+  double velocities[] {1., 0., 1., 0.};
+  double accelerations[] {3.5, 0., 3.5, 0.};
+  pilz::TrajectoryLimitViolation violation;
+  ASSERT_TRUE(table.findTrajectoryViolation(2, trajectory_positions, velocities, accelerations, violation));
+  EXPECT_EQ(1u, violation.waypoint);
+  EXPECT_EQ(0u, violation.joint);
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Acceleration, violation.type);
+  EXPECT_EQ(2., violation.limit);
+
+  EXPECT_EQ(pilz::JointLimitsTable::NO_VIOLATION, table.findAccelerationViolation(velocities, accelerations));
+  EXPECT_EQ(0u, table.findAccelerationViolation(velocities, accelerations, trajectory_positions + 2));
+}
+
+/**
+ * @brief Check that a joint without a deceleration grid takes its acceleration grid as deceleration grid,
+ * like the scalar deceleration defaults to the acceleration
+ */
+TEST_F(JointLimitsContainerTest, CheckDecelerationGridFallback)
+{
+  // acceleration of joint7 over the position of joint1
+  pilz_extensions::JointLimit lim;
+  lim.has_acceleration_limits = true;
+  lim.max_acceleration = 5;
+  lim.has_deceleration_limits = true;
+  lim.max_deceleration = -5;
+  lim.acceleration_grid = std::make_shared<const pilz_extensions::JointLimitsGrid>(
+        std::vector<pilz_extensions::JointLimitsGrid::Axis> {{"joint1", {0., 1.}}},
+        std::vector<double> {4., 2.});
+  container_.addLimit("joint7", lim);
+
+  pilz::JointLimitsTable table {container_.getTable({"joint7", "joint1"})};
+  const double positions[] {0., 1.};
+  EXPECT_NEAR(2., table.getMaxAcceleration(0, positions), 1e-12);
+  EXPECT_NEAR(2., table.getMaxDeceleration(0, positions), 1e-12);
+
+  // the minimal limits of a PTP
+  const double start_positions[] {0., 0.};
+  double max_velocities[2], max_accelerations[2], max_decelerations[2];
+  table.getMinimalLimits(start_positions, positions, max_velocities, max_accelerations, max_decelerations);
+  EXPECT_EQ(2., max_accelerations[0]);
+  EXPECT_EQ(2., max_decelerations[0]);
+
+  // a deceleration of the waypoint violates the grid
+  double trajectory_positions[] {0., 1.};
+  double velocities[] {1., 0.};
+  double accelerations[] {-3., 0.};
+  pilz::TrajectoryLimitViolation violation;
+  ASSERT_TRUE(table.findTrajectoryViolation(1, trajectory_positions, velocities, accelerations, violation));
+  EXPECT_EQ(0u, violation.joint);
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Deceleration, violation.type);
+  EXPECT_EQ(2., violation.limit);
+  EXPECT_EQ(0u, table.findAccelerationViolation(velocities, accelerations, trajectory_positions));
+
+  // a deceleration grid of its own is not replaced
+  lim.deceleration_grid = std::make_shared<const pilz_extensions::JointLimitsGrid>(
+        std::vector<pilz_extensions::JointLimitsGrid::Axis> {{"joint1", {0., 1.}}},
+        std::vector<double> {4., 3.5});
+  pilz::JointLimitsTable own_grid_table;
+  own_grid_table.addJoint("joint7", lim);
+  own_grid_table.addUnlimitedJoint("joint1");
+  EXPECT_NEAR(2., own_grid_table.getMaxAcceleration(0, positions), 1e-12);
+  EXPECT_NEAR(3.5, own_grid_table.getMaxDeceleration(0, positions), 1e-12);
+  EXPECT_FALSE(own_grid_table.findTrajectoryViolation(1, trajectory_positions, velocities, accelerations, violation));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pilz_trajectory_generation/monotonic_arena.h"
+
+/**
+ * @brief Checks that the memory handed out by the arena has the requested alignment.
+ */
+TEST(MonotonicArenaTest, testAlignment)
+{
+  pilz::MonotonicArena arena(64);
+  arena.allocate(1, 1);
+  for (std::size_t alignment : {2u, 4u, 8u, 16u})
+  {
+    void* ptr {arena.allocate(3, alignment)};
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(ptr) % alignment);
+  }
+  EXPECT_EQ(1u, arena.getBlockCount());
+}
+
+/**
+ * @brief Checks that allocations larger than the block size are possible
+ * and that release() frees the blocks.
+ */
+TEST(MonotonicArenaTest, testLargeAllocationAndRelease)
+{
+  pilz::MonotonicArena arena(16);
+  arena.allocate(8, 8);
+  EXPECT_EQ(1u, arena.getBlockCount());
+
+  ASSERT_NE(nullptr, arena.allocate(1024, 8));
+  EXPECT_EQ(2u, arena.getBlockCount());
+
+  arena.release();
+  EXPECT_EQ(0u, arena.getBlockCount());
+}
+
+/**
+ * @brief Checks that standard containers work with the ArenaAllocator.
+ */
+TEST(MonotonicArenaTest, testContainer)
+{
+  pilz::MonotonicArena arena;
+  std::vector<std::string, pilz::ArenaAllocator<std::string> > cont {pilz::ArenaAllocator<std::string>(arena)};
+  for (int i = 0; i < 100; ++i)
+  {
+    cont.emplace_back(std::to_string(i));
+  }
+
+  ASSERT_EQ(100u, cont.size());
+  EXPECT_EQ("42", cont.at(42));
+  EXPECT_GT(arena.getBlockCount(), 0u);
+  EXPECT_EQ(cont.get_allocator(), pilz::ArenaAllocator<int>(arena));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
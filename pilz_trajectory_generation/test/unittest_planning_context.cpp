@@ -15,6 +15,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 #include <boost/core/demangle.hpp>
 
@@ -27,6 +29,7 @@
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/kinematic_constraints/utils.h>
 
+#include "pilz_trajectory_generation/cancellation_token.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
 #include "pilz_trajectory_generation/planning_context_ptp.h"
 #include "pilz_trajectory_generation/planning_context_lin.h"
@@ -91,19 +94,18 @@ protected:
     cartesian_limit.setMaxTranslationalDeceleration(1.0*M_PI);
     cartesian_limit.setMaxTranslationalVelocity(1.0*M_PI);
 
-    pilz::LimitsContainer limits;
-    limits.setJointLimits(joint_limits);
-    limits.setCartesianLimits(cartesian_limit);
+    limits_.setJointLimits(joint_limits);
+    limits_.setCartesianLimits(cartesian_limit);
 
-    planning_context_ = std::unique_ptr<typename T::Type_>(new typename T::Type_("TestPlanningContext", "TestGroup", robot_model_, limits));
+    planning_context_ = std::unique_ptr<typename T::Type_>(new typename T::Type_("TestPlanningContext", "TestGroup", robot_model_, limits_));
 
     // Define and set the current scene
-    planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(robot_model_));
+    scene_.reset(new planning_scene::PlanningScene(robot_model_));
     robot_state::RobotState current_state(robot_model_);
     current_state.setToDefaultValues();
     current_state.setJointGroupPositions(planning_group_, {0, 1.57, 1.57, 0, 0.2, 0});
-    scene->setCurrentState(current_state);
-    planning_context_->setPlanningScene(scene); // TODO Check what happens if this is missing
+    scene_->setCurrentState(current_state);
+    planning_context_->setPlanningScene(scene_); // TODO Check what happens if this is missing
   }
 
   /**
@@ -161,6 +163,8 @@ protected:
   robot_model::RobotModelConstPtr robot_model_ {
     robot_model_loader::RobotModelLoader(!T::VALUE ? PARAM_MODEL_NO_GRIPPER_NAME: PARAM_MODEL_WITH_GRIPPER_NAME).getModel()};
 
+  pilz::LimitsContainer limits_;
+  planning_scene::PlanningScenePtr scene_;
   std::unique_ptr<planning_interface::PlanningContext> planning_context_;
 
   std::string planning_group_, target_link_;
@@ -209,7 +213,8 @@ TYPED_TEST(PlanningContextTest, SolveValidRequest)
 }
 
 /**
- * @brief Solve a valid request. Expect a detailed response.
+ * @brief Solve a valid request. Expect a detailed response containing the
+ * processing times of the planning phases.
  */
 TYPED_TEST(PlanningContextTest, SolveValidRequestDetailedResponse)
 {
@@ -222,6 +227,16 @@ TYPED_TEST(PlanningContextTest, SolveValidRequestDetailedResponse)
   EXPECT_TRUE(result) << testutils::demangel(typeid(TypeParam).name());
   EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val)
       << testutils::demangel(typeid(TypeParam).name());
+
+  ASSERT_FALSE(res.description_.empty()) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ("plan", res.description_.front()) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ(res.description_.size(), res.trajectory_.size()) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ(res.description_.size(), res.processing_time_.size()) << testutils::demangel(typeid(TypeParam).name());
+  for(const std::string& phase : {"validate_request", "extract_motion_plan_info", "plan", "set_success_response"})
+  {
+    EXPECT_NE(std::find(res.description_.begin() + 1, res.description_.end(), phase), res.description_.end())
+        << phase << " " << testutils::demangel(typeid(TypeParam).name());
+  }
 }
 
 /**
@@ -245,6 +260,32 @@ TYPED_TEST(PlanningContextTest, SolveOnTerminated)
 
 }
 
+/**
+ * @brief Call solve on a context which was created in the scope of a cancelled token.
+ *
+ * Expected Results:
+ *    1. solve() fails with error code PREEMPTED.
+ */
+TYPED_TEST(PlanningContextTest, SolveInCancelledScope)
+{
+  pilz::CancellationToken cancellation {pilz::CancellationToken::create()};
+  std::unique_ptr<planning_interface::PlanningContext> planning_context;
+  {
+    pilz::CancellationScope scope(cancellation);
+    planning_context.reset(new typename TypeParam::Type_("TestPlanningContext", "TestGroup",
+                                                         this->robot_model_, this->limits_));
+  }
+  planning_context->setPlanningScene(this->scene_);
+  planning_context->setMotionPlanRequest(this->getValidRequest(testutils::demangel(typeid(TypeParam).name())));
+
+  cancellation.cancel();
+
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(planning_context->solve(res)) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PREEMPTED, res.error_code_.val)
+      << testutils::demangel(typeid(TypeParam).name());
+}
+
 /**
  * @brief Check if clear can be called. So far only stability is expected.
  */
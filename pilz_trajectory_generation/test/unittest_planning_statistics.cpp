@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <ros/time.h>
+
+#include "pilz_trajectory_generation/phase_timings.h"
+#include "pilz_trajectory_generation/planning_statistics.h"
+
+using namespace pilz_trajectory_generation;
+
+static constexpr double EPSILON {1e-9};
+
+/**
+ * @brief Checks that the processing time of a phase which is added twice is
+ * accumulated and that the order of the phases is kept.
+ */
+TEST(PlanningStatisticsTest, testPhaseTimings)
+{
+  pilz::PhaseTimings timings;
+  timings.add("b", 1.);
+  timings.add("a", 2.);
+  timings.add("b", 3.);
+
+  pilz::PhaseTimings other;
+  other.add(timings, "prefix/");
+
+  ASSERT_EQ(2u, other.getEntries().size());
+  EXPECT_EQ("prefix/b", other.getEntries().front().first);
+  EXPECT_NEAR(4., other.get("prefix/b"), EPSILON);
+  EXPECT_NEAR(2., other.get("prefix/a"), EPSILON);
+  EXPECT_NEAR(0., other.get("b"), EPSILON);
+}
+
+/**
+ * @brief Checks the percentiles of known samples.
+ */
+TEST(PlanningStatisticsTest, testComputePercentile)
+{
+  std::vector<double> samples;
+  for(int i = 100; i > 0; --i)
+  {
+    samples.push_back(i);
+  }
+
+  EXPECT_NEAR(50., PlanningStatistics::computePercentile(samples, 50.), EPSILON);
+  EXPECT_NEAR(99., PlanningStatistics::computePercentile(samples, 99.), EPSILON);
+  EXPECT_NEAR(100., PlanningStatistics::computePercentile(samples, 100.), EPSILON);
+  EXPECT_NEAR(1., PlanningStatistics::computePercentile(samples, 0.), EPSILON);
+  EXPECT_NEAR(0., PlanningStatistics::computePercentile(std::vector<double>(), 50.), EPSILON);
+}
+
+/**
+ * @brief Checks that only the last requests (window size) are used for the statistics.
+ */
+TEST(PlanningStatisticsTest, testRollingWindow)
+{
+  PlanningStatistics statistics(2);
+  for(double time : {10., 1., 3.})
+  {
+    pilz::PhaseTimings timings;
+    timings.add("plan", time);
+    statistics.addRequest(timings);
+  }
+
+  pilz_msgs::PlanningStatistics msg {statistics.getStatistics()};
+  EXPECT_EQ(3u, msg.request_count);
+  ASSERT_EQ(1u, msg.phases.size());
+  EXPECT_EQ("plan", msg.phases.front().phase);
+  EXPECT_EQ(2u, msg.phases.front().sample_count);
+  EXPECT_NEAR(2., msg.phases.front().mean, EPSILON);
+  EXPECT_NEAR(3., msg.phases.front().max, EPSILON);
+  EXPECT_NEAR(1., msg.phases.front().p50, EPSILON);
+  EXPECT_NEAR(3., msg.phases.front().p99, EPSILON);
+}
+
+/**
+ * @brief Checks that the allocation counts of a phase are accumulated like
+ * the processing time, and that the statistics contain their mean.
+ */
+TEST(PlanningStatisticsTest, testAllocationCounts)
+{
+  pilz::AllocationCounts counts;
+  counts.allocations = 2;
+  counts.allocated_bytes = 100;
+  counts.copies = 1;
+  counts.copied_bytes = 10;
+
+  pilz::PhaseTimings timings;
+  timings.add("plan", 1., counts);
+  timings.add("plan", 1., counts);
+  timings.add("blend", 1.);
+  ASSERT_EQ(timings.getEntries().size(), timings.getAllocationCounts().size());
+  EXPECT_EQ(4u, timings.getAllocationCounts().front().allocations);
+  EXPECT_EQ(200u, timings.getAllocationCounts().front().allocated_bytes);
+  EXPECT_EQ(2u, timings.getAllocationCounts().front().copies);
+  EXPECT_EQ(20u, timings.getAllocationCounts().front().copied_bytes);
+  EXPECT_EQ(0u, timings.getAllocationCounts().back().allocations);
+
+  PlanningStatistics statistics;
+  statistics.addRequest(timings);
+  timings.clear();
+  timings.add("plan", 1.);
+  statistics.addRequest(timings);
+
+  pilz_msgs::PlanningStatistics msg {statistics.getStatistics()};
+  ASSERT_EQ(2u, msg.phases.size());
+  EXPECT_EQ("plan", msg.phases.front().phase);
+  EXPECT_NEAR(2., msg.phases.front().mean_allocations, EPSILON);
+  EXPECT_NEAR(100., msg.phases.front().mean_allocated_bytes, EPSILON);
+  EXPECT_NEAR(1., msg.phases.front().mean_copies, EPSILON);
+  EXPECT_NEAR(10., msg.phases.front().mean_copied_bytes, EPSILON);
+}
+
+int main(int argc, char **argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
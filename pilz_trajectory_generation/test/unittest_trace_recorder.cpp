@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "pilz_trajectory_generation/trace_recorder.h"
+
+static const std::string TRACE_FILE_NAME {"unittest_trace_recorder.json"};
+
+class TraceRecorderTest : public testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    pilz::TraceRecorder::getInstance().close();
+    std::remove(TRACE_FILE_NAME.c_str());
+  }
+
+  static std::string getTrace()
+  {
+    std::ostringstream os;
+    pilz::TraceRecorder::getInstance().write(os);
+    return os.str();
+  }
+};
+
+/**
+ * @brief Checks that no spans are recorded while the recorder is closed.
+ */
+TEST_F(TraceRecorderTest, testNoRecordingWhenClosed)
+{
+  pilz::TraceRecorder& recorder {pilz::TraceRecorder::getInstance()};
+  recorder.clear();
+  ASSERT_FALSE(recorder.isRecording());
+  {
+    pilz::TraceSpan span("test", "closed_span");
+  }
+  EXPECT_EQ(std::string::npos, getTrace().find("closed_span"));
+}
+
+/**
+ * @brief Checks that spans of different threads are written as complete
+ * events with different thread ids, and that close() writes the file.
+ */
+TEST_F(TraceRecorderTest, testSpansOfThreads)
+{
+  pilz::TraceRecorder& recorder {pilz::TraceRecorder::getInstance()};
+  ASSERT_TRUE(recorder.open(TRACE_FILE_NAME));
+  EXPECT_TRUE(recorder.open(TRACE_FILE_NAME));
+  EXPECT_FALSE(recorder.open("other_" + TRACE_FILE_NAME));
+
+  {
+    pilz::TraceSpan outer("test", "outer \"span\"");
+    std::thread thread([](){ pilz::TraceSpan inner("test", "thread_span"); });
+    thread.join();
+  }
+
+  const std::string trace {getTrace()};
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"outer \\\"span\\\"\",\"cat\":\"test\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"thread_span\""));
+  EXPECT_NE(std::string::npos, trace.find("\"tid\":0}"));
+  EXPECT_NE(std::string::npos, trace.find("\"tid\":1}"));
+
+  recorder.close();
+  EXPECT_FALSE(recorder.isRecording());
+  std::ifstream file(TRACE_FILE_NAME);
+  std::stringstream file_content;
+  file_content << file.rdbuf();
+  EXPECT_EQ(trace, file_content.str());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -282,7 +282,7 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testZeroRadius)
  *
  * Expected Results:
  *    1. Two linear trajectories generated.
- *    2. Blending trajectory cannot be generated.
+ *    2. Blending trajectory is generated and valid.
  */
 TEST_P(TrajectoryBlenderTransitionWindowTest, testDifferentSamplingTimes)
 {
@@ -303,10 +303,7 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testDifferentSamplingTimes)
     }
     // generate trajectory
     planning_interface::MotionPlanResponse resp;
-    if(!lin_generator_->generate(req, resp, sampling_time_))
-    {
-      std::runtime_error("Failed to generate trajectory.");
-    }
+    ASSERT_TRUE(lin_generator_->generate(req, resp, sampling_time_)) << "Failed to generate trajectory.";
     responses.at(index) = resp;
   }
 
@@ -318,13 +315,20 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testDifferentSamplingTimes)
   blend_req.first_trajectory = responses[0].trajectory_;
   blend_req.second_trajectory = responses[1].trajectory_;
   blend_req.blend_radius = seq.getBlendRadius(0);
-  EXPECT_FALSE(blender_->blend(blend_req, blend_res));
+  EXPECT_TRUE(blender_->blend(blend_req, blend_res));
+
+  EXPECT_TRUE(testutils::checkBlendResult(blend_req,
+                                          blend_res,
+                                          planner_limits_,
+                                          joint_velocity_tolerance_,
+                                          joint_acceleration_tolerance_,
+                                          cartesian_velocity_tolerance_,
+                                          cartesian_angular_velocity_tolerance_));
 }
 
 /**
  * @brief  Tests the blending of two trajectories with one trajectory
- * having non-uniform sampling time (apart from the last sample,
- * which is ignored).
+ * having non-uniform sampling time.
  *
  * Test Sequence:
  *    1. Generate two linear trajectories and corrupt uniformity of sampling time.
@@ -332,7 +336,7 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testDifferentSamplingTimes)
  *
  * Expected Results:
  *    1. Two linear trajectories generated.
- *    2. Blending trajectory cannot be generated.
+ *    2. Blending trajectory is generated and valid.
  */
 TEST_P(TrajectoryBlenderTransitionWindowTest, testNonUniformSamplingTime)
 {
@@ -352,7 +356,15 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testNonUniformSamplingTime)
   blend_req.first_trajectory = res.at(0).trajectory_;
   blend_req.second_trajectory = res.at(1).trajectory_;
   blend_req.blend_radius = seq.getBlendRadius(0);
-  EXPECT_FALSE(blender_->blend(blend_req, blend_res));
+  EXPECT_TRUE(blender_->blend(blend_req, blend_res));
+
+  EXPECT_TRUE(testutils::checkBlendResult(blend_req,
+                                          blend_res,
+                                          planner_limits_,
+                                          joint_velocity_tolerance_,
+                                          joint_acceleration_tolerance_,
+                                          cartesian_velocity_tolerance_,
+                                          cartesian_angular_velocity_tolerance_));
 }
 
 /**
@@ -18,19 +18,26 @@
 #include <gtest/gtest.h>
 
 #include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <set>
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_model/joint_model_group.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/conversions.h>
 #include <moveit_msgs/RobotTrajectory.h>
 #include <moveit_msgs/RobotState.h>
 #include <Eigen/Geometry>
 #include <eigen_conversions/eigen_msg.h>
+#include <geometric_shapes/shapes.h>
 
+#include <kdl/path_line.hpp>
 #include <kdl/path_roundedcomposite.hpp>
 #include <kdl/rotational_interpolation_sa.hpp>
 #include <kdl/frames.hpp>
@@ -840,6 +847,551 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testDetermineAndCheckSamplingTim
   EXPECT_EQ(expected_sampling_time, sampling_time);
 }
 
+/**
+ * @brief Check that the TipFramePoseCache contains the pose of the link for
+ * each waypoint of the trajectory.
+ *
+ *
+ * Test Sequence:
+ *    1. Create trajectory with different waypoints and create the cache.
+ *    2. Create cache of the tail of the trajectory.
+ *
+ * Expected Results:
+ *    1. Cache has one pose per waypoint equal to the pose of the link.
+ *    2. Cache contains the poses of the tail only.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testTipFramePoseCache)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory =
+      std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, planning_group_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToDefaultValues();
+  for(std::size_t i = 0; i < 3; ++i)
+  {
+    rstate.setVariablePosition(joint_names_.front(), 0.1*i);
+    rstate.update();
+    trajectory->addSuffixWayPoint(rstate, 0.1);
+  }
+
+  pilz::TipFramePoseCache cache(*trajectory, tcp_link_);
+  ASSERT_EQ(trajectory->getWayPointCount(), cache.size());
+  EXPECT_EQ(tcp_link_, cache.getFrameName());
+  for(std::size_t i = 0; i < cache.size(); ++i)
+  {
+    EXPECT_TRUE(tfNear(trajectory->getWayPointPtr(i)->getFrameTransform(tcp_link_), cache.getPose(i), EPSILON));
+  }
+
+  pilz::TipFramePoseCache tail_cache(cache, 1);
+  ASSERT_EQ(2u, tail_cache.size());
+  EXPECT_TRUE(tfNear(cache.getPose(1), tail_cache.getPose(0), EPSILON));
+  EXPECT_TRUE(tfNear(cache.getLastPose(), tail_cache.getLastPose(), EPSILON));
+}
+
+/**
+ * @brief Check that a robot trajectory survives the conversion into a
+ * CompactTrajectory and back.
+ *
+ *
+ * Test Sequence:
+ *    1. Create robot trajectory and append it to a CompactTrajectory.
+ *    2. Append the tail of the compact trajectory to itself.
+ *    3. Convert the compact trajectory into a robot trajectory.
+ *
+ * Expected Results:
+ *    1. Compact trajectory has the same waypoints and times as the robot trajectory.
+ *    2. Appended waypoints are shifted in time.
+ *    3. Waypoints of the robot trajectory are equal to the ones of the compact trajectory.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testCompactTrajectoryConversion)
+{
+  robot_trajectory::RobotTrajectory trajectory(robot_model_, planning_group_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToDefaultValues();
+  for(std::size_t i = 0; i < 3; ++i)
+  {
+    rstate.setVariablePosition(joint_names_.front(), 0.1*i);
+    rstate.setVariableVelocity(joint_names_.front(), 0.2*i);
+    rstate.setVariableAcceleration(joint_names_.front(), 0.3*i);
+    trajectory.addSuffixWayPoint(rstate, 0.1);
+  }
+
+  pilz::CompactTrajectory compact_trajectory(pilz::CompactTrajectory::getVariableNames(trajectory));
+  compact_trajectory.appendRobotTrajectory(trajectory);
+  ASSERT_EQ(trajectory.getWayPointCount(), compact_trajectory.getWayPointCount());
+  for(std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    EXPECT_NEAR(trajectory.getWayPointDurationFromPrevious(i), compact_trajectory.getDurationFromPrevious(i), EPSILON);
+  }
+
+  compact_trajectory.append(pilz::CompactTrajectory(compact_trajectory), 0.0, 1);
+  ASSERT_EQ(5u, compact_trajectory.getWayPointCount());
+  EXPECT_NEAR(0.5, compact_trajectory.getDuration(), EPSILON);
+  EXPECT_NEAR(compact_trajectory.getPositions(1)[0], compact_trajectory.getPositions(3)[0], EPSILON);
+
+  robot_trajectory::RobotTrajectory converted_trajectory(robot_model_, planning_group_);
+  compact_trajectory.toRobotTrajectory(trajectory.getFirstWayPoint(), converted_trajectory);
+  ASSERT_EQ(compact_trajectory.getWayPointCount(), converted_trajectory.getWayPointCount());
+  for(std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    EXPECT_TRUE(pilz::isRobotStateEqual(trajectory.getWayPoint(i), converted_trajectory.getWayPoint(i),
+                                        planning_group_, EPSILON));
+    EXPECT_NEAR(trajectory.getWayPointDurationFromPrevious(i),
+                converted_trajectory.getWayPointDurationFromPrevious(i), EPSILON);
+  }
+}
+
+/**
+ * @brief Check that the link transforms of a trajectory converted from a CompactTrajectory
+ * are up to date, although the reference state has other positions.
+ *
+ *
+ * Test Sequence:
+ *    1. Convert a compact trajectory moving the first joint into a robot trajectory and cache the tip poses.
+ *
+ * Expected Results:
+ *    1. The cached poses are equal to the forward kinematics of the waypoints.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testCompactTrajectoryConversionPoses)
+{
+  pilz::CompactTrajectory compact_trajectory(joint_names_);
+  for(std::size_t i = 0; i < 3; ++i)
+  {
+    const std::size_t index {compact_trajectory.addWayPoint(0.1 * static_cast<double>(i))};
+    std::fill(compact_trajectory.getPositions(index),
+              compact_trajectory.getPositions(index) + compact_trajectory.getJointCount(), 0.);
+    compact_trajectory.getPositions(index)[0] = 0.5 * static_cast<double>(i);
+  }
+
+  robot_state::RobotState reference_state(robot_model_);
+  reference_state.setToDefaultValues();
+  reference_state.update();
+  robot_trajectory::RobotTrajectory converted_trajectory(robot_model_, planning_group_);
+  compact_trajectory.toRobotTrajectory(reference_state, converted_trajectory);
+
+  const pilz::TipFramePoseCache cache(converted_trajectory, tcp_link_);
+  ASSERT_EQ(compact_trajectory.getWayPointCount(), cache.size());
+  for(std::size_t i = 0; i < cache.size(); ++i)
+  {
+    std::map<std::string, double> positions;
+    for(std::size_t j = 0; j < joint_names_.size(); ++j)
+    {
+      positions[joint_names_[j]] = compact_trajectory.getPositions(i)[j];
+    }
+    Eigen::Isometry3d expected_pose;
+    ASSERT_TRUE(pilz::computeLinkFK(robot_model_, tcp_link_, positions, expected_pose));
+    EXPECT_TRUE(tfNear(expected_pose, cache.getPose(i), EPSILON)) << "waypoint " << i;
+  }
+}
+
+/**
+ * @brief Checks the resampling of a compact trajectory.
+ *
+ * Test Sequence:
+ *    1. Resample a trajectory with linear joint motion sampled every 0.1s with a sampling time of 0.03s.
+ *
+ * Expected Results:
+ *    1. The resampled trajectory has the same duration, all but the last waypoint are 0.03s apart,
+ *       the positions are on the line, the velocities are constant and the accelerations zero.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testResampleJointTrajectory)
+{
+  const double velocity {2.};
+  pilz::CompactTrajectory trajectory(joint_names_);
+  for(std::size_t i = 0; i <= 10; ++i)
+  {
+    const double time {0.1 * static_cast<double>(i)};
+    const std::size_t index {trajectory.addWayPoint(time)};
+    for(std::size_t j = 0; j < trajectory.getJointCount(); ++j)
+    {
+      trajectory.getPositions(index)[j] = velocity * time;
+      trajectory.getVelocities(index)[j] = velocity;
+    }
+  }
+
+  const double sampling_time {0.03};
+  pilz::CompactTrajectory resampled_trajectory;
+  pilz::resampleJointTrajectory(trajectory, sampling_time, resampled_trajectory);
+
+  ASSERT_EQ(35u, resampled_trajectory.getWayPointCount());
+  EXPECT_EQ(trajectory.getJointNames(), resampled_trajectory.getJointNames());
+  EXPECT_NEAR(trajectory.getDuration(), resampled_trajectory.getDuration(), EPSILON);
+  for(std::size_t i = 0; i < resampled_trajectory.getWayPointCount(); ++i)
+  {
+    if(i > 0 && i + 1 < resampled_trajectory.getWayPointCount())
+    {
+      EXPECT_NEAR(sampling_time, resampled_trajectory.getDurationFromPrevious(i), EPSILON);
+    }
+    const double time {resampled_trajectory.getTimeFromStart(i)};
+    for(std::size_t j = 0; j < resampled_trajectory.getJointCount(); ++j)
+    {
+      EXPECT_NEAR(velocity * time, resampled_trajectory.getPositions(i)[j], EPSILON);
+      EXPECT_NEAR(velocity, resampled_trajectory.getVelocities(i)[j], EPSILON);
+      EXPECT_NEAR(0., resampled_trajectory.getAccelerations(i)[j], EPSILON);
+    }
+  }
+}
+
+/**
+ * @brief Checks that the resampling of the joint trajectory of a linear Cartesian motion keeps
+ * the joint velocities consistent with the Cartesian motion.
+ *
+ * Test Sequence:
+ *    1. Generate the joint trajectory of a linear Cartesian motion with a fine sampling time.
+ *    2. Resample the joint trajectory with a sampling time which is no multiple of the fine one.
+ *
+ * Expected Results:
+ *    1. -
+ *    2. The joint velocities of each sample are J⁺v, with the Jacobian J at the joint positions of
+ *       the sample and the Cartesian velocity v of the motion at the time of the sample.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testResampleJointTrajectoryOfLin)
+{
+  std::map<std::string, double> start_state {zero_state_};
+  start_state.at(joint_names_.at(1)) = -0.5;
+  start_state.at(joint_names_.at(2)) = 1.;
+  start_state.at(joint_names_.at(4)) = 0.5;
+  Eigen::Isometry3d start_pose;
+  ASSERT_TRUE(pilz::computeLinkFK(robot_model_, tcp_link_, start_state, start_pose));
+  KDL::Frame start_frame, goal_frame;
+  tf::transformEigenToKDL(start_pose, start_frame);
+  goal_frame = start_frame;
+  goal_frame.p += KDL::Vector(0.1, 0.05, -0.05);
+  goal_frame.M.DoRotZ(0.2);
+
+  // Note: 'path' and 'vel_prof' are deleted by KDL::Trajectory_Segment
+  KDL::Path* path = new KDL::Path_Line(start_frame, goal_frame, new KDL::RotationalInterpolation_SingleAxis(), 1.);
+  KDL::VelocityProfile* vel_prof = new KDL::VelocityProfile_Trap(0.2, 0.4);
+  vel_prof->SetProfile(0, path->PathLength());
+  KDL::Trajectory_Segment kdl_trajectory(path, vel_prof);
+
+  // 1
+  pilz::CompactTrajectory joint_trajectory;
+  moveit_msgs::MoveItErrorCodes error_code;
+  ASSERT_TRUE(pilz::generateJointTrajectory(robot_model_, pilz::JointLimitsContainer(), kdl_trajectory,
+                                            planning_group_, tcp_link_, start_state, 0.002,
+                                            joint_trajectory, error_code));
+
+  // 2
+  pilz::CompactTrajectory resampled_trajectory;
+  pilz::resampleJointTrajectory(joint_trajectory, 0.007, resampled_trajectory);
+  ASSERT_GT(resampled_trajectory.getWayPointCount(), 50u);
+
+  const moveit::core::JointModelGroup* group {robot_model_->getJointModelGroup(planning_group_)};
+  const std::vector<std::string>& group_joint_names {group->getActiveJointModelNames()};
+  robot_state::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  Eigen::MatrixXd jacobian;
+  for(std::size_t i = 0; i < resampled_trajectory.getWayPointCount(); ++i)
+  {
+    for(std::size_t j = 0; j < resampled_trajectory.getJointCount(); ++j)
+    {
+      state.setVariablePosition(resampled_trajectory.getJointNames().at(j), resampled_trajectory.getPositions(i)[j]);
+    }
+    state.update();
+    state.getJacobian(group, robot_model_->getLinkModel(tcp_link_), Eigen::Vector3d::Zero(), jacobian);
+
+    // the Jacobian is expressed in the frame of the parent link of the first joint of the group
+    const KDL::Twist twist {kdl_trajectory.Vel(resampled_trajectory.getTimeFromStart(i))};
+    const Eigen::Matrix3d rotation {state.getGlobalLinkTransform(
+                                      group->getJointModels().front()->getParentLinkModel()).linear().transpose()};
+    Eigen::VectorXd cartesian_velocity(6);
+    cartesian_velocity << rotation * Eigen::Vector3d(twist.vel.x(), twist.vel.y(), twist.vel.z()),
+                          rotation * Eigen::Vector3d(twist.rot.x(), twist.rot.y(), twist.rot.z());
+    const Eigen::VectorXd expected_velocities {
+      jacobian.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(cartesian_velocity)};
+
+    for(std::size_t j = 0; j < resampled_trajectory.getJointCount(); ++j)
+    {
+      const auto column {std::find(group_joint_names.begin(), group_joint_names.end(),
+                                   resampled_trajectory.getJointNames().at(j)) - group_joint_names.begin()};
+      EXPECT_NEAR(expected_velocities(column), resampled_trajectory.getVelocities(i)[j], 1e-3)
+          << "sample " << i << ", joint " << j;
+    }
+  }
+}
+
+/**
+ * @brief Checks that enforceFrameSpeedLimit() slows down a trajectory exceeding the speed limit of a frame.
+ *
+ * Test Sequence:
+ *    1. Enforce a speed limit of the tcp above the speed of a trajectory turning the second joint.
+ *    2. Enforce a speed limit of half the speed without scaling.
+ *    3. Enforce the speed limit with scaling, without resampling.
+ *    4. Enforce the speed limit with scaling and resampling.
+ *    5. Enforce a speed limit of an unknown frame.
+ *
+ * Expected Results:
+ *    1. The trajectory is not changed.
+ *    2. FrameSpeedLimitViolated is thrown.
+ *    3. The trajectory is slowed down to twice the duration, the waypoints are kept.
+ *    4. The trajectory is slowed down and resampled, the speed limit is satisfied.
+ *    5. UnknownSpeedLimitFrame is thrown.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testEnforceFrameSpeedLimit)
+{
+  robot_state::RobotState reference_state(robot_model_);
+  reference_state.setToDefaultValues();
+  pilz::CompactTrajectory trajectory(joint_names_);
+  for(std::size_t i = 0; i <= 10; ++i)
+  {
+    const double time {0.1 * static_cast<double>(i)};
+    const std::size_t index {trajectory.addWayPoint(time)};
+    trajectory.getPositions(index)[1] = 0.5 * time;
+    trajectory.getVelocities(index)[1] = 0.5;
+  }
+  const std::vector<const moveit::core::LinkModel*> links {robot_model_->getLinkModel(tcp_link_)};
+  const double speed {pilz::computeMaxFrameSpeed(reference_state, trajectory, links).speed};
+  ASSERT_GT(speed, 0.);
+
+  // 1. below the limit
+  pilz::CartesianLimit cartesian_limit;
+  cartesian_limit.setSpeedLimitFrames({tcp_link_});
+  cartesian_limit.setMaxFrameSpeed(2. * speed);
+  pilz::CompactTrajectory limited_trajectory {trajectory};
+  EXPECT_FALSE(pilz::enforceFrameSpeedLimit(reference_state, cartesian_limit, 0., limited_trajectory));
+  EXPECT_EQ(trajectory.getDuration(), limited_trajectory.getDuration());
+
+  // 2. without scaling
+  cartesian_limit.setMaxFrameSpeed(0.5 * speed);
+  EXPECT_THROW(pilz::enforceFrameSpeedLimit(reference_state, cartesian_limit, 0., limited_trajectory),
+               pilz::FrameSpeedLimitViolated);
+
+  // 3. scaled
+  cartesian_limit.setScaleToMaxFrameSpeed(true);
+  EXPECT_TRUE(pilz::enforceFrameSpeedLimit(reference_state, cartesian_limit, 0., limited_trajectory));
+  EXPECT_EQ(trajectory.getWayPointCount(), limited_trajectory.getWayPointCount());
+  EXPECT_NEAR(2. * trajectory.getDuration(), limited_trajectory.getDuration(), EPSILON);
+  EXPECT_LE(pilz::computeMaxFrameSpeed(reference_state, limited_trajectory, links).speed,
+            0.5 * speed * (1. + 1e-6));
+
+  // 4. scaled and resampled
+  const double sampling_time {0.03};
+  limited_trajectory = trajectory;
+  EXPECT_TRUE(pilz::enforceFrameSpeedLimit(reference_state, cartesian_limit, sampling_time, limited_trajectory));
+  ASSERT_GT(limited_trajectory.getWayPointCount(), 2u);
+  EXPECT_NEAR(sampling_time, limited_trajectory.getDurationFromPrevious(1), EPSILON);
+  EXPECT_LE(pilz::computeMaxFrameSpeed(reference_state, limited_trajectory, links).speed,
+            0.5 * speed * (1. + 1e-6));
+
+  // 5. unknown frame
+  cartesian_limit.setSpeedLimitFrames({"unknown_frame"});
+  EXPECT_THROW(pilz::enforceFrameSpeedLimit(reference_state, cartesian_limit, 0., limited_trajectory),
+               pilz::UnknownSpeedLimitFrame);
+}
+
+/**
+ * @brief Check that function verifyTrajectoryLimits() reports the first violation of a trajectory.
+ *
+ * Test Sequence:
+ *    1. Verify a trajectory of the group within the velocity limit of its first joint.
+ *    2. Increase the velocity of the first joint at the third waypoint above the limit.
+ *
+ * Expected Results:
+ *    1. Function returns 'true'.
+ *    2. Function returns 'false', the velocity violation of the first joint at the third waypoint is reported.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testVerifyTrajectoryLimits)
+{
+  pilz::JointLimitsContainer joint_limits;
+  pilz_extensions::JointLimit test_joint_limits;
+  test_joint_limits.has_velocity_limits = true;
+  test_joint_limits.max_velocity = 1.;
+  joint_limits.addLimit(joint_names_.front(), test_joint_limits);
+  const pilz::JointLimitsTable limits_table {joint_limits.getTable(joint_names_)};
+
+  pilz::CompactTrajectory trajectory(joint_names_);
+  for(std::size_t i = 0; i < 5; ++i)
+  {
+    const std::size_t index {trajectory.addWayPoint(0.1 * static_cast<double>(i))};
+    trajectory.getVelocities(index)[0] = 1.;
+  }
+  EXPECT_TRUE(pilz::verifyTrajectoryLimits(trajectory, limits_table));
+
+  trajectory.getVelocities(2)[0] = -1.1;
+  pilz::TrajectoryLimitViolation violation;
+  EXPECT_FALSE(pilz::verifyTrajectoryLimits(trajectory, limits_table, &violation));
+  EXPECT_EQ(2u, violation.waypoint);
+  EXPECT_EQ(0u, violation.joint);
+  EXPECT_EQ(pilz::TrajectoryLimitViolation::Type::Velocity, violation.type);
+  EXPECT_NEAR(-1.1, violation.value, EPSILON);
+  EXPECT_NEAR(1., violation.limit, EPSILON);
+}
+
+/**
+ * @brief Checks that applySpeedOverride() stretches a trajectory uniformly in time
+ * and verifies the result against the joint limits.
+ *
+ * Test Sequence:
+ *    1. Apply a speed override of 0.5 to a trajectory whose first joint moves with velocity 1.
+ *    2. Apply a speed override of 0.8 with a velocity limit of 0.6 of the first joint.
+ *
+ * Expected Results:
+ *    1. Function returns 'true'. The positions are kept, the durations are doubled,
+ *       the velocities halved and the accelerations quartered.
+ *    2. Function returns 'false'.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testApplySpeedOverride)
+{
+  pilz::JointLimitsContainer joint_limits;
+  pilz_extensions::JointLimit test_joint_limits;
+  test_joint_limits.has_velocity_limits = true;
+  test_joint_limits.max_velocity = 0.6;
+  joint_limits.addLimit(joint_names_.front(), test_joint_limits);
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model_, planning_group_);
+  const std::vector<std::string>& variable_names {pilz::CompactTrajectory::getVariableNames(trajectory)};
+  ASSERT_EQ(joint_names_.front(), variable_names.front());
+  const pilz::JointLimitsTable limits_table {joint_limits.getTable(variable_names)};
+
+  robot_state::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  for(std::size_t i = 0; i < 5; ++i)
+  {
+    state.setVariablePosition(joint_names_.front(), 0.1 * static_cast<double>(i));
+    state.setVariableVelocity(joint_names_.front(), 1.);
+    state.setVariableAcceleration(joint_names_.front(), 0.4);
+    trajectory.addSuffixWayPoint(state, 0.1);
+  }
+
+  robot_trajectory::RobotTrajectory scaled_trajectory(robot_model_, planning_group_);
+  EXPECT_TRUE(pilz::applySpeedOverride(trajectory, 0.5, limits_table, scaled_trajectory));
+  ASSERT_EQ(trajectory.getWayPointCount(), scaled_trajectory.getWayPointCount());
+  for(std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    const robot_state::RobotState& scaled_state {scaled_trajectory.getWayPoint(i)};
+    EXPECT_NEAR(0.2, scaled_trajectory.getWayPointDurationFromPrevious(i), EPSILON);
+    EXPECT_NEAR(0.1 * static_cast<double>(i), scaled_state.getVariablePosition(joint_names_.front()), EPSILON);
+    EXPECT_NEAR(0.5, scaled_state.getVariableVelocity(joint_names_.front()), EPSILON);
+    EXPECT_NEAR(0.1, scaled_state.getVariableAcceleration(joint_names_.front()), EPSILON);
+  }
+
+  EXPECT_FALSE(pilz::applySpeedOverride(trajectory, 0.8, limits_table, scaled_trajectory));
+}
+
+/**
+ * @brief Check that generateJointTrajectory() computes the joint velocities and accelerations
+ * of a Cartesian trajectory consistently with the joint positions.
+ *
+ * Test Sequence:
+ *    1. Generate the joint trajectory of a linear Cartesian motion with a fine sampling time.
+ *
+ * Expected Results:
+ *    1. The joint velocities are the derivatives of the positions and the joint accelerations
+ *       the derivatives of the velocities (apart from the switching times of the velocity profile),
+ *       compared to central differences of the waypoints. The first and last waypoint are at rest.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGenerateJointTrajectoryDerivatives)
+{
+  std::map<std::string, double> start_state {zero_state_};
+  start_state.at(joint_names_.at(1)) = -0.5;
+  start_state.at(joint_names_.at(2)) = 1.;
+  start_state.at(joint_names_.at(4)) = 0.5;
+  Eigen::Isometry3d start_pose;
+  ASSERT_TRUE(pilz::computeLinkFK(robot_model_, tcp_link_, start_state, start_pose));
+  KDL::Frame start_frame, goal_frame;
+  tf::transformEigenToKDL(start_pose, start_frame);
+  goal_frame = start_frame;
+  goal_frame.p += KDL::Vector(0.1, 0.05, -0.05);
+  goal_frame.M.DoRotZ(0.2);
+
+  // Note: 'path' and 'vel_prof' are deleted by KDL::Trajectory_Segment
+  KDL::Path* path = new KDL::Path_Line(start_frame, goal_frame, new KDL::RotationalInterpolation_SingleAxis(), 1.);
+  KDL::VelocityProfile* vel_prof = new KDL::VelocityProfile_Trap(0.2, 0.4);
+  vel_prof->SetProfile(0, path->PathLength());
+  KDL::Trajectory_Segment kdl_trajectory(path, vel_prof);
+
+  const double sampling_time {0.001};
+  pilz::CompactTrajectory joint_trajectory;
+  moveit_msgs::MoveItErrorCodes error_code;
+  ASSERT_TRUE(pilz::generateJointTrajectory(robot_model_, pilz::JointLimitsContainer(), kdl_trajectory,
+                                            planning_group_, tcp_link_, start_state, sampling_time,
+                                            joint_trajectory, error_code));
+  ASSERT_GT(joint_trajectory.getWayPointCount(), 100u);
+
+  const std::size_t last {joint_trajectory.getWayPointCount() - 1};
+  for(std::size_t j = 0; j < joint_trajectory.getJointCount(); ++j)
+  {
+    EXPECT_EQ(0., joint_trajectory.getVelocities(0)[j]);
+    EXPECT_EQ(0., joint_trajectory.getAccelerations(0)[j]);
+    EXPECT_EQ(0., joint_trajectory.getVelocities(last)[j]);
+    EXPECT_EQ(0., joint_trajectory.getAccelerations(last)[j]);
+  }
+
+  // the inner points without the neighbors of the first and the last point (the last interval is shorter)
+  for(std::size_t i = 2; i + 2 < last; ++i)
+  {
+    for(std::size_t j = 0; j < joint_trajectory.getJointCount(); ++j)
+    {
+      const double velocity {(joint_trajectory.getPositions(i + 1)[j] - joint_trajectory.getPositions(i - 1)[j])
+                             / (2. * sampling_time)};
+      EXPECT_NEAR(velocity, joint_trajectory.getVelocities(i)[j], 1e-3) << "waypoint " << i << ", joint " << j;
+
+      const double acceleration_before {joint_trajectory.getAccelerations(i - 1)[j]};
+      const double acceleration_after {joint_trajectory.getAccelerations(i + 1)[j]};
+      if(std::fabs(acceleration_after - acceleration_before) < 0.01)
+      {
+        const double acceleration {(joint_trajectory.getVelocities(i + 1)[j] - joint_trajectory.getVelocities(i - 1)[j])
+                                   / (2. * sampling_time)};
+        EXPECT_NEAR(acceleration, joint_trajectory.getAccelerations(i)[j], 1e-2) << "waypoint " << i << ", joint " << j;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Check that scanCartesianPath() detects unreachable and singular paths.
+ *
+ * Test Sequence:
+ *    1. Scan a short linear path from a regular configuration.
+ *    2. Scan a linear path ending far outside of the workspace.
+ *    3. Scan a short linear path starting at the wrist singularity, with a minimal manipulability.
+ *
+ * Expected Results:
+ *    1. Function returns 'true' with a positive manipulability.
+ *    2. Function returns 'false' with status Unreachable at a fraction of the path in (0, 1].
+ *    3. Function returns 'false' with status Singular at the start of the path.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testScanCartesianPath)
+{
+  auto createPath = [this](const std::map<std::string, double>& start_state, const KDL::Vector& translation)
+  {
+    Eigen::Isometry3d start_pose;
+    EXPECT_TRUE(pilz::computeLinkFK(robot_model_, tcp_link_, start_state, start_pose));
+    KDL::Frame start_frame;
+    tf::transformEigenToKDL(start_pose, start_frame);
+    KDL::Frame goal_frame {start_frame};
+    goal_frame.p += translation;
+    return std::unique_ptr<KDL::Path>(new KDL::Path_Line(start_frame, goal_frame,
+                                                         new KDL::RotationalInterpolation_SingleAxis(), 1.));
+  };
+
+  std::map<std::string, double> start_state {zero_state_};
+  start_state.at(joint_names_.at(1)) = -0.5;
+  start_state.at(joint_names_.at(2)) = 1.;
+  start_state.at(joint_names_.at(4)) = 0.5;
+
+  pilz::PathScanResult result;
+  std::unique_ptr<KDL::Path> path {createPath(start_state, KDL::Vector(0.1, 0.05, -0.05))};
+  EXPECT_TRUE(pilz::scanCartesianPath(robot_model_, planning_group_, tcp_link_, *path, start_state, 10, 0., result));
+  EXPECT_EQ(pilz::PathScanResult::Status::Feasible, result.status);
+  EXPECT_GT(result.min_manipulability, 0.);
+
+  path = createPath(start_state, KDL::Vector(2., 0., 0.));
+  EXPECT_FALSE(pilz::scanCartesianPath(robot_model_, planning_group_, tcp_link_, *path, start_state, 10, 0., result));
+  EXPECT_EQ(pilz::PathScanResult::Status::Unreachable, result.status);
+  EXPECT_GT(result.path_fraction, 0.);
+  EXPECT_LE(result.path_fraction, 1.);
+
+  start_state.at(joint_names_.at(4)) = 0.;
+  path = createPath(start_state, KDL::Vector(0.1, 0., 0.));
+  EXPECT_FALSE(pilz::scanCartesianPath(robot_model_, planning_group_, tcp_link_, *path, start_state, 10, 1e-4,
+                                       result));
+  EXPECT_EQ(pilz::PathScanResult::Status::Singular, result.status);
+  EXPECT_EQ(0., result.path_fraction);
+}
+
 /**
  * @brief Check that function isRobotStateEqual() returns 'false' if
  * the positions of the robot states are not equal.
@@ -983,6 +1535,80 @@ TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testIsRobotStateStationaryAccele
   EXPECT_FALSE( pilz::isRobotStateStationary(rstate_1, planning_group_, epsilon) );
 }
 
+/**
+ * @brief Checks that getAttachedPayload() sums the weights of the objects attached in the start state
+ * and reports an unknown payload, if the weight of an attached object is unknown.
+ *
+ * Test Sequence:
+ *    1. Full start state without attached objects, a tool is attached in the current state.
+ *    2. Full start state with two weighted objects and a removed object without weight.
+ *    3. Full start state with an object of weight zero.
+ *    4. Diff start state without attached objects, the tool is attached in the current state.
+ *    5. Diff start state with the weighted tool.
+ *    6. Diff start state removing the tool.
+ *    7. Diff start state without attached objects, without current state.
+ *
+ * Expected Results:
+ *    1. The payload is zero, the full start state replaces the attached bodies of the current state.
+ *    2. The payload is the sum of the weights, the removed object is ignored.
+ *    3. The payload is unknown (NaN).
+ *    4. The payload is unknown (NaN), the weight of the tool is not given.
+ *    5. The payload is the weight of the tool.
+ *    6. The payload is zero.
+ *    7. The payload is zero.
+ */
+TEST_P(TrajectoryFunctionsTestFlangeAndGripper, testGetAttachedPayload)
+{
+  const std::string tool {"tool"};
+  robot_state::RobotState current_state(robot_model_);
+  current_state.setToDefaultValues();
+  current_state.attachBody(tool, {std::make_shared<shapes::Box>(0.1, 0.1, 0.1)}, {Eigen::Isometry3d::Identity()},
+                           std::set<std::string>(), tcp_link_);
+
+  auto attachedObject = [this](const std::string& id, double weight, int8_t operation)
+  {
+    moveit_msgs::AttachedCollisionObject attached_object;
+    attached_object.link_name = tcp_link_;
+    attached_object.object.id = id;
+    attached_object.object.operation = operation;
+    attached_object.weight = weight;
+    return attached_object;
+  };
+
+  // 1. full start state
+  moveit_msgs::RobotState full_state;
+  moveit::core::robotStateToRobotStateMsg(current_state, full_state, false);
+  ASSERT_FALSE(full_state.joint_state.name.empty());
+  EXPECT_EQ(0., pilz::getAttachedPayload(full_state, &current_state));
+
+  // 2. weighted objects
+  full_state.attached_collision_objects.push_back(attachedObject(tool, 1.5, moveit_msgs::CollisionObject::ADD));
+  full_state.attached_collision_objects.push_back(attachedObject("part", 0.5, moveit_msgs::CollisionObject::ADD));
+  full_state.attached_collision_objects.push_back(attachedObject("old_part", 0., moveit_msgs::CollisionObject::REMOVE));
+  EXPECT_DOUBLE_EQ(2., pilz::getAttachedPayload(full_state, &current_state));
+
+  // 3. weight zero
+  full_state.attached_collision_objects.push_back(attachedObject("unknown", 0., moveit_msgs::CollisionObject::ADD));
+  EXPECT_TRUE(std::isnan(pilz::getAttachedPayload(full_state, &current_state)));
+
+  // 4. diff start state without the tool
+  moveit_msgs::RobotState diff_state;
+  diff_state.is_diff = true;
+  EXPECT_TRUE(std::isnan(pilz::getAttachedPayload(diff_state, &current_state)));
+
+  // 5. diff start state with the tool
+  diff_state.attached_collision_objects.push_back(attachedObject(tool, 2., moveit_msgs::CollisionObject::ADD));
+  EXPECT_DOUBLE_EQ(2., pilz::getAttachedPayload(diff_state, &current_state));
+
+  // 6. diff start state removing the tool
+  diff_state.attached_collision_objects.front().object.operation = moveit_msgs::CollisionObject::REMOVE;
+  EXPECT_EQ(0., pilz::getAttachedPayload(diff_state, &current_state));
+
+  // 7. without current state
+  diff_state.attached_collision_objects.clear();
+  EXPECT_EQ(0., pilz::getAttachedPayload(diff_state, nullptr));
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_trajectory_functions");
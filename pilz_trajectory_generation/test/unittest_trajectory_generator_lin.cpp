@@ -188,6 +188,16 @@ TEST(TrajectoryGeneratorLINTest, TestExceptionErrorCodeMapping)
     std::shared_ptr<LinInverseForGoalIncalculable> lifgi_ex {new LinInverseForGoalIncalculable("")};
     EXPECT_EQ(lifgi_ex->getErrorCode(), moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION);
   }
+
+  {
+    std::shared_ptr<PathUnreachable> pu_ex {new PathUnreachable("")};
+    EXPECT_EQ(pu_ex->getErrorCode(), moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION);
+  }
+
+  {
+    std::shared_ptr<PathNearSingularity> pns_ex {new PathNearSingularity("")};
+    EXPECT_EQ(pns_ex->getErrorCode(), moveit_msgs::MoveItErrorCodes::PLANNING_FAILED);
+  }
 }
 
 // Instantiate the test cases for robot model with and without gripper
@@ -314,6 +324,127 @@ TEST_P(TrajectoryGeneratorLINTest, LinPlannerLimitViolation)
   ASSERT_FALSE(lin_->generate(lin.toRequest(), res));
 }
 
+/**
+ * @brief Checks that a LIN trajectory can be returned with an output sampling time
+ * smaller than the sampling time of the planning.
+ *
+ * Test Sequence:
+ *    1. Generate lin trajectory with the default sampling time.
+ *    2. Generate the same trajectory with an output sampling time of 0.004s.
+ *
+ * Expected Results:
+ *    1. Function returns 'true'.
+ *    2. Function returns 'true', the goal is reached, all but the last waypoint are 0.004s apart
+ *       and the trajectory has the same duration and waypoints (at the planned times) as in step 1.
+ */
+TEST_P(TrajectoryGeneratorLINTest, outputSamplingTime)
+{
+  planning_interface::MotionPlanRequest lin_joint_req {tdp_->getLinJoint("lin2").toRequest()};
+  const double sampling_time {0.1};
+  const double output_sampling_time {0.004};
+
+  planning_interface::MotionPlanResponse planned_res;
+  ASSERT_TRUE(lin_->generate(lin_joint_req, planned_res, sampling_time));
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(lin_->generate(lin_joint_req, res, sampling_time, output_sampling_time));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
+
+  const robot_trajectory::RobotTrajectory& planned_traj {*planned_res.trajectory_};
+  const robot_trajectory::RobotTrajectory& traj {*res.trajectory_};
+  ASSERT_GT(traj.getWayPointCount(), planned_traj.getWayPointCount());
+  for(std::size_t i = 1; i + 1 < traj.getWayPointCount(); ++i)
+  {
+    EXPECT_NEAR(output_sampling_time, traj.getWayPointDurationFromPrevious(i), other_tolerance_);
+  }
+  EXPECT_NEAR(planned_traj.getWaypointDurationFromStart(planned_traj.getWayPointCount() - 1),
+              traj.getWaypointDurationFromStart(traj.getWayPointCount() - 1), other_tolerance_);
+
+  // every 25th output sample is a planned sample
+  for(std::size_t i = 0; i + 1 < planned_traj.getWayPointCount(); ++i)
+  {
+    std::vector<double> planned_positions, positions;
+    planned_traj.getWayPoint(i).copyJointGroupPositions(planning_group_, planned_positions);
+    traj.getWayPoint(25 * i).copyJointGroupPositions(planning_group_, positions);
+    ASSERT_EQ(planned_positions.size(), positions.size());
+    for(std::size_t j = 0; j < positions.size(); ++j)
+    {
+      EXPECT_NEAR(planned_positions.at(j), positions.at(j), joint_position_tolerance_);
+    }
+  }
+}
+
+/**
+ * @brief Checks the path scan of the LIN generator.
+ *
+ * Test Sequence:
+ *    1. Generate lin trajectory with a path scan of 10 samples.
+ *    2. Generate the same trajectory with a minimal manipulability which no configuration reaches.
+ *    3. Generate the same trajectory with a manipulability for fine sampling which no configuration reaches.
+ *    4. Generate the same trajectory with a manipulability for fine sampling far above the path.
+ *
+ * Expected Results:
+ *    1. Function returns 'true'.
+ *    2. Function returns 'false' with error code PLANNING_FAILED.
+ *    3. Function returns 'true', the trajectory has more waypoints than in step 1.
+ *    4. Function returns 'true', the sampling time is reduced at most by a factor of 10.
+ */
+TEST_P(TrajectoryGeneratorLINTest, pathScan)
+{
+  planning_interface::MotionPlanRequest lin_joint_req {tdp_->getLinJoint("lin2").toRequest()};
+
+  LimitsContainer limits {planner_limits_};
+  CartesianLimit cartesian_limit {planner_limits_.getCartesianLimits()};
+  cartesian_limit.setPathScanSamples(10);
+  limits.setCartesianLimits(cartesian_limit);
+  planning_interface::MotionPlanResponse scanned_res;
+  ASSERT_TRUE(TrajectoryGeneratorLIN(robot_model_, limits).generate(lin_joint_req, scanned_res));
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, scanned_res));
+
+  cartesian_limit.setMinManipulability(1e3);
+  limits.setCartesianLimits(cartesian_limit);
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(TrajectoryGeneratorLIN(robot_model_, limits).generate(lin_joint_req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, res.error_code_.val);
+
+  cartesian_limit.setMinManipulability(0.);
+  cartesian_limit.setFineSamplingManipulability(1.);
+  limits.setCartesianLimits(cartesian_limit);
+  ASSERT_TRUE(TrajectoryGeneratorLIN(robot_model_, limits).generate(lin_joint_req, res));
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
+  EXPECT_GT(res.trajectory_->getWayPointCount(), scanned_res.trajectory_->getWayPointCount());
+
+  cartesian_limit.setFineSamplingManipulability(1e6);
+  limits.setCartesianLimits(cartesian_limit);
+  ASSERT_TRUE(TrajectoryGeneratorLIN(robot_model_, limits).generate(lin_joint_req, res));
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
+  EXPECT_LE(res.trajectory_->getWayPointCount(), 10 * scanned_res.trajectory_->getWayPointCount());
+}
+
+/**
+ * @brief Checks that a LIN trajectory is not generated with invalid sampling times.
+ *
+ * Test Sequence:
+ *    1. Generate lin trajectory with output sampling time greater than the sampling time.
+ *    2. Generate lin trajectory with negative sampling time.
+ *
+ * Expected Results:
+ *    1. Function returns 'false' with error code INVALID_MOTION_PLAN.
+ *    2. Function returns 'false' with error code INVALID_MOTION_PLAN.
+ */
+TEST_P(TrajectoryGeneratorLINTest, invalidSamplingTime)
+{
+  planning_interface::MotionPlanRequest lin_joint_req {tdp_->getLinJoint("lin2").toRequest()};
+
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(lin_->generate(lin_joint_req, res, 0.01, 0.1));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
+
+  EXPECT_FALSE(lin_->generate(lin_joint_req, res, -0.1));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
+}
+
 /**
  * @brief test joint linear movement with discontinuities in joint space
  *
@@ -15,6 +15,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
 #include <memory>
 
 #include <gtest/gtest.h>
@@ -27,6 +28,8 @@
 #include <pluginlib/class_loader.h>
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/kinematic_constraints/utils.h>
+#include <moveit/robot_state/conversions.h>
+#include <eigen_conversions/eigen_msg.h>
 
 // parameters for parameterized tests
 const std::string PARAM_MODEL_NO_GRIPPER_NAME {"robot_description"};
@@ -947,6 +950,185 @@ TEST_P(TrajectoryGeneratorPTPTest, testJointGoalNoStartVel)
                           [this]( double v){ return std::fabs(v) < this->joint_acceleration_tolerance_; }));
 }
 
+/**
+ * @brief Checks the speed limit of frames for a PTP command.
+ *
+ *  - Test Sequence:
+ *    1. Generate a trajectory without speed limit of frames.
+ *    2. Generate the trajectory with a speed limit of the flange below its speed in 1., without scaling.
+ *    3. Generate the trajectory with the same speed limit and scaling.
+ *    4. Generate the trajectory with an unknown frame of the speed limit.
+ *
+ *  - Expected Results:
+ *    1. The flange exceeds the speed limit used in the following steps.
+ *    2. The planning fails with PLANNING_FAILED.
+ *    3. The trajectory is slower than 1., the flange does not exceed the speed limit.
+ *    4. The planning fails with FAILURE.
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testFrameSpeedLimit)
+{
+  const double max_frame_speed {0.1};
+  const std::string frame {"prbt_flange"};
+  ASSERT_TRUE(robot_model_->hasLinkModel(frame));
+  const std::vector<const moveit::core::LinkModel*> links {robot_model_->getLinkModel(frame)};
+
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = "prbt_joint_2";
+  jc.position = 1.0;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+
+  auto getMaxFrameSpeed = [&links](const robot_trajectory::RobotTrajectory& trajectory)
+  {
+    pilz::CompactTrajectory compact_trajectory {pilz::CompactTrajectory::getVariableNames(trajectory)};
+    compact_trajectory.appendRobotTrajectory(trajectory);
+    return computeMaxFrameSpeed(trajectory.getFirstWayPoint(), compact_trajectory, links).speed;
+  };
+
+  // 1. without speed limit
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(ptp_->generate(req, res));
+  const double duration {res.trajectory_->getWayPointDurationFromStart(res.trajectory_->getWayPointCount())};
+  ASSERT_GT(getMaxFrameSpeed(*res.trajectory_), 2 * max_frame_speed);
+
+  // 2. speed limit without scaling
+  pilz::CartesianLimit cartesian_limit;
+  cartesian_limit.setMaxFrameSpeed(max_frame_speed);
+  cartesian_limit.setSpeedLimitFrames({frame});
+  LimitsContainer planner_limits {planner_limits_};
+  planner_limits.setCartesianLimits(cartesian_limit);
+  std::unique_ptr<TrajectoryGenerator> ptp {new TrajectoryGeneratorPTP(robot_model_, planner_limits)};
+  EXPECT_FALSE(ptp->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, res.error_code_.val);
+
+  // 3. speed limit with scaling
+  cartesian_limit.setScaleToMaxFrameSpeed(true);
+  planner_limits.setCartesianLimits(cartesian_limit);
+  ptp.reset(new TrajectoryGeneratorPTP(robot_model_, planner_limits));
+  ASSERT_TRUE(ptp->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val);
+  EXPECT_GT(res.trajectory_->getWayPointDurationFromStart(res.trajectory_->getWayPointCount()), duration);
+  EXPECT_LE(getMaxFrameSpeed(*res.trajectory_), max_frame_speed * (1. + 1e-6));
+
+  moveit_msgs::MotionPlanResponse res_msg;
+  res.getMessage(res_msg);
+  EXPECT_TRUE(checkTrajectory(res_msg.trajectory.joint_trajectory, req, planner_limits_.getJointLimitContainer()));
+
+  // 4. unknown frame
+  cartesian_limit.setSpeedLimitFrames({"unknown_frame"});
+  planner_limits.setCartesianLimits(cartesian_limit);
+  ptp.reset(new TrajectoryGeneratorPTP(robot_model_, planner_limits));
+  EXPECT_FALSE(ptp->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::FAILURE, res.error_code_.val);
+}
+
+/**
+ * @brief Checks that the goal IK of a Cartesian goal chooses the fastest of several candidates,
+ * even if it is another branch than the one of the start state.
+ *
+ * The goal pose is reached by a configuration A and by its flipped wrist B (joint 4 and 6 turned by pi,
+ * joint 5 mirrored). A is closer to the start state, but B needs a smaller maximal joint motion, so
+ * the PTP to B is faster (all joints have the same limits).
+ *
+ *  - Test Sequence:
+ *    1. Plan to the goal pose with the goal IK seeded by the start state only.
+ *    2. Plan again with B as further seed.
+ *    3. Plan step 2 again.
+ *
+ *  - Expected Results:
+ *    1. The planning succeeds with goal A.
+ *    2. The planning succeeds with goal B, the trajectory is faster than in step 1.
+ *    3. The same goal as in step 2 is chosen.
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testCartesianGoalFromSeveralSeeds)
+{
+  const moveit::core::JointModelGroup* group {robot_model_->getJointModelGroup(planning_group_)};
+  const std::vector<std::string>& joint_names {group->getActiveJointModelNames()};
+  ASSERT_EQ(6u, joint_names.size());
+  const std::vector<double> start_positions {0., -0.5, 1., 0., 0.8, 0.};
+  const std::vector<double> goal_positions_a {0.2, -0.5, 1., 1.9, 0.8, 1.57};
+  const std::vector<double> goal_positions_b {0.2, -0.5, 1., 1.9 - M_PI, -0.8, 1.57 - M_PI};
+
+  robot_state::RobotState start_state(robot_model_);
+  start_state.setToDefaultValues();
+  start_state.setJointGroupPositions(group, start_positions);
+  robot_state::RobotState goal_state_a(start_state), goal_state_b(start_state);
+  goal_state_a.setJointGroupPositions(group, goal_positions_a);
+  goal_state_b.setJointGroupPositions(group, goal_positions_b);
+  goal_state_a.update();
+  goal_state_b.update();
+  const Eigen::Isometry3d& goal_pose {goal_state_a.getGlobalLinkTransform(target_link_)};
+  ASSERT_TRUE(goal_pose.isApprox(goal_state_b.getGlobalLinkTransform(target_link_), 1e-9))
+      << "The flipped wrist does not reach the same pose";
+
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  moveit::core::robotStateToRobotStateMsg(start_state, req.start_state, false);
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = robot_model_->getModelFrame();
+  tf::poseEigenToMsg(goal_pose, pose.pose);
+  std::vector<double> tolerance_pose(3, 0.01);
+  std::vector<double> tolerance_angle(3, 0.01);
+  req.goal_constraints.push_back(kinematic_constraints::constructGoalConstraints(target_link_,
+                                                                                pose,
+                                                                                tolerance_pose,
+                                                                                tolerance_angle));
+
+  auto goalPositions = [&joint_names](const planning_interface::MotionPlanResponse& res)
+  {
+    std::vector<double> positions;
+    const robot_state::RobotState& goal_state {res.trajectory_->getLastWayPoint()};
+    for(const auto& joint_name : joint_names)
+    {
+      positions.push_back(goal_state.getVariablePosition(joint_name));
+    }
+    return positions;
+  };
+  auto expectPositionsNear = [](const std::vector<double>& expected, const std::vector<double>& actual)
+  {
+    ASSERT_EQ(expected.size(), actual.size());
+    for(std::size_t i = 0; i < expected.size(); ++i)
+    {
+      EXPECT_NEAR(expected[i], actual[i], 1e-3) << "joint " << i;
+    }
+  };
+
+  // 1. seeded by the start state
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(ptp_->generate(req, res));
+  const double duration {res.trajectory_->getWayPointDurationFromStart(res.trajectory_->getWayPointCount())};
+  expectPositionsNear(goal_positions_a, goalPositions(res));
+
+  // 2. the flipped wrist as further candidate
+  GoalIkOptions options;
+  std::map<std::string, double> seed;
+  for(std::size_t i = 0; i < joint_names.size(); ++i)
+  {
+    seed[joint_names[i]] = goal_positions_b[i];
+  }
+  options.seeds.push_back(seed);
+  LimitsContainer planner_limits {planner_limits_};
+  planner_limits.setGoalIkOptions({{planning_group_, options}});
+  std::unique_ptr<TrajectoryGenerator> ptp {new TrajectoryGeneratorPTP(robot_model_, planner_limits)};
+
+  ASSERT_TRUE(ptp->generate(req, res));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val);
+  expectPositionsNear(goal_positions_b, goalPositions(res));
+  EXPECT_LT(res.trajectory_->getWayPointDurationFromStart(res.trajectory_->getWayPointCount()), duration - 0.1);
+
+  moveit_msgs::MotionPlanResponse res_msg;
+  res.getMessage(res_msg);
+  EXPECT_TRUE(testutils::isGoalReached(robot_model_, res_msg.trajectory.joint_trajectory, req, pose_norm_tolerance_));
+
+  // 3. the choice is deterministic
+  planning_interface::MotionPlanResponse repeated_res;
+  ASSERT_TRUE(ptp->generate(req, repeated_res));
+  EXPECT_EQ(goalPositions(res), goalPositions(repeated_res));
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_trajectory_generator_ptp");
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2019 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Replays the planning requests recorded by pilz::PlanningRequestRecorder
+ * and reports the planning time of each request as CSV on stdout.
+ *
+ * Usage: rosrun pilz_trajectory_generation replay_planning_requests <request_log.bag>
+ *
+ * Only a roscore is needed: the recorded robot description, kinematics and
+ * limits are set as parameters before the robot model and the planners are loaded.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include <pilz_msgs/PlanningParametersRecord.h>
+#include <pilz_msgs/PlanningRequestRecord.h>
+
+#include "pilz_trajectory_generation/command_list_manager.h"
+#include "pilz_trajectory_generation/planning_request_recorder.h"
+#include "pilz_trajectory_generation/trajectory_generation_exceptions.h"
+
+namespace
+{
+
+const std::string ROBOT_DESCRIPTION_STR {"robot_description"};
+const std::string PARAM_PLANNING_PLUGIN {"planning_plugin"};
+const std::string PARAM_REQUEST_ADAPTERS {"request_adapters"};
+const std::string PARAM_REPETITIONS {"repetitions"};
+const std::string DEFAULT_PLANNING_PLUGIN {"pilz::CommandPlanner"};
+const std::string DEFAULT_REQUEST_ADAPTERS {"default_planner_request_adapters/FixWorkspaceBounds "
+                                            "default_planner_request_adapters/FixStartStateBounds "
+                                            "default_planner_request_adapters/FixStartStateCollision "
+                                            "default_planner_request_adapters/FixStartStatePathConstraints"};
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Sets the parameter from its XML-RPC encoding, if it was recorded.
+ */
+void setParameterXml(const std::string& name, const std::string& xml)
+{
+  if(xml.empty())
+  {
+    return;
+  }
+  XmlRpc::XmlRpcValue value;
+  int offset {0};
+  if(!value.fromXml(xml, &offset))
+  {
+    throw std::runtime_error("Recorded parameter " + name + " is not valid XML-RPC");
+  }
+  ros::param::set(name, value);
+}
+
+void setParameters(const pilz_msgs::PlanningParametersRecord& parameters)
+{
+  ros::param::set(ROBOT_DESCRIPTION_STR, parameters.robot_description);
+  ros::param::set(ROBOT_DESCRIPTION_STR + "_semantic", parameters.robot_description_semantic);
+  setParameterXml(ROBOT_DESCRIPTION_STR + "_kinematics", parameters.robot_description_kinematics);
+  setParameterXml(ROBOT_DESCRIPTION_STR + "_planning", parameters.robot_description_planning);
+}
+
+void setDefaultParameter(ros::NodeHandle& nh, const std::string& name, const std::string& value)
+{
+  if(!nh.hasParam(name))
+  {
+    nh.setParam(name, value);
+  }
+}
+
+double toMilliseconds(const Clock::duration& duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "replay_planning_requests", ros::init_options::AnonymousName);
+  if(argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <request_log.bag>" << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    rosbag::Bag bag(argv[1], rosbag::bagmode::Read);
+
+    rosbag::View parameters_view(bag, rosbag::TopicQuery(pilz::PlanningRequestRecorder::PARAMETERS_TOPIC));
+    if(parameters_view.size() == 0)
+    {
+      ROS_ERROR_STREAM(argv[1] << " contains no recorded planning parameters");
+      return 1;
+    }
+    const pilz_msgs::PlanningParametersRecordConstPtr parameters {
+      parameters_view.begin()->instantiate<pilz_msgs::PlanningParametersRecord>()};
+    setParameters(*parameters);
+
+    ros::NodeHandle ph("~");
+    setDefaultParameter(ph, PARAM_PLANNING_PLUGIN, DEFAULT_PLANNING_PLUGIN);
+    setDefaultParameter(ph, PARAM_REQUEST_ADAPTERS, DEFAULT_REQUEST_ADAPTERS);
+    int repetitions {1};
+    ph.param(PARAM_REPETITIONS, repetitions, repetitions);
+
+    const robot_model::RobotModelConstPtr robot_model {
+      robot_model_loader::RobotModelLoader(ROBOT_DESCRIPTION_STR).getModel()};
+    if(!robot_model)
+    {
+      ROS_ERROR_STREAM("Failed to load the recorded robot model " << parameters->robot_model_name);
+      return 1;
+    }
+    const planning_pipeline::PlanningPipelinePtr pipeline {
+      std::make_shared<planning_pipeline::PlanningPipeline>(robot_model, ph)};
+    pilz_trajectory_generation::CommandListManager manager(ph, robot_model);
+
+    std::vector<double> planning_times;
+    std::size_t failure_count {0};
+    std::cout << "index,source,items,repetition,error_code,planning_time_ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    std::size_t index {0};
+    rosbag::View requests_view(bag, rosbag::TopicQuery(pilz::PlanningRequestRecorder::REQUEST_TOPIC));
+    for(const rosbag::MessageInstance& instance : requests_view)
+    {
+      const pilz_msgs::PlanningRequestRecordConstPtr record {instance.instantiate<pilz_msgs::PlanningRequestRecord>()};
+      if(record->robot_model_name != robot_model->getName())
+      {
+        ROS_WARN_STREAM("Request " << index << " was recorded for robot model " << record->robot_model_name);
+      }
+
+      const planning_scene::PlanningScenePtr scene {std::make_shared<planning_scene::PlanningScene>(robot_model)};
+      scene->setPlanningSceneMsg(record->planning_scene);
+
+      for(int repetition = 0; repetition < repetitions; ++repetition)
+      {
+        moveit_msgs::MoveItErrorCodes error_code;
+        error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+        const Clock::time_point start {Clock::now()};
+        try
+        {
+          manager.solve(scene, pipeline, record->request);
+        }
+        catch(const pilz_trajectory_generation::MoveItErrorCodeException& ex)
+        {
+          error_code.val = ex.getErrorCode();
+        }
+        const double planning_time {toMilliseconds(Clock::now() - start)};
+
+        if(error_code.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
+        {
+          planning_times.push_back(planning_time);
+        }
+        else
+        {
+          ++failure_count;
+        }
+        std::cout << index << "," << record->source << "," << record->request.items.size() << ","
+                  << repetition << "," << error_code.val << "," << planning_time << std::endl;
+      }
+      ++index;
+    }
+
+    std::sort(planning_times.begin(), planning_times.end());
+    std::cerr << "Replayed " << index << " requests, " << failure_count << " failed plannings" << std::endl;
+    if(!planning_times.empty())
+    {
+      double total {0.};
+      for(const double time : planning_times)
+      {
+        total += time;
+      }
+      std::cerr << std::fixed << std::setprecision(3)
+                << "Planning time [ms] of successful plannings: mean " << total / planning_times.size()
+                << ", median " << planning_times.at(planning_times.size() / 2)
+                << ", max " << planning_times.back() << std::endl;
+    }
+  }
+  catch(const std::exception& ex)
+  {
+    ROS_ERROR_STREAM("Replay failed: " << ex.what());
+    return 1;
+  }
+  return 0;
+}